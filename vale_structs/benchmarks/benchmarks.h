@@ -0,0 +1,221 @@
+/** @file benchmarks.h
+* @brief Header that declares the benchmark suites of the structs.
+* Each suite compares a vale struct with its standard library counterpart using nanobench.
+* Suites are run by passing '--bench' to the executable, optionally followed by
+* the name of the suite to run (all suites are run if no name is given).
+* Without arguments, the executable runs the checks instead, and exits with a failure if any fails.
+*/
+
+#pragma once
+#include <vale_structs/array.h>
+#include <vale_structs/vector.h>
+
+namespace vale::benchmarks
+{
+	/// @brief Benchmarks vale::vector against std::vector
+	void bench_vector();
+
+	/// @brief Counts the allocations of vale::small_vector against std::vector
+	void bench_small_vector();
+
+	/// @brief Benchmarks concurrent appends to vale::ts_vector against a std::vector protected by a std::mutex
+	void bench_ts_vector();
+
+	/// @brief Benchmarks reading a file into a zero-filled std::vector against the uninitialized vale::vector APIs
+	void bench_bulk_io();
+
+	/// @brief Benchmarks growing and reading a very large vale::vector using mmap_allocator against heap_allocator
+	void bench_mmap_vector();
+
+	/// @brief Benchmarks opening a vale::mapped_vector file against deserializing the same table from a stream
+	void bench_mapped_vector();
+
+	/// @brief Benchmarks the memory footprint and scan throughput of vale::packed_vector against std::vector
+	void bench_packed_vector();
+
+	/// @brief Benchmarks vale::static_vector against a std::vector with reserved capacity
+	void bench_static_vector();
+
+	/// @brief Checks that erasing ranges of a vale::static_vector (including empty ones) keeps the other objects intact
+	/// @return The number of failures
+	size_t check_static_vector_erase();
+
+	/// @brief Benchmarks the allocations and latency of vale::string against std::string on short keys
+	void bench_string();
+
+	/// @brief Benchmarks find/count/split/contains on log text against std::string and std::string_view
+	void bench_string_search();
+
+	/// @brief Benchmarks the memory use and multi-threaded interning throughput of vale::string_pool
+	void bench_string_pool();
+
+	/// @brief Benchmarks handing copies of payloads to many workers with vale::shared_string and
+	/// vale::ts_shared_string against std::string copies, on one and several threads
+	void bench_shared_string();
+
+	/// @brief Benchmarks vale::rope against std::string on large documents built through appends and splices
+	void bench_rope();
+
+	/// @brief Checks the vectorized UTF-8 functions against their scalar reference on random inputs
+	/// (exiting with a failure on a mismatch), then benchmarks their throughput against it
+	void bench_utf8();
+
+	/// @brief Checks that the vectorized UTF-8 functions agree with their scalar reference
+	/// on random valid, corrupted and truncated strings
+	/// @return The number of mismatches
+	size_t check_utf8_equivalence();
+
+	/// @brief Benchmarks formatting and parsing integers and doubles with vale::string against
+	/// std::ostringstream, snprintf, strtod and std::to_chars/from_chars
+	void bench_number_format();
+
+	/// @brief Benchmarks building log lines with vale::format against std::ostringstream and snprintf
+	void bench_format();
+
+	/// @brief Benchmarks the lines per second of vale::multi_matcher against one search per pattern,
+	/// with 10, 100 and 1000 patterns
+	void bench_multi_match();
+
+	/// @brief Benchmarks the allocations and the push/pop latency of vale::intrusive_list against std::list
+	void bench_intrusive_list();
+
+	/// @brief Benchmarks traversing a vale::list built through random insertions, before and after compact(),
+	/// against a std::list
+	void bench_list();
+
+	/// @brief Benchmarks summing the values of a vale::unrolled_list, and inserting values at random positions,
+	/// against a std::list, a std::deque and a std::vector
+	void bench_unrolled_list();
+
+	/// @brief Benchmarks recycling buffers through a vale::lock_free_stack from 1 to 64 threads,
+	/// against a stack protected by a std::mutex
+	void bench_lock_free_stack();
+
+	/// @brief Benchmarks a mixed workload of lookups, insertions and erasures on a vale::ts_skip_list_map
+	/// from 1 to 64 threads, against a std::map protected by a std::mutex
+	void bench_skip_list_map();
+
+	/// @brief Benchmarks inserting, searching (present and missing keys) and erasing keys of a vale::map
+	/// against a std::unordered_map, and heterogeneous lookups of string keys
+	void bench_map();
+
+	/// @brief Benchmarks 95/5 and 50/50 mixes of lookups and assignments on a vale::ts_map
+	/// from 1 to 64 threads, against a std::unordered_map protected by a single std::mutex
+	void bench_ts_map();
+
+	/// @brief Benchmarks inserting, searching, range scanning, bulk loading and erasing keys of a vale::btree_map
+	/// against a std::map, and prints the memory used by both
+	void bench_btree_map();
+
+	/// @brief Allocator policy which counts the calls to allocate() and reallocate(), and the bytes allocated
+	struct counting_allocator
+	{
+		/// @brief The number of allocations since the last reset
+		static inline size_t allocations = 0;
+		/// @brief The number of bytes currently allocated (which may wrap around between resets)
+		static inline size_t allocated_bytes = 0;
+
+		static void* allocate(size_t bytes, size_t alignment)
+		{
+			++allocations;
+			void* result = heap_allocator::allocate(bytes, alignment);
+			allocated_bytes += bytes;
+			return result;
+		}
+
+		static void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t alignment)
+		{
+			++allocations;
+			void* result = heap_allocator::reallocate(ptr, old_bytes, new_bytes, alignment);
+			allocated_bytes += new_bytes - old_bytes;
+			return result;
+		}
+
+		static void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept
+		{
+			allocated_bytes -= bytes;
+			heap_allocator::deallocate(ptr, bytes, alignment);
+		}
+	};
+
+	template<typename T>
+	/// @brief Standard allocator which counts its allocations in counting_allocator::allocations
+	struct counting_std_allocator
+	{
+		using value_type = T;
+
+		counting_std_allocator() = default;
+		template<typename U>
+		counting_std_allocator(const counting_std_allocator<U>&) noexcept {}
+
+		T* allocate(size_t count)
+		{
+			++counting_allocator::allocations;
+			T* result = std::allocator<T>().allocate(count);
+			counting_allocator::allocated_bytes += count * sizeof(T);
+			return result;
+		}
+
+		void deallocate(T* ptr, size_t count) noexcept
+		{
+			counting_allocator::allocated_bytes -= count * sizeof(T);
+			std::allocator<T>().deallocate(ptr, count);
+		}
+
+		friend bool operator==(const counting_std_allocator&, const counting_std_allocator&) { return true; }
+		friend bool operator!=(const counting_std_allocator&, const counting_std_allocator&) { return false; }
+	};
+
+	/// @brief A benchmark suite which can be selected from the command line
+	struct suite
+	{
+		/// @brief The name of the suite
+		const char* name;
+		/// @brief The function running the suite
+		void(*run)();
+	};
+
+	/// @brief All the benchmark suites, in the order in which they are run
+	inline const vale::array suites = {
+		suite{ "vector", &bench_vector },
+		suite{ "small_vector", &bench_small_vector },
+		suite{ "ts_vector", &bench_ts_vector },
+		suite{ "bulk_io", &bench_bulk_io },
+		suite{ "mmap_vector", &bench_mmap_vector },
+		suite{ "mapped_vector", &bench_mapped_vector },
+		suite{ "packed_vector", &bench_packed_vector },
+		suite{ "static_vector", &bench_static_vector },
+		suite{ "string", &bench_string },
+		suite{ "string_search", &bench_string_search },
+		suite{ "string_pool", &bench_string_pool },
+		suite{ "rope", &bench_rope },
+		suite{ "shared_string", &bench_shared_string },
+		suite{ "utf8", &bench_utf8 },
+		suite{ "number_format", &bench_number_format },
+		suite{ "format", &bench_format },
+		suite{ "multi_match", &bench_multi_match },
+		suite{ "intrusive_list", &bench_intrusive_list },
+		suite{ "list", &bench_list },
+		suite{ "unrolled_list", &bench_unrolled_list },
+		suite{ "lock_free_stack", &bench_lock_free_stack },
+		suite{ "skip_list_map", &bench_skip_list_map },
+		suite{ "map", &bench_map },
+		suite{ "ts_map", &bench_ts_map },
+		suite{ "btree_map", &bench_btree_map }
+	};
+
+	/// @brief A check run when the executable is given no arguments (as by ctest)
+	struct check
+	{
+		/// @brief The name of the check
+		const char* name;
+		/// @brief The function running the check, which returns its number of failures
+		size_t(*run)();
+	};
+
+	/// @brief All the checks, in the order in which they are run
+	inline const vale::array checks = {
+		check{ "static_vector_erase", &check_static_vector_erase },
+		check{ "utf8_equivalence", &check_utf8_equivalence }
+	};
+}
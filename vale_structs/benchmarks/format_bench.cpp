@@ -0,0 +1,172 @@
+#include <comppch.h>
+#include <nanobench.h>
+
+#include <vale_structs/format.h>
+#include <vale_structs/variant.h>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstdio>
+#include <iostream>
+
+#include "benchmarks.h"
+
+namespace vale::benchmarks
+{
+	/// @brief Number of log lines formatted in each iteration of the format benchmark
+	static constexpr size_t FORMAT_BENCH_LINES = 10000;
+
+	/// @brief The fields of a request log line
+	struct request_record
+	{
+		int64_t timestamp;
+		const char* method;
+		std::string path;
+		int status;
+		double latency_ms;
+		uint64_t bytes;
+	};
+
+	/// @brief Returns FORMAT_BENCH_LINES request records
+	/// @return The records
+	static std::vector<request_record> make_request_records()
+	{
+		static const char* const methods[] = { "GET", "POST", "PUT", "DELETE" };
+		static const int statuses[] = { 200, 200, 200, 201, 304, 404, 500 };
+		std::vector<request_record> records;
+		records.reserve(FORMAT_BENCH_LINES);
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (size_t i = 0; i < FORMAT_BENCH_LINES; i++)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			records.push_back(request_record{
+				static_cast<int64_t>(1700000000000 + i * 37),
+				methods[(state >> 33) % 4],
+				"/api/v1/items/" + std::to_string((state >> 40) % 100000),
+				statuses[(state >> 20) % 7],
+				static_cast<double>((state >> 44) % 100000) / 1000.0,
+				(state >> 30) % 1000000 });
+		}
+		return records;
+	}
+
+	void bench_format()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		const std::vector<request_record> records = make_request_records();
+
+		ankerl::nanobench::Bench bench;
+		bench.relative(true).minEpochIterations(10).batch(FORMAT_BENCH_LINES).unit("line");
+
+		bench.title("format request log lines");
+		bench.run("std::ostringstream <<", [&]() {
+			size_t total = 0;
+			for (const request_record& r : records)
+			{
+				std::ostringstream os;
+				os << '[' << r.timestamp << "] " << r.method << ' ' << r.path << " -> "
+					<< r.status << " in " << r.latency_ms << "ms (" << r.bytes << " bytes)";
+				total += os.str().size();
+			}
+			doNotOptimizeAway(total);
+		});
+		bench.run("snprintf", [&]() {
+			size_t total = 0;
+			for (const request_record& r : records)
+			{
+				char buffer[256];
+				const int size = std::snprintf(buffer, sizeof(buffer), "[%lld] %s %s -> %d in %gms (%llu bytes)",
+					static_cast<long long>(r.timestamp), r.method, r.path.c_str(), r.status, r.latency_ms,
+					static_cast<unsigned long long>(r.bytes));
+				total += std::string(buffer, size).size();
+			}
+			doNotOptimizeAway(total);
+		});
+		bench.run("vale::format", [&]() {
+			size_t total = 0;
+			for (const request_record& r : records)
+			{
+				const vale::string line = vale::format(VALE_FORMAT("[{}] {} {} -> {} in {}ms ({} bytes)"),
+					r.timestamp, r.method, r.path, r.status, r.latency_ms, r.bytes);
+				total += line.size();
+			}
+			doNotOptimizeAway(total);
+		});
+		bench.run("vale::format_to (buffer)", [&]() {
+			size_t total = 0;
+			for (const request_record& r : records)
+			{
+				char buffer[256];
+				total += vale::format_to(buffer, sizeof(buffer), VALE_FORMAT("[{}] {} {} -> {} in {}ms ({} bytes)"),
+					r.timestamp, r.method, r.path, r.status, r.latency_ms, r.bytes);
+			}
+			doNotOptimizeAway(total);
+		});
+
+		//Appending every line to a single string, whose growth should be amortized
+		using counted_string = vale::basic_string<vale::default_growth, counting_allocator>;
+		const auto append_lines = [&records](counted_string& out) {
+			for (const request_record& r : records)
+				vale::format_append(out, VALE_FORMAT("[{}] {} {} -> {} in {}ms ({} bytes)\n"),
+					r.timestamp, r.method, r.path, r.status, r.latency_ms, r.bytes);
+		};
+		counting_allocator::allocations = 0;
+		{
+			counted_string out;
+			append_lines(out);
+		}
+		std::cout << "vale::format_append: " << counting_allocator::allocations << " allocations to append "
+			<< records.size() << " lines to one string\n";
+
+		bench.title("append request log lines to one string");
+		bench.run("std::ostringstream <<", [&]() {
+			std::ostringstream os;
+			for (const request_record& r : records)
+				os << '[' << r.timestamp << "] " << r.method << ' ' << r.path << " -> "
+					<< r.status << " in " << r.latency_ms << "ms (" << r.bytes << " bytes)\n";
+			doNotOptimizeAway(os.str().size());
+		});
+		bench.run("snprintf + std::string::append", [&]() {
+			std::string out;
+			for (const request_record& r : records)
+			{
+				char buffer[256];
+				const int size = std::snprintf(buffer, sizeof(buffer), "[%lld] %s %s -> %d in %gms (%llu bytes)\n",
+					static_cast<long long>(r.timestamp), r.method, r.path.c_str(), r.status, r.latency_ms,
+					static_cast<unsigned long long>(r.bytes));
+				out.append(buffer, size);
+			}
+			doNotOptimizeAway(out.size());
+		});
+		bench.run("vale::format_append", [&]() {
+			counted_string out;
+			append_lines(out);
+			doNotOptimizeAway(out.size());
+		});
+
+		//Containers are printed through their print(std::ostream&) or print(String&) method
+		using sample = vale::variant<int64_t, double>;
+		std::vector<vale::array<sample, 3>> samples;
+		samples.reserve(records.size());
+		for (const request_record& r : records)
+			samples.push_back({ sample{ int64_t{ r.status } }, sample{ double{ r.latency_ms } }, sample{ int64_t{ r.timestamp } } });
+
+		bench.title("format lines with an array of variants");
+		bench.run("std::ostringstream <<", [&]() {
+			size_t total = 0;
+			for (size_t i = 0; i < records.size(); i++)
+			{
+				std::ostringstream os;
+				os << records[i].path << ": " << samples[i];
+				total += os.str().size();
+			}
+			doNotOptimizeAway(total);
+		});
+		bench.run("vale::format", [&]() {
+			size_t total = 0;
+			for (size_t i = 0; i < records.size(); i++)
+				total += vale::format(VALE_FORMAT("{}: {}"), records[i].path, samples[i]).size();
+			doNotOptimizeAway(total);
+		});
+	}
+}
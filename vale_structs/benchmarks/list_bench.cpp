@@ -0,0 +1,346 @@
+#include <comppch.h>
+#include <nanobench.h>
+
+#include <vale_structs/list.h>
+#include <vector>
+#include <list>
+#include <deque>
+#include <string>
+#include <iostream>
+#include <thread>
+#include <mutex>
+
+#include "benchmarks.h"
+
+namespace vale::benchmarks
+{
+	/// @brief Number of jobs queued and dequeued in each iteration of the intrusive list benchmark
+	static constexpr size_t INTRUSIVE_LIST_BENCH_JOBS = 100000;
+
+	/// @brief Number of nodes of the lists traversed by the list benchmark.
+	/// Lower it on machines with less than 2 GB of memory.
+	static constexpr size_t LIST_BENCH_NODES = 10'000'000;
+
+	/// @brief Number of values summed by the scan rows of the unrolled list benchmark
+	static constexpr size_t UNROLLED_LIST_BENCH_SCAN = 1'000'000;
+
+	/// @brief Number of values inserted at random positions by the insert rows of the unrolled list benchmark
+	static constexpr size_t UNROLLED_LIST_BENCH_INSERTS = 20000;
+
+	/// @brief Number of pop + push pairs executed by all the threads of the lock-free stack benchmark
+	static constexpr size_t STACK_BENCH_OPERATIONS = 1'000'000;
+
+	/// @brief Number of buffers recycled through the stacks of the lock-free stack benchmark
+	static constexpr size_t STACK_BENCH_BUFFERS = 1024;
+
+	/// @brief A job of a scheduler, which is both in the ready queue and in the timer list
+	struct bench_job
+	{
+		/// @brief The identifier of the job
+		uint64_t id = 0;
+		/// @brief The hook of the ready queue
+		vale::list_hook<> ready_hook;
+		/// @brief The hook of the timer list
+		vale::list_hook<> timer_hook;
+	};
+
+	void bench_intrusive_list()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		using ready_list = vale::intrusive_list<bench_job, &bench_job::ready_hook>;
+		using timer_list = vale::intrusive_list<bench_job, &bench_job::timer_hook>;
+		using std_list = std::list<bench_job*, counting_std_allocator<bench_job*>>;
+
+		std::vector<bench_job> jobs(INTRUSIVE_LIST_BENCH_JOBS);
+		for (size_t i = 0; i < jobs.size(); i++)
+			jobs[i].id = i;
+
+		//Timers are cancelled in O(1) through the hook, or through an iterator stored next to the job
+		std::vector<std_list::iterator> timer_iterators(jobs.size());
+		const auto run_std = [&]() {
+			std_list ready, timers;
+			uint64_t checksum = 0;
+			for (auto& job : jobs)
+			{
+				ready.push_back(&job);
+				timer_iterators[job.id] = timers.insert(timers.end(), &job);
+			}
+			while (!ready.empty())
+			{
+				bench_job* job = ready.front();
+				ready.pop_front();
+				if (job->id % 4 == 0)
+					timers.erase(timer_iterators[job->id]);
+				checksum += job->id;
+			}
+			return checksum;
+		};
+		const auto run_intrusive = [&]() {
+			ready_list ready;
+			timer_list timers;
+			uint64_t checksum = 0;
+			for (auto& job : jobs)
+			{
+				ready.push_back(job);
+				timers.push_back(job);
+			}
+			while (!ready.is_empty())
+			{
+				bench_job& job = ready.pop_front();
+				if (job.id % 4 == 0)
+					timers.erase(job);
+				checksum += job.id;
+			}
+			return checksum;
+		};
+
+		counting_allocator::allocations = 0;
+		doNotOptimizeAway(run_std());
+		std::cout << "std::list: " << double(counting_allocator::allocations) / jobs.size() << " allocations per job\n";
+		std::cout << "vale::intrusive_list: 0 allocations per job\n";
+
+		ankerl::nanobench::Bench bench;
+		bench.title("queue and dequeue jobs in 2 lists").relative(true).minEpochIterations(10)
+			.batch(INTRUSIVE_LIST_BENCH_JOBS).unit("job");
+		bench.run("std::list<T*>", [&]() { doNotOptimizeAway(run_std()); });
+		bench.run("vale::intrusive_list", [&]() { doNotOptimizeAway(run_intrusive()); });
+
+		//Latency of a single push and pop on a warm list
+		std_list std_ready;
+		ready_list intrusive_ready;
+		bench.title("push_back + pop_front").batch(1).unit("op").minEpochIterations(100000);
+		bench.run("std::list<T*>", [&]() {
+			std_ready.push_back(&jobs[0]);
+			doNotOptimizeAway(std_ready.front());
+			std_ready.pop_front();
+		});
+		bench.run("vale::intrusive_list", [&]() {
+			intrusive_ready.push_back(jobs[0]);
+			doNotOptimizeAway(&intrusive_ready.pop_front());
+		});
+	}
+
+	template<typename List>
+	/// @brief Builds a list of LIST_BENCH_NODES values by inserting each value before a random node,
+	/// so that the order of the list is unrelated to the order in which the nodes were allocated
+	/// @return The list
+	static List make_scattered_list()
+	{
+		List result;
+		std::vector<typename List::iterator> nodes;
+		nodes.reserve(LIST_BENCH_NODES);
+		nodes.push_back(result.insert(result.end(), 0));
+		uint64_t state = 1;
+		for (size_t i = 1; i < LIST_BENCH_NODES; i++)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			nodes.push_back(result.insert(nodes[(state >> 33) % nodes.size()], i));
+		}
+		return result;
+	}
+
+	void bench_list()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		ankerl::nanobench::Bench bench;
+		bench.title("traverse a list of " + std::to_string(LIST_BENCH_NODES) + " nodes").relative(true)
+			.epochs(3).minEpochIterations(1).batch(LIST_BENCH_NODES).unit("node");
+		{
+			const auto list = make_scattered_list<std::list<uint64_t>>();
+			bench.run("std::list", [&]() {
+				uint64_t sum = 0;
+				for (const uint64_t value : list)
+					sum += value;
+				doNotOptimizeAway(sum);
+			});
+		}
+		auto list = make_scattered_list<vale::list<uint64_t>>();
+		const auto iterate = [&]() {
+			uint64_t sum = 0;
+			for (const uint64_t value : list)
+				sum += value;
+			doNotOptimizeAway(sum);
+		};
+		const auto for_each = [&]() {
+			uint64_t sum = 0;
+			list.for_each([&sum](uint64_t value) { sum += value; });
+			doNotOptimizeAway(sum);
+		};
+		bench.run("vale::list (iterators)", iterate);
+		bench.run("vale::list (for_each)", for_each);
+		//A single run: the first compaction is the one which moves scattered nodes
+		ankerl::nanobench::Bench compaction;
+		compaction.title("compact a scattered list of " + std::to_string(LIST_BENCH_NODES) + " nodes")
+			.epochs(1).minEpochIterations(1).batch(LIST_BENCH_NODES).unit("node");
+		compaction.run("vale::list::compact()", [&]() { list.compact(); });
+
+		bench.run("vale::list after compact() (iterators)", iterate);
+		bench.run("vale::list after compact() (for_each)", for_each);
+	}
+
+	template<typename Container>
+	/// @brief Inserts UNROLLED_LIST_BENCH_INSERTS values, each before a random position of the container
+	/// @return The sum of the values, in the order of the container
+	static uint64_t insert_at_random_positions()
+	{
+		Container container;
+		uint64_t state = 1;
+		for (size_t i = 0; i < UNROLLED_LIST_BENCH_INSERTS; i++)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			const size_t index = (state >> 33) % (container.size() + 1);
+			if constexpr (std::is_same_v<Container, std::list<uint64_t>>)
+				container.insert(std::next(container.begin(), index), i);
+			else if constexpr (std::is_same_v<Container, std::vector<uint64_t>> || std::is_same_v<Container, std::deque<uint64_t>>)
+				container.insert(container.begin() + index, i);
+			else
+				container.insert(container.iterator_at(index), i);
+		}
+		uint64_t sum = 0;
+		for (const uint64_t value : container)
+			sum += value;
+		return sum;
+	}
+
+	void bench_unrolled_list()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		const auto scan = [](auto& bench, const char* name, const auto& container) {
+			bench.run(name, [&]() {
+				uint64_t sum = 0;
+				for (const uint64_t value : container)
+					sum += value;
+				doNotOptimizeAway(sum);
+			});
+		};
+
+		ankerl::nanobench::Bench bench;
+		bench.title("sum " + std::to_string(UNROLLED_LIST_BENCH_SCAN) + " values").relative(true)
+			.minEpochIterations(5).batch(UNROLLED_LIST_BENCH_SCAN).unit("value");
+		{
+			std::list<uint64_t> list;
+			uint64_t state = 1;
+			//Random insertions, so that the order of the list is unrelated to the order of the allocations
+			std::vector<std::list<uint64_t>::iterator> nodes;
+			nodes.reserve(UNROLLED_LIST_BENCH_SCAN);
+			nodes.push_back(list.insert(list.end(), 0));
+			for (size_t i = 1; i < UNROLLED_LIST_BENCH_SCAN; i++)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				nodes.push_back(list.insert(nodes[(state >> 33) % nodes.size()], i));
+			}
+			scan(bench, "std::list", list);
+		}
+		{
+			std::deque<uint64_t> deque;
+			for (size_t i = 0; i < UNROLLED_LIST_BENCH_SCAN; i++)
+				deque.push_back(i);
+			scan(bench, "std::deque", deque);
+		}
+		{
+			std::vector<uint64_t> vector;
+			for (size_t i = 0; i < UNROLLED_LIST_BENCH_SCAN; i++)
+				vector.push_back(i);
+			scan(bench, "std::vector", vector);
+		}
+		vale::unrolled_list<uint64_t> unrolled;
+		for (size_t i = 0; i < UNROLLED_LIST_BENCH_SCAN; i++)
+			unrolled.push_back(i);
+		scan(bench, "vale::unrolled_list (iterators)", unrolled);
+		bench.run("vale::unrolled_list (blocks)", [&]() {
+			uint64_t sum = 0;
+			for (const auto block : unrolled.blocks())
+			{
+				const uint64_t* data = block.data();
+				for (size_t i = 0; i < block.size(); i++)
+					sum += data[i];
+			}
+			doNotOptimizeAway(sum);
+		});
+
+		ankerl::nanobench::Bench insert;
+		insert.title("insert " + std::to_string(UNROLLED_LIST_BENCH_INSERTS) + " values at random positions").relative(true)
+			.epochs(3).minEpochIterations(1).batch(UNROLLED_LIST_BENCH_INSERTS).unit("insert");
+		insert.run("std::list", [&]() { doNotOptimizeAway(insert_at_random_positions<std::list<uint64_t>>()); });
+		insert.run("std::deque", [&]() { doNotOptimizeAway(insert_at_random_positions<std::deque<uint64_t>>()); });
+		insert.run("std::vector", [&]() { doNotOptimizeAway(insert_at_random_positions<std::vector<uint64_t>>()); });
+		insert.run("vale::unrolled_list", [&]() { doNotOptimizeAway(insert_at_random_positions<vale::unrolled_list<uint64_t>>()); });
+	}
+
+	/// @brief A buffer recycled between threads by the lock-free stack benchmark
+	struct bench_buffer
+	{
+		/// @brief The content of the buffer
+		uint64_t data[7] = {};
+		/// @brief The hook of the free list
+		vale::stack_hook hook;
+	};
+
+	/// @brief A free list protected by a std::mutex, to which the lock-free stack is compared
+	class mutex_stack
+	{
+		std::mutex mutex;
+		std::vector<bench_buffer*> buffers;
+
+	public:
+		void push(bench_buffer& buffer)
+		{
+			std::scoped_lock lock(mutex);
+			buffers.push_back(&buffer);
+		}
+
+		bench_buffer* try_pop()
+		{
+			std::scoped_lock lock(mutex);
+			if (buffers.empty())
+				return nullptr;
+			bench_buffer* result = buffers.back();
+			buffers.pop_back();
+			return result;
+		}
+	};
+
+	template<typename Stack>
+	/// @brief Splits STACK_BENCH_OPERATIONS pop + push pairs between 'nb_threads' threads, each thread
+	/// taking a buffer from the stack, writing to it, and returning it
+	/// @param stack The stack of the free buffers
+	/// @param nb_threads The number of threads
+	static void recycle_buffers(Stack& stack, size_t nb_threads)
+	{
+		const auto worker = [&stack, nb_threads]() {
+			for (size_t i = 0; i < STACK_BENCH_OPERATIONS / nb_threads; i++)
+			{
+				bench_buffer* buffer = stack.try_pop();
+				if (buffer == nullptr)
+					continue;
+				buffer->data[0] += i;
+				stack.push(*buffer);
+			}
+		};
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < nb_threads; t++)
+			threads.emplace_back(worker);
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	void bench_lock_free_stack()
+	{
+		std::vector<bench_buffer> buffers(STACK_BENCH_BUFFERS);
+		vale::lock_free_stack<bench_buffer, &bench_buffer::hook> lock_free;
+		mutex_stack locked;
+		for (auto& buffer : buffers)
+		{
+			lock_free.push(buffer);
+			locked.push(buffer);
+		}
+		for (const size_t nb_threads : { 1, 2, 4, 8, 16, 32, 64 })
+		{
+			ankerl::nanobench::Bench bench;
+			bench.title("pop + push on " + std::to_string(nb_threads) + " threads").relative(true)
+				.minEpochIterations(3).batch(STACK_BENCH_OPERATIONS).unit("pop + push");
+			bench.run("std::mutex + std::vector", [&]() { recycle_buffers(locked, nb_threads); });
+			bench.run("vale::lock_free_stack", [&]() { recycle_buffers(lock_free, nb_threads); });
+		}
+	}
+}
@@ -0,0 +1,392 @@
+#include <comppch.h>
+#include <nanobench.h>
+
+#include <vale_structs/map.h>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <string_view>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <algorithm>
+#include <iostream>
+
+#include "benchmarks.h"
+
+namespace vale::benchmarks
+{
+	/// @brief Number of keys of the skip list benchmark (half of them are in the maps at any time)
+	static constexpr size_t SKIP_LIST_BENCH_KEYS = 100000;
+
+	/// @brief Number of operations executed by all the threads of the skip list benchmark
+	static constexpr size_t SKIP_LIST_BENCH_OPERATIONS = 1'000'000;
+
+	/// @brief Number of keys inserted, searched and erased by the hash map benchmark
+	static constexpr size_t MAP_BENCH_KEYS = 1'000'000;
+
+	/// @brief Number of keys of the thread safe hash map benchmark (all of them are in the maps)
+	static constexpr size_t TS_MAP_BENCH_KEYS = 100000;
+
+	/// @brief Number of operations executed by all the threads of the thread safe hash map benchmark
+	static constexpr size_t TS_MAP_BENCH_OPERATIONS = 1'000'000;
+
+	/// @brief Number of keys of the B-tree benchmark
+	static constexpr size_t BTREE_BENCH_KEYS = 1'000'000;
+
+	/// @brief Number of consecutive keys read by each range scan of the B-tree benchmark
+	static constexpr size_t BTREE_BENCH_SCAN_LENGTH = 1000;
+
+	/// @brief Number of range scans of the B-tree benchmark
+	static constexpr size_t BTREE_BENCH_SCANS = 1000;
+
+	/// @brief A std::map protected by a std::mutex, to which the lock-free skip list is compared
+	class mutex_map
+	{
+		mutable std::mutex mutex;
+		std::map<uint64_t, uint64_t> map;
+
+	public:
+		bool insert(uint64_t key, uint64_t value)
+		{
+			std::scoped_lock lock(mutex);
+			return map.emplace(key, value).second;
+		}
+
+		bool erase(uint64_t key)
+		{
+			std::scoped_lock lock(mutex);
+			return map.erase(key) != 0;
+		}
+
+		bool try_get(uint64_t key, uint64_t& out) const
+		{
+			std::scoped_lock lock(mutex);
+			auto it = map.find(key);
+			if (it == map.end())
+				return false;
+			out = it->second;
+			return true;
+		}
+	};
+
+	template<typename Map>
+	/// @brief Splits SKIP_LIST_BENCH_OPERATIONS operations between 'nb_threads' threads:
+	/// 80% of lookups, 10% of insertions and 10% of erasures of random keys
+	/// @param map The map
+	/// @param nb_threads The number of threads
+	/// @return The number of successful lookups
+	static size_t mixed_workload(Map& map, size_t nb_threads)
+	{
+		std::atomic<size_t> found{ 0 };
+		const auto worker = [&map, &found, nb_threads](uint64_t state) {
+			size_t local_found = 0;
+			for (size_t i = 0; i < SKIP_LIST_BENCH_OPERATIONS / nb_threads; i++)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				const uint64_t key = (state >> 33) % SKIP_LIST_BENCH_KEYS;
+				const uint64_t operation = (state >> 20) % 10;
+				uint64_t value;
+				if (operation == 0)
+					map.insert(key, key);
+				else if (operation == 1)
+					map.erase(key);
+				else
+					local_found += map.try_get(key, value);
+			}
+			found.fetch_add(local_found, std::memory_order_relaxed);
+		};
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < nb_threads; t++)
+			threads.emplace_back(worker, t + 1);
+		for (auto& thread : threads)
+			thread.join();
+		return found.load();
+	}
+
+	void bench_skip_list_map()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		mutex_map locked;
+		vale::ts_skip_list_map<uint64_t, uint64_t> lock_free;
+		for (uint64_t key = 0; key < SKIP_LIST_BENCH_KEYS; key += 2)
+		{
+			locked.insert(key, key);
+			lock_free.insert(key, key);
+		}
+		for (const size_t nb_threads : { 1, 2, 4, 8, 16, 32, 64 })
+		{
+			ankerl::nanobench::Bench bench;
+			bench.title("80% lookups, 10% insertions, 10% erasures on " + std::to_string(nb_threads) + " threads").relative(true)
+				.minEpochIterations(3).batch(SKIP_LIST_BENCH_OPERATIONS).unit("op");
+			bench.run("std::mutex + std::map", [&]() { doNotOptimizeAway(mixed_workload(locked, nb_threads)); });
+			bench.run("vale::ts_skip_list_map", [&]() { doNotOptimizeAway(mixed_workload(lock_free, nb_threads)); });
+		}
+	}
+
+	/// @brief Returns MAP_BENCH_KEYS distinct pseudo-random keys
+	static std::vector<uint64_t> make_map_keys(uint64_t seed)
+	{
+		std::vector<uint64_t> keys(MAP_BENCH_KEYS);
+		uint64_t state = seed;
+		for (auto& key : keys)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			//The lowest bit tells the present keys (odd) from the missing keys (even)
+			key = (state & ~uint64_t(1)) | (seed & 1);
+		}
+		return keys;
+	}
+
+	template<typename Map>
+	/// @brief Benchmarks inserting, searching (present and missing keys) and erasing MAP_BENCH_KEYS keys
+	static void bench_map_operations(ankerl::nanobench::Bench& insert, ankerl::nanobench::Bench& hit, ankerl::nanobench::Bench& miss, ankerl::nanobench::Bench& erase,
+		const char* name, const std::vector<uint64_t>& keys, const std::vector<uint64_t>& missing)
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		Map map;
+		insert.run(name, [&]() {
+			map = Map();
+			for (const uint64_t key : keys)
+				map.emplace(key, key);
+			doNotOptimizeAway(map.size());
+		});
+		hit.run(name, [&]() {
+			uint64_t sum = 0;
+			for (const uint64_t key : keys)
+				sum += map.find(key)->second;
+			doNotOptimizeAway(sum);
+		});
+		miss.run(name, [&]() {
+			size_t found = 0;
+			for (const uint64_t key : missing)
+				found += map.find(key) != map.end();
+			doNotOptimizeAway(found);
+		});
+		erase.run(name, [&]() {
+			Map copy = map;
+			for (const uint64_t key : keys)
+				copy.erase(key);
+			doNotOptimizeAway(copy.size());
+		});
+	}
+
+	void bench_map()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		const auto keys = make_map_keys(1);
+		const auto missing = make_map_keys(2);
+		ankerl::nanobench::Bench insert, hit, miss, erase;
+		const std::string count = std::to_string(MAP_BENCH_KEYS);
+		insert.title("insert " + count + " keys");
+		hit.title("find " + count + " present keys");
+		miss.title("find " + count + " missing keys");
+		erase.title("copy, then erase " + count + " keys");
+		for (auto* bench : { &insert, &hit, &miss, &erase })
+			bench->relative(true).minEpochIterations(3).batch(MAP_BENCH_KEYS).unit("key");
+		bench_map_operations<std::unordered_map<uint64_t, uint64_t>>(insert, hit, miss, erase, "std::unordered_map", keys, missing);
+		bench_map_operations<vale::map<uint64_t, uint64_t>>(insert, hit, miss, erase, "vale::map", keys, missing);
+
+		//Heterogeneous lookups: std::unordered_map (before C++20) constructs a std::string per lookup
+		std::vector<std::string> names;
+		for (size_t i = 0; i < MAP_BENCH_KEYS / 10; i++)
+			names.push_back("session/" + std::to_string(keys[i]));
+		std::unordered_map<std::string, size_t> std_names;
+		vale::map<std::string, size_t> vale_names;
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			std_names.emplace(names[i], i);
+			vale_names.emplace(names[i], i);
+		}
+		ankerl::nanobench::Bench lookup;
+		lookup.title("find " + std::to_string(names.size()) + " std::string keys through a std::string_view").relative(true)
+			.minEpochIterations(3).batch(names.size()).unit("key");
+		lookup.run("std::unordered_map", [&]() {
+			size_t sum = 0;
+			for (const auto& name : names)
+				sum += std_names.find(std::string(std::string_view(name)))->second;
+			doNotOptimizeAway(sum);
+		});
+		lookup.run("vale::map", [&]() {
+			size_t sum = 0;
+			for (const auto& name : names)
+				sum += vale_names.find(std::string_view(name))->second;
+			doNotOptimizeAway(sum);
+		});
+	}
+
+	/// @brief A std::unordered_map protected by a single std::mutex, to which the sharded vale::ts_map is compared
+	class mutex_unordered_map
+	{
+		mutable std::mutex mutex;
+		std::unordered_map<uint64_t, uint64_t> map;
+
+	public:
+		bool insert_or_assign(uint64_t key, uint64_t value)
+		{
+			std::scoped_lock lock(mutex);
+			return map.insert_or_assign(key, value).second;
+		}
+
+		bool try_get(uint64_t key, uint64_t& out) const
+		{
+			std::scoped_lock lock(mutex);
+			auto it = map.find(key);
+			if (it == map.end())
+				return false;
+			out = it->second;
+			return true;
+		}
+	};
+
+	template<typename Map>
+	/// @brief Splits TS_MAP_BENCH_OPERATIONS operations between 'nb_threads' threads:
+	/// lookups, and 'write_percent'% of assignments of random keys
+	/// @param map The map
+	/// @param nb_threads The number of threads
+	/// @param write_percent The percentage of assignments
+	/// @return The sum of the values read
+	static uint64_t read_write_workload(Map& map, size_t nb_threads, uint64_t write_percent)
+	{
+		std::atomic<uint64_t> sum{ 0 };
+		const auto worker = [&map, &sum, nb_threads, write_percent](uint64_t state) {
+			uint64_t local_sum = 0;
+			for (size_t i = 0; i < TS_MAP_BENCH_OPERATIONS / nb_threads; i++)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				const uint64_t key = (state >> 33) % TS_MAP_BENCH_KEYS;
+				uint64_t value = 0;
+				if ((state >> 20) % 100 < write_percent)
+					map.insert_or_assign(key, i);
+				else if (map.try_get(key, value))
+					local_sum += value;
+			}
+			sum.fetch_add(local_sum, std::memory_order_relaxed);
+		};
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < nb_threads; t++)
+			threads.emplace_back(worker, t + 1);
+		for (auto& thread : threads)
+			thread.join();
+		return sum.load();
+	}
+
+	void bench_ts_map()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		mutex_unordered_map locked;
+		vale::ts_map<uint64_t, uint64_t> sharded;
+		for (uint64_t key = 0; key < TS_MAP_BENCH_KEYS; key++)
+		{
+			locked.insert_or_assign(key, key);
+			sharded.insert_or_assign(key, key);
+		}
+		for (const uint64_t write_percent : { 5, 50 })
+		{
+			for (const size_t nb_threads : { 1, 2, 4, 8, 16, 32, 64 })
+			{
+				ankerl::nanobench::Bench bench;
+				bench.title(std::to_string(100 - write_percent) + "% lookups, " + std::to_string(write_percent) + "% assignments on "
+					+ std::to_string(nb_threads) + " threads").relative(true)
+					.minEpochIterations(3).batch(TS_MAP_BENCH_OPERATIONS).unit("op");
+				bench.run("std::mutex + std::unordered_map", [&]() { doNotOptimizeAway(read_write_workload(locked, nb_threads, write_percent)); });
+				bench.run("vale::ts_map", [&]() { doNotOptimizeAway(read_write_workload(sharded, nb_threads, write_percent)); });
+			}
+		}
+	}
+
+	template<typename Map, typename BulkLoad, typename Scan>
+	/// @brief Benchmarks inserting, searching, range scanning, bulk loading and erasing BTREE_BENCH_KEYS keys
+	static void bench_ordered_map_operations(std::vector<ankerl::nanobench::Bench>& benches, const char* name,
+		const std::vector<uint64_t>& keys, const std::vector<std::pair<uint64_t, uint64_t>>& sorted, BulkLoad&& bulk_load, Scan&& scan)
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		Map map;
+		benches[0].run(name, [&]() {
+			map = Map();
+			for (const uint64_t key : keys)
+				map.emplace(key, key);
+			doNotOptimizeAway(map.size());
+		});
+		benches[1].run(name, [&]() {
+			uint64_t sum = 0;
+			for (const uint64_t key : keys)
+				sum += map.find(key)->second;
+			doNotOptimizeAway(sum);
+		});
+		benches[2].run(name, [&]() {
+			uint64_t sum = 0;
+			for (size_t i = 0; i < BTREE_BENCH_SCANS; i++)
+			{
+				const size_t first = (i * 7919) % (sorted.size() - BTREE_BENCH_SCAN_LENGTH);
+				sum += scan(map, sorted[first].first, sorted[first + BTREE_BENCH_SCAN_LENGTH].first);
+			}
+			doNotOptimizeAway(sum);
+		});
+		const size_t random_bytes = counting_allocator::allocated_bytes;
+		Map loaded;
+		benches[3].run(name, [&]() {
+			bulk_load(loaded, sorted);
+			doNotOptimizeAway(loaded.size());
+		});
+		benches[4].run(name, [&]() {
+			Map copy = loaded;
+			for (const uint64_t key : keys)
+				copy.erase(key);
+			doNotOptimizeAway(copy.size());
+		});
+		std::cout << name << ": " << double(random_bytes) / keys.size() << " bytes per key inserted in random order, "
+			<< double(counting_allocator::allocated_bytes - random_bytes) / keys.size() << " bytes per key loaded in order\n";
+	}
+
+	void bench_btree_map()
+	{
+		std::vector<uint64_t> keys(BTREE_BENCH_KEYS);
+		uint64_t state = 1;
+		for (auto& key : keys)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			key = state;
+		}
+		std::vector<std::pair<uint64_t, uint64_t>> sorted;
+		for (const uint64_t key : keys)
+			sorted.emplace_back(key, key);
+		std::sort(sorted.begin(), sorted.end());
+
+		std::vector<ankerl::nanobench::Bench> benches(5);
+		const std::string count = std::to_string(BTREE_BENCH_KEYS);
+		benches[0].title("insert " + count + " keys in random order").batch(BTREE_BENCH_KEYS).unit("key");
+		benches[1].title("find " + count + " keys in random order").batch(BTREE_BENCH_KEYS).unit("key");
+		benches[2].title("scan " + std::to_string(BTREE_BENCH_SCANS) + " ranges of " + std::to_string(BTREE_BENCH_SCAN_LENGTH) + " keys")
+			.batch(BTREE_BENCH_SCANS * BTREE_BENCH_SCAN_LENGTH).unit("key");
+		benches[3].title("build from " + count + " sorted keys").batch(BTREE_BENCH_KEYS).unit("key");
+		benches[4].title("copy, then erase " + count + " keys in random order").batch(BTREE_BENCH_KEYS).unit("key");
+		for (auto& bench : benches)
+			bench.relative(true).minEpochIterations(3);
+
+		using std_map = std::map<uint64_t, uint64_t, std::less<>, counting_std_allocator<std::pair<const uint64_t, uint64_t>>>;
+		counting_allocator::allocated_bytes = 0;
+		bench_ordered_map_operations<std_map>(benches, "std::map", keys, sorted,
+			[](std_map& map, const auto& pairs) {
+				map.clear();
+				for (const auto& pair : pairs)
+					map.emplace_hint(map.end(), pair);
+			},
+			[](std_map& map, uint64_t first, uint64_t last) {
+				uint64_t sum = 0;
+				for (auto it = map.lower_bound(first); it != map.end() && it->first < last; ++it)
+					sum += it->second;
+				return sum;
+			});
+
+		using btree_map = vale::btree_map<uint64_t, uint64_t, std::less<>, counting_allocator>;
+		counting_allocator::allocated_bytes = 0;
+		bench_ordered_map_operations<btree_map>(benches, "vale::btree_map", keys, sorted,
+			[](btree_map& map, const auto& pairs) { map.assign_sorted(pairs.begin(), pairs.end()); },
+			[](btree_map& map, uint64_t first, uint64_t last) {
+				uint64_t sum = 0;
+				map.scan(first, last, [&sum](uint64_t, uint64_t value) { sum += value; });
+				return sum;
+			});
+	}
+}
@@ -0,0 +1,99 @@
+#include <comppch.h>
+#include <nanobench.h>
+
+#include <vale_structs/packed_vector.h>
+#include <vector>
+#include <numeric>
+
+#include "benchmarks.h"
+
+namespace vale::benchmarks
+{
+	/// @brief Number of 10-bit values stored by the packed vector benchmark
+	static constexpr size_t PACKED_VECTOR_BENCH_SIZE = size_t(1) << 24;
+	/// @brief Number of values unpacked at once by the bulk scans
+	static constexpr size_t PACKED_VECTOR_UNPACK_CHUNK = 1024;
+
+	template<typename Packed>
+	/// @brief Sums all the values of a packed vector, unpacking them by chunks
+	/// @param packed The packed vector to scan
+	/// @return The sum of the values
+	static uint64_t sum_unpacked(const Packed& packed)
+	{
+		typename Packed::value_type chunk[PACKED_VECTOR_UNPACK_CHUNK];
+		uint64_t sum = 0;
+		for (size_t i = 0; i < packed.size(); i += PACKED_VECTOR_UNPACK_CHUNK)
+		{
+			const size_t count = std::min(PACKED_VECTOR_UNPACK_CHUNK, packed.size() - i);
+			packed.unpack(i, count, chunk);
+			for (size_t j = 0; j < count; j++)
+				sum += chunk[j];
+		}
+		return sum;
+	}
+
+	void bench_packed_vector()
+	{
+		std::vector<uint16_t> unpacked;
+		vale::packed_vector<10> packed;
+		vale::runtime_packed_vector runtime_packed(10);
+		unpacked.reserve(PACKED_VECTOR_BENCH_SIZE);
+		packed.reserve(PACKED_VECTOR_BENCH_SIZE);
+		runtime_packed.reserve(PACKED_VECTOR_BENCH_SIZE);
+		for (size_t i = 0; i < PACKED_VECTOR_BENCH_SIZE; i++)
+		{
+			const uint16_t value = static_cast<uint16_t>((i * 2654435761u) % 1024);
+			unpacked.push_back(value);
+			packed.push_back(value);
+			runtime_packed.push_back(value);
+		}
+
+		std::cout << "std::vector<uint16_t>: " << (unpacked.capacity() * sizeof(uint16_t)) / 1024 << " KB\n";
+		std::cout << "vale::packed_vector<10>: " << packed.byte_size() / 1024 << " KB\n";
+
+		ankerl::nanobench::Bench bench;
+		bench.title("sum of " + std::to_string(PACKED_VECTOR_BENCH_SIZE) + " 10-bit values").relative(true)
+			.minEpochIterations(3).batch(PACKED_VECTOR_BENCH_SIZE).unit("value");
+		bench.run("std::vector<uint16_t>", [&]() {
+			ankerl::nanobench::doNotOptimizeAway(std::accumulate(unpacked.begin(), unpacked.end(), uint64_t(0)));
+		});
+		bench.run("vale::packed_vector<10> iterators", [&]() {
+			ankerl::nanobench::doNotOptimizeAway(std::accumulate(packed.cbegin(), packed.cend(), uint64_t(0)));
+		});
+		bench.run("vale::packed_vector<10> unpack", [&]() {
+			ankerl::nanobench::doNotOptimizeAway(sum_unpacked(packed));
+		});
+		bench.run("vale::runtime_packed_vector unpack", [&]() {
+			ankerl::nanobench::doNotOptimizeAway(sum_unpacked(runtime_packed));
+		});
+
+		vale::vector<vale::packed_vector<10>::value_type> values;
+		vale::vector<vale::runtime_packed_vector::value_type> runtime_values;
+		values.reserve(PACKED_VECTOR_BENCH_SIZE);
+		runtime_values.reserve(PACKED_VECTOR_BENCH_SIZE);
+		for (size_t i = 0; i < PACKED_VECTOR_BENCH_SIZE; i++)
+		{
+			values.push_back(unpacked[i]);
+			runtime_values.push_back(unpacked[i]);
+		}
+		ankerl::nanobench::Bench pack_bench;
+		pack_bench.title("pack " + std::to_string(PACKED_VECTOR_BENCH_SIZE) + " 10-bit values").relative(true)
+			.minEpochIterations(3).batch(PACKED_VECTOR_BENCH_SIZE).unit("value");
+		pack_bench.run("vale::packed_vector<10> push_back", [&]() {
+			packed.clear();
+			for (size_t i = 0; i < PACKED_VECTOR_BENCH_SIZE; i++)
+				packed.push_back(values[i]);
+			ankerl::nanobench::doNotOptimizeAway(packed.size());
+		});
+		pack_bench.run("vale::packed_vector<10> pack", [&]() {
+			packed.clear();
+			packed.pack(values.to_view());
+			ankerl::nanobench::doNotOptimizeAway(packed.size());
+		});
+		pack_bench.run("vale::runtime_packed_vector pack", [&]() {
+			runtime_packed.clear();
+			runtime_packed.pack(runtime_values.to_view());
+			ankerl::nanobench::doNotOptimizeAway(runtime_packed.size());
+		});
+	}
+}
@@ -0,0 +1,83 @@
+#include <comppch.h>
+#include <nanobench.h>
+
+#include <vale_structs/static_vector.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iterator>
+
+#include "benchmarks.h"
+
+namespace vale::benchmarks
+{
+	/// @brief Maximum number of pending items of each batch
+	static constexpr size_t STATIC_VECTOR_BENCH_CAPACITY = 32;
+	/// @brief Number of batches built in each iteration of the static vector benchmark
+	static constexpr size_t STATIC_VECTOR_BENCH_BATCHES = 10000;
+
+	template<typename Vector, typename Make>
+	/// @brief Builds STATIC_VECTOR_BENCH_BATCHES batches of up to STATIC_VECTOR_BENCH_CAPACITY pending items,
+	/// which are consumed from the back.
+	/// @param make Functor which constructs an empty batch
+	/// @return A checksum of the consumed items
+	static size_t build_batches(Make make)
+	{
+		size_t checksum = 0;
+		for (size_t batch = 0; batch < STATIC_VECTOR_BENCH_BATCHES; batch++)
+		{
+			Vector pending = make();
+			const size_t count = 1 + (batch * 7) % STATIC_VECTOR_BENCH_CAPACITY;
+			for (size_t i = 0; i < count; i++)
+				pending.emplace_back(batch + i);
+			while (pending.size() != 0)
+			{
+				checksum += pending.back();
+				pending.pop_back();
+			}
+		}
+		return checksum;
+	}
+
+	void bench_static_vector()
+	{
+		ankerl::nanobench::Bench bench;
+		bench.title("batches of at most " + std::to_string(STATIC_VECTOR_BENCH_CAPACITY) + " items").relative(true)
+			.minEpochIterations(10).batch(STATIC_VECTOR_BENCH_BATCHES).unit("batch");
+		bench.run("std::vector + reserve", []() {
+			ankerl::nanobench::doNotOptimizeAway(build_batches<std::vector<size_t>>([]() {
+				std::vector<size_t> vec;
+				vec.reserve(STATIC_VECTOR_BENCH_CAPACITY);
+				return vec;
+			}));
+		});
+		bench.run("vale::static_vector", []() {
+			ankerl::nanobench::doNotOptimizeAway(build_batches<vale::static_vector<size_t, STATIC_VECTOR_BENCH_CAPACITY>>(
+				[]() { return vale::static_vector<size_t, STATIC_VECTOR_BENCH_CAPACITY>{}; }));
+		});
+	}
+
+	size_t check_static_vector_erase()
+	{
+		const std::string strings[] = { std::string(32, 'a'), std::string(32, 'b'), "c", std::string(32, 'd') };
+		size_t failures = 0;
+		for (size_t first = 0; first <= std::size(strings); first++)
+		{
+			for (size_t last = first; last <= std::size(strings); last++)
+			{
+				vale::static_vector<std::string, 4> vec;
+				std::vector<std::string> expected;
+				for (const std::string& str : strings)
+				{
+					vec.push_back(str);
+					expected.push_back(str);
+				}
+				const auto result = vec.erase(vec.cbegin() + first, vec.cbegin() + last);
+				expected.erase(expected.cbegin() + first, expected.cbegin() + last);
+				failures += result != vec.begin() + first || vec.size() != expected.size()
+					|| !std::equal(expected.begin(), expected.end(), vec.begin());
+			}
+		}
+		return failures;
+	}
+}
@@ -0,0 +1,881 @@
+#include <comppch.h>
+#include <nanobench.h>
+
+#include <vale_structs/string.h>
+#include <vale_structs/variant.h>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
+#include <sstream>
+#include <iomanip>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+
+#include "benchmarks.h"
+
+namespace vale::benchmarks
+{
+	/// @brief Number of keys constructed and copied in each iteration of the string benchmark
+	static constexpr size_t STRING_BENCH_KEYS = 10000;
+
+	/// @brief Number of records interned in each iteration of the string pool benchmark
+	static constexpr size_t STRING_POOL_BENCH_RECORDS = size_t(1) << 21;
+	/// @brief Number of distinct tags of the records of the string pool benchmark
+	static constexpr size_t STRING_POOL_BENCH_TAGS = 5000;
+
+	/// @brief Size of the document built by the rope benchmark
+	static constexpr size_t ROPE_BENCH_BYTES = size_t(16) << 20;
+	/// @brief Size of the fragments appended and spliced by the rope benchmark
+	static constexpr size_t ROPE_BENCH_FRAGMENT = 100;
+	/// @brief Number of fragments spliced at random offsets of the document by the rope benchmark
+	static constexpr size_t ROPE_BENCH_SPLICES = 1000;
+
+	/// @brief Size of each text of the UTF-8 benchmark
+	static constexpr size_t UTF8_BENCH_BYTES = size_t(16) << 20;
+	/// @brief Number of random (valid and corrupted) strings compared with the scalar reference by the UTF-8 benchmark
+	static constexpr size_t UTF8_FUZZ_INPUTS = 100000;
+
+	/// @brief Number of integers and doubles formatted and parsed in each iteration of the number format benchmark
+	static constexpr size_t NUMBER_BENCH_VALUES = 100000;
+
+	/// @brief Number of log lines searched in each iteration of the multi-pattern matching benchmark
+	static constexpr size_t MULTI_MATCH_BENCH_LINES = 10000;
+	/// @brief Number of distinct words of the lines and patterns of the multi-pattern matching benchmark
+	static constexpr size_t MULTI_MATCH_BENCH_WORDS = 20000;
+
+	/// @brief Number of payloads handed to the workers in each iteration of the shared string benchmark
+	static constexpr size_t SHARED_STRING_BENCH_PAYLOADS = 10000;
+	/// @brief Number of workers receiving a copy of each payload in the shared string benchmark
+	static constexpr size_t SHARED_STRING_BENCH_WORKERS = 8;
+
+	/// @brief Size of the log text searched by the string search benchmark.
+	/// Raise it (for example to 1 GB) on machines with enough memory.
+	static constexpr size_t STRING_SEARCH_BENCH_BYTES = size_t(64) << 20;
+
+	/// @brief Returns STRING_BENCH_KEYS keys following our key-length distribution:
+	/// 60% of 4 to 16 characters, 30% of 17 to 23 characters, 10% of 24 to 64 characters.
+	/// @return The keys
+	static std::vector<std::string> make_keys()
+	{
+		std::vector<std::string> keys;
+		keys.reserve(STRING_BENCH_KEYS);
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (size_t i = 0; i < STRING_BENCH_KEYS; i++)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			const size_t bucket = (state >> 33) % 10;
+			const size_t random = state >> 40;
+			size_t length;
+			if (bucket < 6)
+				length = 4 + random % 13;
+			else if (bucket < 9)
+				length = 17 + random % 7;
+			else
+				length = 24 + random % 41;
+			keys.emplace_back(length, static_cast<char>('a' + i % 26));
+		}
+		return keys;
+	}
+
+	template<typename String>
+	/// @brief Constructs a copy of each key
+	/// @param keys The keys to copy
+	/// @return The strings
+	static std::vector<String> construct_keys(const std::vector<std::string>& keys)
+	{
+		std::vector<String> result;
+		result.reserve(keys.size());
+		for (const auto& key : keys)
+			result.emplace_back(key.data(), key.size());
+		return result;
+	}
+
+	template<typename String>
+	/// @brief Prints the number of allocations per key made by constructing and copying the keys
+	/// @param name The name of the string type
+	/// @param keys The keys
+	static void print_allocations_per_key(const char* name, const std::vector<std::string>& keys)
+	{
+		auto strings = construct_keys<String>(keys);
+		counting_allocator::allocations = 0;
+		auto constructed = construct_keys<String>(keys);
+		const size_t construct_allocations = counting_allocator::allocations;
+		counting_allocator::allocations = 0;
+		auto copies = strings;
+		std::cout << name << ": " << double(construct_allocations) / keys.size() << " allocations per key constructed, "
+			<< double(counting_allocator::allocations) / keys.size() << " per key copied\n";
+	}
+
+	void bench_string()
+	{
+		using std_string_t = std::basic_string<char, std::char_traits<char>, counting_std_allocator<char>>;
+		using vale_string_t = vale::basic_string<default_growth, counting_allocator>;
+
+		const auto keys = make_keys();
+		std::cout << "sizeof(std::string): " << sizeof(std::string) << ", sizeof(vale::string): " << sizeof(vale::string) << '\n';
+		print_allocations_per_key<std_string_t>("std::string", keys);
+		print_allocations_per_key<vale_string_t>("vale::string", keys);
+
+		ankerl::nanobench::Bench bench;
+		bench.title("construct keys").relative(true).minEpochIterations(10).batch(STRING_BENCH_KEYS).unit("key");
+		bench.run("std::string", [&]() { ankerl::nanobench::doNotOptimizeAway(construct_keys<std::string>(keys)); });
+		bench.run("vale::string", [&]() { ankerl::nanobench::doNotOptimizeAway(construct_keys<vale::string>(keys)); });
+
+		const auto std_strings = construct_keys<std::string>(keys);
+		const auto vale_strings = construct_keys<vale::string>(keys);
+		bench.title("copy keys");
+		bench.run("std::string", [&]() { ankerl::nanobench::doNotOptimizeAway(std::vector<std::string>(std_strings)); });
+		bench.run("vale::string", [&]() { ankerl::nanobench::doNotOptimizeAway(std::vector<vale::string>(vale_strings)); });
+	}
+
+	/// @brief Returns STRING_SEARCH_BENCH_BYTES of log lines, one line in 1000 being an error
+	/// @return The log text
+	static std::string make_log_text()
+	{
+		static constexpr const char* levels[] = { "INFO ", "DEBUG", "WARN " };
+		static constexpr const char* paths[] = { "/api/v1/users", "/api/v1/orders/checkout", "/static/app.js", "/health" };
+		std::string text;
+		text.reserve(STRING_SEARCH_BENCH_BYTES + 256);
+		for (size_t line = 0; text.size() < STRING_SEARCH_BENCH_BYTES; line++)
+		{
+			text += "2024-05-17T12:";
+			text += std::to_string(10 + line % 50);
+			text += ":00.000Z ";
+			text += line % 1000 == 999 ? "ERROR" : levels[line % 3];
+			text += " service=gateway request_id=";
+			text += std::to_string(line * 2654435761u);
+			text += " path=";
+			text += paths[line % 4];
+			text += " latency_ms=";
+			text += std::to_string(line % 997);
+			if (line % 1000 == 999)
+				text += " upstream connection timeout";
+			text += '\n';
+		}
+		return text;
+	}
+
+	void bench_string_search()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		const std::string text = make_log_text();
+		const std::string_view std_view = text;
+		const vale::string_view view(text.data(), text.size());
+		const std::string needle = "connection timeout";
+		const vale::string_view vale_needle(needle.data(), needle.size());
+
+		ankerl::nanobench::Bench bench;
+		bench.relative(true).minEpochIterations(3).batch(text.size()).unit("byte");
+
+		bench.title("find all \"" + needle + "\"");
+		bench.run("std::string::find", [&]() {
+			size_t found = 0;
+			for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + needle.size()))
+				++found;
+			doNotOptimizeAway(found);
+		});
+		bench.run("std::string_view::find", [&]() {
+			size_t found = 0;
+			for (size_t pos = std_view.find(needle); pos != std::string_view::npos; pos = std_view.find(needle, pos + needle.size()))
+				++found;
+			doNotOptimizeAway(found);
+		});
+		bench.run("vale::count", [&]() { doNotOptimizeAway(vale::count(view, vale_needle)); });
+
+		bench.title("count lines");
+		bench.run("std::count", [&]() { doNotOptimizeAway(std::count(text.begin(), text.end(), '\n')); });
+		bench.run("vale::count", [&]() { doNotOptimizeAway(vale::count(view, '\n')); });
+
+		bench.title("split lines and fields");
+		bench.run("std::string_view::find", [&]() {
+			size_t fields = 0;
+			std::string_view rest = std_view;
+			while (!rest.empty())
+			{
+				const size_t end = std::min(rest.find('\n'), rest.size());
+				std::string_view line = rest.substr(0, end);
+				rest.remove_prefix(std::min(end + 1, rest.size()));
+				for (size_t pos = line.find(' '); pos != std::string_view::npos; pos = line.find(' '))
+				{
+					++fields;
+					line.remove_prefix(pos + 1);
+				}
+				++fields;
+			}
+			doNotOptimizeAway(fields);
+		});
+		bench.run("vale::split", [&]() {
+			size_t fields = 0;
+			for (vale::string_view line : vale::split(view, '\n'))
+			{
+				for (vale::string_view field : vale::split(line, ' '))
+				{
+					doNotOptimizeAway(field);
+					++fields;
+				}
+			}
+			doNotOptimizeAway(fields);
+		});
+
+		bench.title("lines containing \"" + needle + "\"");
+		bench.run("std::string_view::find", [&]() {
+			size_t matches = 0;
+			std::string_view rest = std_view;
+			while (!rest.empty())
+			{
+				const size_t end = std::min(rest.find('\n'), rest.size());
+				matches += rest.substr(0, end).find(needle) != std::string_view::npos;
+				rest.remove_prefix(std::min(end + 1, rest.size()));
+			}
+			doNotOptimizeAway(matches);
+		});
+		bench.run("vale::contains", [&]() {
+			size_t matches = 0;
+			for (vale::string_view line : vale::split(view, '\n'))
+				matches += vale::contains(line, vale_needle);
+			doNotOptimizeAway(matches);
+		});
+	}
+
+	/// @brief Returns the tag of each record: STRING_POOL_BENCH_TAGS distinct tags of 8 to 40 characters
+	/// @return The tags of STRING_POOL_BENCH_RECORDS records
+	static std::vector<std::string> make_record_tags()
+	{
+		std::vector<std::string> tags;
+		for (size_t i = 0; i < STRING_POOL_BENCH_TAGS; i++)
+			tags.push_back("tag." + std::to_string(i) + std::string(4 + (i * 7) % 30, static_cast<char>('a' + i % 26)));
+		std::vector<std::string> records;
+		records.reserve(STRING_POOL_BENCH_RECORDS);
+		for (size_t i = 0; i < STRING_POOL_BENCH_RECORDS; i++)
+			records.push_back(tags[(i * 2654435761u) % STRING_POOL_BENCH_TAGS]);
+		return records;
+	}
+
+	template<typename Intern>
+	/// @brief Interns all the records from 'nb_threads' threads, each thread interning a slice of the records
+	/// @param nb_threads The number of threads
+	/// @param intern Functor which interns one record
+	static void intern_on_threads(size_t nb_threads, Intern intern)
+	{
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < nb_threads; t++)
+		{
+			threads.emplace_back([&intern, t, nb_threads]() {
+				for (size_t i = t; i < STRING_POOL_BENCH_RECORDS; i += nb_threads)
+					intern(i);
+			});
+		}
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	void bench_string_pool()
+	{
+		const auto records = make_record_tags();
+
+		size_t copies_bytes = records.size() * sizeof(std::string);
+		for (const auto& record : records)
+			copies_bytes += record.capacity() > std::string().capacity() ? record.capacity() + 1 : 0;
+		vale::string_pool pool;
+		for (const auto& record : records)
+			pool.intern(vale::string_view(record.data(), record.size()));
+		std::cout << "std::string copies: " << copies_bytes / 1024 << " KB\n";
+		std::cout << "vale::string_handle + vale::string_pool: "
+			<< (records.size() * sizeof(vale::string_handle) + pool.byte_size()) / 1024 << " KB\n";
+
+		ankerl::nanobench::Bench bench;
+		bench.relative(true).minEpochIterations(3).batch(STRING_POOL_BENCH_RECORDS).unit("record");
+		for (size_t nb_threads : { size_t(1), size_t(4), size_t(std::max(2u, std::thread::hardware_concurrency())) })
+		{
+			bench.title("intern records on " + std::to_string(nb_threads) + " threads");
+			bench.run("std::unordered_set + std::mutex", [&]() {
+				std::unordered_set<std::string> set;
+				std::mutex mutex;
+				intern_on_threads(nb_threads, [&](size_t i) {
+					std::scoped_lock lock{ mutex };
+					ankerl::nanobench::doNotOptimizeAway(&*set.insert(records[i]).first);
+				});
+			});
+			bench.run("vale::string_pool", [&]() {
+				vale::string_pool pool;
+				intern_on_threads(nb_threads, [&](size_t i) {
+					ankerl::nanobench::doNotOptimizeAway(pool.intern(vale::string_view(records[i].data(), records[i].size())));
+				});
+			});
+		}
+	}
+
+	void bench_rope()
+	{
+		const std::string fragment = std::string(ROPE_BENCH_FRAGMENT - 1, 'x') + '\n';
+		const vale::string_view fragment_view = vale::string_view(fragment.data(), fragment.size());
+		constexpr size_t nb_fragments = ROPE_BENCH_BYTES / ROPE_BENCH_FRAGMENT;
+
+		ankerl::nanobench::Bench bench;
+		bench.relative(true).minEpochIterations(3);
+
+		bench.title("build a document through appends").batch(nb_fragments).unit("append");
+		bench.run("std::string", [&]() {
+			std::string document;
+			for (size_t i = 0; i < nb_fragments; i++)
+				document += fragment;
+			ankerl::nanobench::doNotOptimizeAway(document.data());
+		});
+		bench.run("vale::rope", [&]() {
+			vale::rope document;
+			for (size_t i = 0; i < nb_fragments; i++)
+				document += fragment_view;
+			ankerl::nanobench::doNotOptimizeAway(document.size());
+		});
+
+		std::string std_document;
+		vale::rope rope_document;
+		for (size_t i = 0; i < nb_fragments; i++)
+		{
+			std_document += fragment;
+			rope_document += fragment_view;
+		}
+
+		bench.title("splice fragments in a copy of the document").batch(ROPE_BENCH_SPLICES).unit("splice");
+		bench.run("std::string", [&]() {
+			std::string document = std_document;
+			uint64_t state = 1;
+			for (size_t i = 0; i < ROPE_BENCH_SPLICES; i++)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				document.insert((state >> 16) % document.size(), fragment);
+			}
+			ankerl::nanobench::doNotOptimizeAway(document.data());
+		});
+		bench.run("vale::rope", [&]() {
+			vale::rope document = rope_document;
+			uint64_t state = 1;
+			for (size_t i = 0; i < ROPE_BENCH_SPLICES; i++)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				document.insert((state >> 16) % document.size(), fragment_view);
+			}
+			ankerl::nanobench::doNotOptimizeAway(document.size());
+		});
+
+		bench.title("flatten the document").batch(ROPE_BENCH_BYTES).unit("byte");
+		bench.run("std::string copy", [&]() {
+			std::string copy = std_document;
+			ankerl::nanobench::doNotOptimizeAway(copy.data());
+		});
+		bench.run("vale::rope::flatten", [&]() {
+			vale::string copy = rope_document.flatten();
+			ankerl::nanobench::doNotOptimizeAway(copy.data());
+		});
+	}
+
+	/// @brief Returns UTF-8 text of at least 'bytes' bytes, whose code points are drawn from the given ranges
+	/// @param bytes The minimum size of the text
+	/// @param ranges The [first, last] ranges of code points to draw from (surrogates are skipped)
+	/// @param state The state of the random number generator
+	/// @return The text
+	static std::string make_utf8_text(size_t bytes, std::initializer_list<std::pair<char32_t, char32_t>> ranges, uint64_t& state)
+	{
+		std::string text;
+		text.reserve(bytes + 4);
+		while (text.size() < bytes)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			const auto& range = ranges.begin()[(state >> 33) % ranges.size()];
+			char32_t code_point = range.first + static_cast<char32_t>((state >> 40) % (range.second - range.first + 1));
+			if (code_point >= 0xD800 && code_point <= 0xDFFF)
+				code_point = ' ';
+			char encoded[4];
+			text.append(encoded, vale::details::encode_utf8(code_point, encoded));
+		}
+		return text;
+	}
+
+	size_t check_utf8_equivalence()
+	{
+		uint64_t state = 42;
+		size_t mismatches = 0;
+		std::vector<char16_t> simd16, scalar16;
+		std::vector<char32_t> simd32, scalar32;
+		for (size_t i = 0; i < UTF8_FUZZ_INPUTS; i++)
+		{
+			std::string text = make_utf8_text(state % 300, { { 0, 0x7F }, { 0x80, 0x7FF }, { 0x800, 0xFFFF }, { 0x10000, 0x10FFFF } }, state);
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			switch ((state >> 60) % 4)
+			{
+			case 1:
+				//Corrupt one byte
+				if (!text.empty())
+					text[(state >> 20) % text.size()] = static_cast<char>(state >> 8);
+				break;
+			case 2:
+				//Truncate, possibly in the middle of a sequence
+				text.resize((state >> 20) % (text.size() + 1));
+				break;
+			case 3:
+				//Replace every byte by a random one
+				for (char& c : text)
+				{
+					state = state * 6364136223846793005ull + 1442695040888963407ull;
+					c = static_cast<char>(state >> 56);
+				}
+				break;
+			default:
+				break;
+			}
+			const vale::string_view view(text.data(), text.size());
+			const size_t expected = vale::details::validate_utf8_scalar(text.data(), text.size());
+			mismatches += vale::is_valid_utf8(view) != (expected == vale::npos);
+			mismatches += vale::find_invalid_utf8(view) != expected;
+
+			simd16.resize(text.size()); scalar16.resize(text.size());
+			const size_t units = vale::utf8_to_utf16(view, simd16.data());
+			mismatches += units != vale::details::utf8_to_utf16_scalar(text.data(), text.size(), scalar16.data())
+				|| (units != vale::npos && !std::equal(simd16.begin(), simd16.begin() + units, scalar16.begin()));
+			simd32.resize(text.size()); scalar32.resize(text.size());
+			const size_t code_points = vale::utf8_to_utf32(view, simd32.data());
+			mismatches += code_points != vale::details::utf8_to_utf32_scalar(text.data(), text.size(), scalar32.data())
+				|| (code_points != vale::npos && !std::equal(simd32.begin(), simd32.begin() + code_points, scalar32.begin()));
+			if (expected != vale::npos)
+				continue;
+
+			mismatches += vale::count_code_points(view) != code_points;
+			mismatches += vale::utf16_length(view) != units;
+			const vale::string back = vale::to_utf8(vale::u16string_view(simd16.data(), units));
+			mismatches += back.to_view() != view;
+		}
+		return mismatches;
+	}
+
+	void bench_utf8()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		if (const size_t mismatches = check_utf8_equivalence(); mismatches != 0)
+		{
+			std::cout << "UTF-8 fuzz equivalence: " << mismatches << " mismatches with the scalar reference!\n";
+			std::exit(EXIT_FAILURE);
+		}
+		std::cout << "UTF-8 fuzz equivalence: " << UTF8_FUZZ_INPUTS << " inputs matched the scalar reference\n";
+
+		uint64_t state = 1;
+		const std::pair<const char*, std::string> texts[] = {
+			{ "ASCII", make_utf8_text(UTF8_BENCH_BYTES, { { 0x20, 0x7E } }, state) },
+			{ "Latin", make_utf8_text(UTF8_BENCH_BYTES, { { 0x20, 0x7E }, { 0x20, 0x7E }, { 0x20, 0x7E }, { 0xC0, 0x17F } }, state) },
+			{ "CJK", make_utf8_text(UTF8_BENCH_BYTES, { { 0x4E00, 0x9FFF } }, state) },
+			{ "emoji", make_utf8_text(UTF8_BENCH_BYTES, { { 0x20, 0x7E }, { 0x1F300, 0x1F64F } }, state) },
+		};
+
+		ankerl::nanobench::Bench bench;
+		bench.relative(true).minEpochIterations(3).unit("byte");
+		std::vector<char16_t> utf16(UTF8_BENCH_BYTES + 4);
+		std::vector<char> utf8(UTF8_BENCH_BYTES + 4);
+		for (const auto& [name, text] : texts)
+		{
+			const vale::string_view view(text.data(), text.size());
+			bench.batch(text.size());
+
+			bench.title(std::string("validate UTF-8 (") + name + ")");
+			bench.run("scalar reference", [&]() { doNotOptimizeAway(vale::details::validate_utf8_scalar(view.data(), view.size())); });
+			bench.run("vale::is_valid_utf8", [&]() { doNotOptimizeAway(vale::is_valid_utf8(view)); });
+
+			bench.title(std::string("count code points (") + name + ")");
+			bench.run("scalar reference", [&]() { doNotOptimizeAway(vale::details::count_code_points_scalar(view.data(), view.size())); });
+			bench.run("vale::count_code_points", [&]() { doNotOptimizeAway(vale::count_code_points(view)); });
+
+			bench.title(std::string("UTF-8 to UTF-16 (") + name + ")");
+			bench.run("scalar reference", [&]() { doNotOptimizeAway(vale::details::utf8_to_utf16_scalar(view.data(), view.size(), utf16.data())); });
+			bench.run("vale::utf8_to_utf16", [&]() { doNotOptimizeAway(vale::utf8_to_utf16(view, utf16.data())); });
+
+			const vale::u16string_view view16(utf16.data(), vale::utf8_to_utf16(view, utf16.data()));
+			bench.title(std::string("UTF-16 to UTF-8 (") + name + ")");
+			bench.run("scalar reference", [&]() { doNotOptimizeAway(vale::details::utf16_to_utf8_scalar(view16.data(), view16.size(), utf8.data())); });
+			bench.run("vale::utf16_to_utf8", [&]() { doNotOptimizeAway(vale::utf16_to_utf8(view16, utf8.data())); });
+		}
+	}
+
+	/// @brief Returns NUMBER_BENCH_VALUES integers whose magnitudes are spread over 1 to 19 digits
+	/// @return The integers
+	static std::vector<int64_t> make_bench_integers()
+	{
+		std::vector<int64_t> values;
+		values.reserve(NUMBER_BENCH_VALUES);
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (size_t i = 0; i < NUMBER_BENCH_VALUES; i++)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			const int64_t value = static_cast<int64_t>((state >> 1) / vale::details::powers_of_10[(state >> 33) % 19]);
+			values.push_back(i % 4 == 0 ? -value : value);
+		}
+		return values;
+	}
+
+	/// @brief Returns NUMBER_BENCH_VALUES doubles like those of a metrics exporter:
+	/// half of them are measures with a few decimals, half of them are ratios using all the digits
+	/// @return The doubles
+	static std::vector<double> make_bench_doubles()
+	{
+		std::vector<double> values;
+		values.reserve(NUMBER_BENCH_VALUES);
+		uint64_t state = 0x2545F4914F6CDD1Dull;
+		for (size_t i = 0; i < NUMBER_BENCH_VALUES; i++)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			const double random = static_cast<double>(state >> 11) / static_cast<double>(uint64_t(1) << 53);
+			if (i % 2 == 0)
+				values.push_back(static_cast<double>((state >> 40) % 10000000) / 1000.0);
+			else
+				values.push_back(random * 1e6 / static_cast<double>((state >> 20) % 1000 + 1));
+		}
+		return values;
+	}
+
+	template<typename T, typename Format>
+	/// @brief Formats each value using 'format', which appends the characters of a value
+	/// to a std::string, separated by spaces
+	/// @param values The values to format
+	/// @param format The formatting function
+	/// @return The total size of the formatted values, so that the work is not optimized away
+	static size_t format_values(const std::vector<T>& values, Format format)
+	{
+		std::string out;
+		out.reserve(values.size() * 25);
+		for (const T& value : values)
+		{
+			format(out, value);
+			out.push_back(' ');
+		}
+		return out.size();
+	}
+
+	void bench_number_format()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		const std::vector<int64_t> integers = make_bench_integers();
+		const std::vector<double> doubles = make_bench_doubles();
+
+		ankerl::nanobench::Bench bench;
+		bench.relative(true).minEpochIterations(5).batch(NUMBER_BENCH_VALUES).unit("number");
+
+		bench.title("format integers");
+		bench.run("std::ostringstream", [&]() {
+			std::ostringstream os;
+			for (const int64_t value : integers)
+				os << value << ' ';
+			doNotOptimizeAway(os.tellp());
+		});
+		bench.run("snprintf", [&]() {
+			doNotOptimizeAway(format_values(integers, [](std::string& out, int64_t value) {
+				char buffer[32];
+				out.append(buffer, std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value)));
+			}));
+		});
+		bench.run("std::to_chars", [&]() {
+			doNotOptimizeAway(format_values(integers, [](std::string& out, int64_t value) {
+				char buffer[32];
+				out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+			}));
+		});
+		bench.run("vale::string::append_int", [&]() {
+			vale::string out;
+			out.reserve(integers.size() * 21);
+			for (const int64_t value : integers)
+				out.append_int(value).push_back(' ');
+			doNotOptimizeAway(out.size());
+		});
+
+		//ostream and snprintf need 17 significant digits to round-trip
+		bench.title("format doubles (round-trip)");
+		bench.run("std::ostringstream", [&]() {
+			std::ostringstream os;
+			os << std::setprecision(17);
+			for (const double value : doubles)
+				os << value << ' ';
+			doNotOptimizeAway(os.tellp());
+		});
+		bench.run("snprintf", [&]() {
+			doNotOptimizeAway(format_values(doubles, [](std::string& out, double value) {
+				char buffer[32];
+				out.append(buffer, std::snprintf(buffer, sizeof(buffer), "%.17g", value));
+			}));
+		});
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+		bench.run("std::to_chars", [&]() {
+			doNotOptimizeAway(format_values(doubles, [](std::string& out, double value) {
+				char buffer[32];
+				out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+			}));
+		});
+#endif
+		bench.run("vale::string::append_double", [&]() {
+			vale::string out;
+			out.reserve(doubles.size() * 25);
+			for (const double value : doubles)
+				out.append_double(value).push_back(' ');
+			doNotOptimizeAway(out.size());
+		});
+
+		vale::string integer_text, double_text;
+		for (const int64_t value : integers)
+			integer_text.append_int(value).push_back(' ');
+		for (const double value : doubles)
+			double_text.append_double(value).push_back(' ');
+
+		bench.title("parse integers");
+		bench.run("strtoll", [&]() {
+			int64_t sum = 0;
+			for (const char* ptr = integer_text.c_str(); *ptr != '\0';)
+			{
+				char* end;
+				sum += std::strtoll(ptr, &end, 10);
+				ptr = end + 1;
+			}
+			doNotOptimizeAway(sum);
+		});
+		bench.run("std::from_chars", [&]() {
+			int64_t sum = 0;
+			for (const char* ptr = integer_text.data(), *end = ptr + integer_text.size(); ptr != end;)
+			{
+				int64_t value = 0;
+				ptr = std::from_chars(ptr, end, value).ptr + 1;
+				sum += value;
+			}
+			doNotOptimizeAway(sum);
+		});
+		bench.run("vale::parse_int", [&]() {
+			int64_t sum = 0;
+			for (size_t offset = 0; offset != integer_text.size();)
+			{
+				int64_t value = 0;
+				offset += vale::parse_int(vale::string_view(integer_text.data() + offset, integer_text.size() - offset), value) + 1;
+				sum += value;
+			}
+			doNotOptimizeAway(sum);
+		});
+
+		bench.title("parse doubles");
+		bench.run("strtod", [&]() {
+			double sum = 0;
+			for (const char* ptr = double_text.c_str(); *ptr != '\0';)
+			{
+				char* end;
+				sum += std::strtod(ptr, &end);
+				ptr = end + 1;
+			}
+			doNotOptimizeAway(sum);
+		});
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+		bench.run("std::from_chars", [&]() {
+			double sum = 0;
+			for (const char* ptr = double_text.data(), *end = ptr + double_text.size(); ptr != end;)
+			{
+				double value = 0;
+				ptr = std::from_chars(ptr, end, value).ptr + 1;
+				sum += value;
+			}
+			doNotOptimizeAway(sum);
+		});
+#endif
+		bench.run("vale::parse_double", [&]() {
+			double sum = 0;
+			for (size_t offset = 0; offset != double_text.size();)
+			{
+				double value = 0;
+				offset += vale::parse_double(vale::string_view(double_text.data() + offset, double_text.size() - offset), value) + 1;
+				sum += value;
+			}
+			doNotOptimizeAway(sum);
+		});
+
+		//The same path as a metrics exporter printing its samples
+		using sample = vale::variant<int64_t, double>;
+		std::vector<vale::array<sample, 4>> samples;
+		for (size_t i = 0; i + 1 < NUMBER_BENCH_VALUES; i += 2)
+			samples.push_back({ sample{ int64_t{ integers[i] } }, sample{ double{ doubles[i] } },
+				sample{ int64_t{ integers[i + 1] } }, sample{ double{ doubles[i + 1] } } });
+		bench.title("print arrays of variants").batch(samples.size()).unit("array");
+		bench.run("print(std::ostream&)", [&]() {
+			std::ostringstream os;
+			for (const auto& array : samples)
+				array.print(os);
+			doNotOptimizeAway(os.tellp());
+		});
+		bench.run("print(vale::string&)", [&]() {
+			vale::string out;
+			for (const auto& array : samples)
+				array.print(out);
+			doNotOptimizeAway(out.size());
+		});
+	}
+
+	/// @brief Returns MULTI_MATCH_BENCH_WORDS random words of 4 to 11 lowercase letters
+	/// @param state The state of the random number generator
+	/// @return The words
+	static std::vector<std::string> make_match_words(uint64_t& state)
+	{
+		std::vector<std::string> words(MULTI_MATCH_BENCH_WORDS);
+		for (auto& word : words)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			word.resize(4 + (state >> 33) % 8);
+			for (auto& c : word)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				c = static_cast<char>('a' + (state >> 33) % 26);
+			}
+		}
+		return words;
+	}
+
+	void bench_multi_match()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		uint64_t state = 1;
+		const std::vector<std::string> words = make_match_words(state);
+		//Log lines of about 100 characters made of the words
+		std::vector<std::string> lines(MULTI_MATCH_BENCH_LINES);
+		for (auto& line : lines)
+		{
+			line = "2024-05-17T12:00:00.000Z INFO";
+			while (line.size() < 100)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				line += ' ';
+				line += words[(state >> 33) % words.size()];
+			}
+		}
+
+		ankerl::nanobench::Bench bench;
+		bench.relative(true).minEpochIterations(3).batch(lines.size()).unit("line");
+		for (const size_t nb_patterns : { size_t(10), size_t(100), size_t(1000) })
+		{
+			std::vector<std::string> patterns;
+			for (size_t i = 0; i < nb_patterns; i++)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				patterns.push_back(words[(state >> 33) % words.size()]);
+			}
+			const vale::multi_matcher matcher(patterns);
+
+			bench.title("lines containing any of " + std::to_string(nb_patterns) + " patterns ("
+				+ (matcher.uses_fingerprint_filter() ? "fingerprint filter" : "automaton") + ")");
+			bench.run("std::string_view::find per pattern", [&]() {
+				size_t matching = 0;
+				for (const auto& line : lines)
+				{
+					const std::string_view view = line;
+					for (const auto& pattern : patterns)
+						if (view.find(pattern) != std::string_view::npos)
+						{
+							++matching;
+							break;
+						}
+				}
+				doNotOptimizeAway(matching);
+			});
+			bench.run("vale::find per pattern", [&]() {
+				size_t matching = 0;
+				for (const auto& line : lines)
+				{
+					const vale::string_view view(line.data(), line.size());
+					for (const auto& pattern : patterns)
+						if (vale::find(view, vale::string_view(pattern.data(), pattern.size())) != vale::npos)
+						{
+							++matching;
+							break;
+						}
+				}
+				doNotOptimizeAway(matching);
+			});
+			bench.run("vale::multi_matcher::contains_any", [&]() {
+				size_t matching = 0;
+				for (const auto& line : lines)
+					matching += matcher.contains_any(vale::string_view(line.data(), line.size()));
+				doNotOptimizeAway(matching);
+			});
+			bench.run("vale::multi_matcher::count", [&]() {
+				size_t matches = 0;
+				for (const auto& line : lines)
+					matches += matcher.count(vale::string_view(line.data(), line.size()));
+				doNotOptimizeAway(matches);
+			});
+		}
+	}
+
+	template<typename String>
+	/// @brief Hands a copy of each payload to each worker, whose inbox is consumed once all payloads are handed
+	/// @param payloads The payloads
+	/// @param inboxes The inbox of each worker
+	/// @param nb_threads The number of threads handing the payloads (each handles a part of the workers)
+	/// @return The number of characters received by the workers
+	static size_t fan_out(const std::vector<String>& payloads, std::vector<std::vector<String>>& inboxes, size_t nb_threads)
+	{
+		std::atomic<size_t> received{ 0 };
+		const auto hand = [&](size_t first_worker) {
+			size_t characters = 0;
+			for (size_t worker = first_worker; worker < inboxes.size(); worker += nb_threads)
+			{
+				auto& inbox = inboxes[worker];
+				for (const auto& payload : payloads)
+					inbox.push_back(payload);
+				for (const auto& message : inbox)
+					characters += message.size();
+				inbox.clear();
+			}
+			received.fetch_add(characters, std::memory_order_relaxed);
+		};
+		if (nb_threads == 1)
+			hand(0);
+		else
+		{
+			std::vector<std::thread> threads;
+			for (size_t t = 0; t < nb_threads; t++)
+				threads.emplace_back(hand, t);
+			for (auto& thread : threads)
+				thread.join();
+		}
+		return received.load();
+	}
+
+	void bench_shared_string()
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		ankerl::nanobench::Bench bench;
+		bench.relative(true).minEpochIterations(3).batch(SHARED_STRING_BENCH_PAYLOADS * SHARED_STRING_BENCH_WORKERS).unit("copy");
+		uint64_t state = 1;
+		for (const size_t payload_size : { size_t(64), size_t(1024), size_t(16384) })
+		{
+			std::vector<std::string> std_payloads(SHARED_STRING_BENCH_PAYLOADS);
+			std::vector<vale::shared_string> shared_payloads;
+			std::vector<vale::ts_shared_string> ts_payloads;
+			for (auto& payload : std_payloads)
+			{
+				payload.resize(payload_size);
+				for (auto& c : payload)
+				{
+					state = state * 6364136223846793005ull + 1442695040888963407ull;
+					c = static_cast<char>('a' + (state >> 33) % 26);
+				}
+				shared_payloads.emplace_back(vale::string_view(payload.data(), payload.size()));
+				ts_payloads.emplace_back(vale::string_view(payload.data(), payload.size()));
+			}
+			std::vector<std::vector<std::string>> std_inboxes(SHARED_STRING_BENCH_WORKERS);
+			std::vector<std::vector<vale::shared_string>> shared_inboxes(SHARED_STRING_BENCH_WORKERS);
+			std::vector<std::vector<vale::ts_shared_string>> ts_inboxes(SHARED_STRING_BENCH_WORKERS);
+
+			for (const size_t nb_threads : { size_t(1), size_t(4) })
+			{
+				bench.title("fan out " + std::to_string(payload_size) + "-byte payloads to "
+					+ std::to_string(SHARED_STRING_BENCH_WORKERS) + " workers (" + std::to_string(nb_threads) + " threads)");
+				bench.run("std::string copies", [&]() { doNotOptimizeAway(fan_out(std_payloads, std_inboxes, nb_threads)); });
+				if (nb_threads == 1)
+					bench.run("vale::shared_string", [&]() { doNotOptimizeAway(fan_out(shared_payloads, shared_inboxes, nb_threads)); });
+				bench.run("vale::ts_shared_string", [&]() { doNotOptimizeAway(fan_out(ts_payloads, ts_inboxes, nb_threads)); });
+			}
+		}
+	}
+}
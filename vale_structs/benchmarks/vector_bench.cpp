@@ -0,0 +1,441 @@
+#include <comppch.h>
+#include <nanobench.h>
+
+#include <vale_structs/vector.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "benchmarks.h"
+
+namespace vale::benchmarks
+{
+	/// @brief Number of objects pushed/inserted/erased in each iteration of the benchmarks
+	static constexpr size_t VECTOR_BENCH_SIZE = 1000;
+
+	/// @brief Number of simulated requests in each iteration of the small vector benchmark
+	static constexpr size_t SMALL_VECTOR_BENCH_REQUESTS = 10000;
+
+	/// @brief Total number of objects pushed by all threads in each iteration of the ts_vector benchmark
+	static constexpr size_t TS_VECTOR_BENCH_SIZE = size_t(1) << 20;
+
+	/// @brief Size of the file read in each iteration of the bulk I/O benchmark
+	static constexpr size_t BULK_IO_BENCH_BYTES = size_t(256) << 20;
+	/// @brief Size of the chunks read by the streaming part of the bulk I/O benchmark
+	static constexpr size_t BULK_IO_CHUNK_BYTES = size_t(1) << 20;
+
+	/// @brief Size of the vector grown by the mmap benchmark.
+	/// Raise it (for example to 16 GB) on machines with enough memory.
+	static constexpr size_t MMAP_BENCH_BYTES = size_t(2) << 30;
+	/// @brief Number of random reads in each iteration of the mmap benchmark
+	static constexpr size_t MMAP_BENCH_READS = size_t(1) << 24;
+
+	/// @brief Size of the lookup table opened by the mapped_vector benchmark.
+	/// Raise it (for example to 4 GB) on machines with enough memory and disk.
+	static constexpr size_t MAPPED_BENCH_BYTES = size_t(1) << 30;
+	/// @brief Number of lookups done after opening the table
+	static constexpr size_t MAPPED_BENCH_LOOKUPS = 1000;
+
+	/// @brief An item of the list built while handling a simulated request
+	struct request_item
+	{
+		uint32_t id;
+		uint32_t flags;
+		uint64_t value;
+	};
+
+	template<typename T, typename Make>
+	/// @brief Runs the push_back/insert/erase/reserve benchmarks on vale::vector and std::vector of 'T'
+	/// @tparam Make Functor which returns a 'T' from a size_t
+	/// @param type_name The name of 'T' shown in the titles
+	/// @param make Functor which returns a 'T' from a size_t
+	static void bench_vector_of(const char* type_name, Make make)
+	{
+		using ankerl::nanobench::doNotOptimizeAway;
+		ankerl::nanobench::Bench bench;
+		bench.relative(true).minEpochIterations(10);
+
+		bench.title(std::string("push_back ") + type_name);
+		bench.run("std::vector", [&]() {
+			std::vector<T> vec;
+			for (size_t i = 0; i < VECTOR_BENCH_SIZE; i++)
+				vec.push_back(make(i));
+			doNotOptimizeAway(vec.data());
+		});
+		bench.run("vale::vector", [&]() {
+			vale::vector<T> vec;
+			for (size_t i = 0; i < VECTOR_BENCH_SIZE; i++)
+				vec.push_back(make(i));
+			doNotOptimizeAway(vec.data());
+		});
+
+		bench.title(std::string("reserve + push_back ") + type_name);
+		bench.run("std::vector", [&]() {
+			std::vector<T> vec;
+			vec.reserve(VECTOR_BENCH_SIZE);
+			for (size_t i = 0; i < VECTOR_BENCH_SIZE; i++)
+				vec.push_back(make(i));
+			doNotOptimizeAway(vec.data());
+		});
+		bench.run("vale::vector", [&]() {
+			vale::vector<T> vec;
+			vec.reserve(VECTOR_BENCH_SIZE);
+			for (size_t i = 0; i < VECTOR_BENCH_SIZE; i++)
+				vec.push_back(make(i));
+			doNotOptimizeAway(vec.data());
+		});
+
+		bench.title(std::string("insert in the middle ") + type_name);
+		bench.run("std::vector", [&]() {
+			std::vector<T> vec;
+			for (size_t i = 0; i < VECTOR_BENCH_SIZE; i++)
+				vec.insert(vec.begin() + vec.size() / 2, make(i));
+			doNotOptimizeAway(vec.data());
+		});
+		bench.run("vale::vector", [&]() {
+			vale::vector<T> vec;
+			for (size_t i = 0; i < VECTOR_BENCH_SIZE; i++)
+				vec.insert(vec.begin() + vec.size() / 2, make(i));
+			doNotOptimizeAway(vec.data());
+		});
+
+		//The vectors are filled outside of the erase loop, but copied in each iteration
+		std::vector<T> std_filled;
+		vale::vector<T> vale_filled;
+		for (size_t i = 0; i < VECTOR_BENCH_SIZE; i++)
+		{
+			std_filled.push_back(make(i));
+			vale_filled.push_back(make(i));
+		}
+
+		bench.title(std::string("erase from the front ") + type_name);
+		bench.run("std::vector", [&]() {
+			std::vector<T> vec;
+			vec.swap(std_filled);
+			while (!vec.empty())
+				vec.erase(vec.begin());
+			for (size_t i = 0; i < VECTOR_BENCH_SIZE; i++)
+				vec.push_back(make(i));
+			vec.swap(std_filled);
+		});
+		bench.run("vale::vector", [&]() {
+			vale::vector<T> vec;
+			vec.swap(vale_filled);
+			while (!vec.is_empty())
+				vec.erase(vec.begin());
+			for (size_t i = 0; i < VECTOR_BENCH_SIZE; i++)
+				vec.push_back(make(i));
+			vec.swap(vale_filled);
+		});
+	}
+
+	template<typename Vector>
+	/// @brief Simulates requests which each build a small list of items.
+	/// Most requests have less than 8 items, some have up to 24.
+	/// @return The sum of the values of the items, to avoid optimizing the loop away
+	static uint64_t simulate_requests()
+	{
+		static constexpr uint32_t item_counts[16] = { 1, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 2, 8, 12, 3, 24 };
+		uint64_t sum = 0;
+		for (uint32_t r = 0; r < SMALL_VECTOR_BENCH_REQUESTS; r++)
+		{
+			Vector items;
+			for (uint32_t i = 0; i < item_counts[r % 16]; i++)
+				items.push_back(request_item{ i, r, uint64_t(r) * i });
+			for (const auto& item : items)
+				sum += item.value;
+		}
+		return sum;
+	}
+
+	template<typename Vector>
+	/// @brief Runs simulate_requests() and prints the number of allocations per request
+	/// @param name The name of the vector type
+	static void print_allocations_per_request(const char* name)
+	{
+		counting_allocator::allocations = 0;
+		ankerl::nanobench::doNotOptimizeAway(simulate_requests<Vector>());
+		std::cout << name << ": " << double(counting_allocator::allocations) / SMALL_VECTOR_BENCH_REQUESTS
+			<< " allocations per request\n";
+	}
+
+	void bench_small_vector()
+	{
+		using std_vector_t = std::vector<request_item, counting_std_allocator<request_item>>;
+		using vale_vector_t = vale::vector<request_item, default_growth, counting_allocator>;
+		using small_vector_t = vale::small_vector<request_item, 8, default_growth, counting_allocator>;
+
+		print_allocations_per_request<std_vector_t>("std::vector");
+		print_allocations_per_request<vale_vector_t>("vale::vector");
+		print_allocations_per_request<small_vector_t>("vale::small_vector<8>");
+
+		ankerl::nanobench::Bench bench;
+		bench.title("small lists per request").relative(true).minEpochIterations(10)
+			.batch(SMALL_VECTOR_BENCH_REQUESTS).unit("request");
+		bench.run("std::vector", []() { ankerl::nanobench::doNotOptimizeAway(simulate_requests<std_vector_t>()); });
+		bench.run("vale::vector", []() { ankerl::nanobench::doNotOptimizeAway(simulate_requests<vale_vector_t>()); });
+		bench.run("vale::small_vector<8>", []() { ankerl::nanobench::doNotOptimizeAway(simulate_requests<small_vector_t>()); });
+	}
+
+	/// @brief An event record appended by many threads
+	struct event_record
+	{
+		uint64_t timestamp;
+		uint32_t thread;
+		uint32_t code;
+	};
+
+	template<typename Push>
+	/// @brief Runs 'push' on 'nb_threads' threads, each thread pushing its part of TS_VECTOR_BENCH_SIZE objects
+	/// @param nb_threads The number of threads
+	/// @param push Functor which pushes one event_record
+	static void run_on_threads(size_t nb_threads, Push push)
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(nb_threads);
+		for (size_t t = 0; t < nb_threads; t++)
+		{
+			threads.emplace_back([&push, t, nb_threads]() {
+				for (size_t i = t; i < TS_VECTOR_BENCH_SIZE; i += nb_threads)
+					push(event_record{ i, static_cast<uint32_t>(t), static_cast<uint32_t>(i % 97) });
+			});
+		}
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	void bench_ts_vector()
+	{
+		for (size_t nb_threads = 1; nb_threads <= 64; nb_threads *= 2)
+		{
+			ankerl::nanobench::Bench bench;
+			bench.title("concurrent push_back, " + std::to_string(nb_threads) + " thread(s)")
+				.relative(true).minEpochIterations(3).batch(TS_VECTOR_BENCH_SIZE).unit("push");
+
+			bench.run("std::mutex + std::vector", [&]() {
+				std::mutex mutex;
+				std::vector<event_record> vec;
+				run_on_threads(nb_threads, [&](const event_record& record) {
+					std::scoped_lock lock(mutex);
+					vec.push_back(record);
+				});
+				ankerl::nanobench::doNotOptimizeAway(vec.data());
+			});
+			bench.run("vale::ts_vector", [&]() {
+				vale::ts_vector<event_record> vec;
+				run_on_threads(nb_threads, [&](const event_record& record) {
+					vec.push_back(record);
+				});
+				ankerl::nanobench::doNotOptimizeAway(vec.size());
+			});
+		}
+	}
+
+	/// @brief Returns a checksum of a buffer, which samples one byte per page
+	/// @param ptr The buffer
+	/// @param size The size of the buffer
+	/// @return The sum of the sampled bytes
+	static uint64_t sample_checksum(const char* ptr, size_t size)
+	{
+		uint64_t sum = 0;
+		for (size_t i = 0; i < size; i += 4096)
+			sum += static_cast<unsigned char>(ptr[i]);
+		return sum;
+	}
+
+	void bench_bulk_io()
+	{
+		const auto path = std::filesystem::temp_directory_path() / "vale_structs_bulk_io.bin";
+		{
+			//Write the file that is read by the benchmarks
+			std::vector<char> content(BULK_IO_CHUNK_BYTES);
+			for (size_t i = 0; i < content.size(); i++)
+				content[i] = static_cast<char>(i * 31);
+			std::FILE* file = std::fopen(path.string().c_str(), "wb");
+			if (file == nullptr)
+				return void(std::cerr << "Could not create " << path << '\n');
+			for (size_t i = 0; i < BULK_IO_BENCH_BYTES; i += BULK_IO_CHUNK_BYTES)
+				std::fwrite(content.data(), 1, content.size(), file);
+			std::fclose(file);
+		}
+
+		const auto open_file = [&]() { return std::fopen(path.string().c_str(), "rb"); };
+
+		ankerl::nanobench::Bench bench;
+		bench.title("read 256 MB file in one buffer").relative(true).minEpochIterations(2)
+			.batch(BULK_IO_BENCH_BYTES).unit("byte");
+		bench.run("std::vector<char>::resize", [&]() {
+			std::FILE* file = open_file();
+			std::vector<char> vec;
+			vec.resize(BULK_IO_BENCH_BYTES);
+			vec.resize(std::fread(vec.data(), 1, vec.size(), file));
+			std::fclose(file);
+			ankerl::nanobench::doNotOptimizeAway(sample_checksum(vec.data(), vec.size()));
+		});
+		bench.run("vale::vector<char>::resize_default_init", [&]() {
+			std::FILE* file = open_file();
+			vale::vector<char> vec;
+			vec.resize_default_init(BULK_IO_BENCH_BYTES);
+			vec.resize(std::fread(vec.data(), 1, vec.size(), file));
+			std::fclose(file);
+			ankerl::nanobench::doNotOptimizeAway(sample_checksum(vec.data(), vec.size()));
+		});
+
+		bench.title("read 256 MB file by 1 MB chunks").relative(true).minEpochIterations(2)
+			.batch(BULK_IO_BENCH_BYTES).unit("byte");
+		bench.run("std::vector<char>::resize", [&]() {
+			std::FILE* file = open_file();
+			std::vector<char> vec;
+			for (;;)
+			{
+				const size_t old_size = vec.size();
+				vec.resize(old_size + BULK_IO_CHUNK_BYTES);
+				const size_t read = std::fread(vec.data() + old_size, 1, BULK_IO_CHUNK_BYTES, file);
+				vec.resize(old_size + read);
+				if (read == 0)
+					break;
+			}
+			std::fclose(file);
+			ankerl::nanobench::doNotOptimizeAway(sample_checksum(vec.data(), vec.size()));
+		});
+		bench.run("vale::vector<char>::reserve_and_fill", [&]() {
+			std::FILE* file = open_file();
+			vale::vector<char> vec;
+			while (vec.reserve_and_fill(BULK_IO_CHUNK_BYTES,
+				[&](char* ptr, size_t count) { return std::fread(ptr, 1, count, file); }) != 0);
+			std::fclose(file);
+			ankerl::nanobench::doNotOptimizeAway(sample_checksum(vec.data(), vec.size()));
+		});
+
+		std::error_code ignored;
+		std::filesystem::remove(path, ignored);
+	}
+
+	template<typename Vector>
+	/// @brief Grows a vector of uint64_t to MMAP_BENCH_BYTES bytes by pushing one object at a time
+	/// @return The grown vector
+	static Vector grow_large_vector()
+	{
+		Vector vec;
+		for (uint64_t i = 0; i < MMAP_BENCH_BYTES / sizeof(uint64_t); i++)
+			vec.push_back(i);
+		return vec;
+	}
+
+	template<typename Vector>
+	/// @brief Reads MMAP_BENCH_READS objects at random indexes of a vector
+	/// @return The sum of the objects read
+	static uint64_t random_reads(const Vector& vec)
+	{
+		uint64_t sum = 0;
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		const uint64_t* data = vec.data();
+		for (size_t i = 0; i < MMAP_BENCH_READS; i++)
+		{
+			//xorshift64: cheap random indexes spread over the whole vector
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			sum += data[state % vec.size()];
+		}
+		return sum;
+	}
+
+	void bench_mmap_vector()
+	{
+		using heap_vector_t = vale::vector<uint64_t>;
+		using mmap_vector_t = vale::vector<uint64_t, default_growth, mmap_allocator<>>;
+
+		ankerl::nanobench::Bench bench;
+		bench.title("grow a " + std::to_string(MMAP_BENCH_BYTES >> 20) + " MB vector").relative(true)
+			.epochs(1).minEpochIterations(1).batch(MMAP_BENCH_BYTES / sizeof(uint64_t)).unit("push");
+		bench.run("std::vector", []() { ankerl::nanobench::doNotOptimizeAway(grow_large_vector<std::vector<uint64_t>>().size()); });
+		bench.run("vale::vector<heap_allocator>", []() { ankerl::nanobench::doNotOptimizeAway(grow_large_vector<heap_vector_t>().size()); });
+		bench.run("vale::vector<mmap_allocator>", []() { ankerl::nanobench::doNotOptimizeAway(grow_large_vector<mmap_vector_t>().size()); });
+
+		bench.title("random reads in a " + std::to_string(MMAP_BENCH_BYTES >> 20) + " MB vector").relative(true)
+			.epochs(3).minEpochIterations(1).batch(MMAP_BENCH_READS).unit("read");
+		{
+			const auto vec = grow_large_vector<heap_vector_t>();
+			bench.run("vale::vector<heap_allocator>", [&]() { ankerl::nanobench::doNotOptimizeAway(random_reads(vec)); });
+		}
+		{
+			const auto vec = grow_large_vector<mmap_vector_t>();
+			bench.run("vale::vector<mmap_allocator>", [&]() { ankerl::nanobench::doNotOptimizeAway(random_reads(vec)); });
+		}
+	}
+
+	/// @brief Looks up MAPPED_BENCH_LOOKUPS objects at pseudo-random indexes of a table
+	/// @param data The table
+	/// @param size The number of objects of the table
+	/// @return The sum of the objects looked up
+	static uint64_t table_lookups(const uint64_t* data, size_t size)
+	{
+		uint64_t sum = 0;
+		for (size_t i = 0; i < MAPPED_BENCH_LOOKUPS; i++)
+			sum += data[(i * 0x9E3779B97F4A7C15ull) % size];
+		return sum;
+	}
+
+	void bench_mapped_vector()
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		const auto mapped_path = std::filesystem::temp_directory_path() / "vale_structs_table.vvec";
+		const auto stream_path = std::filesystem::temp_directory_path() / "vale_structs_table.bin";
+		const size_t count = MAPPED_BENCH_BYTES / sizeof(uint64_t);
+		{
+			//Write the same table in both formats
+			std::filesystem::remove(mapped_path);
+			vale::mapped_vector<uint64_t> mapped(mapped_path.string());
+			std::ofstream stream(stream_path, std::ios::binary);
+			mapped.reserve(count);
+			stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+			std::vector<uint64_t> chunk(size_t(1) << 16);
+			for (size_t i = 0; i < count; i += chunk.size())
+			{
+				for (size_t j = 0; j < chunk.size(); j++)
+					chunk[j] = (i + j) * 7;
+				mapped.append(vale::contiguous_struct_view<uint64_t>(chunk.data(), chunk.size()));
+				stream.write(reinterpret_cast<const char*>(chunk.data()), chunk.size() * sizeof(uint64_t));
+			}
+		}
+
+		ankerl::nanobench::Bench bench;
+		bench.title("open a " + std::to_string(MAPPED_BENCH_BYTES >> 20) + " MB table + "
+			+ std::to_string(MAPPED_BENCH_LOOKUPS) + " lookups").relative(true).epochs(3).minEpochIterations(1);
+		bench.run("deserialize from std::ifstream", [&]() {
+			std::ifstream stream(stream_path, std::ios::binary);
+			size_t size = 0;
+			stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+			vale::vector<uint64_t> table;
+			table.resize_default_init(size);
+			stream.read(reinterpret_cast<char*>(table.data()), size * sizeof(uint64_t));
+			ankerl::nanobench::doNotOptimizeAway(table_lookups(table.data(), table.size()));
+		});
+		bench.run("vale::mapped_vector", [&]() {
+			vale::mapped_vector<uint64_t> table(mapped_path.string(), vale::mapped_file_mode::read_only);
+			ankerl::nanobench::doNotOptimizeAway(table_lookups(table.data(), table.size()));
+		});
+
+		std::error_code ignored;
+		std::filesystem::remove(mapped_path, ignored);
+		std::filesystem::remove(stream_path, ignored);
+#endif
+	}
+
+	void bench_vector()
+	{
+		bench_vector_of<int>("int", [](size_t i) { return static_cast<int>(i); });
+		bench_vector_of<std::unique_ptr<int>>("std::unique_ptr<int>",
+			[](size_t i) { return std::make_unique<int>(static_cast<int>(i)); });
+		//std::string is only trivially relocatable with libc++
+		bench_vector_of<std::string>("std::string",
+			[](size_t i) { return std::string(32, static_cast<char>('a' + i % 26)); });
+	}
+}
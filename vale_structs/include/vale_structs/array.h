@@ -22,6 +22,7 @@
 
 #pragma once
 #include <vale_structs/common.h>
+#include <vale_structs/charconv.h>
 
 namespace vale
 {
@@ -260,6 +261,24 @@ namespace vale
 			os << buffer[nb_elem - 1] << '}';
 		}
 
+		template<typename String, typename = std::enable_if_t<!std::is_base_of_v<std::ostream, String>>>
+		/// @brief Appends the content of the array to 'out', in the same format as print(std::ostream&).
+		/// Numbers are formatted without going through an ostream (see append_value).
+		/// @tparam String The string type (vale::basic_string)
+		/// @param out The string to append to
+		inline void print(String& out) const
+		{
+			std::scoped_lock lock{ mutex };
+			out.push_back('{');
+			for (size_t i = 0; i < nb_elem - 1; i++)
+			{
+				vale::append_value(out, buffer[i]);
+				out.append(", ");
+			}
+			vale::append_value(out, buffer[nb_elem - 1]);
+			out.push_back('}');
+		}
+
 	public: //MEMBERS
 
 		/// @brief C-style array of objects
@@ -390,6 +409,23 @@ namespace vale
 			os << buffer[nb_elem - 1] << '}';
 		}
 
+		template<typename String, typename = std::enable_if_t<!std::is_base_of_v<std::ostream, String>>>
+		/// @brief Appends the content of the array to 'out', in the same format as print(std::ostream&).
+		/// Numbers are formatted without going through an ostream (see append_value).
+		/// @tparam String The string type (vale::basic_string)
+		/// @param out The string to append to
+		inline void print(String& out) const
+		{
+			out.push_back('{');
+			for (size_t i = 0; i < nb_elem - 1; i++)
+			{
+				vale::append_value(out, buffer[i]);
+				out.append(", ");
+			}
+			vale::append_value(out, buffer[nb_elem - 1]);
+			out.push_back('}');
+		}
+
 	public: //MEMBERS
 
 		/// @brief C-style array of objects
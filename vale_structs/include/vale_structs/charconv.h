@@ -0,0 +1,1022 @@
+/** @file charconv.h
+* @brief Header that contains the number formatting and parsing functions.
+* Integers and doubles are converted to and from characters without going through a locale,
+* and without allocating: the functions write to (or read from) a caller-provided buffer.
+*
+* Doubles and floats are formatted using the shortest representation which parses back to the same
+* value (using the Ryu algorithm, by Ulf Adams), choosing between fixed and scientific
+* notation like std::to_chars does. The tables of powers of 5 used by Ryu are computed
+* at compile time.
+*
+* 'append_value' appends any printable value to a vale::string, and is used by the
+* string-based 'print' method of vale::array and vale::variant.
+*/
+
+#pragma once
+#include <vale_structs/common.h>
+#include <type_traits>
+#include <limits>
+#include <cstring>
+#include <cstdlib>
+#include <cfloat>
+#include <ostream>
+
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+namespace vale
+{
+	/// @brief The maximum number of characters written by 'write_int' (sign included)
+	static constexpr size_t max_int_chars = 20;
+	/// @brief The maximum number of characters written by 'write_double' (sign included)
+	static constexpr size_t max_double_chars = 24;
+	/// @brief The maximum number of characters written by 'write_float' (sign included)
+	static constexpr size_t max_float_chars = 15;
+
+	namespace details
+	{
+		/******************************************
+		DIGITS
+		******************************************/
+
+		/// @brief The decimal representation of the numbers from 0 to 99, two characters each
+		inline constexpr char digit_pairs[201] =
+			"00010203040506070809"
+			"10111213141516171819"
+			"20212223242526272829"
+			"30313233343536373839"
+			"40414243444546474849"
+			"50515253545556575859"
+			"60616263646566676869"
+			"70717273747576777879"
+			"80818283848586878889"
+			"90919293949596979899";
+
+		/// @brief The powers of 10 which fit in 64 bits
+		inline constexpr uint64_t powers_of_10[20] = {
+			1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+			100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+			10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+			100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+		};
+
+		/// @brief Returns the number of decimal digits of 'value' (1 for 0)
+		/// @param value The value whose digits to count
+		/// @return The number of digits, in [1, 20]
+		inline uint32_t decimal_length(uint64_t value) noexcept
+		{
+			value |= 1;
+			//1233 / 4096 is slightly more than log10(2): the guess is either exact or 1 too big
+			const uint32_t guess = static_cast<uint32_t>(((helpers::floor_log2(value) + 1) * 1233) >> 12);
+			return guess + 1 - (value < powers_of_10[guess]);
+		}
+
+		template<typename Unsigned>
+		/// @brief Writes the decimal digits of 'value' so that they end at 'end'.
+		/// The digits are generated two at a time, from the least significant.
+		/// @tparam Unsigned uint32_t or uint64_t, the narrower type dividing faster
+		/// @param end Pointer past the last digit to write
+		/// @param value The value to write
+		inline void write_digits(char* end, Unsigned value) noexcept
+		{
+			while (value >= 100)
+			{
+				const Unsigned pair = static_cast<Unsigned>(value % 100);
+				value /= 100;
+				end -= 2;
+				std::memcpy(end, digit_pairs + pair * 2, 2);
+			}
+			if (value >= 10)
+				std::memcpy(end - 2, digit_pairs + value * 2, 2);
+			else
+				end[-1] = static_cast<char>('0' + value);
+		}
+
+		/// @brief Checks if the 8 characters of 'chunk' are all decimal digits
+		/// @param chunk 8 characters loaded as a little-endian integer
+		/// @return true if the 8 characters are in ['0', '9']
+		inline bool is_eight_digits(uint64_t chunk) noexcept
+		{
+			return (((chunk & 0xF0F0F0F0F0F0F0F0ull)
+				| (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull);
+		}
+
+		/// @brief Converts 8 decimal digits to their value, using 3 multiplications
+		/// @param chunk 8 decimal digits loaded as a little-endian integer
+		/// @return The value of the digits
+		inline uint32_t parse_eight_digits(uint64_t chunk) noexcept
+		{
+			chunk = ((chunk & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+			chunk = ((chunk & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+			return static_cast<uint32_t>(((chunk & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32);
+		}
+
+		/// @brief Checks if 'c' is a decimal digit
+		/// @param c The character to check
+		/// @return true if 'c' is in ['0', '9']
+		constexpr bool is_digit(char c) noexcept
+		{
+			return static_cast<unsigned char>(c - '0') < 10;
+		}
+
+		/// @brief Checks if the characters of 'str' starting at 'offset' are 'word', ignoring the case
+		/// @param str The characters to check
+		/// @param offset The offset of the first character to compare
+		/// @param word The lowercase word to compare with
+		/// @return true if the characters match
+		inline bool matches_lowercase(contiguous_struct_view<char> str, size_t offset, const char* word) noexcept
+		{
+			const size_t length = std::strlen(word);
+			if (str.size() - offset < length)
+				return false;
+			for (size_t i = 0; i < length; i++)
+				if ((str.data()[offset + i] | 0x20) != word[i])
+					return false;
+			return true;
+		}
+
+		/******************************************
+		RYU TABLES
+		******************************************/
+
+		/// @brief The number of bits of the entries of the tables of powers of 5
+		static constexpr int32_t pow5_bitcount = 125;
+		/// @brief The number of bits of the entries of the tables of inverse powers of 5
+		static constexpr int32_t pow5_inv_bitcount = 125;
+		/// @brief The number of entries of the table of powers of 5
+		static constexpr size_t pow5_table_size = 326;
+		/// @brief The number of entries of the table of inverse powers of 5
+		static constexpr size_t pow5_inv_table_size = 342;
+
+		/// @brief Returns the number of bits of 5^e (ceil(log2(5^e)), or 1 for e == 0)
+		/// @param e The exponent, in [0, 3528]
+		constexpr int32_t pow5_bits(int32_t e) noexcept
+		{
+			return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+		}
+
+		/// @brief Returns floor(log2(5^e))
+		/// @param e The exponent, in [0, 3528]
+		constexpr int32_t log2_pow5(int32_t e) noexcept
+		{
+			return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19);
+		}
+
+		/// @brief Returns floor(log10(2^e))
+		/// @param e The exponent, in [0, 1650]
+		constexpr uint32_t log10_pow2(int32_t e) noexcept
+		{
+			return (static_cast<uint32_t>(e) * 78913) >> 18;
+		}
+
+		/// @brief Returns floor(log10(5^e))
+		/// @param e The exponent, in [0, 2620]
+		constexpr uint32_t log10_pow5(int32_t e) noexcept
+		{
+			return (static_cast<uint32_t>(e) * 732923) >> 20;
+		}
+
+		/// @brief The 128-bit tables used by Ryu, stored as {low, high} pairs
+		struct ryu_tables
+		{
+			/// @brief 5^i, shifted to have exactly 'pow5_bitcount' bits
+			uint64_t pow5[pow5_table_size][2];
+			/// @brief floor(2^(pow5_bits(i) - 1 + pow5_inv_bitcount) / 5^i) + 1
+			uint64_t pow5_inv[pow5_inv_table_size][2];
+		};
+
+		/// @brief The number of 32-bit words of the big integers used to compute the tables
+		static constexpr size_t ryu_big_words = 29;
+
+		/// @brief Returns the 32 bits of a big integer starting at bit 'position'.
+		/// Bits before 0 or after the end of the integer are zeros.
+		/// @param words The little-endian words of the big integer
+		/// @param position The position of the first bit (which may be negative)
+		constexpr uint32_t big_bits32(const uint32_t(&words)[ryu_big_words], int32_t position) noexcept
+		{
+			if (position <= -32)
+				return 0;
+			if (position < 0)
+				return words[0] << -position;
+			const size_t index = static_cast<size_t>(position) / 32;
+			const uint32_t offset = static_cast<uint32_t>(position) % 32;
+			uint32_t result = index < ryu_big_words ? words[index] >> offset : 0;
+			if (offset != 0 && index + 1 < ryu_big_words)
+				result |= words[index + 1] << (32 - offset);
+			return result;
+		}
+
+		/// @brief Writes the 128 bits of a big integer starting at bit 'position' to 'out'
+		/// @param words The little-endian words of the big integer
+		/// @param position The position of the first bit (which may be negative)
+		/// @param out The {low, high} pair to write to
+		constexpr void big_bits128(const uint32_t(&words)[ryu_big_words], int32_t position, uint64_t(&out)[2]) noexcept
+		{
+			out[0] = big_bits32(words, position) | (static_cast<uint64_t>(big_bits32(words, position + 32)) << 32);
+			out[1] = big_bits32(words, position + 64) | (static_cast<uint64_t>(big_bits32(words, position + 96)) << 32);
+		}
+
+		/// @brief Computes the tables used by Ryu.
+		/// 5^i is computed by successive multiplications, and floor(2^k / 5^i) by successive
+		/// divisions of 2^916 by 5 (as floor(floor(x / a) / b) == floor(x / (a * b))).
+		/// @return The tables
+		constexpr ryu_tables make_ryu_tables() noexcept
+		{
+			ryu_tables tables{};
+			uint32_t power[ryu_big_words]{};
+			power[0] = 1;
+			for (size_t i = 0; i < pow5_table_size; i++)
+			{
+				big_bits128(power, pow5_bits(static_cast<int32_t>(i)) - pow5_bitcount, tables.pow5[i]);
+				uint64_t carry = 0;
+				for (size_t w = 0; w < ryu_big_words; w++)
+				{
+					const uint64_t product = static_cast<uint64_t>(power[w]) * 5 + carry;
+					power[w] = static_cast<uint32_t>(product);
+					carry = product >> 32;
+				}
+			}
+
+			//pow5_bits(341) - 1 + pow5_inv_bitcount == 916
+			constexpr int32_t max_shift = pow5_bits(pow5_inv_table_size - 1) - 1 + pow5_inv_bitcount;
+			uint32_t inverse[ryu_big_words]{};
+			inverse[max_shift / 32] = uint32_t(1) << (max_shift % 32);
+			for (size_t i = 0; i < pow5_inv_table_size; i++)
+			{
+				const int32_t shift = pow5_bits(static_cast<int32_t>(i)) - 1 + pow5_inv_bitcount;
+				big_bits128(inverse, max_shift - shift, tables.pow5_inv[i]);
+				tables.pow5_inv[i][1] += (++tables.pow5_inv[i][0] == 0);
+				uint64_t remainder = 0;
+				for (size_t w = ryu_big_words; w-- > 0;)
+				{
+					const uint64_t current = (remainder << 32) | inverse[w];
+					inverse[w] = static_cast<uint32_t>(current / 5);
+					remainder = current % 5;
+				}
+			}
+			return tables;
+		}
+
+		/// @brief The tables used by Ryu, computed at compile time
+		inline constexpr ryu_tables ryu = make_ryu_tables();
+
+		/******************************************
+		RYU
+		******************************************/
+
+		/// @brief Returns the bits of (m * mul) >> j, where mul is a 128-bit integer
+		/// @param m The 64-bit factor
+		/// @param mul The {low, high} 128-bit factor
+		/// @param j The shift, in ]64, 128[
+		inline uint64_t mul_shift64(uint64_t m, const uint64_t* mul, int32_t j) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 low = static_cast<unsigned __int128>(m) * mul[0];
+			const unsigned __int128 high = static_cast<unsigned __int128>(m) * mul[1];
+			return static_cast<uint64_t>(((low >> 64) + high) >> (j - 64));
+#else
+			//Portable 64x64 -> 128 multiplications, using 32-bit halves
+			const auto multiply = [](uint64_t a, uint64_t b, uint64_t& product_high) noexcept -> uint64_t
+			{
+				const uint64_t a_low = static_cast<uint32_t>(a), a_high = a >> 32;
+				const uint64_t b_low = static_cast<uint32_t>(b), b_high = b >> 32;
+				const uint64_t low_low = a_low * b_low, low_high = a_low * b_high;
+				const uint64_t high_low = a_high * b_low, high_high = a_high * b_high;
+				const uint64_t middle = (low_low >> 32) + static_cast<uint32_t>(high_low) + static_cast<uint32_t>(low_high);
+				product_high = high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+				return (middle << 32) | static_cast<uint32_t>(low_low);
+			};
+			uint64_t high0, high1;
+			multiply(m, mul[0], high0);
+			const uint64_t low1 = multiply(m, mul[1], high1);
+			const uint64_t sum = high0 + low1;
+			high1 += (sum < high0);
+			const uint32_t shift = static_cast<uint32_t>(j - 64);
+			return (high1 << (64 - shift)) | (sum >> shift);
+#endif
+		}
+
+		/// @brief Returns the number of times 'value' is divisible by 5
+		/// @param value The value, which should not be 0
+		inline uint32_t pow5_factor(uint64_t value) noexcept
+		{
+			uint32_t count = 0;
+			while (value % 5 == 0)
+			{
+				value /= 5;
+				++count;
+			}
+			return count;
+		}
+
+		/// @brief Checks if 'value' is divisible by 5^p
+		inline bool is_multiple_of_pow5(uint64_t value, uint32_t p) noexcept { return pow5_factor(value) >= p; }
+
+		/// @brief Checks if 'value' is divisible by 2^p
+		/// @param p The power, in [0, 63]
+		inline bool is_multiple_of_pow2(uint64_t value, uint32_t p) noexcept { return (value & ((1ull << p) - 1)) == 0; }
+
+		/// @brief A decimal floating point number: mantissa * 10^exponent
+		struct decimal_double
+		{
+			/// @brief The decimal digits
+			uint64_t mantissa;
+			/// @brief The power of 10 by which to multiply the digits
+			int32_t exponent;
+		};
+
+		/// @brief The number of explicit bits of the mantissa of a double
+		static constexpr int32_t double_mantissa_bits = 52;
+		/// @brief The bias of the exponent of a double
+		static constexpr int32_t double_bias = 1023;
+		/// @brief The number of explicit bits of the mantissa of a float
+		static constexpr int32_t float_mantissa_bits = 23;
+		/// @brief The bias of the exponent of a float
+		static constexpr int32_t float_bias = 127;
+
+		/// @brief Computes the shortest decimal representation which rounds to the double
+		/// whose fields are 'ieee_mantissa' and 'ieee_exponent' (which should be finite and not 0).
+		/// This is the 'd2d' function of Ryu. Floats go through the same computation with their
+		/// own field widths: as the interval of valid representations is computed from the
+		/// float's neighbours, the result is the shortest representation at float precision.
+		/// @param ieee_mantissa The mantissa bits of the double
+		/// @param ieee_exponent The exponent bits of the double
+		/// @param mantissa_bits The number of mantissa bits (52 for doubles, 23 for floats)
+		/// @param bias The bias of the exponent (1023 for doubles, 127 for floats)
+		/// @return The shortest representation
+		inline decimal_double shortest_decimal(uint64_t ieee_mantissa, uint32_t ieee_exponent,
+			int32_t mantissa_bits = double_mantissa_bits, int32_t bias = double_bias) noexcept
+		{
+			//Integers in [1, 2^(mantissa_bits + 1)[ are represented exactly by their digits
+			const int32_t integer_e2 = static_cast<int32_t>(ieee_exponent) - bias - mantissa_bits;
+			if (integer_e2 <= 0 && integer_e2 >= -mantissa_bits)
+			{
+				const uint64_t m2 = (1ull << mantissa_bits) | ieee_mantissa;
+				if ((m2 & ((1ull << -integer_e2) - 1)) == 0)
+				{
+					decimal_double result{ m2 >> -integer_e2, 0 };
+					while (result.mantissa % 10 == 0)
+					{
+						result.mantissa /= 10;
+						++result.exponent;
+					}
+					return result;
+				}
+			}
+
+			//We subtract 2 so that the bounds computation has 2 additional bits
+			int32_t e2;
+			uint64_t m2;
+			if (ieee_exponent == 0)
+			{
+				e2 = 1 - bias - mantissa_bits - 2;
+				m2 = ieee_mantissa;
+			}
+			else
+			{
+				e2 = static_cast<int32_t>(ieee_exponent) - bias - mantissa_bits - 2;
+				m2 = (1ull << mantissa_bits) | ieee_mantissa;
+			}
+			const bool accept_bounds = (m2 & 1) == 0;
+
+			//The interval of valid representations is [mm, mp], around mv
+			const uint64_t mv = 4 * m2;
+			const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+			uint64_t vr, vp, vm;
+			int32_t e10;
+			bool vm_is_trailing_zeros = false;
+			bool vr_is_trailing_zeros = false;
+			if (e2 >= 0)
+			{
+				const uint32_t q = log10_pow2(e2) - (e2 > 3);
+				e10 = static_cast<int32_t>(q);
+				const int32_t k = pow5_inv_bitcount + pow5_bits(static_cast<int32_t>(q)) - 1;
+				const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+				vr = mul_shift64(4 * m2, ryu.pow5_inv[q], i);
+				vp = mul_shift64(4 * m2 + 2, ryu.pow5_inv[q], i);
+				vm = mul_shift64(4 * m2 - 1 - mm_shift, ryu.pow5_inv[q], i);
+				if (q <= 21)
+				{
+					//Only one of mp, mv, and mm can be a multiple of 5, if any
+					if (mv % 5 == 0)
+						vr_is_trailing_zeros = is_multiple_of_pow5(mv, q);
+					else if (accept_bounds)
+						vm_is_trailing_zeros = is_multiple_of_pow5(mv - 1 - mm_shift, q);
+					else
+						vp -= is_multiple_of_pow5(mv + 2, q);
+				}
+			}
+			else
+			{
+				const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+				e10 = static_cast<int32_t>(q) + e2;
+				const int32_t i = -e2 - static_cast<int32_t>(q);
+				const int32_t k = pow5_bits(i) - pow5_bitcount;
+				const int32_t j = static_cast<int32_t>(q) - k;
+				vr = mul_shift64(4 * m2, ryu.pow5[i], j);
+				vp = mul_shift64(4 * m2 + 2, ryu.pow5[i], j);
+				vm = mul_shift64(4 * m2 - 1 - mm_shift, ryu.pow5[i], j);
+				if (q <= 1)
+				{
+					//mv = 4 * m2 always has at least two trailing 0 bits
+					vr_is_trailing_zeros = true;
+					if (accept_bounds)
+						vm_is_trailing_zeros = mm_shift == 1;
+					else
+						--vp;
+				}
+				else if (q < 63)
+					vr_is_trailing_zeros = is_multiple_of_pow2(mv, q);
+			}
+
+			//Remove the digits shared by the bounds, which gives the shortest representation
+			int32_t removed = 0;
+			uint64_t output;
+			if (vm_is_trailing_zeros || vr_is_trailing_zeros)
+			{
+				//Rare case (~0.7%), in which the exact value may be a tie
+				uint32_t last_removed_digit = 0;
+				while (vp / 10 > vm / 10)
+				{
+					vm_is_trailing_zeros &= vm % 10 == 0;
+					vr_is_trailing_zeros &= last_removed_digit == 0;
+					last_removed_digit = static_cast<uint32_t>(vr % 10);
+					vr /= 10;
+					vp /= 10;
+					vm /= 10;
+					++removed;
+				}
+				if (vm_is_trailing_zeros)
+				{
+					while (vm % 10 == 0)
+					{
+						vr_is_trailing_zeros &= last_removed_digit == 0;
+						last_removed_digit = static_cast<uint32_t>(vr % 10);
+						vr /= 10;
+						vp /= 10;
+						vm /= 10;
+						++removed;
+					}
+				}
+				//Round to even if the exact number is .....50..0
+				if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+					last_removed_digit = 4;
+				output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) || last_removed_digit >= 5);
+			}
+			else
+			{
+				bool round_up = false;
+				//Removing two digits at a time is worth it in ~86% of cases
+				if (vp / 100 > vm / 100)
+				{
+					round_up = vr % 100 >= 50;
+					vr /= 100;
+					vp /= 100;
+					vm /= 100;
+					removed += 2;
+				}
+				while (vp / 10 > vm / 10)
+				{
+					round_up = vr % 10 >= 5;
+					vr /= 10;
+					vp /= 10;
+					vm /= 10;
+					++removed;
+				}
+				output = vr + (vr == vm || round_up);
+			}
+			return { output, e10 + removed };
+		}
+
+		/// @brief Converts mantissa * 10^exponent to the nearest double (ties to even).
+		/// This is the 's2d' function of Ryu, which uses the same tables as 'shortest_decimal'.
+		/// @param mantissa The decimal digits, which should not be 0 and should be less than 2^57
+		/// @param exponent The power of 10
+		/// @param negative True if the double should be negative
+		/// @return The nearest double
+		inline double decimal_to_double(uint64_t mantissa, int64_t exponent, bool negative) noexcept
+		{
+			const uint64_t sign = static_cast<uint64_t>(negative) << 63;
+			const int64_t digits = decimal_length(mantissa);
+			uint64_t ieee;
+			if (digits + exponent <= -324)
+			{
+				ieee = sign;
+				double result;
+				std::memcpy(&result, &ieee, sizeof(double));
+				return result;
+			}
+			if (digits + exponent >= 310)
+			{
+				ieee = sign | (0x7FFull << double_mantissa_bits);
+				double result;
+				std::memcpy(&result, &ieee, sizeof(double));
+				return result;
+			}
+
+			//Convert to m2 * 2^e2, the 54 or 55 most significant bits, remembering if it is exact
+			const int32_t e10 = static_cast<int32_t>(exponent);
+			const int32_t log2_mantissa = static_cast<int32_t>(helpers::floor_log2(mantissa));
+			int32_t e2;
+			uint64_t m2;
+			bool trailing_zeros;
+			if (e10 >= 0)
+			{
+				e2 = log2_mantissa + e10 + log2_pow5(e10) - (double_mantissa_bits + 1);
+				const int32_t j = e2 - e10 - pow5_bits(e10) + pow5_bitcount;
+				m2 = mul_shift64(mantissa, ryu.pow5[e10], j);
+				trailing_zeros = e2 < e10 || (e2 - e10 < 64 && is_multiple_of_pow2(mantissa, e2 - e10));
+			}
+			else
+			{
+				e2 = log2_mantissa + e10 - pow5_bits(-e10) - (double_mantissa_bits + 1);
+				const int32_t j = e2 - e10 + pow5_bits(-e10) - 1 + pow5_inv_bitcount;
+				m2 = mul_shift64(mantissa, ryu.pow5_inv[-e10], j);
+				trailing_zeros = is_multiple_of_pow5(mantissa, static_cast<uint32_t>(-e10));
+			}
+
+			const int32_t biased = e2 + double_bias + static_cast<int32_t>(helpers::floor_log2(m2));
+			uint32_t ieee_e2 = static_cast<uint32_t>(biased < 0 ? 0 : biased);
+			if (ieee_e2 > 0x7FE)
+			{
+				ieee = sign | (0x7FFull << double_mantissa_bits);
+				double result;
+				std::memcpy(&result, &ieee, sizeof(double));
+				return result;
+			}
+
+			//Round to nearest, ties to even, taking the final exponent into account
+			const int32_t shift = (ieee_e2 == 0 ? 1 : static_cast<int32_t>(ieee_e2)) - e2 - double_bias - double_mantissa_bits;
+			uint64_t ieee_m2 = 0;
+			if (shift < 64)
+			{
+				trailing_zeros &= (m2 & ((1ull << (shift - 1)) - 1)) == 0;
+				const uint64_t last_removed_bit = (m2 >> (shift - 1)) & 1;
+				const bool round_up = last_removed_bit != 0 && (!trailing_zeros || ((m2 >> shift) & 1) != 0);
+				ieee_m2 = (m2 >> shift) + round_up;
+				ieee_m2 &= (1ull << double_mantissa_bits) - 1;
+				//A carry out of the mantissa increments the exponent (possibly to infinity)
+				if (ieee_m2 == 0 && round_up)
+					++ieee_e2;
+			}
+			ieee = sign | (static_cast<uint64_t>(ieee_e2) << double_mantissa_bits) | ieee_m2;
+			double result;
+			std::memcpy(&result, &ieee, sizeof(double));
+			return result;
+		}
+
+		/// @brief Parses a double which could not be parsed exactly using 17 significant digits.
+		/// This is only used for inputs with more than 17 significant digits,
+		/// whose truncation lies between two doubles, which is very rare.
+		/// @param str The characters of the number, as accepted by parse_double
+		/// @return The nearest double
+		inline double parse_long_double(contiguous_struct_view<char> str) noexcept
+		{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+			double result = 0;
+			std::from_chars(str.data(), str.data() + str.size(), result);
+			return result;
+#else
+			//strtod requires a null-terminated string: the '.' of the current locale is
+			//assumed to be '.', and digits past the 767th cannot change the result.
+			char buffer[800];
+			const size_t size = str.size() < sizeof(buffer) - 1 ? str.size() : sizeof(buffer) - 1;
+			std::memcpy(buffer, str.data(), size);
+			buffer[size] = '\0';
+			return std::strtod(buffer, nullptr);
+#endif
+		}
+
+		/// @brief Writes 'decimal' (whose mantissa should not be 0) using fixed notation,
+		/// unless scientific notation is shorter
+		/// @param out The buffer to write to
+		/// @param decimal The digits and exponent to write
+		/// @return Pointer past the last character written
+		inline char* write_decimal(char* out, decimal_double decimal) noexcept
+		{
+			const int32_t length = static_cast<int32_t>(details::decimal_length(decimal.mantissa));
+			const int32_t exponent = decimal.exponent;
+			const int32_t scientific_exponent = exponent + length - 1;
+
+			//Choose the shortest notation, preferring fixed notation
+			const int32_t scientific_length = length + (length > 1) + 2
+				+ (scientific_exponent >= 100 || scientific_exponent <= -100 ? 3 : 2);
+			int32_t fixed_length;
+			if (exponent >= 0)
+				fixed_length = length + exponent;
+			else if (length + exponent > 0)
+				fixed_length = length + 1;
+			else
+				fixed_length = 2 - exponent;
+
+			if (fixed_length <= scientific_length)
+			{
+				if (exponent >= 0)
+				{
+					details::write_digits(out + length, decimal.mantissa);
+					std::memset(out + length, '0', exponent);
+				}
+				else if (length + exponent > 0)
+				{
+					//Write the digits, then move the fractional ones to make space for the '.'
+					const int32_t integer_length = length + exponent;
+					details::write_digits(out + length, decimal.mantissa);
+					std::memmove(out + integer_length + 1, out + integer_length, -exponent);
+					out[integer_length] = '.';
+				}
+				else
+				{
+					out[0] = '0';
+					out[1] = '.';
+					std::memset(out + 2, '0', -exponent - length);
+					details::write_digits(out + fixed_length, decimal.mantissa);
+				}
+				return out + fixed_length;
+			}
+
+			//Write the digits after the first character, then move the first digit before the '.'
+			details::write_digits(out + length + 1, decimal.mantissa);
+			out[0] = out[1];
+			out[1] = '.';
+			out += length + (length > 1);
+			out[0] = 'e';
+			out[1] = scientific_exponent < 0 ? '-' : '+';
+			const uint32_t magnitude = static_cast<uint32_t>(scientific_exponent < 0 ? -scientific_exponent : scientific_exponent);
+			if (magnitude >= 100)
+			{
+				out[2] = static_cast<char>('0' + magnitude / 100);
+				std::memcpy(out + 3, details::digit_pairs + (magnitude % 100) * 2, 2);
+				return out + 5;
+			}
+			std::memcpy(out + 2, details::digit_pairs + magnitude * 2, 2);
+			return out + 4;
+		}
+	}
+
+	/******************************************
+	FORMATTING
+	******************************************/
+
+	template<typename Int>
+	/// @brief Writes the decimal representation of an integer to 'out'.
+	/// 'out' should have space for at least 'max_int_chars' characters.
+	/// No null terminator is written.
+	/// @tparam Int The integer type
+	/// @param out The buffer to write to
+	/// @param value The integer to write
+	/// @return Pointer past the last character written
+	inline char* write_int(char* out, Int value) noexcept
+	{
+		static_assert(std::is_integral_v<Int> && !std::is_same_v<Int, bool>,
+			"write_int expects an integer type!");
+		uint64_t magnitude = static_cast<uint64_t>(value);
+		if constexpr (std::is_signed_v<Int>)
+		{
+			//The '-' is always written, but only kept if the value is negative
+			*out = '-';
+			out += value < 0;
+			magnitude = value < 0 ? 0 - magnitude : magnitude;
+		}
+		const uint32_t length = details::decimal_length(magnitude);
+		if constexpr (sizeof(Int) <= sizeof(uint32_t))
+			details::write_digits(out + length, static_cast<uint32_t>(magnitude));
+		else
+			details::write_digits(out + length, magnitude);
+		return out + length;
+	}
+
+	/// @brief Writes the shortest decimal representation of 'value' which parses back to 'value'.
+	/// Like std::to_chars, the representation uses fixed notation unless scientific notation
+	/// is shorter. Infinities are written 'inf' and NaNs 'nan'.
+	/// Unlike std::to_chars, integers greater than 2^53 written in fixed notation are written
+	/// as their shortest digits followed by zeros, rather than as their exact value.
+	/// 'out' should have space for at least 'max_double_chars' characters.
+	/// No null terminator is written.
+	/// @param out The buffer to write to
+	/// @param value The double to write
+	/// @return Pointer past the last character written
+	inline char* write_double(char* out, double value) noexcept
+	{
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(double));
+		const bool negative = (bits >> 63) != 0;
+		const uint64_t ieee_mantissa = bits & ((1ull << details::double_mantissa_bits) - 1);
+		const uint32_t ieee_exponent = static_cast<uint32_t>((bits >> details::double_mantissa_bits) & 0x7FF);
+
+		*out = '-';
+		out += negative;
+		if (ieee_exponent == 0x7FF)
+		{
+			std::memcpy(out, ieee_mantissa == 0 ? "inf" : "nan", 3);
+			return out + 3;
+		}
+		if (ieee_exponent == 0 && ieee_mantissa == 0)
+		{
+			*out = '0';
+			return out + 1;
+		}
+
+		return details::write_decimal(out, details::shortest_decimal(ieee_mantissa, ieee_exponent));
+	}
+
+	/// @brief Writes the shortest decimal representation of 'value' which parses back to 'value'
+	/// as a float (so 0.1f is written '0.1'), choosing the notation like 'write_double'.
+	/// 'out' should have space for at least 'max_float_chars' characters.
+	/// No null terminator is written.
+	/// @param out The buffer to write to
+	/// @param value The float to write
+	/// @return Pointer past the last character written
+	inline char* write_float(char* out, float value) noexcept
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(float));
+		const bool negative = (bits >> 31) != 0;
+		const uint32_t ieee_mantissa = bits & ((1u << details::float_mantissa_bits) - 1);
+		const uint32_t ieee_exponent = (bits >> details::float_mantissa_bits) & 0xFF;
+
+		*out = '-';
+		out += negative;
+		if (ieee_exponent == 0xFF)
+		{
+			std::memcpy(out, ieee_mantissa == 0 ? "inf" : "nan", 3);
+			return out + 3;
+		}
+		if (ieee_exponent == 0 && ieee_mantissa == 0)
+		{
+			*out = '0';
+			return out + 1;
+		}
+		return details::write_decimal(out, details::shortest_decimal(ieee_mantissa, ieee_exponent,
+			details::float_mantissa_bits, details::float_bias));
+	}
+
+	/******************************************
+	PARSING
+	******************************************/
+
+	template<typename Int>
+	/// @brief Parses an integer at the beginning of 'str': an optional '-' (for signed types)
+	/// followed by decimal digits. Unlike std::from_chars, the digits are read 8 at a time.
+	/// @tparam Int The integer type
+	/// @param str The characters to parse
+	/// @param value The integer to write to, which is not modified on failure
+	/// @return The number of characters parsed, or 0 if 'str' does not start with
+	/// an integer or if the integer does not fit in 'Int'
+	inline size_t parse_int(contiguous_struct_view<char> str, Int& value) noexcept
+	{
+		static_assert(std::is_integral_v<Int> && !std::is_same_v<Int, bool>,
+			"parse_int expects an integer type!");
+		const char* const begin = str.data();
+		const char* const end = begin + str.size();
+		const char* ptr = begin;
+		bool negative = false;
+		if constexpr (std::is_signed_v<Int>)
+		{
+			if (ptr != end && *ptr == '-')
+			{
+				negative = true;
+				++ptr;
+			}
+		}
+		const char* const digits_begin = ptr;
+		while (ptr != end && *ptr == '0')
+			++ptr;
+		const char* const significant = ptr;
+
+		//At most 2 chunks of 8 digits, so that the result cannot overflow
+		uint64_t result = 0;
+		while (end - ptr >= 8 && ptr - significant <= 8)
+		{
+			uint64_t chunk;
+			std::memcpy(&chunk, ptr, sizeof(uint64_t));
+			if (!details::is_eight_digits(chunk))
+				break;
+			result = result * 100000000 + details::parse_eight_digits(chunk);
+			ptr += 8;
+		}
+		for (; ptr != end && details::is_digit(*ptr); ++ptr)
+		{
+			const uint64_t digit = static_cast<uint64_t>(*ptr - '0');
+			if (ptr - significant >= 19)
+			{
+				//The 20th digit may overflow, and any digit after it does
+				if (ptr - significant > 19 || result > (UINT64_MAX - digit) / 10)
+					return 0;
+			}
+			result = result * 10 + digit;
+		}
+		if (ptr == digits_begin)
+			return 0;
+
+		using Unsigned = std::make_unsigned_t<Int>;
+		if (negative)
+		{
+			if (result > static_cast<uint64_t>(std::numeric_limits<Int>::max()) + 1)
+				return 0;
+			value = static_cast<Int>(static_cast<Unsigned>(0 - result));
+		}
+		else
+		{
+			if (result > static_cast<uint64_t>(std::numeric_limits<Int>::max()))
+				return 0;
+			value = static_cast<Int>(result);
+		}
+		return static_cast<size_t>(ptr - begin);
+	}
+
+	/// @brief Parses a double at the beginning of 'str', rounding to the nearest double.
+	/// Like std::from_chars, accepts an optional '-', digits with an optional '.',
+	/// an optional exponent ('e' or 'E', optional sign, digits), or 'inf', 'infinity'
+	/// and 'nan' (ignoring the case).
+	/// @param str The characters to parse
+	/// @param value The double to write to, which is not modified on failure
+	/// @return The number of characters parsed, or 0 if 'str' does not start with a number
+	inline size_t parse_double(contiguous_struct_view<char> str, double& value) noexcept
+	{
+		const char* const begin = str.data();
+		const char* const end = begin + str.size();
+		const char* ptr = begin;
+		const bool negative = ptr != end && *ptr == '-';
+		ptr += negative;
+		if (ptr != end && !details::is_digit(*ptr) && *ptr != '.')
+		{
+			const size_t offset = static_cast<size_t>(ptr - begin);
+			if (details::matches_lowercase(str, offset, "inf"))
+			{
+				value = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+				return offset + (details::matches_lowercase(str, offset, "infinity") ? 8 : 3);
+			}
+			if (details::matches_lowercase(str, offset, "nan"))
+			{
+				value = negative ? -std::numeric_limits<double>::quiet_NaN() : std::numeric_limits<double>::quiet_NaN();
+				return offset + 3;
+			}
+			return 0;
+		}
+
+		//Keep the first 17 significant digits, remembering if any dropped digit is not 0
+		static constexpr int32_t max_digits = 17;
+		uint64_t mantissa = 0;
+		int32_t significant_digits = 0;
+		int64_t exponent = 0;
+		bool truncated = false;
+		bool has_digits = false;
+		for (; ptr != end && details::is_digit(*ptr); ++ptr)
+		{
+			has_digits = true;
+			const uint32_t digit = static_cast<uint32_t>(*ptr - '0');
+			if (significant_digits < max_digits)
+			{
+				mantissa = mantissa * 10 + digit;
+				significant_digits += mantissa != 0;
+			}
+			else
+			{
+				truncated |= digit != 0;
+				++exponent;
+			}
+		}
+		if (ptr != end && *ptr == '.')
+		{
+			const char* const fraction = ++ptr;
+			for (; ptr != end && details::is_digit(*ptr); ++ptr)
+			{
+				const uint32_t digit = static_cast<uint32_t>(*ptr - '0');
+				if (significant_digits < max_digits)
+				{
+					mantissa = mantissa * 10 + digit;
+					significant_digits += mantissa != 0;
+					--exponent;
+				}
+				else
+					truncated |= digit != 0;
+			}
+			has_digits |= ptr != fraction;
+			//A '.' without any digit is not a number
+			if (!has_digits)
+				return 0;
+		}
+		if (!has_digits)
+			return 0;
+
+		//The exponent is only consumed if it contains digits
+		if (ptr != end && (*ptr | 0x20) == 'e')
+		{
+			const char* exponent_ptr = ptr + 1;
+			const bool negative_exponent = exponent_ptr != end && *exponent_ptr == '-';
+			exponent_ptr += (exponent_ptr != end && (*exponent_ptr == '-' || *exponent_ptr == '+'));
+			if (exponent_ptr != end && details::is_digit(*exponent_ptr))
+			{
+				int64_t explicit_exponent = 0;
+				for (; exponent_ptr != end && details::is_digit(*exponent_ptr); ++exponent_ptr)
+				{
+					//Saturate: such exponents give 0 or infinity anyway
+					if (explicit_exponent < 100000)
+						explicit_exponent = explicit_exponent * 10 + (*exponent_ptr - '0');
+				}
+				exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+				ptr = exponent_ptr;
+			}
+		}
+
+		if (mantissa == 0)
+		{
+			value = negative ? -0.0 : 0.0;
+			return static_cast<size_t>(ptr - begin);
+		}
+		//Both the mantissa and the power of 10 are exact doubles: a single rounding is correct
+		//(unless the operation is evaluated with extended precision, which rounds twice)
+		if (FLT_EVAL_METHOD == 0 && !truncated && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+		{
+			static constexpr double exact_powers[23] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+			};
+			const double magnitude = exponent < 0
+				? static_cast<double>(mantissa) / exact_powers[-exponent]
+				: static_cast<double>(mantissa) * exact_powers[exponent];
+			value = negative ? -magnitude : magnitude;
+			return static_cast<size_t>(ptr - begin);
+		}
+		double result = details::decimal_to_double(mantissa, exponent, negative);
+		//The exact value is in ]mantissa, mantissa + 1[ * 10^exponent: if both bounds round
+		//to the same double, so does the exact value
+		if (truncated && details::decimal_to_double(mantissa + 1, exponent, negative) != result)
+			result = details::parse_long_double(contiguous_struct_view<char>(begin, static_cast<size_t>(ptr - begin)));
+		value = result;
+		return static_cast<size_t>(ptr - begin);
+	}
+
+	/******************************************
+	APPENDING TO STRINGS
+	******************************************/
+
+	namespace details
+	{
+		template<typename T, typename String, typename = void>
+		/// @brief Checks if 'T' has a 'print(String&)' method
+		struct has_string_print : std::false_type {};
+
+		template<typename T, typename String>
+		/// @brief Checks if 'T' has a 'print(String&)' method
+		struct has_string_print<T, String,
+			std::void_t<decltype(std::declval<const T&>().print(std::declval<String&>()))>> : std::true_type {};
+
+		template<typename T, typename = void>
+		/// @brief Checks if 'T' has a 'to_view()' method returning a view of characters
+		struct has_char_view : std::false_type {};
+
+		template<typename T>
+		/// @brief Checks if 'T' has a 'to_view()' method returning a view of characters
+		struct has_char_view<T,
+			std::enable_if_t<std::is_convertible_v<decltype(std::declval<const T&>().to_view()), contiguous_struct_view<char>>>> : std::true_type {};
+
+		template<typename T, typename = void>
+		/// @brief Checks if 'T' has 'data()' returning characters and 'size()' (std::string...)
+		struct has_char_data : std::false_type {};
+
+		template<typename T>
+		/// @brief Checks if 'T' has 'data()' returning characters and 'size()' (std::string...)
+		struct has_char_data<T,
+			std::enable_if_t<std::is_convertible_v<decltype(std::declval<const T&>().data()), const char*>
+			&& std::is_convertible_v<decltype(std::declval<const T&>().size()), size_t>>> : std::true_type {};
+	}
+
+	template<typename String, typename T>
+	/// @brief Appends a value to a vale::string, without going through an ostream.
+	/// Integers and floating points are formatted by 'append_int', 'append_float' and 'append_double',
+	/// characters and strings are appended as is (like an ostream), bools as '1' or '0',
+	/// and types with a 'print(String&)' method (vale::array, vale::variant...) print themselves.
+	/// @tparam String The string type (vale::basic_string)
+	/// @tparam T The type of the value
+	/// @param out The string to append to
+	/// @param value The value to append
+	inline void append_value(String& out, const T& value)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+			out.push_back(value ? '1' : '0');
+		else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>)
+			out.push_back(static_cast<char>(value));
+		else if constexpr (std::is_integral_v<T>)
+			out.append_int(value);
+		else if constexpr (std::is_same_v<T, float>)
+			out.append_float(value);
+		else if constexpr (std::is_floating_point_v<T>)
+			out.append_double(static_cast<double>(value));
+		else if constexpr (std::is_convertible_v<const T&, const char*>)
+			out.append(static_cast<const char*>(value));
+		else if constexpr (details::has_char_view<T>::value)
+			out.append(contiguous_struct_view<char>(value.to_view()));
+		else if constexpr (details::has_string_print<T, String>::value)
+			value.print(out);
+		else if constexpr (details::has_char_data<T>::value)
+			out.append(contiguous_struct_view<char>(value.data(), value.size()));
+		else
+			static_assert(details::has_string_print<T, String>::value,
+				"append_value expects a number, a string, or a type with a 'print(String&)' method!");
+	}
+}
@@ -3,8 +3,19 @@
 #include <initializer_list>
 #include <iterator> // For iterator tags
 #include <cstddef>  // For std::ptrdiff_t
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <comppch.h>
 
+#ifdef _MSC_VER
+#include <intrin.h> // For _BitScanReverse64/_BitScanForward64
+#endif
+
 namespace vale
 {
 	/// @brief Thread safety policy which signifies to a struct to use its thread safe implementation
@@ -17,6 +28,14 @@ namespace vale
 	/// @brief Buffer policy which signifies to a struct to not use an optional buffer
 	struct NonOptionalBuffer {};
 
+	/// @brief Unlink policy which signifies to an intrusive hook to unlink itself from its list when destroyed
+	struct AutoUnlink {};
+	/// @brief Unlink policy which signifies to an intrusive hook to be unlinked through its list only
+	struct NonAutoUnlink {};
+
+	/// @brief The assumed size of a cache line, used to avoid false sharing between threads
+	static constexpr size_t cache_line_size = 64;
+
 	/// @brief Variant destructor policy, which signifies that the implementation should choose the complexity of the destructor
 	struct AutoComplexityDestruct {};
 	/// @brief Variant destructor policy, which signifies that the linear complexity destructor should be used
@@ -102,6 +121,39 @@ namespace vale
 		using search_for_type_of_size_in_pack_t = typename search_for_type_of_size_in_pack<size, First, Rest...>::type;
 	}
 
+	/******************************************
+	TRIVIAL RELOCATION
+	******************************************/
+
+	template<typename T>
+	/// @brief Trait which signifies that an object of type 'T' can be moved to another address
+	/// by copying its bytes, without calling its move constructor and destructor.
+	/// This is true for all trivially copyable types, and can be specialized for user types.
+	/// @tparam T The type to check for
+	struct is_trivially_relocatable
+		: std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+	template<typename T, typename Deleter>
+	/// @brief Overload for unique_ptr, which is relocatable if its deleter is
+	struct is_trivially_relocatable<std::unique_ptr<T, Deleter>>
+		: is_trivially_relocatable<Deleter> {};
+
+	template<typename T>
+	/// @brief Overload for shared_ptr, which is a pointer to the object and a pointer to the control block
+	struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+#ifdef _LIBCPP_VERSION
+	template<typename Char, typename Traits, typename Alloc>
+	/// @brief Overload for libc++'s strings, whose small buffer does not point to itself.
+	/// libstdc++'s strings store a pointer to their internal buffer: they are NOT trivially relocatable.
+	struct is_trivially_relocatable<std::basic_string<Char, Traits, Alloc>> : std::true_type {};
+#endif
+
+	template<typename T>
+	/// @brief Helper to check if a type is trivially relocatable
+	/// @tparam T The type to check for
+	static constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
 	namespace helpers
 	{
 		/******************************************
@@ -126,6 +178,50 @@ namespace vale
 		/// @tparam T The type to check for
 		static constexpr bool is_thread_safety_policy_v = is_thread_safety_policy<T>::value;
 
+		/******************************************
+		BUFFER POLICY
+		******************************************/
+
+		template<typename T>
+		/// @brief Helper struct to check if a type is [Non]OptionalBuffer
+		/// @tparam T The type to check for
+		struct is_buffer_policy { static constexpr bool value = false; };
+
+		template<>
+		/// @brief Overload for OptionalBuffer buffer policy
+		struct is_buffer_policy<OptionalBuffer> { static constexpr bool value = true; };
+
+		template<>
+		/// @brief Overload for NonOptionalBuffer buffer policy
+		struct is_buffer_policy<NonOptionalBuffer> { static constexpr bool value = true; };
+
+		template<typename T>
+		/// @brief helper type to help determine if a type is [Non]OptionalBuffer
+		/// @tparam T The type to check for
+		static constexpr bool is_buffer_policy_v = is_buffer_policy<T>::value;
+
+		/******************************************
+		UNLINK POLICY
+		******************************************/
+
+		template<typename T>
+		/// @brief Helper struct to check if a type is [Non]AutoUnlink
+		/// @tparam T The type to check for
+		struct is_unlink_policy { static constexpr bool value = false; };
+
+		template<>
+		/// @brief Overload for AutoUnlink unlink policy
+		struct is_unlink_policy<AutoUnlink> { static constexpr bool value = true; };
+
+		template<>
+		/// @brief Overload for NonAutoUnlink unlink policy
+		struct is_unlink_policy<NonAutoUnlink> { static constexpr bool value = true; };
+
+		template<typename T>
+		/// @brief helper type to help determine if a type is [Non]AutoUnlink
+		/// @tparam T The type to check for
+		static constexpr bool is_unlink_policy_v = is_unlink_policy<T>::value;
+
 		/******************************************
 		VARIANT DESTRUCTION POLICY
 		******************************************/
@@ -350,6 +446,118 @@ namespace vale
 		using get_type_of_max_size_t =
 			typename get_type_of_max_size<First, Rest...>::type;
 
+		/******************************************
+		BIT OPERATIONS
+		******************************************/
+
+		/// @brief Returns the index of the most significant bit set in 'value'
+		/// @param value The value, which should not be 0
+		/// @return floor(log2(value))
+		inline uint64_t floor_log2(uint64_t value) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return 63 - __builtin_clzll(value);
+#elif defined(_MSC_VER)
+			unsigned long index;
+			_BitScanReverse64(&index, value);
+			return index;
+#else
+			uint64_t index = 0;
+			while (value >>= 1)
+				++index;
+			return index;
+#endif
+		}
+
+		/// @brief Returns the index of the least significant bit set in 'value'
+		/// @param value The value, which should not be 0
+		/// @return The number of trailing 0 bits
+		inline uint64_t count_trailing_zeros(uint64_t value) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_ctzll(value);
+#elif defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward64(&index, value);
+			return index;
+#else
+			uint64_t index = 0;
+			while ((value & 1) == 0)
+			{
+				value >>= 1;
+				++index;
+			}
+			return index;
+#endif
+		}
+
+		/// @brief Returns the number of bits set in 'value'
+		/// @param value The value
+		/// @return The number of 1 bits
+		inline uint64_t popcount(uint64_t value) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_popcountll(value);
+#else
+			uint64_t count = 0;
+			for (; value != 0; value &= value - 1)
+				++count;
+			return count;
+#endif
+		}
+
+		/******************************************
+		PREFETCHING
+		******************************************/
+
+		/// @brief Hints the processor to load the cache line containing 'ptr' ahead of its use.
+		/// Never faults, so 'ptr' can be any address.
+		/// @param ptr The address to load
+		inline void prefetch(const void* ptr) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			__builtin_prefetch(ptr);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+			_mm_prefetch(static_cast<const char*>(ptr), _MM_HINT_T0);
+#else
+			(void)ptr;
+#endif
+		}
+
+		/******************************************
+		RELOCATION
+		******************************************/
+
+		template<typename T>
+		/// @brief Moves 'count' objects from 'from' to the uninitialized (or overlapping) 'to',
+		/// destroying the moved-from objects. Trivially relocatable objects are moved by a memmove.
+		/// @param to Where to move the objects
+		/// @param from The objects to move
+		/// @param count The number of objects to move
+		inline void relocate(T* to, T* from, size_t count) noexcept
+		{
+			if (count == 0 || to == from)
+				return;
+			if constexpr (is_trivially_relocatable_v<T>)
+				std::memmove(static_cast<void*>(to), static_cast<const void*>(from), count * sizeof(T));
+			else if (to < from)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					new(to + i) T(std::move(from[i]));
+					from[i].~T();
+				}
+			}
+			else
+			{
+				for (size_t i = count; i != 0; i--)
+				{
+					new(to + i - 1) T(std::move(from[i - 1]));
+					from[i - 1].~T();
+				}
+			}
+		}
+
 		/******************************************
 		SFINAE FOR MOVE AND COPY CONSTRUCTOR
 		******************************************/
@@ -420,9 +628,15 @@ namespace vale
 		constexpr contiguous_iterator(pointer ptr)
 			: ptr(ptr) {}
 
+		template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+		/// @brief Converts an iterator to an iterator to const
+		/// @param it The iterator to convert
+		constexpr contiguous_iterator(const contiguous_iterator<U>& it)
+			: ptr(it.ptr) {}
+
 		//OPERATOR
 		constexpr value_type& operator*() const { return *ptr; }
-		constexpr value_type& operator->() const { return *ptr; }
+		constexpr pointer operator->() const { return ptr; }
 		constexpr contiguous_iterator& operator++() { ptr++; return *this; }
 		constexpr contiguous_iterator operator++(int) { contiguous_iterator tmp = *this; ++(*this); return tmp; }
 		constexpr contiguous_iterator& operator--() { ptr--; return *this; }
@@ -430,8 +644,8 @@ namespace vale
 		constexpr contiguous_iterator operator+(difference_type val) { return ptr + val; }
 		constexpr contiguous_iterator operator-(difference_type val) { return ptr - val; }
 		constexpr difference_type operator-(const contiguous_iterator val) const { return ptr - val.ptr; }
-		constexpr contiguous_iterator& operator+=(difference_type val) { ptr += val; }
-		constexpr contiguous_iterator& operator-=(difference_type val) { ptr -= val; }
+		constexpr contiguous_iterator& operator+=(difference_type val) { ptr += val; return *this; }
+		constexpr contiguous_iterator& operator-=(difference_type val) { ptr -= val; return *this; }
 		//COMPARISONS
 		friend constexpr bool operator== (const contiguous_iterator& a, const contiguous_iterator& b) { return a.ptr == b.ptr; };
 		friend constexpr bool operator!= (const contiguous_iterator& a, const contiguous_iterator& b) { return a.ptr != b.ptr; };
@@ -442,6 +656,9 @@ namespace vale
 
 	private:
 		pointer ptr;
+
+		template<typename U>
+		friend struct contiguous_iterator;
 	};
 
 	template<typename T>
@@ -475,6 +692,11 @@ namespace vale
 			throw std::out_of_range("vale::contiguous_struct_view: Index was greater than size!");
 		}
 
+		/// @brief Constructs an empty view
+		constexpr contiguous_struct_view() noexcept
+			: ptr(nullptr), nb_elem(0)
+		{}
+
 		/// @brief Constructs a struct view with a pointer and a size
 		/// @param ptr Pointer to the beginning of the view
 		/// @param size Number of element pointed to by the view
@@ -597,9 +819,11 @@ namespace vale
 	std::ostream& operator<<(std::ostream& os, const contiguous_struct_view<T>& var)
 	{
 		os << "{";
-		for (size_t i = 0; i < var.size() - 1; i++)
+		for (size_t i = 0; i + 1 < var.size(); i++)
 			os << *(var.data() + i) << ", ";
-		os << *(var.data() + var.size() - 1) << '}';
+		if (!var.is_empty())
+			os << *(var.data() + var.size() - 1);
+		os << '}';
 		return os;
 	}
 }
\ No newline at end of file
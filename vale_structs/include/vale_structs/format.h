@@ -0,0 +1,400 @@
+/** @file format.h
+* @brief Header that contains the format functions.
+* A format string is made of literal characters and '{}' placeholders, each of which is
+* replaced by the next argument ('{{' and '}}' are replaced by '{' and '}').
+*
+* Format strings are created through the VALE_FORMAT macro, which wraps a string literal in a type:
+* the format string is validated and split into literal and argument segments at compile time,
+* and a mismatch between the number of placeholders and of arguments is a compilation error.
+* ```
+* vale::string line = vale::format(VALE_FORMAT("{} requests in {}s"), count, seconds);
+* ```
+*
+* The size of the result is computed before writing it, so that the destination is allocated
+* exactly once. Arguments are formatted through 'append_value' (see charconv.h): numbers,
+* characters, strings, and types with a 'print(String&)' method (vale::array, vale::variant...).
+*/
+
+#pragma once
+#include <vale_structs/string.h>
+#include <tuple>
+#include <utility>
+
+/// @brief Creates a format string, whose type is used to parse it at compile time
+/// @param str The string literal
+#define VALE_FORMAT(str) \
+	([]() noexcept { \
+		struct vale_format_string { \
+			static constexpr vale::string_view view() noexcept { return vale::string_view(str, sizeof(str) - 1); } \
+		}; \
+		return vale_format_string{}; \
+	}())
+
+namespace vale
+{
+	namespace details
+	{
+		/******************************************
+		PARSING
+		******************************************/
+
+		/// @brief A part of a format string: either literal characters, or a placeholder
+		struct format_segment
+		{
+			/// @brief The offset of the literal characters in the format string
+			size_t offset = 0;
+			/// @brief The number of literal characters
+			size_t size = 0;
+			/// @brief The index of the argument, or npos for literal characters
+			size_t argument = npos;
+		};
+
+		template<size_t count>
+		/// @brief The segments of a format string
+		/// @tparam count The number of segments
+		struct format_segments
+		{
+			/// @brief The segments, in order
+			format_segment segments[count == 0 ? 1 : count];
+			/// @brief The number of literal characters
+			size_t literal_size = 0;
+		};
+
+		/// @brief The result of the validation of a format string
+		struct format_summary
+		{
+			/// @brief True if all the braces are escaped or placeholders
+			bool is_valid = true;
+			/// @brief The number of segments
+			size_t segments = 0;
+			/// @brief The number of placeholders
+			size_t arguments = 0;
+		};
+
+		/// @brief Visits the segments of a format string, stopping at the first invalid brace
+		/// @param str The format string
+		/// @param visit Called with (offset, size, argument) for each segment
+		/// @return false if a brace is neither escaped nor part of a placeholder
+		template<typename Visitor>
+		constexpr bool visit_format_segments(string_view str, Visitor&& visit) noexcept
+		{
+			size_t begin = 0;
+			size_t arguments = 0;
+			for (size_t i = 0; i < str.size(); i++)
+			{
+				const char c = str.data()[i];
+				if (c != '{' && c != '}')
+					continue;
+				//Escaped braces end a literal segment after the first brace, and skip the second
+				if (i + 1 < str.size() && str.data()[i + 1] == c)
+				{
+					visit(begin, i + 1 - begin, npos);
+					begin = ++i + 1;
+					continue;
+				}
+				if (c == '}' || i + 1 == str.size() || str.data()[i + 1] != '}')
+					return false;
+				if (i != begin)
+					visit(begin, i - begin, npos);
+				visit(i, 0, arguments++);
+				begin = ++i + 1;
+			}
+			if (begin != str.size())
+				visit(begin, str.size() - begin, npos);
+			return true;
+		}
+
+		template<typename Format>
+		/// @brief Validates the format string of 'Format', and counts its segments
+		/// @tparam Format The type created by VALE_FORMAT
+		/// @return The summary of the format string
+		constexpr format_summary summarize_format() noexcept
+		{
+			format_summary summary;
+			summary.is_valid = visit_format_segments(Format::view(),
+				[&summary](size_t, size_t, size_t argument) {
+					++summary.segments;
+					summary.arguments += argument != npos;
+				});
+			return summary;
+		}
+
+		template<typename Format>
+		/// @brief The summary of the format string of 'Format', computed at compile time
+		inline constexpr format_summary format_summary_v = summarize_format<Format>();
+
+		template<typename Format>
+		/// @brief Splits the format string of 'Format' into segments
+		/// @tparam Format The type created by VALE_FORMAT
+		/// @return The segments
+		constexpr format_segments<format_summary_v<Format>.segments> parse_format() noexcept
+		{
+			format_segments<format_summary_v<Format>.segments> result{};
+			size_t index = 0;
+			visit_format_segments(Format::view(),
+				[&result, &index](size_t offset, size_t size, size_t argument) {
+					result.segments[index++] = format_segment{ offset, size, argument };
+					result.literal_size += size;
+				});
+			return result;
+		}
+
+		template<typename Format>
+		/// @brief The segments of the format string of 'Format', computed at compile time
+		inline constexpr auto format_segments_v = parse_format<Format>();
+
+		/******************************************
+		SINKS
+		******************************************/
+
+		/// @brief String-like type which only counts the characters appended to it,
+		/// used to compute the size of formatted arguments
+		struct counting_sink
+		{
+			/// @brief The number of characters appended
+			size_t count = 0;
+
+			void push_back(char) noexcept { ++count; }
+			counting_sink& append(string_view view) noexcept { count += view.size(); return *this; }
+			counting_sink& append(const char* str) noexcept { count += std::strlen(str); return *this; }
+
+			template<typename Int>
+			counting_sink& append_int(Int value) noexcept
+			{
+				char buffer[max_int_chars];
+				count += vale::write_int(buffer, value) - buffer;
+				return *this;
+			}
+
+			counting_sink& append_double(double value) noexcept
+			{
+				char buffer[max_double_chars];
+				count += vale::write_double(buffer, value) - buffer;
+				return *this;
+			}
+
+			counting_sink& append_float(float value) noexcept
+			{
+				char buffer[max_float_chars];
+				count += vale::write_float(buffer, value) - buffer;
+				return *this;
+			}
+		};
+
+		/// @brief String-like type which writes the characters appended to it to a buffer,
+		/// whose size should have been checked beforehand
+		struct buffer_sink
+		{
+			/// @brief Pointer past the last character written
+			char* ptr;
+
+			void push_back(char c) noexcept { *ptr++ = c; }
+			buffer_sink& append(string_view view) noexcept
+			{
+				std::memcpy(ptr, view.data(), view.size());
+				ptr += view.size();
+				return *this;
+			}
+			buffer_sink& append(const char* str) noexcept { return append(vale::to_view(str)); }
+
+			template<typename Int>
+			buffer_sink& append_int(Int value) noexcept { ptr = vale::write_int(ptr, value); return *this; }
+			buffer_sink& append_double(double value) noexcept { ptr = vale::write_double(ptr, value); return *this; }
+			buffer_sink& append_float(float value) noexcept { ptr = vale::write_float(ptr, value); return *this; }
+		};
+
+		/******************************************
+		ARGUMENTS
+		******************************************/
+
+		template<typename T, typename = void>
+		/// @brief An argument whose size is computed by formatting it to a counting_sink
+		/// @tparam T The type of the argument
+		struct format_argument
+		{
+			/// @brief The argument
+			const T& value;
+
+			explicit format_argument(const T& value) noexcept : value(value) {}
+
+			size_t size() const
+			{
+				counting_sink sink;
+				vale::append_value(sink, value);
+				return sink.count;
+			}
+
+			void write(buffer_sink& out) const { vale::append_value(out, value); }
+		};
+
+		template<typename T>
+		/// @brief An integer argument, whose size is the number of digits
+		/// @tparam T The integer type
+		struct format_argument<T, std::enable_if_t<std::is_integral_v<T>
+			&& !std::is_same_v<T, bool> && !std::is_same_v<T, char>
+			&& !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char>>>
+		{
+			/// @brief The argument
+			T value;
+
+			explicit format_argument(T value) noexcept : value(value) {}
+
+			size_t size() const noexcept
+			{
+				const uint64_t magnitude = std::is_signed_v<T> && value < 0
+					? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+				return decimal_length(magnitude) + (std::is_signed_v<T> && value < 0);
+			}
+
+			void write(buffer_sink& out) const noexcept { out.append_int(value); }
+		};
+
+		template<typename T>
+		/// @brief A floating point argument, which is formatted once to compute its size
+		/// @tparam T The floating point type
+		struct format_argument<T, std::enable_if_t<std::is_floating_point_v<T>>>
+		{
+			/// @brief The formatted characters
+			char chars[max_double_chars];
+			/// @brief The number of formatted characters
+			size_t length;
+
+			explicit format_argument(T value) noexcept
+			{
+				if constexpr (std::is_same_v<T, float>)
+					length = static_cast<size_t>(vale::write_float(chars, value) - chars);
+				else
+					length = static_cast<size_t>(vale::write_double(chars, static_cast<double>(value)) - chars);
+			}
+
+			size_t size() const noexcept { return length; }
+
+			void write(buffer_sink& out) const noexcept { out.append(string_view(chars, length)); }
+		};
+
+		template<typename Format, size_t... Is, typename... Arguments>
+		/// @brief Writes the segments of the format string, replacing placeholders by the arguments
+		/// @param out The sink to write to, which should have enough space
+		/// @param arguments The prepared arguments
+		inline void write_format(buffer_sink& out, std::index_sequence<Is...>, const std::tuple<Arguments...>& arguments)
+		{
+			[[maybe_unused]] const char* const str = Format::view().data();
+			[[maybe_unused]] const auto write_segment = [&](auto index) {
+				constexpr format_segment segment = format_segments_v<Format>.segments[decltype(index)::value];
+				if constexpr (segment.argument == npos)
+					out.append(string_view(str + segment.offset, segment.size));
+				else
+					std::get<segment.argument>(arguments).write(out);
+			};
+			(write_segment(std::integral_constant<size_t, Is>{}), ...);
+		}
+
+		template<typename Format, typename... Args>
+		/// @brief Checks the format string and the number of arguments at compile time
+		constexpr void check_format() noexcept
+		{
+			static_assert(format_summary_v<Format>.is_valid,
+				"vale::format: '{' and '}' should be escaped as '{{' and '}}', or form a '{}' placeholder!");
+			static_assert(format_summary_v<Format>.arguments == sizeof...(Args),
+				"vale::format: the number of '{}' placeholders differs from the number of arguments!");
+		}
+
+		template<typename Format, typename... Arguments>
+		/// @brief Returns the size of the formatted string
+		/// @param arguments The prepared arguments
+		inline size_t formatted_size(const std::tuple<Arguments...>& arguments)
+		{
+			return std::apply([](const auto&... argument) {
+				return (format_segments_v<Format>.literal_size + ... + argument.size());
+			}, arguments);
+		}
+
+		template<typename Format, typename... Arguments>
+		/// @brief Writes the formatted string to a buffer large enough for it
+		/// @param buffer The buffer to write to
+		/// @param arguments The prepared arguments
+		/// @return Pointer past the last character written
+		inline char* write_formatted(char* buffer, const std::tuple<Arguments...>& arguments)
+		{
+			buffer_sink out{ buffer };
+			write_format<Format>(out, std::make_index_sequence<format_summary_v<Format>.segments>{}, arguments);
+			return out.ptr;
+		}
+
+		template<typename... Args>
+		/// @brief Prepares the arguments: numbers are converted, others are referenced
+		/// @param args The arguments
+		/// @return The prepared arguments
+		inline auto prepare_arguments(const Args&... args)
+		{
+			return std::tuple<format_argument<Args>...>(format_argument<Args>(args)...);
+		}
+	}
+
+	template<typename Format, typename... Args>
+	/// @brief Returns the number of characters of the formatted string
+	/// @tparam Format The type created by VALE_FORMAT
+	/// @param args The arguments replacing the placeholders
+	/// @return The number of characters
+	inline size_t formatted_size(Format, const Args&... args)
+	{
+		details::check_format<Format, Args...>();
+		return details::formatted_size<Format>(details::prepare_arguments(args...));
+	}
+
+	template<typename Format, typename String, typename... Args>
+	/// @brief Appends the formatted string to 'out', growing it at most once (through its Growth policy,
+	/// so that repeated appends to the same string are amortized)
+	/// @tparam Format The type created by VALE_FORMAT
+	/// @tparam String The string type (vale::basic_string)
+	/// @param out The string to append to
+	/// @param args The arguments replacing the placeholders
+	/// @return out
+	inline String& format_append(String& out, Format, const Args&... args)
+	{
+		details::check_format<Format, Args...>();
+		const auto arguments = details::prepare_arguments(args...);
+		const size_t old_size = out.size();
+		//resize() grows the string at most once, through its Growth policy: the characters are then overwritten
+		out.resize(old_size + details::formatted_size<Format>(arguments));
+		details::write_formatted<Format>(out.data() + old_size, arguments);
+		return out;
+	}
+
+	template<typename Format, typename... Args>
+	/// @brief Returns the formatted string, which is allocated at most once
+	/// @tparam Format The type created by VALE_FORMAT
+	/// @param args The arguments replacing the placeholders
+	/// @return The formatted string
+	inline string format(Format, const Args&... args)
+	{
+		details::check_format<Format, Args...>();
+		const auto arguments = details::prepare_arguments(args...);
+		const size_t size = details::formatted_size<Format>(arguments);
+		//A new string is allocated with the exact size, rather than grown
+		string result;
+		result.reserve(size);
+		result.resize(size);
+		details::write_formatted<Format>(result.data(), arguments);
+		return result;
+	}
+
+	template<typename Format, typename... Args>
+	/// @brief Writes the formatted string to a buffer, or throws if the buffer is too small.
+	/// No null terminator is written.
+	/// @tparam Format The type created by VALE_FORMAT
+	/// @param buffer The buffer to write to
+	/// @param size The size of the buffer
+	/// @param args The arguments replacing the placeholders
+	/// @return The number of characters written
+	inline size_t format_to(char* buffer, size_t size, Format, const Args&... args)
+	{
+		details::check_format<Format, Args...>();
+		const auto arguments = details::prepare_arguments(args...);
+		const size_t required = details::formatted_size<Format>(arguments);
+		if (required > size)
+			throw std::length_error("vale::format_to: formatted size was greater than size!");
+		details::write_formatted<Format>(buffer, arguments);
+		return required;
+	}
+}
@@ -0,0 +1,2262 @@
+/** @file list.h
+* @brief Header that contains the list classes.
+* An intrusive list does not own its objects: it links them through a 'list_hook' member
+* embedded in the objects, so adding an object to a list never allocates, and an object can be
+* unlinked in O(1) from any position. An object can be in as many lists at once as it has hooks:
+* ```
+* struct task
+* {
+*     list_hook<> ready_hook;
+*     list_hook<> timer_hook;
+* };
+* intrusive_list<task, &task::ready_hook> ready;
+* intrusive_list<task, &task::timer_hook> timers;
+* ```
+* The objects must outlive the lists they are in, unless their hooks are 'list_hook<AutoUnlink>',
+* which unlink themselves when destroyed (the size of their lists is then computed in O(n)).
+*
+* A 'list' owns its objects, and allocates its nodes from slabs (blocks of contiguous nodes)
+* rather than one at a time: nodes are contiguous in the order in which they were allocated,
+* and 'compact()' moves the objects so that they are contiguous in the order of the list,
+* after which traversing the list reads memory sequentially.
+*
+* An 'unrolled_list' links blocks of up to 'node_capacity' contiguous objects rather than single objects:
+* it is scanned almost as fast as an array, while inserting or erasing in the middle only moves
+* the objects of one block. Each block can be viewed as a contiguous_struct_view through 'blocks()'.
+*
+* A 'lock_free_stack' is a Treiber stack of objects linked through a 'stack_hook' member, whose top is a tagged pointer
+* to prevent the ABA problem. A 'freelist' builds on it to recycle the memory of objects between threads without locks.
+*
+* The intrusive list and the list are overloaded for ThreadSafe, and NonThreadSafe thread safety policy.
+* Like a 'ts_static_vector', a thread safe intrusive list 'ts_intrusive_list' (or list 'ts_list') does not provide an iterator interface,
+* but rather provides helpful methods to manipulate the list's content in a thread safe way.
+*/
+
+#pragma once
+#include <vale_structs/vector.h>
+#include <type_traits>
+#include <stdexcept>
+#include <ostream>
+#include <utility>
+#include <mutex>
+#include <new>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <cassert>
+
+namespace vale
+{
+	/******************************************
+	INTRUSIVE LIST
+	******************************************/
+
+	/// @brief Unspecialized intrusive list which defaults to a NonThreadSafe.
+	/// Reports an error if ThreadSafety is not a thread safety policy: [Non]ThreadSafe.
+	/// @tparam T The type of the objects to link
+	/// @tparam Hook Pointer to the list_hook member of T used by the list
+	/// @tparam ThreadSafety The thread safety policy of the list
+	template<typename T, auto Hook, typename ThreadSafety = NonThreadSafe>
+	class intrusive_list { static_assert(helpers::is_thread_safety_policy_v<ThreadSafety>, "ThreadSafety can only be [Non]ThreadSafe"); };
+
+	template<typename UnlinkPolicy = NonAutoUnlink>
+	/// @brief The links embedded in an object to put it in an intrusive_list.
+	/// Copying an object does not copy the links of its hooks: the copy is not linked.
+	/// @tparam UnlinkPolicy AutoUnlink to unlink the hook from its list when it is destroyed
+	class list_hook
+	{
+		static_assert(helpers::is_unlink_policy_v<UnlinkPolicy>, "UnlinkPolicy can only be [Non]AutoUnlink");
+
+		template<typename, auto, typename>
+		friend class intrusive_list;
+
+		/// @brief The previous hook in the list, or nullptr if the hook is not linked
+		list_hook* prev = nullptr;
+		/// @brief The next hook in the list, or nullptr if the hook is not linked
+		list_hook* next = nullptr;
+
+		/// @brief Links the hook before 'position'
+		/// @param position The hook which follows the hook once linked
+		void link_before(list_hook* position) noexcept
+		{
+			prev = position->prev;
+			next = position;
+			prev->next = this;
+			position->prev = this;
+		}
+
+		/// @brief Removes the hook from its list, if it is linked
+		void unlink_hook() noexcept
+		{
+			if (next == nullptr)
+				return;
+			prev->next = next;
+			next->prev = prev;
+			prev = nullptr;
+			next = nullptr;
+		}
+
+	public:
+		/// @brief True if the hook unlinks itself when destroyed
+		static constexpr bool is_auto_unlink = std::is_same_v<UnlinkPolicy, AutoUnlink>;
+
+		/// @brief Constructs a hook which is not linked
+		list_hook() noexcept = default;
+
+		/// @brief Constructs a hook which is not linked: links are not copied
+		list_hook(const list_hook&) noexcept {}
+
+		/// @brief Does nothing: links are not copied
+		/// @return *this
+		list_hook& operator=(const list_hook&) noexcept { return *this; }
+
+		/// @brief Unlinks the hook from its list if it is an AutoUnlink hook
+		~list_hook() noexcept
+		{
+			if constexpr (is_auto_unlink)
+				unlink_hook();
+		}
+
+		/// @brief Check if the hook is in a list
+		/// @return True if the hook is linked
+		[[nodiscard]] bool is_linked() const noexcept { return next != nullptr; }
+
+		/// @brief Removes the hook from its list in O(1), if it is linked.
+		/// Only AutoUnlink hooks can be unlinked without their list, as the lists of NonAutoUnlink hooks count their objects.
+		void unlink() noexcept
+		{
+			static_assert(is_auto_unlink, "Only list_hook<AutoUnlink> can be unlinked without their list: use intrusive_list::erase()!");
+			unlink_hook();
+		}
+	};
+
+	namespace details
+	{
+		template<typename MemberPointer>
+		/// @brief Unspecialized helper, for types which are not pointers to data members
+		struct member_hook_traits { static constexpr bool value = false; };
+
+		template<typename T, typename UnlinkPolicy>
+		/// @brief Helper which extracts the type of the objects and hooks of a pointer to a list_hook member
+		struct member_hook_traits<list_hook<UnlinkPolicy> T::*>
+		{
+			static constexpr bool value = true;
+			using object = T;
+			using hook = list_hook<UnlinkPolicy>;
+		};
+	}
+
+	template<typename T, auto Hook>
+	/// @brief A non-thread safe doubly linked list of objects which are linked through their 'Hook' member.
+	/// The list does not own its objects, and never allocates.
+	/// @tparam T The type of the objects to link
+	/// @tparam Hook Pointer to the list_hook member of T used by the list
+	class intrusive_list<T, Hook, NonThreadSafe>
+	{
+		static_assert(details::member_hook_traits<decltype(Hook)>::value, "Hook should be a pointer to a list_hook member!");
+		static_assert(std::is_same_v<typename details::member_hook_traits<decltype(Hook)>::object, T>,
+			"Hook should be a pointer to a list_hook member of T!");
+
+		using hook_type = typename details::member_hook_traits<decltype(Hook)>::hook;
+
+		/// @brief True if the hooks can unlink themselves, in which case the objects are not counted
+		static constexpr bool is_auto_unlink = hook_type::is_auto_unlink;
+
+		/// @brief The sentinel of the circular list: its next hook is the first object, its previous hook the last one
+		hook_type head;
+		/// @brief The number of objects (unused for AutoUnlink hooks)
+		size_t nb_elem = 0;
+
+		/// @brief Returns the offset of the hook inside of the objects
+		static std::ptrdiff_t hook_offset() noexcept
+		{
+			//The member pointer is applied to a dummy (aligned and non-null) address which is never dereferenced
+			const T* dummy = reinterpret_cast<const T*>(static_cast<uintptr_t>(alignof(T) * 64));
+			return reinterpret_cast<const char*>(&(dummy->*Hook)) - reinterpret_cast<const char*>(dummy);
+		}
+
+		/// @brief Returns the object containing a hook
+		static T& object_of(hook_type* hook) noexcept
+		{
+			return *reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - hook_offset());
+		}
+
+		/// @brief Returns the hook of an object
+		static hook_type* hook_of(const T& object) noexcept
+		{
+			return const_cast<hook_type*>(&(object.*Hook));
+		}
+
+		/// @brief Makes the sentinel point to itself
+		void reset() noexcept
+		{
+			head.prev = &head;
+			head.next = &head;
+			nb_elem = 0;
+		}
+
+		/// @brief Takes the objects of another list, leaving it empty
+		void steal(intrusive_list& other) noexcept
+		{
+			if (other.is_empty())
+				return;
+			head.next = other.head.next;
+			head.prev = other.head.prev;
+			head.next->prev = &head;
+			head.prev->next = &head;
+			nb_elem = other.nb_elem;
+			other.reset();
+		}
+
+	public:
+		template<bool is_const>
+		/// @brief Bidirectional iterator over the objects of the list
+		class basic_iterator
+		{
+			friend class intrusive_list;
+
+			/// @brief The hook of the current object, or the sentinel for the end iterator
+			hook_type* current = nullptr;
+
+			explicit basic_iterator(hook_type* current) noexcept : current(current) {}
+
+		public:
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<is_const, const T*, T*>;
+			using reference = std::conditional_t<is_const, const T&, T&>;
+
+			basic_iterator() noexcept = default;
+			/// @brief Converts an iterator to a const iterator
+			template<bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+			basic_iterator(const basic_iterator<other_const>& other) noexcept : current(other.current) {}
+
+			reference operator*() const noexcept { return object_of(current); }
+			pointer operator->() const noexcept { return &object_of(current); }
+
+			basic_iterator& operator++() noexcept { current = current->next; return *this; }
+			basic_iterator operator++(int) noexcept { basic_iterator copy = *this; current = current->next; return copy; }
+			basic_iterator& operator--() noexcept { current = current->prev; return *this; }
+			basic_iterator operator--(int) noexcept { basic_iterator copy = *this; current = current->prev; return copy; }
+
+			friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept { return a.current == b.current; }
+			friend bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept { return a.current != b.current; }
+
+			template<bool>
+			friend class basic_iterator;
+		};
+
+		/// @brief Helper alias for iterators
+		using iterator = basic_iterator<false>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = basic_iterator<true>;
+
+		/******************************************
+		CONSTRUCTORS AND DESTRUCTOR
+		******************************************/
+
+		/// @brief Constructs an empty list
+		intrusive_list() noexcept { reset(); }
+
+		/// @brief Lists cannot be copied, as an object can only be linked once through a hook
+		intrusive_list(const intrusive_list&) = delete;
+		/// @brief Lists cannot be copied, as an object can only be linked once through a hook
+		intrusive_list& operator=(const intrusive_list&) = delete;
+
+		/// @brief Move constructor, which takes the objects of 'to_move' in O(1)
+		/// @param to_move The list to move, which becomes empty
+		intrusive_list(intrusive_list&& to_move) noexcept
+		{
+			reset();
+			steal(to_move);
+		}
+
+		/// @brief Move assignment operator, which unlinks the objects of the list
+		/// and takes the objects of 'to_move'
+		/// @param to_move The list to move, which becomes empty
+		/// @return *this
+		intrusive_list& operator=(intrusive_list&& to_move) noexcept
+		{
+			if (this != &to_move)
+			{
+				clear();
+				steal(to_move);
+			}
+			return *this;
+		}
+
+		/// @brief Unlinks the objects of the list (which are not destroyed)
+		~intrusive_list() noexcept
+		{
+			clear();
+			//The sentinel of an AutoUnlink list should not unlink itself
+			head.prev = nullptr;
+			head.next = nullptr;
+		}
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the number of objects in the list: O(1), or O(n) for AutoUnlink hooks
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept
+		{
+			if constexpr (is_auto_unlink)
+				return static_cast<size_t>(std::distance(begin(), end()));
+			else
+				return nb_elem;
+		}
+
+		/// @brief Check if the list is empty (contains 0 objects)
+		/// @return true if the list is empty
+		[[nodiscard]] bool is_empty() const noexcept { return head.next == &head; }
+
+		/// @brief Returns the first object, or throws if the list is empty
+		/// @return reference to the first object
+		[[nodiscard]] T& front()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::intrusive_list: list was empty!");
+			return object_of(head.next);
+		}
+
+		/// @brief Returns the first object, or throws if the list is empty
+		/// @return const reference to the first object
+		[[nodiscard]] const T& front() const
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::intrusive_list: list was empty!");
+			return object_of(head.next);
+		}
+
+		/// @brief Returns the last object, or throws if the list is empty
+		/// @return reference to the last object
+		[[nodiscard]] T& back()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::intrusive_list: list was empty!");
+			return object_of(head.prev);
+		}
+
+		/// @brief Returns the last object, or throws if the list is empty
+		/// @return const reference to the last object
+		[[nodiscard]] const T& back() const
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::intrusive_list: list was empty!");
+			return object_of(head.prev);
+		}
+
+		/// @brief Check if an object is linked through the hook of the list (in this list or another one)
+		/// @param object The object to check for
+		/// @return True if the hook of the object is linked
+		[[nodiscard]] static bool is_linked(const T& object) noexcept { return hook_of(object)->is_linked(); }
+
+		/******************************************
+		ITERATORS
+		******************************************/
+
+		/// @brief Returns an iterator to a linked object, in O(1)
+		/// @param object The object, which should be in the list
+		/// @return iterator to 'object'
+		[[nodiscard]] static iterator iterator_to(T& object) noexcept { return iterator(hook_of(object)); }
+		/// @brief Returns an iterator to a linked object, in O(1)
+		/// @param object The object, which should be in the list
+		/// @return const iterator to 'object'
+		[[nodiscard]] static const_iterator iterator_to(const T& object) noexcept { return const_iterator(hook_of(object)); }
+
+		[[nodiscard]] iterator begin() noexcept { return iterator(head.next); }
+		[[nodiscard]] iterator end() noexcept { return iterator(&head); }
+		[[nodiscard]] const_iterator begin() const noexcept { return const_iterator(const_cast<hook_type*>(head.next)); }
+		[[nodiscard]] const_iterator end() const noexcept { return const_iterator(const_cast<hook_type*>(&head)); }
+		[[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+		[[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		/// @brief Links an object at the beginning of the list.
+		/// Throws std::invalid_argument if the object is already linked through the hook.
+		/// @param object The object to link
+		void push_front(T& object) { insert(begin(), object); }
+
+		/// @brief Links an object at the end of the list.
+		/// Throws std::invalid_argument if the object is already linked through the hook.
+		/// @param object The object to link
+		void push_back(T& object) { insert(end(), object); }
+
+		/// @brief Links an object before 'pos'.
+		/// Throws std::invalid_argument if the object is already linked through the hook.
+		/// @param pos The iterator to the object which follows 'object' once linked
+		/// @param object The object to link
+		/// @return iterator to 'object'
+		iterator insert(const_iterator pos, T& object)
+		{
+			hook_type* hook = hook_of(object);
+			if (hook->is_linked())
+				throw std::invalid_argument("vale::intrusive_list: object was already linked!");
+			hook->link_before(pos.current);
+			++nb_elem;
+			return iterator(hook);
+		}
+
+		/// @brief Unlinks the first object, or throws if the list is empty
+		/// @return reference to the unlinked object
+		T& pop_front()
+		{
+			T& object = front();
+			head.next->unlink_hook();
+			--nb_elem;
+			return object;
+		}
+
+		/// @brief Unlinks the last object, or throws if the list is empty
+		/// @return reference to the unlinked object
+		T& pop_back()
+		{
+			T& object = back();
+			head.prev->unlink_hook();
+			--nb_elem;
+			return object;
+		}
+
+		/// @brief Unlinks an object from the list, in O(1).
+		/// Throws std::invalid_argument if the object is not linked through the hook.
+		/// @param object The object to unlink, which should be in the list
+		/// @return iterator following the unlinked object
+		iterator erase(T& object)
+		{
+			hook_type* hook = hook_of(object);
+			if (!hook->is_linked())
+				throw std::invalid_argument("vale::intrusive_list: object was not linked!");
+			hook_type* next = hook->next;
+			hook->unlink_hook();
+			--nb_elem;
+			return iterator(next);
+		}
+
+		/// @brief Unlinks the object pointed to by 'pos', in O(1)
+		/// @param pos The iterator to the object to unlink
+		/// @return iterator following the unlinked object
+		iterator erase(const_iterator pos) { return erase(object_of(pos.current)); }
+
+		/// @brief Moves all the objects of 'other' at the end of the list, in O(1)
+		/// @param other The list whose objects to move, which becomes empty
+		void splice_back(intrusive_list& other) noexcept
+		{
+			if (this == &other || other.is_empty())
+				return;
+			hook_type* first = other.head.next;
+			hook_type* last = other.head.prev;
+			first->prev = head.prev;
+			head.prev->next = first;
+			last->next = &head;
+			head.prev = last;
+			nb_elem += other.nb_elem;
+			other.reset();
+		}
+
+		/// @brief Unlinks all the objects (which are not destroyed), in O(n)
+		void clear() noexcept
+		{
+			for (hook_type* hook = head.next; hook != &head;)
+			{
+				hook_type* next = hook->next;
+				hook->prev = nullptr;
+				hook->next = nullptr;
+				hook = next;
+			}
+			reset();
+		}
+
+		/// @brief Prints the content of the list in 'os'
+		/// @param os The ostream in which to << the list's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (auto it = begin(); it != end(); ++it)
+			{
+				if (it != begin())
+					os << ", ";
+				os << *it;
+			}
+			os << '}';
+		}
+	};
+
+	template<typename T, auto Hook>
+	/// @brief A thread safe intrusive list which provides helpful methods when working concurrently.
+	/// Does not possess iterators to avoid false usages.
+	/// All methods lock the mutex protecting the links.
+	/// @tparam T The type of the objects to link
+	/// @tparam Hook Pointer to the list_hook member of T used by the list
+	class intrusive_list<T, Hook, ThreadSafe>
+	{
+		static_assert(!details::member_hook_traits<decltype(Hook)>::hook::is_auto_unlink,
+			"A ThreadSafe intrusive list cannot use list_hook<AutoUnlink>, as hooks would unlink themselves without locking!");
+
+		/// @brief The links
+		intrusive_list<T, Hook, NonThreadSafe> list;
+		/// @brief The mutex which protects the links
+		mutable std::mutex mutex{};
+
+	public:
+		/// @brief Constructs an empty list
+		intrusive_list() noexcept = default;
+
+		/// @brief Returns the number of objects in the list
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept
+		{
+			std::scoped_lock lock{ mutex };
+			return list.size();
+		}
+
+		/// @brief Check if the list is empty (contains 0 objects)
+		/// @return true if the list is empty
+		[[nodiscard]] bool is_empty() const noexcept
+		{
+			std::scoped_lock lock{ mutex };
+			return list.is_empty();
+		}
+
+		/// @brief Links an object at the beginning of the list.
+		/// Throws std::invalid_argument if the object is already linked through the hook.
+		/// @param object The object to link
+		void push_front(T& object)
+		{
+			std::scoped_lock lock{ mutex };
+			list.push_front(object);
+		}
+
+		/// @brief Links an object at the end of the list.
+		/// Throws std::invalid_argument if the object is already linked through the hook.
+		/// @param object The object to link
+		void push_back(T& object)
+		{
+			std::scoped_lock lock{ mutex };
+			list.push_back(object);
+		}
+
+		/// @brief Unlinks the first object, if the list is not empty
+		/// @return pointer to the unlinked object, or nullptr if the list was empty
+		[[nodiscard]] T* try_pop_front() noexcept
+		{
+			std::scoped_lock lock{ mutex };
+			return list.is_empty() ? nullptr : &list.pop_front();
+		}
+
+		/// @brief Unlinks the last object, if the list is not empty
+		/// @return pointer to the unlinked object, or nullptr if the list was empty
+		[[nodiscard]] T* try_pop_back() noexcept
+		{
+			std::scoped_lock lock{ mutex };
+			return list.is_empty() ? nullptr : &list.pop_back();
+		}
+
+		/// @brief Unlinks an object from the list, in O(1).
+		/// Throws std::invalid_argument if the object is not linked through the hook.
+		/// @param object The object to unlink, which should be in the list
+		void erase(T& object)
+		{
+			std::scoped_lock lock{ mutex };
+			list.erase(object);
+		}
+
+		/// @brief Unlinks all the objects (which are not destroyed)
+		void clear() noexcept
+		{
+			std::scoped_lock lock{ mutex };
+			list.clear();
+		}
+
+		/// @brief Call a functor with each of the object in the list
+		/// @param func The functor to which a reference of each object is passed
+		template<typename Func>
+		void for_each(Func func)
+		{
+			std::scoped_lock lock{ mutex };
+			for (T& object : list)
+				func(object);
+		}
+
+		/// @brief Passes begin and end iterators followed by an argument pack to a function, and returns the result of the function.
+		/// This method can be used to thread-safely access iterators of the list.
+		/// @tparam Func Type of the function to which to pass the iterators followed by the argument pack
+		/// @tparam ...Args Parameter pack
+		/// @param function The function to which to pass the iterators followed by the argument pack
+		/// @param ...args Argument pack forwarded to 'function' after iterators
+		/// @return What is returned by the 'function'
+		template<typename Func, typename... Args>
+		auto pass_iterators(Func function, Args&&... args)
+		{
+			std::scoped_lock lock{ mutex };
+			return function(list.begin(), list.end(), std::forward<Args>(args)...);
+		}
+
+		/// @brief Prints the content of the list in 'os'
+		/// @param os The ostream in which to << the list's content
+		inline void print(std::ostream& os) const
+		{
+			std::scoped_lock lock{ mutex };
+			list.print(os);
+		}
+	};
+
+	template<typename T, auto Hook>
+	/// @brief Thread safe intrusive list typedef
+	using ts_intrusive_list = intrusive_list<T, Hook, ThreadSafe>;
+
+	template<typename T, auto Hook, typename ThreadSafety>
+	/// @brief writes the content of the list between '{}', separating the objects by ','.
+	/// Will lock the mutex of the list if its thread safety policy is ThreadSafe.
+	static std::ostream& operator<<(std::ostream& os, const intrusive_list<T, Hook, ThreadSafety>& var)
+	{
+		var.print(os);
+		return os;
+	}
+
+	/******************************************
+	LIST
+	******************************************/
+
+	namespace details
+	{
+		/// @brief The links of a node of a list, which are also the sentinel of the list
+		struct list_links
+		{
+			/// @brief The previous node (or the sentinel)
+			list_links* prev;
+			/// @brief The next node (or the sentinel), or the next free node for nodes which are not used
+			list_links* next;
+		};
+
+		template<typename T>
+		/// @brief A node of a list, whose object is constructed when the node is used
+		/// @tparam T The type of the object
+		struct list_node : list_links
+		{
+			/// @brief The storage of the object
+			alignas(T) unsigned char storage[sizeof(T)];
+
+			T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+			const T* value() const noexcept { return std::launder(reinterpret_cast<const T*>(storage)); }
+		};
+	}
+
+	/// @brief Unspecialized list which defaults to a NonThreadSafe.
+	/// Reports an error if ThreadSafety is not a thread safety policy: [Non]ThreadSafe.
+	/// @tparam T The type of the objects to store
+	/// @tparam Allocator The allocator policy used for the slabs of nodes
+	/// @tparam ThreadSafety The thread safety policy of the list
+	template<typename T, typename Allocator = heap_allocator, typename ThreadSafety = NonThreadSafe>
+	class list { static_assert(helpers::is_thread_safety_policy_v<ThreadSafety>, "ThreadSafety can only be [Non]ThreadSafe"); };
+
+	template<typename T, typename Allocator>
+	/// @brief A non-thread safe doubly linked list, whose nodes are allocated from slabs owned by the list.
+	/// Nodes are contiguous in the order in which they were allocated, and erased nodes are reused
+	/// by the next insertions. compact() moves the objects so that nodes are contiguous in the order of the list.
+	/// @tparam T The type of the objects to store
+	/// @tparam Allocator The allocator policy used for the slabs of nodes
+	class list<T, Allocator, NonThreadSafe>
+	{
+		static_assert(std::is_nothrow_destructible_v<T>, "vale::list requires a noexcept destructor!");
+
+		using links = details::list_links;
+		using node = details::list_node<T>;
+
+		/// @brief The number of nodes of the first slab
+		static constexpr size_t min_slab_nodes = std::max<size_t>(4096 / sizeof(node), 4);
+		/// @brief The maximum number of nodes of a slab allocated when growing (slabs of 1 MB)
+		static constexpr size_t max_slab_nodes = std::max<size_t>((size_t(1) << 20) / sizeof(node), min_slab_nodes);
+
+		/// @brief A block of contiguous nodes
+		struct slab
+		{
+			/// @brief The nodes
+			node* nodes;
+			/// @brief The number of nodes
+			size_t count;
+		};
+
+		/// @brief The sentinel of the circular list: its next node is the first node, its previous node the last one
+		links head;
+		/// @brief The number of objects
+		size_t nb_elem = 0;
+		/// @brief The slabs of nodes, in the order in which they were allocated
+		vale::vector<slab> slabs;
+		/// @brief The number of nodes of the last slab which were never used
+		size_t nb_untouched = 0;
+		/// @brief The erased nodes, linked through their 'next' links
+		links* free_nodes = nullptr;
+
+		static node* as_node(links* ptr) noexcept { return static_cast<node*>(ptr); }
+		static const node* as_node(const links* ptr) noexcept { return static_cast<const node*>(ptr); }
+
+	public:
+		template<bool is_const>
+		/// @brief Bidirectional iterator over the objects of the list.
+		/// Advancing the iterator prefetches the node following the new current node.
+		class basic_iterator
+		{
+			friend class list;
+
+			/// @brief The current node, or the sentinel for the end iterator
+			links* current = nullptr;
+
+			explicit basic_iterator(const links* current) noexcept : current(const_cast<links*>(current)) {}
+
+		public:
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<is_const, const T*, T*>;
+			using reference = std::conditional_t<is_const, const T&, T&>;
+
+			basic_iterator() noexcept = default;
+			/// @brief Converts an iterator to a const iterator
+			template<bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+			basic_iterator(const basic_iterator<other_const>& other) noexcept : current(other.current) {}
+
+			reference operator*() const noexcept { return *as_node(current)->value(); }
+			pointer operator->() const noexcept { return as_node(current)->value(); }
+
+			basic_iterator& operator++() noexcept
+			{
+				current = current->next;
+				helpers::prefetch(current->next);
+				return *this;
+			}
+			basic_iterator operator++(int) noexcept { basic_iterator copy = *this; ++*this; return copy; }
+			basic_iterator& operator--() noexcept { current = current->prev; return *this; }
+			basic_iterator operator--(int) noexcept { basic_iterator copy = *this; current = current->prev; return copy; }
+
+			friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept { return a.current == b.current; }
+			friend bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept { return a.current != b.current; }
+
+			template<bool>
+			friend class basic_iterator;
+		};
+
+		/// @brief Helper alias for iterators
+		using iterator = basic_iterator<false>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = basic_iterator<true>;
+
+		/// @brief The number of nodes ahead of the current one which for_each() prefetches
+		static constexpr size_t prefetch_distance = 4;
+
+		/******************************************
+		CONSTRUCTORS AND DESTRUCTOR
+		******************************************/
+
+		/// @brief Constructs an empty list, which does not allocate
+		list() noexcept { reset_links(); }
+
+		/// @brief Constructs a list by copying the objects of an initializer list, in a single slab
+		/// @param init The objects to copy
+		list(std::initializer_list<T> init)
+			: list()
+		{
+			reserve(init.size());
+			for (const T& value : init)
+				emplace_back(value);
+		}
+
+		/// @brief Copy constructor, which copies the objects in a single slab
+		/// @param to_copy The list to copy
+		list(const list& to_copy)
+			: list()
+		{
+			reserve(to_copy.nb_elem);
+			for (const T& value : to_copy)
+				emplace_back(value);
+		}
+
+		/// @brief Move constructor, which takes the nodes of 'to_move' in O(1)
+		/// @param to_move The list to move, which becomes empty
+		list(list&& to_move) noexcept
+			: list()
+		{
+			steal(to_move);
+		}
+
+		/// @brief Copy assignment operator
+		/// @param to_copy The list to copy
+		/// @return *this
+		list& operator=(const list& to_copy)
+		{
+			if (this != &to_copy)
+			{
+				list copy(to_copy);
+				release();
+				steal(copy);
+			}
+			return *this;
+		}
+
+		/// @brief Move assignment operator
+		/// @param to_move The list to move, which becomes empty
+		/// @return *this
+		list& operator=(list&& to_move) noexcept
+		{
+			if (this != &to_move)
+			{
+				release();
+				steal(to_move);
+			}
+			return *this;
+		}
+
+		/// @brief Destroys the objects, and frees the slabs
+		~list() noexcept { release(); }
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the number of objects in the list
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept { return nb_elem; }
+
+		/// @brief Returns the number of nodes of the slabs, which is the number of objects
+		/// which can be stored without allocating
+		/// @return The number of nodes
+		[[nodiscard]] size_t capacity() const noexcept
+		{
+			size_t result = 0;
+			for (size_t i = 0; i < slabs.size(); i++)
+				result += slabs.data()[i].count;
+			return result;
+		}
+
+		/// @brief Check if the list is empty (contains 0 objects)
+		/// @return true if the list is empty
+		[[nodiscard]] bool is_empty() const noexcept { return nb_elem == 0; }
+
+		/// @brief Returns the first object, or throws if the list is empty
+		/// @return reference to the first object
+		[[nodiscard]] T& front()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::list: list was empty!");
+			return *as_node(head.next)->value();
+		}
+
+		/// @brief Returns the first object, or throws if the list is empty
+		/// @return const reference to the first object
+		[[nodiscard]] const T& front() const
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::list: list was empty!");
+			return *as_node(head.next)->value();
+		}
+
+		/// @brief Returns the last object, or throws if the list is empty
+		/// @return reference to the last object
+		[[nodiscard]] T& back()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::list: list was empty!");
+			return *as_node(head.prev)->value();
+		}
+
+		/// @brief Returns the last object, or throws if the list is empty
+		/// @return const reference to the last object
+		[[nodiscard]] const T& back() const
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::list: list was empty!");
+			return *as_node(head.prev)->value();
+		}
+
+		/******************************************
+		ITERATORS
+		******************************************/
+
+		[[nodiscard]] iterator begin() noexcept { return iterator(head.next); }
+		[[nodiscard]] iterator end() noexcept { return iterator(&head); }
+		[[nodiscard]] const_iterator begin() const noexcept { return const_iterator(head.next); }
+		[[nodiscard]] const_iterator end() const noexcept { return const_iterator(&head); }
+		[[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+		[[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+		template<typename Func>
+		/// @brief Calls a functor with each object of the list, in order, prefetching the nodes
+		/// 'prefetch_distance' nodes ahead of the current one.
+		/// The functor should not insert or erase objects.
+		/// @param func The functor to which a reference of each object is passed
+		void for_each(Func func)
+		{
+			links* ahead = head.next;
+			for (size_t i = 0; i < prefetch_distance; i++)
+			{
+				helpers::prefetch(ahead);
+				//The list is circular: 'ahead' wraps around instead of becoming null
+				ahead = ahead->next;
+			}
+			for (links* current = head.next; current != &head; current = current->next)
+			{
+				helpers::prefetch(ahead);
+				ahead = ahead->next;
+				func(*as_node(current)->value());
+			}
+		}
+
+		template<typename Func>
+		/// @brief Calls a functor with each object of the list, in order, prefetching the nodes
+		/// 'prefetch_distance' nodes ahead of the current one
+		/// @param func The functor to which a const reference of each object is passed
+		void for_each(Func func) const
+		{
+			const_cast<list*>(this)->for_each([&func](const T& value) { func(value); });
+		}
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		/// @brief Copies an object at the end of the list
+		/// @param value The object to copy
+		void push_back(const T& value) { emplace(end(), value); }
+		/// @brief Moves an object at the end of the list
+		/// @param value The object to move
+		void push_back(T&& value) { emplace(end(), std::move(value)); }
+		/// @brief Copies an object at the beginning of the list
+		/// @param value The object to copy
+		void push_front(const T& value) { emplace(begin(), value); }
+		/// @brief Moves an object at the beginning of the list
+		/// @param value The object to move
+		void push_front(T&& value) { emplace(begin(), std::move(value)); }
+
+		template<typename... Args>
+		/// @brief Constructs an object at the end of the list
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return reference to the constructed object
+		T& emplace_back(Args&&... args) { return *emplace(end(), std::forward<Args>(args)...); }
+
+		template<typename... Args>
+		/// @brief Constructs an object at the beginning of the list
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return reference to the constructed object
+		T& emplace_front(Args&&... args) { return *emplace(begin(), std::forward<Args>(args)...); }
+
+		template<typename... Args>
+		/// @brief Constructs an object before 'pos'
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param pos The iterator to the object which follows the new object
+		/// @param ...args The arguments to forward to the constructor
+		/// @return iterator to the constructed object
+		iterator emplace(const_iterator pos, Args&&... args)
+		{
+			node* new_node = take_node();
+			try
+			{
+				new(new_node->storage) T(std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				give_node(new_node);
+				throw;
+			}
+			links* position = pos.current;
+			new_node->prev = position->prev;
+			new_node->next = position;
+			position->prev->next = new_node;
+			position->prev = new_node;
+			++nb_elem;
+			return iterator(new_node);
+		}
+
+		/// @brief Copies an object before 'pos'
+		/// @param pos The iterator to the object which follows the new object
+		/// @param value The object to copy
+		/// @return iterator to the new object
+		iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+		/// @brief Moves an object before 'pos'
+		/// @param pos The iterator to the object which follows the new object
+		/// @param value The object to move
+		/// @return iterator to the new object
+		iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+		/// @brief Destroys the first object, or throws if the list is empty
+		void pop_front()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::list: list was empty!");
+			erase(begin());
+		}
+
+		/// @brief Destroys the last object, or throws if the list is empty
+		void pop_back()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::list: list was empty!");
+			erase(const_iterator(head.prev));
+		}
+
+		/// @brief Destroys the object pointed to by 'pos', whose node is reused by the next insertion
+		/// @param pos The iterator to the object to erase (which should not be end())
+		/// @return iterator following the erased object
+		iterator erase(const_iterator pos) noexcept
+		{
+			links* current = pos.current;
+			links* next = current->next;
+			current->prev->next = next;
+			next->prev = current->prev;
+			as_node(current)->value()->~T();
+			give_node(as_node(current));
+			--nb_elem;
+			return iterator(next);
+		}
+
+		/// @brief Destroys all the objects, keeping the slabs to reuse their nodes
+		void clear() noexcept
+		{
+			destroy_values();
+			reset_links();
+			//Every node becomes untouched again, so that the next insertions reuse them in order
+			free_nodes = nullptr;
+			for (size_t i = slabs.size(); i > 1; i--)
+				for (size_t j = slabs.data()[i - 2].count; j != 0; j--)
+					give_node(slabs.data()[i - 2].nodes + j - 1);
+			nb_untouched = slabs.is_empty() ? 0 : slabs.back().count;
+		}
+
+		/// @brief Ensures that 'count' objects can be stored without allocating more than once.
+		/// If the slabs cannot hold 'count' objects, allocates a single slab for the missing nodes.
+		/// @param count The number of objects
+		void reserve(size_t count)
+		{
+			const size_t available = capacity() - nb_elem;
+			if (count > nb_elem && count - nb_elem > available)
+				add_slab(count - nb_elem - available);
+		}
+
+		/// @brief Moves the objects to a new slab in the order of the list, and frees the old slabs,
+		/// so that traversing the list reads contiguous memory. Invalidates the iterators.
+		/// If an object throws while being moved (or copied, if its move constructor can throw), the list is not modified.
+		void compact()
+		{
+			if (is_empty())
+			{
+				release();
+				return;
+			}
+			const size_t count = nb_elem;
+			node* nodes = static_cast<node*>(Allocator::allocate(sizeof(node) * count, alignof(node)));
+			size_t constructed = 0;
+			try
+			{
+				for (links* current = head.next; current != &head; current = current->next)
+				{
+					helpers::prefetch(current->next);
+					new(nodes[constructed].storage) T(std::move_if_noexcept(*as_node(current)->value()));
+					++constructed;
+				}
+			}
+			catch (...)
+			{
+				for (size_t i = 0; i < constructed; i++)
+					nodes[i].value()->~T();
+				Allocator::deallocate(nodes, sizeof(node) * count, alignof(node));
+				throw;
+			}
+			release();
+			slabs.push_back(slab{ nodes, count });
+			for (size_t i = 0; i < count; i++)
+			{
+				nodes[i].prev = i == 0 ? &head : &nodes[i - 1];
+				nodes[i].next = i + 1 == count ? &head : &nodes[i + 1];
+			}
+			head.next = &nodes[0];
+			head.prev = &nodes[count - 1];
+			nb_elem = count;
+		}
+
+		/// @brief Prints the content of the list in 'os'
+		/// @param os The ostream in which to << the list's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (auto it = begin(); it != end(); ++it)
+			{
+				if (it != begin())
+					os << ", ";
+				os << *it;
+			}
+			os << '}';
+		}
+
+		friend bool operator==(const list& a, const list& b)
+		{
+			return a.nb_elem == b.nb_elem && std::equal(a.begin(), a.end(), b.begin());
+		}
+		friend bool operator!=(const list& a, const list& b) { return !(a == b); }
+
+	private:
+		/// @brief Makes the sentinel point to itself
+		void reset_links() noexcept
+		{
+			head.prev = &head;
+			head.next = &head;
+			nb_elem = 0;
+		}
+
+		/// @brief Destroys the objects, without modifying the links
+		void destroy_values() noexcept
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				for (links* current = head.next; current != &head; current = current->next)
+					as_node(current)->value()->~T();
+			}
+		}
+
+		/// @brief Destroys the objects and frees the slabs, leaving the list empty
+		void release() noexcept
+		{
+			destroy_values();
+			for (size_t i = 0; i < slabs.size(); i++)
+				Allocator::deallocate(slabs.data()[i].nodes, sizeof(node) * slabs.data()[i].count, alignof(node));
+			slabs.clear();
+			nb_untouched = 0;
+			free_nodes = nullptr;
+			reset_links();
+		}
+
+		/// @brief Takes the nodes of another list, leaving it empty (without slabs)
+		void steal(list& other) noexcept
+		{
+			slabs = std::move(other.slabs);
+			other.slabs.clear();
+			nb_untouched = std::exchange(other.nb_untouched, 0);
+			free_nodes = std::exchange(other.free_nodes, nullptr);
+			if (other.is_empty())
+				return;
+			head.next = other.head.next;
+			head.prev = other.head.prev;
+			head.next->prev = &head;
+			head.prev->next = &head;
+			nb_elem = other.nb_elem;
+			other.reset_links();
+		}
+
+		/// @brief Allocates a slab of 'count' nodes, which becomes the slab from which new nodes are taken.
+		/// The untouched nodes of the previous slab are moved to the free nodes.
+		void add_slab(size_t count)
+		{
+			if (count > std::numeric_limits<size_t>::max() / sizeof(node))
+				throw std::length_error("vale::list: size was greater than max_size()!");
+			slabs.reserve(slabs.size() + 1);
+			node* nodes = static_cast<node*>(Allocator::allocate(sizeof(node) * count, alignof(node)));
+			if (!slabs.is_empty())
+			{
+				const slab& last = slabs.back();
+				for (size_t i = last.count; i != last.count - nb_untouched; i--)
+					give_node(last.nodes + i - 1);
+			}
+			slabs.push_back(slab{ nodes, count });
+			nb_untouched = count;
+		}
+
+		/// @brief Returns an unused node: an erased one, or the next untouched node of the last slab
+		node* take_node()
+		{
+			if (free_nodes != nullptr)
+				return as_node(std::exchange(free_nodes, free_nodes->next));
+			if (nb_untouched == 0)
+				add_slab(std::min(std::max(capacity(), min_slab_nodes), max_slab_nodes));
+			const slab& last = slabs.back();
+			return last.nodes + (last.count - nb_untouched--);
+		}
+
+		/// @brief Adds a node to the free nodes
+		void give_node(node* unused) noexcept
+		{
+			unused->next = free_nodes;
+			free_nodes = unused;
+		}
+	};
+
+	template<typename T, typename Allocator>
+	/// @brief A thread safe list which provides helpful methods when working concurrently.
+	/// Does not possess iterators to avoid false usages.
+	/// All methods lock the mutex protecting the objects.
+	/// @tparam T The type of the objects to store
+	/// @tparam Allocator The allocator policy used for the slabs of nodes
+	class list<T, Allocator, ThreadSafe>
+	{
+		/// @brief The objects
+		list<T, Allocator, NonThreadSafe> objects;
+		/// @brief The mutex which protects the objects
+		mutable std::mutex mutex{};
+
+	public:
+		/// @brief Constructs an empty list
+		list() noexcept = default;
+
+		/// @brief Constructs a list by copying the objects of an initializer list
+		/// @param init The objects to copy
+		list(std::initializer_list<T> init)
+			: objects(init) {}
+
+		/// @brief Returns the number of objects in the list
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept
+		{
+			std::scoped_lock lock{ mutex };
+			return objects.size();
+		}
+
+		/// @brief Check if the list is empty (contains 0 objects)
+		/// @return true if the list is empty
+		[[nodiscard]] bool is_empty() const noexcept
+		{
+			std::scoped_lock lock{ mutex };
+			return objects.is_empty();
+		}
+
+		/// @brief Returns a non-thread safe copy of the list
+		/// @return copy of the objects
+		[[nodiscard]] list<T, Allocator, NonThreadSafe> to_non_thread_safe() const
+		{
+			std::scoped_lock lock{ mutex };
+			return objects;
+		}
+
+		template<typename... Args>
+		/// @brief Constructs an object at the end of the list
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		void emplace_back(Args&&... args)
+		{
+			std::scoped_lock lock{ mutex };
+			objects.emplace_back(std::forward<Args>(args)...);
+		}
+
+		template<typename... Args>
+		/// @brief Constructs an object at the beginning of the list
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		void emplace_front(Args&&... args)
+		{
+			std::scoped_lock lock{ mutex };
+			objects.emplace_front(std::forward<Args>(args)...);
+		}
+
+		/// @brief Copies an object at the end of the list
+		/// @param value The object to copy
+		void push_back(const T& value) { emplace_back(value); }
+		/// @brief Moves an object at the end of the list
+		/// @param value The object to move
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+		/// @brief Copies an object at the beginning of the list
+		/// @param value The object to copy
+		void push_front(const T& value) { emplace_front(value); }
+		/// @brief Moves an object at the beginning of the list
+		/// @param value The object to move
+		void push_front(T&& value) { emplace_front(std::move(value)); }
+
+		/// @brief Moves the first object in 'out' and destroys it, if the list is not empty
+		/// @param out The object to which the first object is move-assigned
+		/// @return false if the list was empty
+		bool try_pop_front(T& out)
+		{
+			std::scoped_lock lock{ mutex };
+			if (objects.is_empty())
+				return false;
+			out = std::move(objects.front());
+			objects.pop_front();
+			return true;
+		}
+
+		/// @brief Moves the last object in 'out' and destroys it, if the list is not empty
+		/// @param out The object to which the last object is move-assigned
+		/// @return false if the list was empty
+		bool try_pop_back(T& out)
+		{
+			std::scoped_lock lock{ mutex };
+			if (objects.is_empty())
+				return false;
+			out = std::move(objects.back());
+			objects.pop_back();
+			return true;
+		}
+
+		/// @brief Destroys all the objects
+		void clear() noexcept
+		{
+			std::scoped_lock lock{ mutex };
+			objects.clear();
+		}
+
+		/// @brief Moves the objects to a new slab in the order of the list (see list::compact())
+		void compact()
+		{
+			std::scoped_lock lock{ mutex };
+			objects.compact();
+		}
+
+		/// @brief Call a functor with each of the object in the list
+		/// @param func The functor to which a reference of each object is passed
+		template<typename Func>
+		void for_each(Func func)
+		{
+			std::scoped_lock lock{ mutex };
+			objects.for_each(func);
+		}
+
+		/// @brief Call a functor with each of the object in the list
+		/// @param func The functor to which a const reference of each object is passed
+		template<typename Func>
+		void for_each(Func func) const
+		{
+			std::scoped_lock lock{ mutex };
+			objects.for_each(func);
+		}
+
+		/// @brief Passes begin and end iterators followed by an argument pack to a function, and returns the result of the function.
+		/// This method can be used to thread-safely access iterators of the list.
+		/// @tparam Func Type of the function to which to pass the iterators followed by the argument pack
+		/// @tparam ...Args Parameter pack
+		/// @param function The function to which to pass the iterators followed by the argument pack
+		/// @param ...args Argument pack forwarded to 'function' after iterators
+		/// @return What is returned by the 'function'
+		template<typename Func, typename... Args>
+		auto pass_iterators(Func function, Args&&... args)
+		{
+			std::scoped_lock lock{ mutex };
+			return function(objects.begin(), objects.end(), std::forward<Args>(args)...);
+		}
+
+		/// @brief Prints the content of the list in 'os'
+		/// @param os The ostream in which to << the list's content
+		inline void print(std::ostream& os) const
+		{
+			std::scoped_lock lock{ mutex };
+			objects.print(os);
+		}
+	};
+
+	template<typename T, typename Allocator = heap_allocator>
+	/// @brief Thread safe list typedef
+	using ts_list = list<T, Allocator, ThreadSafe>;
+
+	template<typename T, typename Allocator, typename ThreadSafety>
+	/// @brief writes the content of the list between '{}', separating the objects by ','.
+	/// Will lock the mutex of the list if its thread safety policy is ThreadSafe.
+	static std::ostream& operator<<(std::ostream& os, const list<T, Allocator, ThreadSafety>& var)
+	{
+		var.print(os);
+		return os;
+	}
+
+	/******************************************
+	UNROLLED LIST
+	******************************************/
+
+	template<typename T, size_t node_capacity = std::max<size_t>(512 / sizeof(T), 4), typename Allocator = heap_allocator>
+	/// @brief A doubly linked list of blocks of up to 'node_capacity' contiguous objects.
+	/// Scanning an unrolled list reads whole blocks sequentially, while inserting or erasing in the middle
+	/// only moves the objects of one block: a full block is split in two halves, and a block which becomes
+	/// less than half full is merged with the next one if they fit in a single block.
+	/// Each block can be viewed as a contiguous_struct_view (see blocks()) for bulk processing.
+	/// Inserting or erasing invalidates the iterators to the objects of the modified blocks.
+	/// @tparam T The type of the objects to store
+	/// @tparam node_capacity The maximum number of objects of a block
+	/// @tparam Allocator The allocator policy used for the blocks
+	class unrolled_list
+	{
+		static_assert(node_capacity >= 2, "vale::unrolled_list requires a node capacity of at least 2!");
+		static_assert(std::is_nothrow_move_constructible_v<T>, "vale::unrolled_list requires a noexcept move constructor!");
+		static_assert(std::is_nothrow_destructible_v<T>, "vale::unrolled_list requires a noexcept destructor!");
+
+		using links = details::list_links;
+
+		/// @brief A block of objects, linked to the previous and next blocks
+		struct block : links
+		{
+			/// @brief The number of objects of the block
+			size_t count;
+			/// @brief The storage of the objects
+			alignas(T) unsigned char storage[sizeof(T) * node_capacity];
+
+			T* data() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+			const T* data() const noexcept { return std::launder(reinterpret_cast<const T*>(storage)); }
+		};
+
+		/// @brief The sentinel of the circular list of blocks
+		links head;
+		/// @brief The number of objects
+		size_t nb_elem = 0;
+		/// @brief The number of blocks
+		size_t nb_blocks = 0;
+
+		static block* as_block(links* ptr) noexcept { return static_cast<block*>(ptr); }
+		static const block* as_block(const links* ptr) noexcept { return static_cast<const block*>(ptr); }
+
+	public:
+		template<bool is_const>
+		/// @brief Bidirectional iterator over the objects of the list
+		class basic_iterator
+		{
+			friend class unrolled_list;
+
+			/// @brief The block of the current object, or the sentinel for the end iterator
+			links* current = nullptr;
+			/// @brief The index of the current object in its block
+			size_t index = 0;
+
+			basic_iterator(const links* current, size_t index) noexcept
+				: current(const_cast<links*>(current)), index(index) {}
+
+		public:
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<is_const, const T*, T*>;
+			using reference = std::conditional_t<is_const, const T&, T&>;
+
+			basic_iterator() noexcept = default;
+			/// @brief Converts an iterator to a const iterator
+			template<bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+			basic_iterator(const basic_iterator<other_const>& other) noexcept : current(other.current), index(other.index) {}
+
+			reference operator*() const noexcept { return as_block(current)->data()[index]; }
+			pointer operator->() const noexcept { return as_block(current)->data() + index; }
+
+			basic_iterator& operator++() noexcept
+			{
+				if (++index == as_block(current)->count)
+				{
+					current = current->next;
+					index = 0;
+				}
+				return *this;
+			}
+			basic_iterator operator++(int) noexcept { basic_iterator copy = *this; ++*this; return copy; }
+			basic_iterator& operator--() noexcept
+			{
+				if (index == 0)
+				{
+					current = current->prev;
+					index = as_block(current)->count;
+				}
+				--index;
+				return *this;
+			}
+			basic_iterator operator--(int) noexcept { basic_iterator copy = *this; --*this; return copy; }
+
+			friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept { return a.current == b.current && a.index == b.index; }
+			friend bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept { return !(a == b); }
+
+			template<bool>
+			friend class basic_iterator;
+		};
+
+		/// @brief Helper alias for iterators
+		using iterator = basic_iterator<false>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = basic_iterator<true>;
+
+		/// @brief Forward iterator over the blocks of the list, each exposed as a contiguous_struct_view
+		class block_iterator
+		{
+			/// @brief The current block, or the sentinel for the end iterator
+			const links* current = nullptr;
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = contiguous_struct_view<T>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const contiguous_struct_view<T>*;
+			using reference = contiguous_struct_view<T>;
+
+			block_iterator() noexcept = default;
+			explicit block_iterator(const links* current) noexcept : current(current) {}
+
+			contiguous_struct_view<T> operator*() const noexcept
+			{
+				return contiguous_struct_view<T>(as_block(current)->data(), as_block(current)->count);
+			}
+
+			block_iterator& operator++() noexcept { current = current->next; return *this; }
+			block_iterator operator++(int) noexcept { block_iterator copy = *this; current = current->next; return copy; }
+
+			friend bool operator==(const block_iterator& a, const block_iterator& b) noexcept { return a.current == b.current; }
+			friend bool operator!=(const block_iterator& a, const block_iterator& b) noexcept { return a.current != b.current; }
+		};
+
+		/// @brief Range over the blocks of the list
+		struct block_range
+		{
+			/// @brief The first block
+			block_iterator first;
+			/// @brief The end iterator
+			block_iterator last;
+
+			block_iterator begin() const noexcept { return first; }
+			block_iterator end() const noexcept { return last; }
+		};
+
+		/******************************************
+		CONSTRUCTORS AND DESTRUCTOR
+		******************************************/
+
+		/// @brief Constructs an empty list, which does not allocate
+		unrolled_list() noexcept { reset_links(); }
+
+		/// @brief Constructs a list by copying the objects of an initializer list
+		/// @param init The objects to copy
+		unrolled_list(std::initializer_list<T> init)
+			: unrolled_list()
+		{
+			for (const T& value : init)
+				emplace_back(value);
+		}
+
+		/// @brief Copy constructor
+		/// @param to_copy The list to copy
+		unrolled_list(const unrolled_list& to_copy)
+			: unrolled_list()
+		{
+			for (const T& value : to_copy)
+				emplace_back(value);
+		}
+
+		/// @brief Move constructor, which takes the blocks of 'to_move' in O(1)
+		/// @param to_move The list to move, which becomes empty
+		unrolled_list(unrolled_list&& to_move) noexcept
+			: unrolled_list()
+		{
+			steal(to_move);
+		}
+
+		/// @brief Copy assignment operator
+		/// @param to_copy The list to copy
+		/// @return *this
+		unrolled_list& operator=(const unrolled_list& to_copy)
+		{
+			if (this != &to_copy)
+			{
+				unrolled_list copy(to_copy);
+				clear();
+				steal(copy);
+			}
+			return *this;
+		}
+
+		/// @brief Move assignment operator
+		/// @param to_move The list to move, which becomes empty
+		/// @return *this
+		unrolled_list& operator=(unrolled_list&& to_move) noexcept
+		{
+			if (this != &to_move)
+			{
+				clear();
+				steal(to_move);
+			}
+			return *this;
+		}
+
+		/// @brief Destroys the objects, and frees the blocks
+		~unrolled_list() noexcept { clear(); }
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the number of objects in the list
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept { return nb_elem; }
+
+		/// @brief Returns the number of blocks of the list
+		/// @return The number of blocks
+		[[nodiscard]] size_t block_count() const noexcept { return nb_blocks; }
+
+		/// @brief Check if the list is empty (contains 0 objects)
+		/// @return true if the list is empty
+		[[nodiscard]] bool is_empty() const noexcept { return nb_elem == 0; }
+
+		/// @brief Returns the first object, or throws if the list is empty
+		/// @return reference to the first object
+		[[nodiscard]] T& front()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::unrolled_list: list was empty!");
+			return as_block(head.next)->data()[0];
+		}
+
+		/// @brief Returns the first object, or throws if the list is empty
+		/// @return const reference to the first object
+		[[nodiscard]] const T& front() const
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::unrolled_list: list was empty!");
+			return as_block(head.next)->data()[0];
+		}
+
+		/// @brief Returns the last object, or throws if the list is empty
+		/// @return reference to the last object
+		[[nodiscard]] T& back()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::unrolled_list: list was empty!");
+			return as_block(head.prev)->data()[as_block(head.prev)->count - 1];
+		}
+
+		/// @brief Returns the last object, or throws if the list is empty
+		/// @return const reference to the last object
+		[[nodiscard]] const T& back() const
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::unrolled_list: list was empty!");
+			return as_block(head.prev)->data()[as_block(head.prev)->count - 1];
+		}
+
+		/******************************************
+		ITERATORS
+		******************************************/
+
+		[[nodiscard]] iterator begin() noexcept { return iterator(head.next, 0); }
+		[[nodiscard]] iterator end() noexcept { return iterator(&head, 0); }
+		[[nodiscard]] const_iterator begin() const noexcept { return const_iterator(head.next, 0); }
+		[[nodiscard]] const_iterator end() const noexcept { return const_iterator(&head, 0); }
+		[[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+		[[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+		/// @brief Returns an iterator to the object at 'index', skipping whole blocks
+		/// rather than objects, or throws if 'index' is greater than the size
+		/// @param index The index of the object (size() returns end())
+		/// @return iterator to the object at 'index'
+		[[nodiscard]] iterator iterator_at(size_t index)
+		{
+			auto [current, offset] = find_index(index);
+			return iterator(current, offset);
+		}
+
+		/// @brief Returns an iterator to the object at 'index', skipping whole blocks
+		/// rather than objects, or throws if 'index' is greater than the size
+		/// @param index The index of the object (size() returns end())
+		/// @return const iterator to the object at 'index'
+		[[nodiscard]] const_iterator iterator_at(size_t index) const
+		{
+			auto [current, offset] = find_index(index);
+			return const_iterator(current, offset);
+		}
+
+		/// @brief Returns a range over the blocks of the list, each exposed as a contiguous_struct_view
+		/// of its objects (in the order of the list)
+		/// @return Range over the blocks
+		[[nodiscard]] block_range blocks() const noexcept
+		{
+			return block_range{ block_iterator(head.next), block_iterator(&head) };
+		}
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		/// @brief Copies an object at the end of the list
+		/// @param value The object to copy
+		void push_back(const T& value) { emplace_back(value); }
+		/// @brief Moves an object at the end of the list
+		/// @param value The object to move
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+		/// @brief Copies an object at the beginning of the list
+		/// @param value The object to copy
+		void push_front(const T& value) { emplace(begin(), value); }
+		/// @brief Moves an object at the beginning of the list
+		/// @param value The object to move
+		void push_front(T&& value) { emplace(begin(), std::move(value)); }
+
+		template<typename... Args>
+		/// @brief Constructs an object at the end of the list
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return reference to the constructed object
+		T& emplace_back(Args&&... args)
+		{
+			block* last = head.prev == &head ? nullptr : as_block(head.prev);
+			if (last == nullptr || last->count == node_capacity)
+			{
+				block* new_block = allocate_block(&head);
+				try
+				{
+					new(new_block->data()) T(std::forward<Args>(args)...);
+				}
+				catch (...)
+				{
+					free_block(new_block);
+					throw;
+				}
+				new_block->count = 1;
+				++nb_elem;
+				return new_block->data()[0];
+			}
+			T* slot = last->data() + last->count;
+			new(slot) T(std::forward<Args>(args)...);
+			++last->count;
+			++nb_elem;
+			return *slot;
+		}
+
+		template<typename... Args>
+		/// @brief Constructs an object before 'pos', splitting its block if it is full
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param pos The iterator to the object which follows the new object
+		/// @param ...args The arguments to forward to the constructor
+		/// @return iterator to the constructed object
+		iterator emplace(const_iterator pos, Args&&... args)
+		{
+			if (pos.current == &head)
+			{
+				emplace_back(std::forward<Args>(args)...);
+				return iterator(head.prev, as_block(head.prev)->count - 1);
+			}
+			//The object is constructed before shifting, as the arguments could refer to objects of the list
+			T value(std::forward<Args>(args)...);
+			block* target = as_block(pos.current);
+			size_t index = pos.index;
+			if (target->count == node_capacity)
+			{
+				//Split: the upper half of the block moves to a new block which follows it
+				block* upper = allocate_block(target->next);
+				const size_t half = node_capacity / 2;
+				helpers::relocate(upper->data(), target->data() + half, node_capacity - half);
+				upper->count = node_capacity - half;
+				target->count = half;
+				if (index > half)
+				{
+					target = upper;
+					index -= half;
+				}
+			}
+			helpers::relocate(target->data() + index + 1, target->data() + index, target->count - index);
+			new(target->data() + index) T(std::move(value));
+			++target->count;
+			++nb_elem;
+			return iterator(target, index);
+		}
+
+		/// @brief Copies an object before 'pos'
+		/// @param pos The iterator to the object which follows the new object
+		/// @param value The object to copy
+		/// @return iterator to the new object
+		iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+		/// @brief Moves an object before 'pos'
+		/// @param pos The iterator to the object which follows the new object
+		/// @param value The object to move
+		/// @return iterator to the new object
+		iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+		/// @brief Destroys the first object, or throws if the list is empty
+		void pop_front()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::unrolled_list: list was empty!");
+			erase(begin());
+		}
+
+		/// @brief Destroys the last object, or throws if the list is empty
+		void pop_back()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::unrolled_list: list was empty!");
+			erase(const_iterator(head.prev, as_block(head.prev)->count - 1));
+		}
+
+		/// @brief Destroys the object pointed to by 'pos'. A block which becomes empty is freed,
+		/// and a block which becomes less than half full is merged with the next one if they fit in a single block.
+		/// @param pos The iterator to the object to erase (which should not be end())
+		/// @return iterator following the erased object
+		iterator erase(const_iterator pos) noexcept
+		{
+			block* target = as_block(pos.current);
+			const size_t index = pos.index;
+			target->data()[index].~T();
+			helpers::relocate(target->data() + index, target->data() + index + 1, target->count - index - 1);
+			--target->count;
+			--nb_elem;
+			if (target->count == 0)
+			{
+				links* next = target->next;
+				free_block(target);
+				return iterator(next, 0);
+			}
+			if (target->count < node_capacity / 2 && target->next != &head
+				&& target->count + as_block(target->next)->count <= node_capacity)
+			{
+				//The objects of the next block are appended: the object following the erased one stays at 'index'
+				block* next = as_block(target->next);
+				helpers::relocate(target->data() + target->count, next->data(), next->count);
+				target->count += next->count;
+				next->count = 0;
+				free_block(next);
+			}
+			if (index == target->count)
+				return iterator(target->next, 0);
+			return iterator(target, index);
+		}
+
+		/// @brief Destroys all the objects, and frees the blocks
+		void clear() noexcept
+		{
+			for (links* current = head.next; current != &head;)
+			{
+				block* to_free = as_block(current);
+				current = current->next;
+				std::destroy(to_free->data(), to_free->data() + to_free->count);
+				to_free->~block();
+				Allocator::deallocate(to_free, sizeof(block), alignof(block));
+			}
+			reset_links();
+		}
+
+		/// @brief Prints the content of the list in 'os'
+		/// @param os The ostream in which to << the list's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (auto it = begin(); it != end(); ++it)
+			{
+				if (it != begin())
+					os << ", ";
+				os << *it;
+			}
+			os << '}';
+		}
+
+		friend bool operator==(const unrolled_list& a, const unrolled_list& b)
+		{
+			return a.nb_elem == b.nb_elem && std::equal(a.begin(), a.end(), b.begin());
+		}
+		friend bool operator!=(const unrolled_list& a, const unrolled_list& b) { return !(a == b); }
+
+	private:
+		/// @brief Makes the sentinel point to itself
+		void reset_links() noexcept
+		{
+			head.prev = &head;
+			head.next = &head;
+			nb_elem = 0;
+			nb_blocks = 0;
+		}
+
+		/// @brief Returns the block containing the object at 'index', and the index of the object in the block
+		std::pair<const links*, size_t> find_index(size_t index) const
+		{
+			if (index > nb_elem)
+				throw std::out_of_range("vale::unrolled_list: index was greater than size!");
+			if (index == nb_elem)
+				return { &head, 0 };
+			const links* current = head.next;
+			while (index >= as_block(current)->count)
+			{
+				index -= as_block(current)->count;
+				current = current->next;
+			}
+			return { current, index };
+		}
+
+		/// @brief Takes the blocks of another list, leaving it empty
+		void steal(unrolled_list& other) noexcept
+		{
+			if (other.is_empty())
+				return;
+			head.next = other.head.next;
+			head.prev = other.head.prev;
+			head.next->prev = &head;
+			head.prev->next = &head;
+			nb_elem = other.nb_elem;
+			nb_blocks = other.nb_blocks;
+			other.reset_links();
+		}
+
+		/// @brief Allocates an empty block, linked before 'position'
+		/// @param position The block (or the sentinel) which follows the new block
+		/// @return The new block
+		block* allocate_block(links* position)
+		{
+			block* result = new(Allocator::allocate(sizeof(block), alignof(block))) block;
+			result->count = 0;
+			result->prev = position->prev;
+			result->next = position;
+			position->prev->next = result;
+			position->prev = result;
+			++nb_blocks;
+			return result;
+		}
+
+		/// @brief Unlinks and frees a block whose objects were destroyed or moved
+		void free_block(block* to_free) noexcept
+		{
+			to_free->prev->next = to_free->next;
+			to_free->next->prev = to_free->prev;
+			to_free->~block();
+			Allocator::deallocate(to_free, sizeof(block), alignof(block));
+			--nb_blocks;
+		}
+	};
+
+	template<typename T, size_t node_capacity, typename Allocator>
+	/// @brief writes the content of the list between '{}', separating the objects by ','.
+	static std::ostream& operator<<(std::ostream& os, const unrolled_list<T, node_capacity, Allocator>& var)
+	{
+		var.print(os);
+		return os;
+	}
+
+	/******************************************
+	LOCK-FREE STACK
+	******************************************/
+
+	/// @brief The link embedded in an object to push it on a lock_free_stack.
+	/// Copying an object does not copy its link.
+	class stack_hook
+	{
+		template<typename, auto>
+		friend class lock_free_stack;
+
+		/// @brief The next hook of the stack. It is atomic as a thread popping the stack can read it
+		/// while the thread which popped the hook first pushes it again.
+		std::atomic<stack_hook*> next{ nullptr };
+
+	public:
+		/// @brief Constructs a hook which is not linked
+		stack_hook() noexcept = default;
+
+		/// @brief Constructs a hook which is not linked: links are not copied
+		stack_hook(const stack_hook&) noexcept {}
+
+		/// @brief Does nothing: links are not copied
+		/// @return *this
+		stack_hook& operator=(const stack_hook&) noexcept { return *this; }
+	};
+
+	namespace details
+	{
+		/// @brief A pointer and a tag, which is incremented on each modification of the top of a lock-free stack
+		/// so that a compare-and-swap fails if the top was popped and pushed again in between (ABA problem)
+		struct tagged_pointer
+		{
+			/// @brief The pointer
+			stack_hook* pointer = nullptr;
+			/// @brief The tag
+			uintptr_t tag = 0;
+		};
+
+		template<bool is_double_width = std::atomic<tagged_pointer>::is_always_lock_free>
+		/// @brief An atomic tagged pointer, using a double-width compare-and-swap (cmpxchg16b, casp) when it is lock-free
+		class atomic_tagged_pointer
+		{
+			std::atomic<tagged_pointer> value{ tagged_pointer{} };
+
+		public:
+			tagged_pointer load(std::memory_order order) const noexcept { return value.load(order); }
+
+			bool compare_exchange_weak(tagged_pointer& expected, tagged_pointer desired, std::memory_order success, std::memory_order failure) noexcept
+			{
+				return value.compare_exchange_weak(expected, desired, success, failure);
+			}
+		};
+
+		template<>
+		/// @brief An atomic tagged pointer packed in 64 bits, used when a double-width compare-and-swap is not lock-free
+		/// (which is the case of GCC, that routes it through libatomic).
+		/// On 64-bit platforms, the pointer uses the low 48 bits (the width of user-space addresses on x86-64 and AArch64),
+		/// and the tag the high 16 bits; on 32-bit platforms, the pointer and the tag use 32 bits each.
+		/// This assumes that the high 16 bits of the hooks' addresses are 0, which does not hold for memory
+		/// mapped above 2^48 (x86-64 5-level paging, AArch64 52-bit addresses, when the allocator asks for it)
+		/// nor for tagged heap pointers (AArch64 top-byte tags, as used by Android): pack() asserts it in debug builds.
+		class atomic_tagged_pointer<false>
+		{
+			static_assert(sizeof(void*) <= 8, "Unsupported pointer size!");
+
+			/// @brief The number of bits of the pointer
+			static constexpr unsigned pointer_bits = sizeof(void*) == 8 ? 48 : 32;
+			/// @brief The mask of the pointer
+			static constexpr uint64_t pointer_mask = (uint64_t(1) << pointer_bits) - 1;
+
+			std::atomic<uint64_t> value{ 0 };
+
+			static uint64_t pack(tagged_pointer ptr) noexcept
+			{
+				assert((static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr.pointer)) & ~pointer_mask) == 0
+					&& "vale::lock_free_stack: the high bits of the address of a hook were used!");
+				return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr.pointer)) | (static_cast<uint64_t>(ptr.tag) << pointer_bits);
+			}
+
+			static tagged_pointer unpack(uint64_t packed) noexcept
+			{
+				return tagged_pointer{ reinterpret_cast<stack_hook*>(static_cast<uintptr_t>(packed & pointer_mask)),
+					static_cast<uintptr_t>(packed >> pointer_bits) };
+			}
+
+		public:
+			tagged_pointer load(std::memory_order order) const noexcept { return unpack(value.load(order)); }
+
+			bool compare_exchange_weak(tagged_pointer& expected, tagged_pointer desired, std::memory_order success, std::memory_order failure) noexcept
+			{
+				uint64_t packed = pack(expected);
+				const bool result = value.compare_exchange_weak(packed, pack(desired), success, failure);
+				if (!result)
+					expected = unpack(packed);
+				return result;
+			}
+		};
+	}
+
+	template<typename T, auto Hook>
+	/// @brief A lock-free (Treiber) stack of objects which are linked through their 'Hook' member.
+	/// Like an intrusive_list, the stack does not own its objects and never allocates.
+	/// The top of the stack is a tagged pointer, so a thread cannot pop an object which was popped and pushed
+	/// again since it read the top (ABA problem). As a thread popping an object may read the link of an object
+	/// popped at the same time by another thread, the objects must not be destroyed (nor their memory reused)
+	/// while they may still be popped: keeping the objects alive until the stack is destroyed is enough.
+	/// A 'freelist' keeps its hooks outside of the objects it recycles for that reason.
+	/// The stack is always thread safe: it has no ThreadSafety policy.
+	/// @tparam T The type of the objects to link
+	/// @tparam Hook Pointer to the stack_hook member of T used by the stack
+	class lock_free_stack
+	{
+		static_assert(std::is_same_v<decltype(Hook), stack_hook T::*>, "Hook should be a pointer to a stack_hook member of T!");
+
+		/// @brief The top of the stack
+		details::atomic_tagged_pointer<> top;
+
+		/// @brief Returns the offset of the hook inside of the objects
+		static std::ptrdiff_t hook_offset() noexcept
+		{
+			//The member pointer is applied to a dummy (aligned and non-null) address which is never dereferenced
+			const T* dummy = reinterpret_cast<const T*>(static_cast<uintptr_t>(alignof(T) * 64));
+			return reinterpret_cast<const char*>(&(dummy->*Hook)) - reinterpret_cast<const char*>(dummy);
+		}
+
+		/// @brief Returns the object containing a hook
+		static T* object_of(stack_hook* hook) noexcept
+		{
+			return reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - hook_offset());
+		}
+
+	public:
+		/// @brief A chain of objects popped at once from a stack through pop_all(), in the order in which they would have been popped.
+		/// The chain does not own its objects.
+		class chain
+		{
+			friend class lock_free_stack;
+
+			/// @brief The first hook of the chain
+			stack_hook* first = nullptr;
+
+			explicit chain(stack_hook* first) noexcept : first(first) {}
+
+		public:
+			/// @brief Forward iterator over the objects of a chain
+			class iterator
+			{
+				friend class chain;
+
+				stack_hook* current = nullptr;
+
+				explicit iterator(stack_hook* current) noexcept : current(current) {}
+
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = T;
+				using difference_type = std::ptrdiff_t;
+				using pointer = T*;
+				using reference = T&;
+
+				iterator() noexcept = default;
+
+				T& operator*() const noexcept { return *object_of(current); }
+				T* operator->() const noexcept { return object_of(current); }
+
+				iterator& operator++() noexcept { current = current->next.load(std::memory_order_relaxed); return *this; }
+				iterator operator++(int) noexcept { iterator copy = *this; ++*this; return copy; }
+
+				friend bool operator==(const iterator& a, const iterator& b) noexcept { return a.current == b.current; }
+				friend bool operator!=(const iterator& a, const iterator& b) noexcept { return a.current != b.current; }
+			};
+
+			/// @brief Constructs an empty chain
+			chain() noexcept = default;
+
+			/// @brief Check if the chain is empty
+			/// @return True if the chain contains no objects
+			[[nodiscard]] bool is_empty() const noexcept { return first == nullptr; }
+
+			/// @brief Removes the first object of the chain
+			/// @return The first object, or nullptr if the chain is empty
+			[[nodiscard]] T* try_pop() noexcept
+			{
+				if (first == nullptr)
+					return nullptr;
+				stack_hook* result = first;
+				first = first->next.load(std::memory_order_relaxed);
+				return object_of(result);
+			}
+
+			[[nodiscard]] iterator begin() const noexcept { return iterator(first); }
+			[[nodiscard]] iterator end() const noexcept { return iterator(nullptr); }
+		};
+
+		/// @brief Constructs an empty stack
+		lock_free_stack() noexcept = default;
+		lock_free_stack(const lock_free_stack&) = delete;
+		lock_free_stack& operator=(const lock_free_stack&) = delete;
+
+		/// @brief Pushes an object on the stack, which should not already be in the stack
+		/// @param object The object to push
+		void push(T& object) noexcept
+		{
+			stack_hook* hook = &(object.*Hook);
+			details::tagged_pointer expected = top.load(std::memory_order_relaxed);
+			do
+			{
+				hook->next.store(expected.pointer, std::memory_order_relaxed);
+			} while (!top.compare_exchange_weak(expected, details::tagged_pointer{ hook, expected.tag + 1 },
+				std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		/// @brief Pops the object at the top of the stack
+		/// @return The popped object, or nullptr if the stack was empty
+		[[nodiscard]] T* try_pop() noexcept
+		{
+			details::tagged_pointer expected = top.load(std::memory_order_acquire);
+			while (expected.pointer != nullptr)
+			{
+				//If another thread popped 'expected.pointer' in between, this link may be stale:
+				//the tag then differs, and the compare-and-swap fails
+				stack_hook* next = expected.pointer->next.load(std::memory_order_relaxed);
+				if (top.compare_exchange_weak(expected, details::tagged_pointer{ next, expected.tag + 1 },
+					std::memory_order_acquire, std::memory_order_acquire))
+					return object_of(expected.pointer);
+			}
+			return nullptr;
+		}
+
+		/// @brief Pops all the objects of the stack at once
+		/// @return The chain of the popped objects, starting with the top of the stack
+		[[nodiscard]] chain pop_all() noexcept
+		{
+			details::tagged_pointer expected = top.load(std::memory_order_relaxed);
+			while (expected.pointer != nullptr
+				&& !top.compare_exchange_weak(expected, details::tagged_pointer{ nullptr, expected.tag + 1 },
+					std::memory_order_acquire, std::memory_order_relaxed))
+			{}
+			return chain(expected.pointer);
+		}
+
+		/// @brief Check if the stack is empty. The result may already be outdated when returned if other threads modify the stack.
+		/// @return True if the stack contained no objects
+		[[nodiscard]] bool is_empty() const noexcept { return top.load(std::memory_order_relaxed).pointer == nullptr; }
+	};
+
+	template<typename T, typename Allocator = heap_allocator>
+	/// @brief A lock-free freelist of objects, which recycles the memory of released objects between threads.
+	/// The memory of the objects is only freed when the freelist is destroyed, after which
+	/// no object acquired from the freelist should be used.
+	/// @tparam T The type of the objects
+	/// @tparam Allocator The allocator policy used for the objects
+	class freelist
+	{
+		/// @brief The memory of an object, and the link used while it is in the freelist
+		struct node
+		{
+			/// @brief The storage of the object (at offset 0, so that an object is converted to its node by a cast)
+			alignas(T) unsigned char storage[sizeof(T)];
+			/// @brief The link of the node
+			stack_hook hook;
+		};
+
+		/// @brief The free nodes
+		lock_free_stack<node, &node::hook> free_nodes;
+		/// @brief The number of nodes allocated by the freelist
+		std::atomic<size_t> nb_nodes{ 0 };
+
+		/// @brief Returns a free node, allocating one if there are none
+		node* take_node()
+		{
+			if (node* result = free_nodes.try_pop())
+				return result;
+			node* result = new(Allocator::allocate(sizeof(node), alignof(node))) node;
+			nb_nodes.fetch_add(1, std::memory_order_relaxed);
+			return result;
+		}
+
+	public:
+		/// @brief Constructs an empty freelist
+		freelist() noexcept = default;
+		freelist(const freelist&) = delete;
+		freelist& operator=(const freelist&) = delete;
+
+		/// @brief Frees the memory of the objects: all the objects should have been released
+		~freelist() noexcept
+		{
+			auto nodes = free_nodes.pop_all();
+			while (node* to_free = nodes.try_pop())
+			{
+				to_free->~node();
+				Allocator::deallocate(to_free, sizeof(node), alignof(node));
+			}
+		}
+
+		/// @brief Allocates 'count' objects in advance
+		/// @param count The number of objects to allocate
+		void reserve(size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				node* result = new(Allocator::allocate(sizeof(node), alignof(node))) node;
+				nb_nodes.fetch_add(1, std::memory_order_relaxed);
+				free_nodes.push(*result);
+			}
+		}
+
+		template<typename... Args>
+		/// @brief Constructs an object in the memory of a released object, or in newly allocated memory
+		/// if there are none. Can be called from any thread.
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return The constructed object
+		[[nodiscard]] T* acquire(Args&&... args)
+		{
+			node* result = take_node();
+			try
+			{
+				return new(result->storage) T(std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				free_nodes.push(*result);
+				throw;
+			}
+		}
+
+		/// @brief Destroys an object returned by acquire(), and recycles its memory.
+		/// Can be called from any thread, not only the thread which acquired the object.
+		/// @param object The object to release
+		void release(T* object) noexcept
+		{
+			static_assert(std::is_nothrow_destructible_v<T>, "vale::freelist requires a noexcept destructor!");
+			object->~T();
+			free_nodes.push(*reinterpret_cast<node*>(reinterpret_cast<unsigned char*>(object)));
+		}
+
+		/// @brief Returns the number of objects allocated by the freelist (acquired or free)
+		/// @return The number of allocated objects
+		[[nodiscard]] size_t allocated() const noexcept { return nb_nodes.load(std::memory_order_relaxed); }
+	};
+}
@@ -0,0 +1,3660 @@
+/** @file map.h
+* @brief Header that contains the map classes.
+* A 'skip_list_map' is an ordered map implemented as a skip list: each object is linked in a
+* sorted list at level 0, and in a random number of sparser lists above it, which are used to skip
+* over most of the objects when searching. With the ThreadSafe policy, the skip list is lock-free:
+* objects are inserted and erased through compare-and-swaps, and searches never block.
+* Erased objects are freed through epoch-based reclamation, once no thread can still be reading them.
+* The NonThreadSafe skip list runs the same code, on plain integers rather than atomics.
+*
+* A 'map' is an unordered map implemented as an open-addressing hash table (a Swiss table):
+* a control byte per slot stores 7 bits of the hash of its key, and the control bytes of 16 slots
+* are compared at once through SSE2 (8 through 64-bit integers without SSE2) to find the slots worth comparing.
+*
+* A thread safe map 'ts_map' is split in shards, each locked only while it is modified:
+* lookups do not lock, and read immutable nodes protected by the same epoch-based reclamation.
+*
+* A 'btree_map' (or 'btree_set') is an ordered map implemented as a B+ tree, whose nodes span a few cache lines:
+* the keys of a node are contiguous and scanned linearly (16 bytes at a time for arithmetic keys),
+* and the leaves are linked in order for range scans. Sorted input is loaded from the bottom up.
+*
+* Like a 'ts_static_vector', a thread safe skip list 'ts_skip_list_map' (or map 'ts_map') does not provide an iterator interface,
+* but rather provides helpful methods to read and scan the map's content in a thread safe way.
+*/
+
+#pragma once
+#include <vale_structs/vector.h>
+#include <type_traits>
+#include <stdexcept>
+#include <functional>
+#include <ostream>
+#include <utility>
+#include <atomic>
+#include <tuple>
+#include <new>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <algorithm>
+#include <mutex>
+#include <cassert>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace vale
+{
+	/******************************************
+	EPOCH-BASED RECLAMATION
+	******************************************/
+
+	namespace details
+	{
+		/// @brief Epoch-based reclamation of the memory of lock-free structs, shared by all of them.
+		/// A thread pins the current epoch while it reads a struct: an object unlinked from a struct is retired
+		/// with the epoch at which it was unlinked, and freed once the epoch advanced twice, as the epoch
+		/// only advances when all the pinned threads pinned the current epoch.
+		class epoch_domain
+		{
+		public:
+			/// @brief An object waiting to be freed
+			struct retired_object
+			{
+				/// @brief The object
+				void* object;
+				/// @brief The function freeing the object
+				void(*deleter)(void*) noexcept;
+				/// @brief The epoch at which the object was retired
+				uint64_t epoch;
+			};
+
+			/// @brief The state of a thread, which is reused by another thread once the thread exits
+			struct alignas(cache_line_size) thread_record
+			{
+				/// @brief The epoch pinned by the thread, or 0 if the thread is not pinned
+				std::atomic<uint64_t> epoch{ 0 };
+				/// @brief True if a thread owns the record
+				std::atomic<bool> in_use{ true };
+				/// @brief The next record (records are never removed)
+				thread_record* next = nullptr;
+				/// @brief The number of nested pins of the thread
+				size_t nesting = 0;
+				/// @brief The objects retired by the thread
+				vale::vector<retired_object> retired;
+				/// @brief The number of retired objects after which the thread tries to free them
+				size_t collect_at = 0;
+			};
+
+		private:
+			/// @brief The number of retired objects of a thread after which it tries to free them
+			static constexpr size_t collect_threshold = 64;
+
+			/// @brief The current epoch
+			alignas(cache_line_size) std::atomic<uint64_t> global_epoch{ 1 };
+			/// @brief The records of the threads
+			std::atomic<thread_record*> records{ nullptr };
+
+			/// @brief Owns the record of a thread for the lifetime of the thread
+			struct record_owner
+			{
+				thread_record* record;
+
+				record_owner() : record(instance().acquire_record()) {}
+				~record_owner() noexcept { instance().release_record(*record); }
+			};
+
+			epoch_domain() noexcept = default;
+
+			/// @brief Returns a record no thread owns, or a new record
+			thread_record* acquire_record()
+			{
+				for (thread_record* record = records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+				{
+					bool expected = false;
+					if (!record->in_use.load(std::memory_order_relaxed)
+						&& record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+						return record;
+				}
+				thread_record* record = new thread_record();
+				thread_record* head = records.load(std::memory_order_relaxed);
+				do
+				{
+					record->next = head;
+				} while (!records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+				return record;
+			}
+
+			/// @brief Releases the record of an exiting thread, keeping its retired objects for the next owner
+			void release_record(thread_record& record) noexcept
+			{
+				collect(record);
+				record.epoch.store(0, std::memory_order_release);
+				record.in_use.store(false, std::memory_order_release);
+			}
+
+			/// @brief Advances the epoch if all the pinned threads pinned the current epoch
+			/// @return The current epoch
+			uint64_t try_advance() noexcept
+			{
+				uint64_t current = global_epoch.load(std::memory_order_seq_cst);
+				for (thread_record* record = records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+				{
+					const uint64_t pinned = record->epoch.load(std::memory_order_seq_cst);
+					if (pinned != 0 && pinned != current)
+						return current;
+				}
+				if (global_epoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst))
+					return current + 1;
+				return current;
+			}
+
+			/// @brief Frees the objects retired by a thread at least two epochs ago
+			void collect(thread_record& record) noexcept
+			{
+				const uint64_t current = try_advance();
+				size_t kept = 0;
+				for (size_t i = 0; i < record.retired.size(); i++)
+				{
+					retired_object& object = record.retired.data()[i];
+					if (object.epoch + 2 <= current)
+						object.deleter(object.object);
+					else
+						record.retired.data()[kept++] = object;
+				}
+				while (record.retired.size() > kept)
+					record.retired.pop_back();
+				//If a (possibly preempted) thread holds the epoch back, waits for twice as many objects before retrying
+				record.collect_at = std::max(collect_threshold, kept * 2);
+			}
+
+		public:
+			epoch_domain(const epoch_domain&) = delete;
+			epoch_domain& operator=(const epoch_domain&) = delete;
+
+			/// @brief Frees all the retired objects, and the records: no thread should still use a lock-free struct
+			~epoch_domain() noexcept
+			{
+				thread_record* record = records.load(std::memory_order_acquire);
+				while (record != nullptr)
+				{
+					for (size_t i = 0; i < record->retired.size(); i++)
+						record->retired.data()[i].deleter(record->retired.data()[i].object);
+					thread_record* next = record->next;
+					delete record;
+					record = next;
+				}
+			}
+
+			/// @brief Returns the domain shared by all the lock-free structs
+			/// @return The domain
+			static epoch_domain& instance() noexcept
+			{
+				static epoch_domain domain;
+				return domain;
+			}
+
+			/// @brief Returns the record of the calling thread
+			/// @return The record of the thread
+			static thread_record& local()
+			{
+				static thread_local record_owner owner;
+				return *owner.record;
+			}
+
+			/// @brief Pins the current epoch: objects retired from now on are not freed until the thread unpins it
+			/// @param record The record of the calling thread
+			void pin(thread_record& record) noexcept
+			{
+				if (record.nesting++ != 0)
+					return;
+				//The exchange orders the pin before the loads of the protected struct
+				record.epoch.exchange(global_epoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+			}
+
+			/// @brief Unpins the epoch pinned by pin()
+			/// @param record The record of the calling thread
+			void unpin(thread_record& record) noexcept
+			{
+				if (--record.nesting == 0)
+					record.epoch.store(0, std::memory_order_release);
+			}
+
+			/// @brief Frees an object once no thread can still read it. The object should already be unreachable.
+			/// @param record The record of the calling thread
+			/// @param object The object to free
+			/// @param deleter The function freeing the object
+			void retire(thread_record& record, void* object, void(*deleter)(void*) noexcept)
+			{
+				record.retired.push_back(retired_object{ object, deleter, global_epoch.load(std::memory_order_seq_cst) });
+				if (record.retired.size() >= std::max(collect_threshold, record.collect_at))
+					collect(record);
+			}
+		};
+
+		/// @brief Pins the current epoch for its lifetime
+		class epoch_guard
+		{
+			/// @brief The record of the thread
+			epoch_domain::thread_record& record;
+
+		public:
+			/// @brief Pins the current epoch
+			epoch_guard()
+				: record(epoch_domain::local())
+			{
+				epoch_domain::instance().pin(record);
+			}
+
+			epoch_guard(const epoch_guard&) = delete;
+			epoch_guard& operator=(const epoch_guard&) = delete;
+
+			/// @brief Unpins the epoch
+			~epoch_guard() noexcept { epoch_domain::instance().unpin(record); }
+
+			/// @brief Frees an object once no thread can still read it
+			/// @param object The object to free, which should already be unreachable
+			/// @param deleter The function freeing the object
+			void retire(void* object, void(*deleter)(void*) noexcept)
+			{
+				epoch_domain::instance().retire(record, object, deleter);
+			}
+		};
+
+		template<typename T, typename ThreadSafety>
+		/// @brief A std::atomic for ThreadSafe structs, so that lock-free code can be reused as is by NonThreadSafe structs
+		struct policy_atomic : std::atomic<T>
+		{
+			using std::atomic<T>::atomic;
+			using std::atomic<T>::operator=;
+		};
+
+		template<typename T>
+		/// @brief Overload for NonThreadSafe structs, which provides the interface of std::atomic over a plain T
+		class policy_atomic<T, NonThreadSafe>
+		{
+			T value;
+
+		public:
+			constexpr policy_atomic() noexcept : value() {}
+			constexpr policy_atomic(T desired) noexcept : value(desired) {}
+
+			T load(std::memory_order = std::memory_order_seq_cst) const noexcept { return value; }
+			void store(T desired, std::memory_order = std::memory_order_seq_cst) noexcept { value = desired; }
+
+			bool compare_exchange_strong(T& expected, T desired, std::memory_order = std::memory_order_seq_cst) noexcept
+			{
+				if (value != expected)
+				{
+					expected = value;
+					return false;
+				}
+				value = desired;
+				return true;
+			}
+
+			T fetch_add(T arg, std::memory_order = std::memory_order_seq_cst) noexcept { T old = value; value += arg; return old; }
+			T fetch_sub(T arg, std::memory_order = std::memory_order_seq_cst) noexcept { T old = value; value -= arg; return old; }
+			T fetch_or(T arg, std::memory_order = std::memory_order_seq_cst) noexcept { T old = value; value |= arg; return old; }
+		};
+	}
+
+	/******************************************
+	SKIP LIST MAP
+	******************************************/
+
+	template<typename Key, typename Value, typename Compare = std::less<>, typename Allocator = heap_allocator, typename ThreadSafety = NonThreadSafe>
+	/// @brief An ordered map implemented as a skip list
+	/// @tparam Key The type of the keys
+	/// @tparam Value The type of the values
+	/// @tparam Compare The comparison of the keys (transparent comparisons allow heterogeneous lookups)
+	/// @tparam Allocator The allocator policy used for the nodes
+	/// @tparam ThreadSafety The thread safety policy (a ThreadSafe skip list is lock-free)
+	class skip_list_map
+	{
+		static_assert(helpers::is_thread_safety_policy_v<ThreadSafety>, "ThreadSafety can only be [Non]ThreadSafe");
+	};
+
+	namespace details
+	{
+		template<typename Key, typename Value, typename Compare, typename Allocator, typename ThreadSafety>
+		/// @brief The lock-free skip list shared by both overloads of skip_list_map (Fraser, Herlihy and Shavit).
+		/// An object is erased by marking the lowest bit of its links, top level first, the thread which marks
+		/// level 0 erasing it. Marked nodes are then unlinked by the searches which step over them.
+		/// Each node counts the levels it is linked at (plus 1 while its inserter links it): the thread
+		/// which removes its last reference retires it, as it is then unreachable.
+		class skip_list
+		{
+		public:
+			/// @brief The type of the objects of the map
+			using value_type = std::pair<const Key, Value>;
+
+			/// @brief The maximum number of levels of a node: each level is 4 times sparser than the level below it
+			static constexpr uint32_t max_height = 24;
+
+			/// @brief A link, whose lowest bit marks the node which contains it as erased
+			using link = policy_atomic<uintptr_t, ThreadSafety>;
+
+			/// @brief A node, followed in memory by its 'height' links
+			struct node
+			{
+				/// @brief The key and value
+				value_type pair;
+				/// @brief The number of levels at which the node is linked (plus 1 while it is being inserted)
+				policy_atomic<uint32_t, ThreadSafety> refs;
+				/// @brief The number of links of the node
+				uint32_t height;
+
+				template<typename K, typename... Args>
+				node(uint32_t height, K&& key, Args&&... args)
+					: pair(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...))
+					, refs(0), height(height)
+				{
+					for (uint32_t i = 0; i < height; i++)
+						new(links() + i) link(0);
+				}
+
+				/// @brief Returns the links of the node, indexed by level
+				link* links() noexcept { return std::launder(reinterpret_cast<link*>(reinterpret_cast<unsigned char*>(this) + links_offset)); }
+			};
+
+			/// @brief The offset of the links of a node
+			static constexpr size_t links_offset = (sizeof(node) + alignof(link) - 1) / alignof(link) * alignof(link);
+			/// @brief The alignment of a node
+			static constexpr size_t node_alignment = alignof(node) > alignof(link) ? alignof(node) : alignof(link);
+
+		private:
+			/// @brief The links of the sentinel, which precedes all the nodes
+			link head[max_height];
+			/// @brief The highest level at which a node was linked
+			policy_atomic<uint32_t, ThreadSafety> top_level{ 0 };
+			/// @brief The number of objects
+			policy_atomic<size_t, ThreadSafety> nb_elem{ 0 };
+			/// @brief The comparison of the keys
+			Compare comp;
+
+			static node* to_node(uintptr_t value) noexcept { return reinterpret_cast<node*>(value & ~uintptr_t(1)); }
+			static bool is_marked(uintptr_t value) noexcept { return (value & 1) != 0; }
+			static uintptr_t to_link(node* value) noexcept { return reinterpret_cast<uintptr_t>(value); }
+
+			/// @brief Returns a random height, each level being reached with a probability of 1/4
+			static uint32_t random_height() noexcept
+			{
+				static thread_local uint64_t state = reinterpret_cast<uintptr_t>(&state) | 1;
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				return 1 + static_cast<uint32_t>(helpers::count_trailing_zeros((state >> 16) | (uint64_t(1) << (2 * (max_height - 1)))) / 2);
+			}
+
+			template<typename K, typename... Args>
+			/// @brief Allocates and constructs a node, which is not linked
+			static node* create_node(uint32_t height, K&& key, Args&&... args)
+			{
+				const size_t bytes = links_offset + height * sizeof(link);
+				void* memory = Allocator::allocate(bytes, node_alignment);
+				try
+				{
+					return new(memory) node(height, std::forward<K>(key), std::forward<Args>(args)...);
+				}
+				catch (...)
+				{
+					Allocator::deallocate(memory, bytes, node_alignment);
+					throw;
+				}
+			}
+
+			/// @brief Destroys and frees a node
+			static void destroy_node(void* ptr) noexcept
+			{
+				node* to_free = static_cast<node*>(ptr);
+				const size_t bytes = links_offset + to_free->height * sizeof(link);
+				to_free->~node();
+				Allocator::deallocate(to_free, bytes, node_alignment);
+			}
+
+			/// @brief Removes a reference to a node, which is freed (once no thread can still read it) if it was the last
+			void release(node* to_release) noexcept
+			{
+				if (to_release->refs.fetch_sub(1) != 1)
+					return;
+				if constexpr (std::is_same_v<ThreadSafety, ThreadSafe>)
+				{
+					try
+					{
+						epoch_guard().retire(to_release, &destroy_node);
+					}
+					catch (...)
+					{
+						//The retired list could not grow: the node is leaked rather than freed unsafely
+					}
+				}
+				else
+					destroy_node(to_release);
+			}
+
+			template<typename K>
+			/// @brief Searches the predecessors and successors of 'key' at each level, unlinking the marked nodes on the way
+			/// @param key The key to search for
+			/// @param preds The links of the predecessors, indexed by level
+			/// @param succs The successors, indexed by level
+			/// @return True if the successor at level 0 has a key equal to 'key'
+			bool find(const K& key, link** preds, node** succs) noexcept
+			{
+			retry:
+				link* pred = head;
+				//Levels above the top level are empty: a node raises the top level before linking its upper levels
+				const uint32_t top = top_level.load();
+				for (uint32_t level = max_height; level-- > top + 1;)
+				{
+					preds[level] = head;
+					succs[level] = nullptr;
+				}
+				for (uint32_t level = top + 1; level-- != 0;)
+				{
+					node* curr = to_node(pred[level].load());
+					while (curr != nullptr)
+					{
+						uintptr_t succ = curr->links()[level].load();
+						while (is_marked(succ))
+						{
+							uintptr_t expected = to_link(curr);
+							if (!pred[level].compare_exchange_strong(expected, succ & ~uintptr_t(1)))
+								goto retry;
+							release(curr);
+							curr = to_node(succ);
+							if (curr == nullptr)
+								break;
+							succ = curr->links()[level].load();
+						}
+						if (curr == nullptr || !comp(curr->pair.first, key))
+							break;
+						pred = curr->links();
+						curr = to_node(succ);
+					}
+					preds[level] = pred;
+					succs[level] = curr;
+				}
+				return succs[0] != nullptr && !comp(key, succs[0]->pair.first);
+			}
+
+		public:
+			/// @brief Constructs an empty skip list
+			skip_list() noexcept
+			{
+				for (link& level : head)
+					level.store(0, std::memory_order_relaxed);
+			}
+
+			skip_list(const skip_list&) = delete;
+			skip_list& operator=(const skip_list&) = delete;
+
+			/// @brief Frees all the nodes: no other thread should still use the skip list
+			~skip_list() noexcept { clear(); }
+
+			/// @brief Returns the number of objects
+			size_t size() const noexcept { return nb_elem.load(std::memory_order_relaxed); }
+
+			/// @brief Returns the comparison of the keys
+			const Compare& key_comp() const noexcept { return comp; }
+
+			/// @brief Returns the first node whose key is not less than 'key', skipping erased nodes without unlinking them
+			template<typename K>
+			node* lower_bound(const K& key) const noexcept
+			{
+				link* pred = const_cast<link*>(head);
+				node* curr = nullptr;
+				for (uint32_t level = top_level.load(std::memory_order_relaxed) + 1; level-- != 0;)
+				{
+					curr = to_node(pred[level].load(std::memory_order_acquire));
+					while (curr != nullptr)
+					{
+						const uintptr_t succ = curr->links()[level].load(std::memory_order_acquire);
+						if (!is_marked(succ))
+						{
+							if (!comp(curr->pair.first, key))
+								break;
+							pred = curr->links();
+						}
+						curr = to_node(succ);
+					}
+				}
+				return curr;
+			}
+
+			/// @brief Returns the node whose key is equal to 'key', or nullptr
+			template<typename K>
+			node* find(const K& key) const noexcept
+			{
+				node* result = lower_bound(key);
+				return result != nullptr && !comp(key, result->pair.first) ? result : nullptr;
+			}
+
+			/// @brief Returns the first node, or nullptr
+			node* first() const noexcept { return next_of(const_cast<link*>(head)); }
+
+			/// @brief Returns the node following the links 'links' at level 0 which is not erased, or nullptr
+			static node* next_of(link* links) noexcept
+			{
+				node* curr = to_node(links[0].load(std::memory_order_acquire));
+				while (curr != nullptr)
+				{
+					const uintptr_t succ = curr->links()[0].load(std::memory_order_acquire);
+					if (!is_marked(succ))
+						return curr;
+					curr = to_node(succ);
+				}
+				return nullptr;
+			}
+
+			template<typename K, typename... Args>
+			/// @brief Inserts a node with key 'key' and value constructed from 'args' if there is no node with that key
+			/// @return The node with key 'key', and true if it was inserted
+			std::pair<node*, bool> emplace(K&& key, Args&&... args)
+			{
+				link* preds[max_height];
+				node* succs[max_height];
+				if (find(key, preds, succs))
+					return { succs[0], false };
+				//The key may be moved into the node: the key of the node is used from now on
+				node* inserted = create_node(random_height(), std::forward<K>(key), std::forward<Args>(args)...);
+				while (true)
+				{
+					for (uint32_t level = 0; level < inserted->height; level++)
+						inserted->links()[level].store(to_link(succs[level]), std::memory_order_relaxed);
+					//One reference for the link at level 0, and one held until all the levels are linked
+					inserted->refs.store(2, std::memory_order_relaxed);
+					uintptr_t expected = to_link(succs[0]);
+					if (preds[0][0].compare_exchange_strong(expected, to_link(inserted)))
+						break;
+					if (find(inserted->pair.first, preds, succs))
+					{
+						destroy_node(inserted);
+						return { succs[0], false };
+					}
+				}
+				nb_elem.fetch_add(1, std::memory_order_relaxed);
+				uint32_t top = top_level.load(std::memory_order_relaxed);
+				while (top < inserted->height - 1 && !top_level.compare_exchange_strong(top, inserted->height - 1))
+				{}
+
+				link* links = inserted->links();
+				for (uint32_t level = 1; level < inserted->height; level++)
+				{
+					while (true)
+					{
+						uintptr_t succ = links[level].load();
+						//The node was erased: its upper links are marked, and must not be linked
+						if (is_marked(succ))
+							goto linked;
+						if (to_node(succ) != succs[level] && !links[level].compare_exchange_strong(succ, to_link(succs[level])))
+							continue;
+						inserted->refs.fetch_add(1);
+						uintptr_t expected = to_link(succs[level]);
+						if (preds[level][level].compare_exchange_strong(expected, to_link(inserted)))
+							break;
+						inserted->refs.fetch_sub(1);
+						find(inserted->pair.first, preds, succs);
+						if (succs[0] != inserted)
+							goto linked;
+					}
+				}
+			linked:
+				//If the node was erased while being linked, the eraser may have missed the levels linked since
+				if (is_marked(links[0].load()))
+					find(inserted->pair.first, preds, succs);
+				release(inserted);
+				return { inserted, true };
+			}
+
+			template<typename K>
+			/// @brief Erases the node with key 'key'
+			/// @return True if a node was erased
+			bool erase(const K& key) noexcept
+			{
+				link* preds[max_height];
+				node* succs[max_height];
+				while (true)
+				{
+					if (!find(key, preds, succs))
+						return false;
+					node* to_erase = succs[0];
+					link* links = to_erase->links();
+					for (uint32_t level = to_erase->height; level-- > 1;)
+						links[level].fetch_or(1);
+					//The thread which marks level 0 erases the node
+					if (is_marked(links[0].fetch_or(1)))
+						continue;
+					nb_elem.fetch_sub(1, std::memory_order_relaxed);
+					find(key, preds, succs);
+					return true;
+				}
+			}
+
+			/// @brief Erases and frees all the nodes: no other thread should use the skip list
+			void clear() noexcept
+			{
+				//A node is freed when the walk of the last level it is linked at releases it
+				for (uint32_t level = max_height; level-- != 0;)
+				{
+					node* curr = to_node(head[level].load(std::memory_order_relaxed));
+					while (curr != nullptr)
+					{
+						node* next = to_node(curr->links()[level].load(std::memory_order_relaxed));
+						if (curr->refs.fetch_sub(1) == 1)
+							destroy_node(curr);
+						curr = next;
+					}
+					head[level].store(0, std::memory_order_relaxed);
+				}
+				top_level.store(0, std::memory_order_relaxed);
+				nb_elem.store(0, std::memory_order_relaxed);
+			}
+
+			/// @brief Takes the nodes of another skip list, leaving it empty. The skip list should be empty,
+			/// and no other thread should use either skip list.
+			/// @param other The skip list whose nodes to take
+			void steal(skip_list& other) noexcept
+			{
+				for (uint32_t level = 0; level < max_height; level++)
+				{
+					head[level].store(other.head[level].load(std::memory_order_relaxed), std::memory_order_relaxed);
+					other.head[level].store(0, std::memory_order_relaxed);
+				}
+				top_level.store(other.top_level.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				other.top_level.store(0, std::memory_order_relaxed);
+				nb_elem.store(other.nb_elem.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				other.nb_elem.store(0, std::memory_order_relaxed);
+				comp = std::move(other.comp);
+			}
+		};
+	}
+
+	template<typename Key, typename Value, typename Compare, typename Allocator>
+	/// @brief A non-thread safe ordered map implemented as a skip list
+	/// @tparam Key The type of the keys
+	/// @tparam Value The type of the values
+	/// @tparam Compare The comparison of the keys (transparent comparisons allow heterogeneous lookups)
+	/// @tparam Allocator The allocator policy used for the nodes
+	class skip_list_map<Key, Value, Compare, Allocator, NonThreadSafe>
+	{
+		using list_type = details::skip_list<Key, Value, Compare, Allocator, NonThreadSafe>;
+		using node = typename list_type::node;
+
+		/// @brief The skip list
+		list_type list;
+
+	public:
+		/// @brief The type of the objects of the map
+		using value_type = std::pair<const Key, Value>;
+
+		template<bool is_const>
+		/// @brief Forward iterator over the objects of the map, in the order of their keys
+		class basic_iterator
+		{
+			friend class skip_list_map;
+
+			/// @brief The current node, or nullptr for the end iterator
+			node* current = nullptr;
+
+			explicit basic_iterator(node* current) noexcept : current(current) {}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::pair<const Key, Value>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<is_const, const value_type*, value_type*>;
+			using reference = std::conditional_t<is_const, const value_type&, value_type&>;
+
+			basic_iterator() noexcept = default;
+			/// @brief Converts an iterator to a const iterator
+			template<bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+			basic_iterator(const basic_iterator<other_const>& other) noexcept : current(other.current) {}
+
+			reference operator*() const noexcept { return current->pair; }
+			pointer operator->() const noexcept { return &current->pair; }
+
+			basic_iterator& operator++() noexcept { current = list_type::next_of(current->links()); return *this; }
+			basic_iterator operator++(int) noexcept { basic_iterator copy = *this; ++*this; return copy; }
+
+			friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept { return a.current == b.current; }
+			friend bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept { return a.current != b.current; }
+
+			template<bool>
+			friend class basic_iterator;
+		};
+
+		/// @brief Helper alias for iterators
+		using iterator = basic_iterator<false>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = basic_iterator<true>;
+
+		/// @brief Constructs an empty map
+		skip_list_map() noexcept = default;
+
+		/// @brief Constructs a map from an initializer list of key/value pairs (the first of equal keys is kept)
+		/// @param init The pairs to insert
+		skip_list_map(std::initializer_list<std::pair<Key, Value>> init)
+		{
+			for (const auto& [key, value] : init)
+				list.emplace(key, value);
+		}
+
+		/// @brief Copy constructor
+		/// @param to_copy The map to copy
+		skip_list_map(const skip_list_map& to_copy)
+		{
+			for (const auto& [key, value] : to_copy)
+				list.emplace(key, value);
+		}
+
+		/// @brief Copy assignment operator
+		/// @param to_copy The map to copy
+		/// @return *this
+		skip_list_map& operator=(const skip_list_map& to_copy)
+		{
+			if (this != &to_copy)
+			{
+				list.clear();
+				for (const auto& [key, value] : to_copy)
+					list.emplace(key, value);
+			}
+			return *this;
+		}
+
+		/// @brief Move constructor, which takes the nodes of 'to_move'
+		/// @param to_move The map to move, which becomes empty
+		skip_list_map(skip_list_map&& to_move) noexcept { list.steal(to_move.list); }
+
+		/// @brief Move assignment operator
+		/// @param to_move The map to move, which becomes empty
+		/// @return *this
+		skip_list_map& operator=(skip_list_map&& to_move) noexcept
+		{
+			if (this != &to_move)
+			{
+				list.clear();
+				list.steal(to_move.list);
+			}
+			return *this;
+		}
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the number of objects in the map
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept { return list.size(); }
+
+		/// @brief Check if the map is empty (contains 0 objects)
+		/// @return true if the map is empty
+		[[nodiscard]] bool is_empty() const noexcept { return list.size() == 0; }
+
+		template<typename K>
+		/// @brief Returns an iterator to the object with key 'key'
+		/// @param key The key to search for
+		/// @return iterator to the object, or end() if there are none
+		[[nodiscard]] iterator find(const K& key) noexcept { return iterator(list.find(key)); }
+
+		template<typename K>
+		/// @brief Returns an iterator to the object with key 'key'
+		/// @param key The key to search for
+		/// @return const iterator to the object, or end() if there are none
+		[[nodiscard]] const_iterator find(const K& key) const noexcept { return const_iterator(list.find(key)); }
+
+		template<typename K>
+		/// @brief Check if the map contains an object with key 'key'
+		/// @param key The key to search for
+		/// @return True if an object has key 'key'
+		[[nodiscard]] bool contains(const K& key) const noexcept { return list.find(key) != nullptr; }
+
+		template<typename K>
+		/// @brief Returns an iterator to the first object whose key is not less than 'key'
+		/// @param key The key to search for
+		/// @return iterator to the object, or end() if there are none
+		[[nodiscard]] iterator lower_bound(const K& key) noexcept { return iterator(list.lower_bound(key)); }
+
+		template<typename K>
+		/// @brief Returns an iterator to the first object whose key is not less than 'key'
+		/// @param key The key to search for
+		/// @return const iterator to the object, or end() if there are none
+		[[nodiscard]] const_iterator lower_bound(const K& key) const noexcept { return const_iterator(list.lower_bound(key)); }
+
+		template<typename K>
+		/// @brief Returns the value of the object with key 'key', or throws if there are none
+		/// @param key The key to search for
+		/// @return reference to the value
+		[[nodiscard]] Value& at(const K& key)
+		{
+			if (node* result = list.find(key))
+				return result->pair.second;
+			throw std::out_of_range("vale::skip_list_map: key was not found!");
+		}
+
+		template<typename K>
+		/// @brief Returns the value of the object with key 'key', or throws if there are none
+		/// @param key The key to search for
+		/// @return const reference to the value
+		[[nodiscard]] const Value& at(const K& key) const
+		{
+			if (node* result = list.find(key))
+				return result->pair.second;
+			throw std::out_of_range("vale::skip_list_map: key was not found!");
+		}
+
+		/// @brief Returns the value of the object with key 'key', inserting a default constructed value if there are none
+		/// @param key The key to search for
+		/// @return reference to the value
+		Value& operator[](const Key& key) { return list.emplace(key).first->pair.second; }
+
+		template<typename K, typename Func>
+		/// @brief Calls 'func' on each object whose key is in ['first', 'last'), in the order of the keys
+		/// @param first The first key of the range
+		/// @param last The key following the range
+		/// @param func The function to call with the key and the value of the objects
+		void scan(const K& first, const K& last, Func&& func)
+		{
+			for (auto it = lower_bound(first); it != end() && list.key_comp()(it->first, last); ++it)
+				func(it->first, it->second);
+		}
+
+		/******************************************
+		ITERATORS
+		******************************************/
+
+		[[nodiscard]] iterator begin() noexcept { return iterator(list.first()); }
+		[[nodiscard]] iterator end() noexcept { return iterator(nullptr); }
+		[[nodiscard]] const_iterator begin() const noexcept { return const_iterator(list.first()); }
+		[[nodiscard]] const_iterator end() const noexcept { return const_iterator(nullptr); }
+		[[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+		[[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		template<typename K, typename... Args>
+		/// @brief Constructs an object with key 'key' if there are none
+		/// @param key The key of the object
+		/// @param ...args The arguments to forward to the constructor of the value
+		/// @return iterator to the object with key 'key', and true if it was inserted
+		std::pair<iterator, bool> emplace(K&& key, Args&&... args)
+		{
+			auto [result, inserted] = list.emplace(std::forward<K>(key), std::forward<Args>(args)...);
+			return { iterator(result), inserted };
+		}
+
+		/// @brief Inserts a copy of 'value' with key 'key' if there are none
+		/// @param key The key of the object
+		/// @param value The value to copy
+		/// @return iterator to the object with key 'key', and true if it was inserted
+		std::pair<iterator, bool> insert(const Key& key, const Value& value) { return emplace(key, value); }
+
+		template<typename V>
+		/// @brief Inserts 'value' with key 'key', or assigns it to the value of the object with key 'key'
+		/// @param key The key of the object
+		/// @param value The value to insert or assign
+		/// @return iterator to the object with key 'key', and true if it was inserted
+		std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value)
+		{
+			auto result = emplace(key, std::forward<V>(value));
+			if (!result.second)
+				result.first->second = std::forward<V>(value);
+			return result;
+		}
+
+		template<typename K>
+		/// @brief Erases the object with key 'key'
+		/// @param key The key of the object to erase
+		/// @return True if an object was erased
+		bool erase(const K& key) noexcept { return list.erase(key); }
+
+		/// @brief Destroys all the objects
+		void clear() noexcept { list.clear(); }
+
+		/// @brief Prints the content of the map in 'os'
+		/// @param os The ostream in which to << the map's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (auto it = begin(); it != end(); ++it)
+			{
+				if (it != begin())
+					os << ", ";
+				os << it->first << ": " << it->second;
+			}
+			os << '}';
+		}
+	};
+
+	template<typename Key, typename Value, typename Compare, typename Allocator>
+	/// @brief A lock-free ordered map implemented as a skip list.
+	/// Values cannot be modified once inserted: they are read by copy (or in place through for_each and scan).
+	/// @tparam Key The type of the keys
+	/// @tparam Value The type of the values
+	/// @tparam Compare The comparison of the keys (transparent comparisons allow heterogeneous lookups)
+	/// @tparam Allocator The allocator policy used for the nodes
+	class skip_list_map<Key, Value, Compare, Allocator, ThreadSafe>
+	{
+		using list_type = details::skip_list<Key, Value, Compare, Allocator, ThreadSafe>;
+		using node = typename list_type::node;
+
+		/// @brief The skip list
+		list_type list;
+
+	public:
+		/// @brief The type of the objects of the map
+		using value_type = std::pair<const Key, Value>;
+
+		/// @brief Constructs an empty map
+		skip_list_map() noexcept = default;
+		skip_list_map(const skip_list_map&) = delete;
+		skip_list_map& operator=(const skip_list_map&) = delete;
+
+		/// @brief Returns the number of objects in the map, which may already be outdated
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept { return list.size(); }
+
+		/// @brief Check if the map is empty, which may already be outdated
+		/// @return true if the map is empty
+		[[nodiscard]] bool is_empty() const noexcept { return list.size() == 0; }
+
+		template<typename K>
+		/// @brief Check if the map contains an object with key 'key'
+		/// @param key The key to search for
+		/// @return True if an object has key 'key'
+		[[nodiscard]] bool contains(const K& key) const
+		{
+			details::epoch_guard guard;
+			return list.find(key) != nullptr;
+		}
+
+		template<typename K>
+		/// @brief Copies the value of the object with key 'key' into 'out'
+		/// @param key The key to search for
+		/// @param out The value in which to copy the value
+		/// @return True if an object has key 'key' (else 'out' is not modified)
+		bool try_get(const K& key, Value& out) const
+		{
+			details::epoch_guard guard;
+			if (node* result = list.find(key))
+			{
+				out = result->pair.second;
+				return true;
+			}
+			return false;
+		}
+
+		template<typename K>
+		/// @brief Copies the first object whose key is not less than 'key' into 'out_key' and 'out_value'
+		/// @param key The key to search for
+		/// @param out_key The key in which to copy the key
+		/// @param out_value The value in which to copy the value
+		/// @return True if there was such an object (else the outputs are not modified)
+		bool try_lower_bound(const K& key, Key& out_key, Value& out_value) const
+		{
+			details::epoch_guard guard;
+			if (node* result = list.lower_bound(key))
+			{
+				out_key = result->pair.first;
+				out_value = result->pair.second;
+				return true;
+			}
+			return false;
+		}
+
+		template<typename K, typename... Args>
+		/// @brief Constructs an object with key 'key' if there are none
+		/// @param key The key of the object
+		/// @param ...args The arguments to forward to the constructor of the value
+		/// @return True if the object was inserted
+		bool emplace(K&& key, Args&&... args)
+		{
+			details::epoch_guard guard;
+			return list.emplace(std::forward<K>(key), std::forward<Args>(args)...).second;
+		}
+
+		/// @brief Inserts a copy of 'value' with key 'key' if there are none
+		/// @param key The key of the object
+		/// @param value The value to copy
+		/// @return True if the object was inserted
+		bool insert(const Key& key, const Value& value) { return emplace(key, value); }
+
+		template<typename K>
+		/// @brief Erases the object with key 'key'
+		/// @param key The key of the object to erase
+		/// @return True if an object was erased
+		bool erase(const K& key)
+		{
+			details::epoch_guard guard;
+			return list.erase(key);
+		}
+
+		template<typename Func>
+		/// @brief Calls 'func' on each object, in the order of the keys.
+		/// Objects inserted or erased during the call may or may not be visited.
+		/// @param func The function to call with the key and the (const) value of the objects
+		void for_each(Func&& func) const
+		{
+			details::epoch_guard guard;
+			for (node* curr = list.first(); curr != nullptr; curr = list_type::next_of(curr->links()))
+				func(curr->pair.first, static_cast<const Value&>(curr->pair.second));
+		}
+
+		template<typename K, typename Func>
+		/// @brief Calls 'func' on each object whose key is in ['first', 'last'), in the order of the keys.
+		/// Objects inserted or erased during the call may or may not be visited.
+		/// @param first The first key of the range
+		/// @param last The key following the range
+		/// @param func The function to call with the key and the (const) value of the objects
+		void scan(const K& first, const K& last, Func&& func) const
+		{
+			details::epoch_guard guard;
+			for (node* curr = list.lower_bound(first); curr != nullptr && list.key_comp()(curr->pair.first, last); curr = list_type::next_of(curr->links()))
+				func(curr->pair.first, static_cast<const Value&>(curr->pair.second));
+		}
+
+		/// @brief Prints the content of the map in 'os'
+		/// @param os The ostream in which to << the map's content
+		inline void print(std::ostream& os) const
+		{
+			bool first = true;
+			os << "{";
+			for_each([&](const Key& key, const Value& value) {
+				if (!first)
+					os << ", ";
+				first = false;
+				os << key << ": " << value;
+			});
+			os << '}';
+		}
+	};
+
+	template<typename Key, typename Value, typename Compare = std::less<>, typename Allocator = heap_allocator>
+	/// @brief Helper alias for a lock-free skip list map
+	using ts_skip_list_map = skip_list_map<Key, Value, Compare, Allocator, ThreadSafe>;
+
+	template<typename Key, typename Value, typename Compare, typename Allocator, typename ThreadSafety>
+	/// @brief writes the content of the map between '{}', separating the objects by ','.
+	static std::ostream& operator<<(std::ostream& os, const skip_list_map<Key, Value, Compare, Allocator, ThreadSafety>& var)
+	{
+		var.print(os);
+		return os;
+	}
+
+	/******************************************
+	HASH MAP
+	******************************************/
+
+	/// @brief Hash function which hashes the types convertible to std::string_view as strings,
+	/// so that a map of strings can be searched for a std::string_view (or a C string) without constructing a key
+	struct transparent_hash
+	{
+		/// @brief Enables heterogeneous lookups (with a transparent key comparison)
+		using is_transparent = void;
+
+		template<typename T>
+		size_t operator()(const T& value) const noexcept
+		{
+			if constexpr (std::is_convertible_v<const T&, std::string_view>)
+				return std::hash<std::string_view>()(std::string_view(value));
+			else
+				return std::hash<T>()(value);
+		}
+	};
+
+	template<typename Key, typename Value, typename Hash = transparent_hash, typename KeyEqual = std::equal_to<>, typename Allocator = heap_allocator, typename ThreadSafety = NonThreadSafe>
+	/// @brief An unordered map implemented as an open-addressing hash table
+	/// @tparam Key The type of the keys
+	/// @tparam Value The type of the values
+	/// @tparam Hash The hash function of the keys
+	/// @tparam KeyEqual The comparison of the keys (heterogeneous lookups are enabled if both Hash and KeyEqual are transparent)
+	/// @tparam Allocator The allocator policy used for the table
+	/// @tparam ThreadSafety The thread safety policy
+	class map
+	{
+		static_assert(helpers::is_thread_safety_policy_v<ThreadSafety>, "ThreadSafety can only be [Non]ThreadSafe");
+	};
+
+	namespace details
+	{
+		/// @brief The control byte of an empty slot
+		static constexpr int8_t ctrl_empty = -128;
+		/// @brief The control byte of an erased slot (tombstone), which does not stop probing
+		static constexpr int8_t ctrl_deleted = -2;
+
+#if defined(__SSE2__) || defined(_M_X64)
+		/// @brief The control bytes of 16 consecutive slots, compared at once through SSE2
+		struct control_group
+		{
+			/// @brief The number of slots in a group
+			static constexpr size_t width = 16;
+			/// @brief The shift converting the index of a bit of a mask to the index of a slot
+			static constexpr unsigned mask_shift = 0;
+			/// @brief The type of the masks, whose bit i is set if slot i matches
+			using mask = uint32_t;
+
+			__m128i ctrl;
+
+			explicit control_group(const int8_t* ptr) noexcept : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr))) {}
+
+			/// @brief Returns the slots whose control byte is 'h2'
+			mask match(int8_t h2) const noexcept { return static_cast<mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))); }
+			/// @brief Returns the empty slots
+			mask match_empty() const noexcept { return match(ctrl_empty); }
+			/// @brief Returns the empty and erased slots (whose highest bit is set)
+			mask match_empty_or_deleted() const noexcept { return static_cast<mask>(_mm_movemask_epi8(ctrl)); }
+		};
+#else
+		/// @brief The control bytes of 8 consecutive slots, compared at once as the bytes of a 64-bit integer (SWAR).
+		/// match() can return false positives for bytes following a match, which fail the comparison of the keys.
+		struct control_group
+		{
+			/// @brief The number of slots in a group
+			static constexpr size_t width = 8;
+			/// @brief The shift converting the index of a bit of a mask to the index of a slot
+			static constexpr unsigned mask_shift = 3;
+			/// @brief The type of the masks, whose bit 8 * i + 7 is set if slot i matches
+			using mask = uint64_t;
+
+			static constexpr uint64_t lsbs = 0x0101010101010101ull;
+			static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+			uint64_t ctrl = 0;
+
+			explicit control_group(const int8_t* ptr) noexcept
+			{
+				for (size_t i = 0; i < width; i++)
+					ctrl |= static_cast<uint64_t>(static_cast<uint8_t>(ptr[i])) << (8 * i);
+			}
+
+			/// @brief Returns the slots whose control byte is 'h2'
+			mask match(int8_t h2) const noexcept
+			{
+				const uint64_t x = ctrl ^ (lsbs * static_cast<uint8_t>(h2));
+				return (x - lsbs) & ~x & msbs;
+			}
+			/// @brief Returns the empty slots (highest bit set, second lowest bit clear)
+			mask match_empty() const noexcept { return ctrl & ~(ctrl << 6) & msbs; }
+			/// @brief Returns the empty and erased slots (highest bit set, lowest bit clear)
+			mask match_empty_or_deleted() const noexcept { return ctrl & ~(ctrl << 7) & msbs; }
+		};
+#endif
+
+		/// @brief Returns the index of the first matching slot of a non-zero mask
+		inline size_t lowest_match(uint64_t mask) noexcept
+		{
+			return static_cast<size_t>(helpers::count_trailing_zeros(mask)) >> control_group::mask_shift;
+		}
+
+		/// @brief Returns the number of non-matching slots at the end of a group
+		inline size_t leading_non_matches(uint64_t mask) noexcept
+		{
+			if (mask == 0)
+				return control_group::width;
+			return control_group::width - 1 - (static_cast<size_t>(helpers::floor_log2(mask)) >> control_group::mask_shift);
+		}
+
+		/// @brief Mixes the bits of a hash, as std::hash of integers is the identity
+		inline uint64_t mix_hash(size_t hash) noexcept
+		{
+			const uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+			return mixed ^ (mixed >> 32);
+		}
+
+		template<typename Hash, typename KeyEqual, typename = void>
+		/// @brief Unspecialized helper, for hash functions or key comparisons which are not transparent
+		struct is_transparent_lookup { static constexpr bool value = false; };
+
+		template<typename Hash, typename KeyEqual>
+		/// @brief Overload for transparent hash functions and key comparisons
+		struct is_transparent_lookup<Hash, KeyEqual, std::void_t<typename Hash::is_transparent, typename KeyEqual::is_transparent>>
+		{
+			static constexpr bool value = true;
+		};
+	}
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+	/// @brief A non-thread safe unordered map implemented as an open-addressing hash table (Swiss table).
+	/// Each slot has a control byte: empty, erased, or the 7 low bits of the hash of its key, so that
+	/// a group of 16 slots (8 without SSE2) is filtered through a single comparison before any key is compared.
+	/// Inserting or erasing invalidates the iterators when the table is rehashed.
+	/// @tparam Key The type of the keys
+	/// @tparam Value The type of the values
+	/// @tparam Hash The hash function of the keys
+	/// @tparam KeyEqual The comparison of the keys (heterogeneous lookups are enabled if both Hash and KeyEqual are transparent)
+	/// @tparam Allocator The allocator policy used for the table
+	class map<Key, Value, Hash, KeyEqual, Allocator, NonThreadSafe>
+	{
+		/// @brief The type of the slots: the key is not const so that slots can be moved when rehashing,
+		/// but it is only exposed as const through value_type (as do the standard library maps)
+		using slot_type = std::pair<Key, Value>;
+		using group = details::control_group;
+
+		static_assert(std::is_nothrow_move_constructible_v<slot_type>, "vale::map requires keys and values with a noexcept move constructor!");
+		static_assert(std::is_nothrow_destructible_v<slot_type>, "vale::map requires keys and values with a noexcept destructor!");
+
+		/// @brief True if keys can be searched through other types
+		static constexpr bool is_transparent = details::is_transparent_lookup<Hash, KeyEqual>::value;
+		/// @brief The minimum number of slots of a table which allocated
+		static constexpr size_t min_slots = group::width < 16 ? 16 : group::width;
+
+		template<typename K>
+		/// @brief Returns 'key' if lookups are transparent (or if it is a Key), else a Key constructed from 'key'
+		static decltype(auto) to_lookup(const K& key)
+		{
+			if constexpr (is_transparent || std::is_same_v<K, Key>)
+				return (key);
+			else
+				return Key(key);
+		}
+
+		/// @brief The control bytes, followed by copies of the first group::width - 1 bytes so that groups can be loaded at any slot
+		int8_t* ctrl = nullptr;
+		/// @brief The slots
+		slot_type* slots = nullptr;
+		/// @brief The number of slots, which is 0 or a power of 2
+		size_t nb_slots = 0;
+		/// @brief The number of objects
+		size_t nb_elem = 0;
+		/// @brief The number of empty slots which can still be filled before rehashing
+		size_t growth_left = 0;
+		/// @brief The maximum ratio of filled (and erased) slots
+		float max_load = 0.875f;
+		/// @brief The hash function
+		Hash hasher;
+		/// @brief The comparison of the keys
+		KeyEqual equal;
+
+	public:
+		/// @brief The type of the objects of the map
+		using value_type = std::pair<const Key, Value>;
+
+		template<bool is_const>
+		/// @brief Forward iterator over the objects of the map, in no particular order
+		class basic_iterator
+		{
+			friend class map;
+
+			/// @brief The control byte of the current slot
+			const int8_t* current = nullptr;
+			/// @brief The current slot
+			slot_type* slot = nullptr;
+			/// @brief The control byte following the last slot
+			const int8_t* last = nullptr;
+
+			basic_iterator(const int8_t* current, slot_type* slot, const int8_t* last) noexcept
+				: current(current), slot(slot), last(last)
+			{
+				skip_empty();
+			}
+
+			/// @brief Advances to the next filled slot (or to the end)
+			void skip_empty() noexcept
+			{
+				while (current != last && *current < 0)
+				{
+					++current;
+					++slot;
+				}
+			}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::pair<const Key, Value>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<is_const, const value_type*, value_type*>;
+			using reference = std::conditional_t<is_const, const value_type&, value_type&>;
+
+			basic_iterator() noexcept = default;
+			/// @brief Converts an iterator to a const iterator
+			template<bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+			basic_iterator(const basic_iterator<other_const>& other) noexcept : current(other.current), slot(other.slot), last(other.last) {}
+
+			reference operator*() const noexcept { return *reinterpret_cast<pointer>(slot); }
+			pointer operator->() const noexcept { return reinterpret_cast<pointer>(slot); }
+
+			basic_iterator& operator++() noexcept
+			{
+				++current;
+				++slot;
+				skip_empty();
+				return *this;
+			}
+			basic_iterator operator++(int) noexcept { basic_iterator copy = *this; ++*this; return copy; }
+
+			friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept { return a.current == b.current; }
+			friend bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept { return a.current != b.current; }
+
+			template<bool>
+			friend class basic_iterator;
+		};
+
+		/// @brief Helper alias for iterators
+		using iterator = basic_iterator<false>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = basic_iterator<true>;
+
+		/******************************************
+		CONSTRUCTORS AND DESTRUCTOR
+		******************************************/
+
+		/// @brief Constructs an empty map, which does not allocate
+		map() noexcept = default;
+
+		/// @brief Constructs a map from an initializer list of key/value pairs (the first of equal keys is kept)
+		/// @param init The pairs to insert
+		map(std::initializer_list<std::pair<Key, Value>> init)
+		{
+			reserve(init.size());
+			for (const auto& [key, value] : init)
+				emplace(key, value);
+		}
+
+		/// @brief Copy constructor
+		/// @param to_copy The map to copy
+		map(const map& to_copy)
+			: max_load(to_copy.max_load), hasher(to_copy.hasher), equal(to_copy.equal)
+		{
+			reserve(to_copy.size());
+			for (const auto& [key, value] : to_copy)
+				emplace(key, value);
+		}
+
+		/// @brief Move constructor, which takes the table of 'to_move'
+		/// @param to_move The map to move, which becomes empty
+		map(map&& to_move) noexcept
+			: max_load(to_move.max_load), hasher(std::move(to_move.hasher)), equal(std::move(to_move.equal))
+		{
+			steal(to_move);
+		}
+
+		/// @brief Copy assignment operator
+		/// @param to_copy The map to copy
+		/// @return *this
+		map& operator=(const map& to_copy)
+		{
+			if (this != &to_copy)
+			{
+				map copy(to_copy);
+				*this = std::move(copy);
+			}
+			return *this;
+		}
+
+		/// @brief Move assignment operator
+		/// @param to_move The map to move, which becomes empty
+		/// @return *this
+		map& operator=(map&& to_move) noexcept
+		{
+			if (this != &to_move)
+			{
+				destroy_table();
+				max_load = to_move.max_load;
+				hasher = std::move(to_move.hasher);
+				equal = std::move(to_move.equal);
+				steal(to_move);
+			}
+			return *this;
+		}
+
+		/// @brief Destroys the objects, and frees the table
+		~map() noexcept { destroy_table(); }
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the number of objects in the map
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept { return nb_elem; }
+
+		/// @brief Returns the number of slots of the table
+		/// @return The number of slots
+		[[nodiscard]] size_t capacity() const noexcept { return nb_slots; }
+
+		/// @brief Check if the map is empty (contains 0 objects)
+		/// @return true if the map is empty
+		[[nodiscard]] bool is_empty() const noexcept { return nb_elem == 0; }
+
+		/// @brief Returns the ratio of the slots which contain an object
+		/// @return The load factor
+		[[nodiscard]] float load_factor() const noexcept { return nb_slots == 0 ? 0.0f : static_cast<float>(nb_elem) / nb_slots; }
+
+		/// @brief Returns the maximum ratio of the slots which contain an object or were erased, after which the table grows
+		/// @return The maximum load factor
+		[[nodiscard]] float max_load_factor() const noexcept { return max_load; }
+
+		/// @brief Sets the maximum load factor, or throws if it is not in [1 / 16, 1] (so that the smallest table can contain an object).
+		/// Higher load factors use less memory, but lookups compare more control bytes and keys.
+		/// @param load_factor The maximum load factor
+		void max_load_factor(float load_factor)
+		{
+			if (!(static_cast<double>(load_factor) * min_slots >= 1.0 && load_factor <= 1.0f))
+				throw std::invalid_argument("vale::map: max load factor should be in [1 / 16, 1]!");
+			max_load = load_factor;
+			size_t nb_deleted = 0;
+			for (size_t i = 0; i < nb_slots; i++)
+				nb_deleted += ctrl[i] == details::ctrl_deleted;
+			const size_t limit = growth_limit(nb_slots);
+			growth_left = limit > nb_elem + nb_deleted ? limit - nb_elem - nb_deleted : 0;
+		}
+
+		template<typename K>
+		/// @brief Returns an iterator to the object with key 'key'
+		/// @param key The key to search for
+		/// @return iterator to the object, or end() if there are none
+		[[nodiscard]] iterator find(const K& key) noexcept { return iterator_at(find_index(to_lookup(key))); }
+
+		template<typename K>
+		/// @brief Returns an iterator to the object with key 'key'
+		/// @param key The key to search for
+		/// @return const iterator to the object, or end() if there are none
+		[[nodiscard]] const_iterator find(const K& key) const noexcept { return const_cast<map*>(this)->find(key); }
+
+		template<typename K>
+		/// @brief Check if the map contains an object with key 'key'
+		/// @param key The key to search for
+		/// @return True if an object has key 'key'
+		[[nodiscard]] bool contains(const K& key) const noexcept { return find_index(to_lookup(key)) != nb_slots; }
+
+		template<typename K>
+		/// @brief Returns the value of the object with key 'key', or throws if there are none
+		/// @param key The key to search for
+		/// @return reference to the value
+		[[nodiscard]] Value& at(const K& key)
+		{
+			const size_t index = find_index(to_lookup(key));
+			if (index == nb_slots)
+				throw std::out_of_range("vale::map: key was not found!");
+			return slots[index].second;
+		}
+
+		template<typename K>
+		/// @brief Returns the value of the object with key 'key', or throws if there are none
+		/// @param key The key to search for
+		/// @return const reference to the value
+		[[nodiscard]] const Value& at(const K& key) const { return const_cast<map*>(this)->at(key); }
+
+		/// @brief Returns the value of the object with key 'key', inserting a default constructed value if there are none
+		/// @param key The key to search for
+		/// @return reference to the value
+		Value& operator[](const Key& key) { return emplace(key).first->second; }
+
+		/******************************************
+		ITERATORS
+		******************************************/
+
+		[[nodiscard]] iterator begin() noexcept { return iterator(ctrl, slots, ctrl + nb_slots); }
+		[[nodiscard]] iterator end() noexcept { return iterator(ctrl + nb_slots, slots + nb_slots, ctrl + nb_slots); }
+		[[nodiscard]] const_iterator begin() const noexcept { return const_cast<map*>(this)->begin(); }
+		[[nodiscard]] const_iterator end() const noexcept { return const_cast<map*>(this)->end(); }
+		[[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+		[[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		template<typename K, typename... Args>
+		/// @brief Constructs an object with key 'key' if there are none (the arguments are then not used)
+		/// @param key The key of the object, or (for heterogeneous lookups) an object from which the key is constructed
+		/// @param ...args The arguments to forward to the constructor of the value
+		/// @return iterator to the object with key 'key', and true if it was inserted
+		std::pair<iterator, bool> emplace(K&& key, Args&&... args)
+		{
+			const auto& lookup = to_lookup(key);
+			const uint64_t hash = details::mix_hash(hasher(lookup));
+			const size_t found = find_index(lookup, hash);
+			if (found != nb_slots)
+				return { iterator_at(found), false };
+			size_t index = find_first_non_full(hash);
+			if (nb_slots == 0 || (growth_left == 0 && ctrl[index] == details::ctrl_empty))
+			{
+				//Many erased slots: rehashing in place (at the same size) removes them
+				const size_t new_slots = nb_slots != 0 && nb_elem * 2 < growth_limit(nb_slots) ? nb_slots : std::max(nb_slots * 2, min_slots);
+				resize(slots_for(new_slots, nb_elem + 1));
+				index = find_first_non_full(hash);
+			}
+			new(slots + index) slot_type(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+			growth_left -= ctrl[index] == details::ctrl_empty;
+			set_ctrl(index, h2(hash));
+			++nb_elem;
+			return { iterator_at(index), true };
+		}
+
+		/// @brief Inserts a copy of 'value' with key 'key' if there are none
+		/// @param key The key of the object
+		/// @param value The value to copy
+		/// @return iterator to the object with key 'key', and true if it was inserted
+		std::pair<iterator, bool> insert(const Key& key, const Value& value) { return emplace(key, value); }
+
+		template<typename K, typename V>
+		/// @brief Inserts 'value' with key 'key', or assigns it to the value of the object with key 'key'
+		/// @param key The key of the object
+		/// @param value The value to insert or assign
+		/// @return iterator to the object with key 'key', and true if it was inserted
+		std::pair<iterator, bool> insert_or_assign(K&& key, V&& value)
+		{
+			auto result = emplace(std::forward<K>(key), std::forward<V>(value));
+			if (!result.second)
+				result.first->second = std::forward<V>(value);
+			return result;
+		}
+
+		template<typename K>
+		/// @brief Erases the object with key 'key'
+		/// @param key The key of the object to erase
+		/// @return True if an object was erased
+		bool erase(const K& key) noexcept
+		{
+			const size_t index = find_index(to_lookup(key));
+			if (index == nb_slots)
+				return false;
+			erase_at(index);
+			return true;
+		}
+
+		/// @brief Erases the object pointed to by an iterator, which should not be end().
+		/// Erasing never rehashes: the other iterators stay valid.
+		/// @param pos The iterator to the object to erase
+		void erase(const_iterator pos) noexcept { erase_at(static_cast<size_t>(pos.current - ctrl)); }
+
+		/// @brief Erases the object pointed to by an iterator, which should not be end().
+		/// Erasing never rehashes: the other iterators stay valid.
+		/// @param pos The iterator to the object to erase
+		void erase(iterator pos) noexcept { erase_at(static_cast<size_t>(pos.current - ctrl)); }
+
+		/// @brief Reserves enough slots to contain 'count' objects without rehashing
+		/// @param count The number of objects
+		void reserve(size_t count)
+		{
+			const size_t new_slots = slots_for(min_slots, count);
+			if (new_slots > nb_slots)
+				resize(new_slots);
+		}
+
+		/// @brief Destroys all the objects, keeping the table
+		void clear() noexcept
+		{
+			for (size_t i = 0; i < nb_slots; i++)
+			{
+				if (ctrl[i] >= 0)
+					slots[i].~slot_type();
+			}
+			if (nb_slots != 0)
+				std::memset(ctrl, static_cast<uint8_t>(details::ctrl_empty), nb_slots + group::width - 1);
+			nb_elem = 0;
+			growth_left = growth_limit(nb_slots);
+		}
+
+		/// @brief Prints the content of the map in 'os'
+		/// @param os The ostream in which to << the map's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (auto it = begin(); it != end(); ++it)
+			{
+				if (it != begin())
+					os << ", ";
+				os << it->first << ": " << it->second;
+			}
+			os << '}';
+		}
+
+	private:
+		/// @brief Returns the 7 bits of a hash stored in the control byte of its slot
+		static int8_t h2(uint64_t hash) noexcept { return static_cast<int8_t>(hash & 0x7F); }
+
+		/// @brief Returns the number of objects a table of 'slots' slots can contain before growing (at least one slot stays empty)
+		size_t growth_limit(size_t slots) const noexcept
+		{
+			const size_t limit = static_cast<size_t>(static_cast<double>(slots) * max_load);
+			return slots == 0 ? 0 : std::min(limit, slots - 1);
+		}
+
+		/// @brief Doubles a number of slots until a table of that many slots can contain 'count' objects,
+		/// or throws std::length_error if the table would be too large
+		size_t slots_for(size_t slots, size_t count) const
+		{
+			constexpr size_t max_slots = (size_t(-1) / 2) / (sizeof(slot_type) + 1);
+			while (growth_limit(slots) < count)
+			{
+				if (slots > max_slots)
+					throw std::length_error("vale::map: number of slots was greater than max_size()!");
+				slots *= 2;
+			}
+			return slots;
+		}
+
+		/// @brief Returns the number of bytes of the control bytes of a table, rounded up to the alignment of the slots
+		static size_t ctrl_bytes(size_t slots) noexcept
+		{
+			const size_t bytes = slots + group::width - 1;
+			return (bytes + alignof(slot_type) - 1) / alignof(slot_type) * alignof(slot_type);
+		}
+
+		/// @brief Returns the alignment of a table
+		static constexpr size_t table_alignment() noexcept { return alignof(slot_type) > 16 ? alignof(slot_type) : 16; }
+
+		/// @brief Returns an iterator to a slot, or end() if index is nb_slots
+		iterator iterator_at(size_t index) noexcept { return iterator(ctrl + index, slots + index, ctrl + nb_slots); }
+
+		/// @brief Sets the control byte of a slot, and its copy after the last slot
+		void set_ctrl(size_t index, int8_t value) noexcept
+		{
+			ctrl[index] = value;
+			if (index < group::width - 1)
+				ctrl[nb_slots + index] = value;
+		}
+
+		template<typename K>
+		/// @brief Returns the index of the slot containing 'key', or nb_slots if there are none
+		size_t find_index(const K& key) const noexcept { return find_index(key, details::mix_hash(hasher(key))); }
+
+		template<typename K>
+		/// @brief Returns the index of the slot containing 'key' whose mixed hash is 'hash', or nb_slots if there are none
+		size_t find_index(const K& key, uint64_t hash) const noexcept
+		{
+			if (nb_slots == 0)
+				return 0;
+			const size_t mask = nb_slots - 1;
+			size_t position = (hash >> 7) & mask;
+			size_t step = 0;
+			while (true)
+			{
+				const group candidates(ctrl + position);
+				for (auto matches = candidates.match(h2(hash)); matches != 0; matches &= matches - 1)
+				{
+					const size_t index = (position + details::lowest_match(matches)) & mask;
+					if (equal(slots[index].first, key))
+						return index;
+				}
+				if (candidates.match_empty() != 0)
+					return nb_slots;
+				//Triangular probing over groups visits every group of a power of 2 number of slots
+				step += group::width;
+				position = (position + step) & mask;
+			}
+		}
+
+		/// @brief Returns the first empty or erased slot of the probe sequence of 'hash' (or 0 if there are no slots)
+		size_t find_first_non_full(uint64_t hash) const noexcept
+		{
+			if (nb_slots == 0)
+				return 0;
+			const size_t mask = nb_slots - 1;
+			size_t position = (hash >> 7) & mask;
+			size_t step = 0;
+			while (true)
+			{
+				const auto free_slots = group(ctrl + position).match_empty_or_deleted();
+				if (free_slots != 0)
+					return (position + details::lowest_match(free_slots)) & mask;
+				step += group::width;
+				position = (position + step) & mask;
+			}
+		}
+
+		/// @brief Destroys the object of a slot, which becomes empty if no probe sequence went through it
+		/// while the group was full (an erased slot would then be needed so that the probing continues)
+		void erase_at(size_t index) noexcept
+		{
+			slots[index].~slot_type();
+			--nb_elem;
+			const size_t before = (index - group::width) & (nb_slots - 1);
+			const auto empty_after = group(ctrl + index).match_empty();
+			const auto empty_before = group(ctrl + before).match_empty();
+			//The slot was never in a full group if there is an empty slot less than a group away on each side
+			const bool never_full = empty_before != 0 && empty_after != 0
+				&& static_cast<size_t>(helpers::count_trailing_zeros(empty_after) >> group::mask_shift) + details::leading_non_matches(empty_before) < group::width;
+			set_ctrl(index, never_full ? details::ctrl_empty : details::ctrl_deleted);
+			growth_left += never_full;
+		}
+
+		/// @brief Moves the objects to a new table of 'new_slots' slots, dropping the erased slots
+		void resize(size_t new_slots)
+		{
+			const size_t new_ctrl_bytes = ctrl_bytes(new_slots);
+			unsigned char* memory = static_cast<unsigned char*>(Allocator::allocate(new_ctrl_bytes + new_slots * sizeof(slot_type), table_alignment()));
+			int8_t* old_ctrl = ctrl;
+			slot_type* old_slots = slots;
+			const size_t old_nb_slots = nb_slots;
+
+			ctrl = reinterpret_cast<int8_t*>(memory);
+			slots = reinterpret_cast<slot_type*>(memory + new_ctrl_bytes);
+			nb_slots = new_slots;
+			std::memset(ctrl, static_cast<uint8_t>(details::ctrl_empty), new_slots + group::width - 1);
+			for (size_t i = 0; i < old_nb_slots; i++)
+			{
+				if (old_ctrl[i] < 0)
+					continue;
+				const uint64_t hash = details::mix_hash(hasher(old_slots[i].first));
+				const size_t index = find_first_non_full(hash);
+				set_ctrl(index, h2(hash));
+				if constexpr (is_trivially_relocatable_v<Key> && is_trivially_relocatable_v<Value>)
+					std::memcpy(static_cast<void*>(slots + index), static_cast<const void*>(old_slots + i), sizeof(slot_type));
+				else
+				{
+					new(slots + index) slot_type(std::move(old_slots[i]));
+					old_slots[i].~slot_type();
+				}
+			}
+			growth_left = growth_limit(new_slots) - nb_elem;
+			if (old_nb_slots != 0)
+				Allocator::deallocate(old_ctrl, ctrl_bytes(old_nb_slots) + old_nb_slots * sizeof(slot_type), table_alignment());
+		}
+
+		/// @brief Destroys the objects, and frees the table
+		void destroy_table() noexcept
+		{
+			clear();
+			if (nb_slots != 0)
+				Allocator::deallocate(ctrl, ctrl_bytes(nb_slots) + nb_slots * sizeof(slot_type), table_alignment());
+			ctrl = nullptr;
+			slots = nullptr;
+			nb_slots = 0;
+			growth_left = 0;
+		}
+
+		/// @brief Takes the table of another map, leaving it empty
+		void steal(map& other) noexcept
+		{
+			ctrl = std::exchange(other.ctrl, nullptr);
+			slots = std::exchange(other.slots, nullptr);
+			nb_slots = std::exchange(other.nb_slots, 0);
+			nb_elem = std::exchange(other.nb_elem, 0);
+			growth_left = std::exchange(other.growth_left, 0);
+		}
+	};
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+	/// @brief A thread safe unordered map, split in shards chosen by the hash of the keys.
+	/// Each shard is on its own cache lines, and has its own mutex, which is only locked to modify the shard.
+	/// Lookups never lock: the slots of a shard are atomic pointers to immutable nodes, so a lookup
+	/// reads a consistent key and value even while a writer replaces them. Replaced nodes and tables
+	/// are freed through epoch-based reclamation, once no lookup can still be reading them.
+	/// Values are modified by replacing their node: update() and insert_or_assign() need no external locking.
+	/// Like a 'ts_static_vector', a 'ts_map' does not provide an iterator interface.
+	/// @tparam Key The type of the keys
+	/// @tparam Value The type of the values
+	/// @tparam Hash The hash function of the keys
+	/// @tparam KeyEqual The comparison of the keys (heterogeneous lookups are enabled if both Hash and KeyEqual are transparent)
+	/// @tparam Allocator The allocator policy used for the nodes
+	class map<Key, Value, Hash, KeyEqual, Allocator, ThreadSafe>
+	{
+		/// @brief log2 of the number of shards
+		static constexpr size_t shard_bits = 6;
+		/// @brief The number of shards
+		static constexpr size_t nb_shards = size_t(1) << shard_bits;
+		/// @brief The initial number of slots of the table of a shard
+		static constexpr size_t initial_table_capacity = 16;
+		/// @brief The number of low bits of a slot storing the pointer to its node, the high bits storing bits of its hash.
+		/// On 64-bit platforms, this assumes that the high 16 bits of the nodes' addresses are 0 (user-space addresses
+		/// have 48 bits on x86-64 and AArch64), which is asserted in debug builds when a node is stored in a slot.
+		static constexpr unsigned pointer_bits = sizeof(void*) == 8 ? 48 : 32;
+		/// @brief The mask of the pointer of a slot
+		static constexpr uint64_t pointer_mask = (uint64_t(1) << pointer_bits) - 1;
+		/// @brief The value of a slot whose node was erased (which, unlike an empty slot, does not stop probing)
+		static constexpr uint64_t tombstone = 1;
+
+		/// @brief True if keys can be searched through other types
+		static constexpr bool is_transparent = details::is_transparent_lookup<Hash, KeyEqual>::value;
+
+		/// @brief A key and its value, which are never modified once the node is in a table
+		struct node
+		{
+			/// @brief The key
+			const Key key;
+			/// @brief The value
+			const Value value;
+		};
+
+		/// @brief A table of slots: 0 (empty), tombstone, or a pointer to a node tagged with bits of its hash
+		struct slot_table
+		{
+			/// @brief The number of slots, which is a power of 2
+			size_t capacity;
+
+			/// @brief Returns the slots, which follow the table in memory
+			std::atomic<uint64_t>* slots() noexcept
+			{
+				return std::launder(reinterpret_cast<std::atomic<uint64_t>*>(reinterpret_cast<unsigned char*>(this) + slots_offset));
+			}
+		};
+
+		/// @brief The offset of the slots of a table
+		static constexpr size_t slots_offset = (sizeof(slot_table) + alignof(std::atomic<uint64_t>) - 1) / alignof(std::atomic<uint64_t>) * alignof(std::atomic<uint64_t>);
+
+		/// @brief A shard of the map, on its own cache lines
+		struct alignas(cache_line_size) map_shard
+		{
+			/// @brief The current table, read without locking
+			std::atomic<slot_table*> table{ nullptr };
+			/// @brief The number of objects of the shard
+			std::atomic<size_t> nb_elem{ 0 };
+			/// @brief The number of slots which are not empty (objects and tombstones), only accessed when locked
+			size_t nb_used = 0;
+			/// @brief Mutex locked while modifying the shard
+			mutable std::mutex mutex;
+		};
+
+		/// @brief The shards
+		map_shard shards[nb_shards];
+		/// @brief The hash function
+		Hash hasher;
+		/// @brief The comparison of the keys
+		KeyEqual equal;
+
+	public:
+		/// @brief The type of the objects of the map
+		using value_type = std::pair<const Key, Value>;
+
+		/// @brief Constructs an empty map
+		map()
+		{
+			for (auto& shard : shards)
+				shard.table.store(allocate_table(initial_table_capacity), std::memory_order_release);
+		}
+
+		map(const map&) = delete;
+		map& operator=(const map&) = delete;
+
+		/// @brief Destroys the objects, and frees the tables: no other thread should still use the map
+		~map() noexcept
+		{
+			for (auto& shard : shards)
+			{
+				slot_table* table = shard.table.load(std::memory_order_acquire);
+				for (size_t i = 0; i < table->capacity; i++)
+				{
+					const uint64_t slot = table->slots()[i].load(std::memory_order_relaxed);
+					if (slot != 0 && slot != tombstone)
+						destroy_node(node_of(slot));
+				}
+				free_table(table);
+			}
+		}
+
+		/// @brief Returns the number of objects in the map, which may already be outdated
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept
+		{
+			size_t result = 0;
+			for (const auto& shard : shards)
+				result += shard.nb_elem.load(std::memory_order_relaxed);
+			return result;
+		}
+
+		/// @brief Check if the map is empty, which may already be outdated
+		/// @return true if the map is empty
+		[[nodiscard]] bool is_empty() const noexcept { return size() == 0; }
+
+		template<typename K>
+		/// @brief Check if the map contains an object with key 'key', without locking
+		/// @param key The key to search for
+		/// @return True if an object has key 'key'
+		[[nodiscard]] bool contains(const K& key) const
+		{
+			const auto& lookup = to_lookup(key);
+			const uint64_t hash = details::mix_hash(hasher(lookup));
+			details::epoch_guard guard;
+			return find_node(shard_of(hash), hash, lookup) != nullptr;
+		}
+
+		template<typename K>
+		/// @brief Copies the value of the object with key 'key' into 'out', without locking
+		/// @param key The key to search for
+		/// @param out The value in which to copy the value
+		/// @return True if an object has key 'key' (else 'out' is not modified)
+		bool try_get(const K& key, Value& out) const
+		{
+			const auto& lookup = to_lookup(key);
+			const uint64_t hash = details::mix_hash(hasher(lookup));
+			details::epoch_guard guard;
+			if (const node* found = find_node(shard_of(hash), hash, lookup))
+			{
+				out = found->value;
+				return true;
+			}
+			return false;
+		}
+
+		template<typename K, typename... Args>
+		/// @brief Constructs an object with key 'key' if there are none
+		/// @param key The key of the object
+		/// @param ...args The arguments to forward to the constructor of the value
+		/// @return True if the object was inserted
+		bool emplace(K&& key, Args&&... args)
+		{
+			const auto& lookup = to_lookup(key);
+			const uint64_t hash = details::mix_hash(hasher(lookup));
+			map_shard& shard = shard_of(hash);
+			details::epoch_guard guard;
+			std::scoped_lock lock{ shard.mutex };
+			if (probe(shard, hash, lookup) != nullptr)
+				return false;
+			publish(shard, hash, create_node(std::forward<K>(key), std::forward<Args>(args)...), guard);
+			return true;
+		}
+
+		/// @brief Inserts a copy of 'value' with key 'key' if there are none
+		/// @param key The key of the object
+		/// @param value The value to copy
+		/// @return True if the object was inserted
+		bool insert(const Key& key, const Value& value) { return emplace(key, value); }
+
+		template<typename K, typename V>
+		/// @brief Inserts 'value' with key 'key', or replaces the value of the object with key 'key'
+		/// @param key The key of the object
+		/// @param value The value to insert or assign
+		/// @return True if the object was inserted, false if its value was replaced
+		bool insert_or_assign(K&& key, V&& value)
+		{
+			const auto& lookup = to_lookup(key);
+			const uint64_t hash = details::mix_hash(hasher(lookup));
+			map_shard& shard = shard_of(hash);
+			details::epoch_guard guard;
+			std::scoped_lock lock{ shard.mutex };
+			if (std::atomic<uint64_t>* slot = probe(shard, hash, lookup))
+			{
+				replace(*slot, create_node(node_of(slot->load(std::memory_order_relaxed))->key, std::forward<V>(value)), guard);
+				return false;
+			}
+			publish(shard, hash, create_node(std::forward<K>(key), std::forward<V>(value)), guard);
+			return true;
+		}
+
+		template<typename K, typename Func>
+		/// @brief Calls 'func' on a copy of the value of the object with key 'key', which then replaces the value.
+		/// Updates of the same key are serialized, and lookups read either the previous or the updated value.
+		/// @param key The key of the object to update
+		/// @param func The function to call with a reference to the copy of the value
+		/// @return True if an object has key 'key' (else 'func' is not called)
+		bool update(const K& key, Func&& func)
+		{
+			const auto& lookup = to_lookup(key);
+			const uint64_t hash = details::mix_hash(hasher(lookup));
+			map_shard& shard = shard_of(hash);
+			details::epoch_guard guard;
+			std::scoped_lock lock{ shard.mutex };
+			std::atomic<uint64_t>* slot = probe(shard, hash, lookup);
+			if (slot == nullptr)
+				return false;
+			const node* current = node_of(slot->load(std::memory_order_relaxed));
+			Value updated = current->value;
+			func(updated);
+			replace(*slot, create_node(current->key, std::move(updated)), guard);
+			return true;
+		}
+
+		template<typename K>
+		/// @brief Erases the object with key 'key'
+		/// @param key The key of the object to erase
+		/// @return True if an object was erased
+		bool erase(const K& key)
+		{
+			const auto& lookup = to_lookup(key);
+			const uint64_t hash = details::mix_hash(hasher(lookup));
+			map_shard& shard = shard_of(hash);
+			details::epoch_guard guard;
+			std::scoped_lock lock{ shard.mutex };
+			std::atomic<uint64_t>* slot = probe(shard, hash, lookup);
+			if (slot == nullptr)
+				return false;
+			node* erased = node_of(slot->load(std::memory_order_relaxed));
+			slot->store(tombstone, std::memory_order_release);
+			shard.nb_elem.fetch_sub(1, std::memory_order_relaxed);
+			retire(guard, erased, &destroy_node_erased);
+			return true;
+		}
+
+		template<typename Func>
+		/// @brief Calls 'func' on each object, in no particular order, without locking.
+		/// Objects inserted, replaced or erased during the call may or may not be visited.
+		/// @param func The function to call with the key and the (const) value of the objects
+		void for_each(Func&& func) const
+		{
+			details::epoch_guard guard;
+			for (const auto& shard : shards)
+			{
+				slot_table* table = shard.table.load(std::memory_order_acquire);
+				for (size_t i = 0; i < table->capacity; i++)
+				{
+					const uint64_t slot = table->slots()[i].load(std::memory_order_acquire);
+					if (slot != 0 && slot != tombstone)
+						func(node_of(slot)->key, node_of(slot)->value);
+				}
+			}
+		}
+
+		/// @brief Prints the content of the map in 'os'
+		/// @param os The ostream in which to << the map's content
+		inline void print(std::ostream& os) const
+		{
+			bool first = true;
+			os << "{";
+			for_each([&](const Key& key, const Value& value) {
+				if (!first)
+					os << ", ";
+				first = false;
+				os << key << ": " << value;
+			});
+			os << '}';
+		}
+
+	private:
+		template<typename K>
+		/// @brief Returns 'key' if lookups are transparent (or if it is a Key), else a Key constructed from 'key'
+		static decltype(auto) to_lookup(const K& key)
+		{
+			if constexpr (is_transparent || std::is_same_v<K, Key>)
+				return (key);
+			else
+				return Key(key);
+		}
+
+		/// @brief Returns the shard of a hash (its high bits, as its low bits index the slots)
+		map_shard& shard_of(uint64_t hash) const noexcept { return const_cast<map_shard&>(shards[hash >> (64 - shard_bits)]); }
+
+		/// @brief Returns the bits of a hash stored in the slot of its node (which are neither the bits of its shard nor of its index)
+		static uint64_t tag_of(uint64_t hash) noexcept { return (hash >> 32) << pointer_bits; }
+
+		/// @brief Returns the node of a slot
+		static node* node_of(uint64_t slot) noexcept { return reinterpret_cast<node*>(static_cast<uintptr_t>(slot & pointer_mask)); }
+
+		/// @brief Returns the slot of a node, whose high bits store 'tag'
+		static uint64_t slot_of(uint64_t tag, const node* stored) noexcept
+		{
+			const uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(stored));
+			assert((address & ~pointer_mask) == 0 && "vale::ts_map: the high bits of the address of a node were used!");
+			return tag | address;
+		}
+
+		template<typename K, typename V>
+		/// @brief Allocates and constructs a node
+		static node* create_node(K&& key, V&& value)
+		{
+			void* memory = Allocator::allocate(sizeof(node), alignof(node));
+			try
+			{
+				return new(memory) node{ Key(std::forward<K>(key)), Value(std::forward<V>(value)) };
+			}
+			catch (...)
+			{
+				Allocator::deallocate(memory, sizeof(node), alignof(node));
+				throw;
+			}
+		}
+
+		template<typename K, typename V0, typename V1, typename... Args>
+		/// @brief Allocates and constructs a node, whose value is constructed from several arguments
+		static node* create_node(K&& key, V0&& arg0, V1&& arg1, Args&&... args)
+		{
+			return create_node(std::forward<K>(key), Value(std::forward<V0>(arg0), std::forward<V1>(arg1), std::forward<Args>(args)...));
+		}
+
+		template<typename K>
+		/// @brief Allocates and constructs a node, whose value is default constructed
+		static node* create_node(K&& key) { return create_node(std::forward<K>(key), Value()); }
+
+		/// @brief Destroys and frees a node
+		static void destroy_node(node* to_free) noexcept
+		{
+			to_free->~node();
+			Allocator::deallocate(to_free, sizeof(node), alignof(node));
+		}
+
+		/// @brief destroy_node() for the epoch-based reclamation
+		static void destroy_node_erased(void* to_free) noexcept { destroy_node(static_cast<node*>(to_free)); }
+
+		/// @brief Frees an unreachable node or table once no lookup can still read it.
+		/// If the retired list cannot grow, the object is leaked rather than freed unsafely:
+		/// the modification which made it unreachable has already been published.
+		static void retire(details::epoch_guard& guard, void* object, void(*deleter)(void*) noexcept) noexcept
+		{
+			try
+			{
+				guard.retire(object, deleter);
+			}
+			catch (...)
+			{
+			}
+		}
+
+		/// @brief The alignment of the tables
+		static constexpr size_t table_alignment = alignof(slot_table) > alignof(std::atomic<uint64_t>) ? alignof(slot_table) : alignof(std::atomic<uint64_t>);
+
+		/// @brief Returns the number of bytes of a table of 'capacity' slots
+		static constexpr size_t table_bytes(size_t capacity) noexcept { return slots_offset + capacity * sizeof(std::atomic<uint64_t>); }
+
+		/// @brief Allocates a table of empty slots
+		static slot_table* allocate_table(size_t capacity)
+		{
+			void* memory = Allocator::allocate(table_bytes(capacity), table_alignment);
+			slot_table* table = new(memory) slot_table{ capacity };
+			for (size_t i = 0; i < capacity; i++)
+				new(table->slots() + i) std::atomic<uint64_t>(0);
+			return table;
+		}
+
+		/// @brief Frees a table (but not its nodes)
+		static void free_table(void* table) noexcept
+		{
+			const size_t capacity = static_cast<slot_table*>(table)->capacity;
+			Allocator::deallocate(table, table_bytes(capacity), table_alignment);
+		}
+
+		template<typename K>
+		/// @brief Searches the current table of a shard for a key, without locking
+		const node* find_node(const map_shard& shard, uint64_t hash, const K& key) const noexcept
+		{
+			slot_table* table = shard.table.load(std::memory_order_acquire);
+			std::atomic<uint64_t>* slots = table->slots();
+			const uint64_t tag = tag_of(hash);
+			for (size_t i = hash & (table->capacity - 1);; i = (i + 1) & (table->capacity - 1))
+			{
+				const uint64_t slot = slots[i].load(std::memory_order_acquire);
+				if (slot == 0)
+					return nullptr;
+				if ((slot & ~pointer_mask) != tag || slot == tombstone)
+					continue;
+				const node* found = node_of(slot);
+				if (equal(found->key, key))
+					return found;
+			}
+		}
+
+		template<typename K>
+		/// @brief Returns the slot containing a key, or nullptr. The shard should be locked.
+		std::atomic<uint64_t>* probe(map_shard& shard, uint64_t hash, const K& key) noexcept
+		{
+			slot_table* table = shard.table.load(std::memory_order_relaxed);
+			std::atomic<uint64_t>* slots = table->slots();
+			const uint64_t tag = tag_of(hash);
+			for (size_t i = hash & (table->capacity - 1);; i = (i + 1) & (table->capacity - 1))
+			{
+				const uint64_t slot = slots[i].load(std::memory_order_relaxed);
+				if (slot == 0)
+					return nullptr;
+				if ((slot & ~pointer_mask) == tag && slot != tombstone && equal(node_of(slot)->key, key))
+					return slots + i;
+			}
+		}
+
+		/// @brief Replaces the node of a slot, retiring the previous node. The shard should be locked.
+		static void replace(std::atomic<uint64_t>& slot, node* replacement, details::epoch_guard& guard) noexcept
+		{
+			const uint64_t previous = slot.load(std::memory_order_relaxed);
+			slot.store(slot_of(previous & ~pointer_mask, replacement), std::memory_order_release);
+			retire(guard, node_of(previous), &destroy_node_erased);
+		}
+
+		/// @brief Inserts a node which is not in the shard, growing its table if needed. The shard should be locked.
+		void publish(map_shard& shard, uint64_t hash, node* inserted, details::epoch_guard& guard)
+		{
+			slot_table* table = shard.table.load(std::memory_order_relaxed);
+			//Rehashes when 3/4 of the slots are used: in place (dropping tombstones) if they are at most half full of objects
+			if ((shard.nb_used + 1) * 4 > table->capacity * 3)
+			{
+				const size_t nb_elem = shard.nb_elem.load(std::memory_order_relaxed);
+				const size_t capacity = (nb_elem + 1) * 2 > table->capacity ? table->capacity * 2 : table->capacity;
+				slot_table* grown;
+				try
+				{
+					grown = allocate_table(capacity);
+				}
+				catch (...)
+				{
+					destroy_node(inserted);
+					throw;
+				}
+				for (size_t i = 0; i < table->capacity; i++)
+				{
+					const uint64_t slot = table->slots()[i].load(std::memory_order_relaxed);
+					if (slot == 0 || slot == tombstone)
+						continue;
+					const uint64_t slot_hash = details::mix_hash(hasher(node_of(slot)->key));
+					size_t index = slot_hash & (capacity - 1);
+					while (grown->slots()[index].load(std::memory_order_relaxed) != 0)
+						index = (index + 1) & (capacity - 1);
+					grown->slots()[index].store(slot, std::memory_order_relaxed);
+				}
+				shard.table.store(grown, std::memory_order_release);
+				shard.nb_used = nb_elem;
+				//Lookups may still be probing the previous table: it is freed once they are done
+				retire(guard, table, &free_table);
+				table = grown;
+			}
+			size_t index = hash & (table->capacity - 1);
+			std::atomic<uint64_t>* slots = table->slots();
+			while (true)
+			{
+				const uint64_t slot = slots[index].load(std::memory_order_relaxed);
+				if (slot == 0 || slot == tombstone)
+				{
+					shard.nb_used += slot == 0;
+					break;
+				}
+				index = (index + 1) & (table->capacity - 1);
+			}
+			slots[index].store(slot_of(tag_of(hash), inserted), std::memory_order_release);
+			shard.nb_elem.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	template<typename Key, typename Value, typename Hash = transparent_hash, typename KeyEqual = std::equal_to<>, typename Allocator = heap_allocator>
+	/// @brief Helper alias for a thread safe hash map
+	using ts_map = map<Key, Value, Hash, KeyEqual, Allocator, ThreadSafe>;
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename ThreadSafety>
+	/// @brief writes the content of the map between '{}', separating the objects by ','.
+	static std::ostream& operator<<(std::ostream& os, const map<Key, Value, Hash, KeyEqual, Allocator, ThreadSafety>& var)
+	{
+		var.print(os);
+		return os;
+	}
+
+	/******************************************
+	B-TREE
+	******************************************/
+
+	namespace details
+	{
+		template<typename Key, typename Compare, typename K>
+		/// @brief True if the keys of a B-tree node can be compared to a 'K' 16 bytes at a time through SSE2
+		inline constexpr bool is_simd_searchable_v =
+#if defined(__SSE2__) || defined(_M_X64)
+			std::is_same_v<Key, K>
+			&& (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<Key>>)
+			&& ((std::is_integral_v<Key> && !std::is_same_v<Key, bool> && (sizeof(Key) == 4 || sizeof(Key) == 8))
+				|| std::is_same_v<Key, float> || std::is_same_v<Key, double>);
+#else
+			false;
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+		template<bool is_unsigned>
+		/// @brief Returns the 64-bit lanes of 'a' less than the lanes of 'b' (SSE2 can only compare 32-bit integers)
+		inline __m128i less_epi64(__m128i a, __m128i b) noexcept
+		{
+			//Flipping the sign bits compares the low halves (and the high halves of unsigned integers) as unsigned integers
+			const __m128i bias = is_unsigned ? _mm_set1_epi32(INT32_MIN) : _mm_set_epi32(0, INT32_MIN, 0, INT32_MIN);
+			a = _mm_xor_si128(a, bias);
+			b = _mm_xor_si128(b, bias);
+			const __m128i less = _mm_cmplt_epi32(a, b);
+			const __m128i equal = _mm_cmpeq_epi32(a, b);
+			//A lane is less if its high half is less, or equal with a lower low half
+			return _mm_or_si128(less, _mm_and_si128(equal, _mm_shuffle_epi32(less, _MM_SHUFFLE(2, 2, 0, 0))));
+		}
+
+		template<bool upper, typename Key>
+		/// @brief Returns a mask whose bit i is set if the key i of a block of 16 bytes precedes 'key' (if 'upper', does not follow 'key')
+		inline unsigned simd_rank_mask(const Key* keys, Key key) noexcept
+		{
+			if constexpr (std::is_same_v<Key, float>)
+			{
+				const __m128 block = _mm_loadu_ps(keys);
+				const __m128 value = _mm_set1_ps(key);
+				return static_cast<unsigned>(_mm_movemask_ps(upper ? _mm_cmpnlt_ps(value, block) : _mm_cmplt_ps(block, value)));
+			}
+			else if constexpr (std::is_same_v<Key, double>)
+			{
+				const __m128d block = _mm_loadu_pd(keys);
+				const __m128d value = _mm_set1_pd(key);
+				return static_cast<unsigned>(_mm_movemask_pd(upper ? _mm_cmpnlt_pd(value, block) : _mm_cmplt_pd(block, value)));
+			}
+			else if constexpr (sizeof(Key) == 4)
+			{
+				const __m128i bias = _mm_set1_epi32(std::is_signed_v<Key> ? 0 : INT32_MIN);
+				const __m128i block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)), bias);
+				const __m128i value = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(key)), bias);
+				if constexpr (upper)
+					return 0xF ^ static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(value, block))));
+				else
+					return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(block, value))));
+			}
+			else
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+				const __m128i value = _mm_set1_epi64x(static_cast<int64_t>(key));
+				if constexpr (upper)
+					return 0x3 ^ static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(less_epi64<std::is_unsigned_v<Key>>(value, block))));
+				else
+					return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(less_epi64<std::is_unsigned_v<Key>>(block, value))));
+			}
+		}
+
+		template<bool upper, typename Key>
+		/// @brief Linear scan of sorted keys, comparing 16 bytes of keys at once
+		inline size_t simd_rank(const Key* keys, size_t count, Key key) noexcept
+		{
+			constexpr size_t lanes = 16 / sizeof(Key);
+			constexpr unsigned all_lanes = (1u << lanes) - 1;
+			size_t index = 0;
+			for (; index + lanes <= count; index += lanes)
+			{
+				//The keys are sorted: if some keys of the block do not match, the matching keys are a prefix of the block
+				const unsigned mask = simd_rank_mask<upper>(keys + index, key);
+				if (mask != all_lanes)
+					return index + static_cast<size_t>(helpers::popcount(mask));
+			}
+			while (index < count && (upper ? !(key < keys[index]) : keys[index] < key))
+				index++;
+			return index;
+		}
+#endif
+
+		template<bool upper, typename Key, typename Compare, typename K>
+		/// @brief Returns the number of sorted keys preceding 'key' (if 'upper', not following 'key').
+		/// Arithmetic keys compared through std::less are scanned linearly 16 bytes at a time, other keys are binary searched.
+		/// @param keys The sorted keys
+		/// @param count The number of keys
+		/// @param key The key to search for
+		/// @param comp The comparison of the keys
+		/// @return The index of the first key not preceding 'key' (if 'upper', following 'key')
+		inline size_t node_rank(const Key* keys, size_t count, const K& key, const Compare& comp)
+		{
+#if defined(__SSE2__) || defined(_M_X64)
+			if constexpr (is_simd_searchable_v<Key, Compare, K>)
+				return simd_rank<upper>(keys, count, key);
+#endif
+			if constexpr (upper)
+				return static_cast<size_t>(std::upper_bound(keys, keys + count, key, comp) - keys);
+			else
+				return static_cast<size_t>(std::lower_bound(keys, keys + count, key, comp) - keys);
+		}
+
+		/// @brief Returns the end of a B-tree node whose 'capacity' keys start at 'keys_offset',
+		/// followed by 'capacity + extra' objects of another array (the values of a leaf, or the children of an inner node)
+		inline constexpr size_t btree_node_end(size_t keys_offset, size_t key_size, size_t other_alignment, size_t other_size, size_t capacity, size_t extra) noexcept
+		{
+			const size_t keys_end = keys_offset + capacity * key_size;
+			return (keys_end + other_alignment - 1) / other_alignment * other_alignment + (capacity + extra) * other_size;
+		}
+
+		/// @brief Returns the number of keys (at least 4) fitting in a B-tree node of 'node_size' bytes
+		inline constexpr size_t btree_node_capacity(size_t node_size, size_t keys_offset, size_t key_size, size_t other_alignment, size_t other_size, size_t extra) noexcept
+		{
+			size_t capacity = 4;
+			while (btree_node_end(keys_offset, key_size, other_alignment, other_size, capacity + 1, extra) <= node_size)
+				capacity++;
+			return capacity;
+		}
+
+		template<typename Key, typename Value, typename Compare, typename Allocator, size_t node_cache_lines>
+		/// @brief The B+ tree shared by btree_map and btree_set (whose Value is void).
+		/// The objects are stored in the leaves, which are linked in the order of their keys,
+		/// and the inner nodes only store the keys separating their children.
+		/// The keys of a node are contiguous and followed by its values, so that searching a node only reads its keys.
+		class btree
+		{
+		public:
+			/// @brief True if the objects have a value (false for btree_set)
+			static constexpr bool has_values = !std::is_void_v<Value>;
+			/// @brief The type of the values (never constructed for btree_set)
+			using mapped_type = std::conditional_t<has_values, Value, char>;
+
+			/// @brief The header of the nodes
+			struct node_base
+			{
+				/// @brief The number of keys of the node
+				uint32_t count;
+				/// @brief True if the node is a leaf
+				bool is_leaf;
+			};
+
+			/// @brief The header of a leaf, followed by its keys and values
+			struct leaf_node : node_base
+			{
+				/// @brief The next leaf, in the order of the keys
+				leaf_node* next;
+			};
+
+			/// @brief The header of an inner node, followed by its keys and its children
+			struct inner_node : node_base {};
+
+			/// @brief The position of an object, whose leaf is nullptr for the end position
+			struct position
+			{
+				leaf_node* leaf = nullptr;
+				size_t index = 0;
+			};
+
+		private:
+			/// @brief The size targeted for the nodes
+			static constexpr size_t node_size = node_cache_lines * cache_line_size;
+
+			static constexpr size_t leaf_keys_offset = (sizeof(leaf_node) + alignof(Key) - 1) / alignof(Key) * alignof(Key);
+			static constexpr size_t inner_keys_offset = (sizeof(inner_node) + alignof(Key) - 1) / alignof(Key) * alignof(Key);
+
+		public:
+			/// @brief The maximum number of objects of a leaf
+			static constexpr size_t leaf_capacity = btree_node_capacity(node_size, leaf_keys_offset, sizeof(Key),
+				alignof(mapped_type), has_values ? sizeof(mapped_type) : 0, 0);
+			/// @brief The maximum number of keys of an inner node (which has one more child)
+			static constexpr size_t inner_capacity = btree_node_capacity(node_size, inner_keys_offset, sizeof(Key),
+				alignof(node_base*), sizeof(node_base*), 1);
+			/// @brief The size of a leaf: 'node_cache_lines' cache lines, unless 4 objects do not fit in them
+			static constexpr size_t leaf_size = (btree_node_end(leaf_keys_offset, sizeof(Key), alignof(mapped_type), has_values ? sizeof(mapped_type) : 0, leaf_capacity, 0)
+				+ cache_line_size - 1) / cache_line_size * cache_line_size;
+			/// @brief The size of an inner node: 'node_cache_lines' cache lines, unless 4 keys do not fit in them
+			static constexpr size_t inner_size = (btree_node_end(inner_keys_offset, sizeof(Key), alignof(node_base*), sizeof(node_base*), inner_capacity, 1)
+				+ cache_line_size - 1) / cache_line_size * cache_line_size;
+
+		private:
+			/// @brief The offset of the values of a leaf
+			static constexpr size_t leaf_values_offset = (leaf_keys_offset + leaf_capacity * sizeof(Key) + alignof(mapped_type) - 1) / alignof(mapped_type) * alignof(mapped_type);
+			/// @brief The offset of the children of an inner node
+			static constexpr size_t inner_children_offset = (inner_keys_offset + inner_capacity * sizeof(Key) + alignof(node_base*) - 1) / alignof(node_base*) * alignof(node_base*);
+
+		private:
+			/// @brief The minimum number of objects of a leaf which is not the root
+			static constexpr size_t leaf_min = leaf_capacity / 2;
+			/// @brief The minimum number of keys of an inner node which is not the root
+			static constexpr size_t inner_min = inner_capacity / 2;
+			/// @brief The maximum depth of a tree, whose inner nodes have at least 3 children
+			static constexpr size_t max_depth = 48;
+
+			/// @brief The root, or nullptr if the tree is empty
+			node_base* root = nullptr;
+			/// @brief The first leaf, or nullptr if the tree is empty
+			leaf_node* head = nullptr;
+			/// @brief The number of objects
+			size_t nb_elem = 0;
+			/// @brief The comparison of the keys
+			Compare comp;
+
+		public:
+			btree() noexcept = default;
+
+			btree(btree&& to_move) noexcept
+				: root(std::exchange(to_move.root, nullptr)), head(std::exchange(to_move.head, nullptr))
+				, nb_elem(std::exchange(to_move.nb_elem, 0)), comp(std::move(to_move.comp)) {}
+
+			btree& operator=(btree&& to_move) noexcept
+			{
+				std::swap(root, to_move.root);
+				std::swap(head, to_move.head);
+				std::swap(nb_elem, to_move.nb_elem);
+				std::swap(comp, to_move.comp);
+				return *this;
+			}
+
+			~btree() noexcept { clear(); }
+
+			/// @brief Returns the keys of a leaf
+			static Key* keys_of(const leaf_node* leaf) noexcept
+			{
+				return reinterpret_cast<Key*>(const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(leaf)) + leaf_keys_offset);
+			}
+			/// @brief Returns the values of a leaf (nullptr for btree_set)
+			static mapped_type* values_of(const leaf_node* leaf) noexcept
+			{
+				if constexpr (has_values)
+					return reinterpret_cast<mapped_type*>(const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(leaf)) + leaf_values_offset);
+				else
+					return nullptr;
+			}
+			/// @brief Returns the keys of an inner node
+			static Key* keys_of(const inner_node* inner) noexcept
+			{
+				return reinterpret_cast<Key*>(const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(inner)) + inner_keys_offset);
+			}
+			/// @brief Returns the children of an inner node
+			static node_base** children_of(const inner_node* inner) noexcept
+			{
+				return reinterpret_cast<node_base**>(const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(inner)) + inner_children_offset);
+			}
+
+			/// @brief Moves a position to the following object
+			static void advance(position& pos) noexcept
+			{
+				if (++pos.index == pos.leaf->count)
+				{
+					pos.leaf = pos.leaf->next;
+					pos.index = 0;
+				}
+			}
+
+			[[nodiscard]] size_t size() const noexcept { return nb_elem; }
+			[[nodiscard]] const Compare& key_comp() const noexcept { return comp; }
+			/// @brief Returns the position of the first object
+			[[nodiscard]] position first() const noexcept { return { head, 0 }; }
+
+			template<typename K>
+			/// @brief Returns the position of the first object whose key is not less than 'key'
+			[[nodiscard]] position lower_bound(const K& key) const
+			{
+				if (root == nullptr)
+					return {};
+				leaf_node* leaf = leaf_of(key);
+				return normalize(leaf, node_rank<false>(keys_of(leaf), leaf->count, key, comp));
+			}
+
+			template<typename K>
+			/// @brief Returns the position of the first object whose key is greater than 'key'
+			[[nodiscard]] position upper_bound(const K& key) const
+			{
+				if (root == nullptr)
+					return {};
+				leaf_node* leaf = leaf_of(key);
+				return normalize(leaf, node_rank<true>(keys_of(leaf), leaf->count, key, comp));
+			}
+
+			template<typename K>
+			/// @brief Returns the position of the object with key 'key', or the end position
+			[[nodiscard]] position find(const K& key) const
+			{
+				if (root == nullptr)
+					return {};
+				leaf_node* leaf = leaf_of(key);
+				const size_t index = node_rank<false>(keys_of(leaf), leaf->count, key, comp);
+				if (index < leaf->count && !comp(key, keys_of(leaf)[index]))
+					return { leaf, index };
+				return {};
+			}
+
+			template<typename K, typename... Args>
+			/// @brief Constructs an object with key 'key' if there are none.
+			/// The tree is not modified if an exception is thrown.
+			/// @return The position of the object with key 'key', and true if it was inserted
+			std::pair<position, bool> emplace(K&& key, Args&&... args)
+			{
+				inner_node* path[max_depth];
+				size_t path_index[max_depth];
+				size_t depth = 0;
+				leaf_node* leaf = nullptr;
+				size_t index = 0;
+				if (root != nullptr)
+				{
+					node_base* node = root;
+					while (!node->is_leaf)
+					{
+						inner_node* inner = static_cast<inner_node*>(node);
+						path[depth] = inner;
+						path_index[depth] = node_rank<true>(keys_of(inner), inner->count, key, comp);
+						node = children_of(inner)[path_index[depth++]];
+					}
+					leaf = static_cast<leaf_node*>(node);
+					index = node_rank<false>(keys_of(leaf), leaf->count, key, comp);
+					if (index < leaf->count && !comp(key, keys_of(leaf)[index]))
+						return { position{ leaf, index }, false };
+				}
+
+				//Allocates the nodes of the splits and constructs the object before modifying the tree
+				node_base* spares[max_depth + 2];
+				size_t nb_spares = 0;
+				alignas(Key) unsigned char key_storage[sizeof(Key)];
+				alignas(mapped_type) unsigned char value_storage[sizeof(mapped_type)];
+				alignas(Key) unsigned char separator_storage[sizeof(Key)];
+				Key* new_key = reinterpret_cast<Key*>(key_storage);
+				mapped_type* new_value = reinterpret_cast<mapped_type*>(value_storage);
+				const bool is_full = leaf != nullptr && leaf->count == leaf_capacity;
+				bool has_key = false;
+				try
+				{
+					if (leaf == nullptr)
+						spares[nb_spares++] = allocate_leaf();
+					else if (is_full)
+					{
+						spares[nb_spares++] = allocate_leaf();
+						size_t level = depth;
+						while (level > 0 && path[level - 1]->count == inner_capacity)
+						{
+							spares[nb_spares++] = allocate_inner();
+							level--;
+						}
+						if (level == 0)
+							spares[nb_spares++] = allocate_inner();
+					}
+					new(new_key) Key(std::forward<K>(key));
+					has_key = true;
+					if constexpr (has_values)
+						new(new_value) mapped_type(std::forward<Args>(args)...);
+					if (is_full)
+					{
+						//The first key of the new right leaf, which separates the two leaves in their parent
+						const size_t split = (leaf_capacity + 1) / 2;
+						const Key& first_of_right = index < split ? keys_of(leaf)[split - 1] : (index == split ? *new_key : keys_of(leaf)[split]);
+						try
+						{
+							new(separator_storage) Key(first_of_right);
+						}
+						catch (...)
+						{
+							if constexpr (has_values)
+								new_value->~mapped_type();
+							throw;
+						}
+					}
+				}
+				catch (...)
+				{
+					if (has_key)
+						new_key->~Key();
+					for (size_t i = 0; i < nb_spares; i++)
+						free_node(spares[i]);
+					throw;
+				}
+
+				nb_elem++;
+				if (leaf == nullptr)
+				{
+					root = head = leaf = static_cast<leaf_node*>(spares[0]);
+					insert_in_leaf(leaf, 0, new_key, new_value);
+					return { position{ leaf, 0 }, true };
+				}
+				if (!is_full)
+				{
+					insert_in_leaf(leaf, index, new_key, new_value);
+					return { position{ leaf, index }, true };
+				}
+				return { split_leaf(leaf, index, new_key, new_value, reinterpret_cast<Key*>(separator_storage), path, path_index, depth, spares), true };
+			}
+
+			template<typename K>
+			/// @brief Erases the object with key 'key', merging or rebalancing the nodes left less than half full
+			/// @return True if an object was erased
+			bool erase(const K& key)
+			{
+				if (root == nullptr)
+					return false;
+				inner_node* path[max_depth];
+				size_t path_index[max_depth];
+				size_t depth = 0;
+				node_base* node = root;
+				while (!node->is_leaf)
+				{
+					inner_node* inner = static_cast<inner_node*>(node);
+					path[depth] = inner;
+					path_index[depth] = node_rank<true>(keys_of(inner), inner->count, key, comp);
+					node = children_of(inner)[path_index[depth++]];
+				}
+				leaf_node* leaf = static_cast<leaf_node*>(node);
+				const size_t index = node_rank<false>(keys_of(leaf), leaf->count, key, comp);
+				if (index == leaf->count || comp(key, keys_of(leaf)[index]))
+					return false;
+
+				keys_of(leaf)[index].~Key();
+				helpers::relocate(keys_of(leaf) + index, keys_of(leaf) + index + 1, leaf->count - index - 1);
+				if constexpr (has_values)
+				{
+					values_of(leaf)[index].~mapped_type();
+					helpers::relocate(values_of(leaf) + index, values_of(leaf) + index + 1, leaf->count - index - 1);
+				}
+				leaf->count--;
+				nb_elem--;
+
+				//Rebalances the nodes left less than half full, from the leaf up to the root
+				for (; depth > 0; depth--)
+				{
+					if (node->count >= (node->is_leaf ? leaf_min : inner_min))
+						break;
+					if (!rebalance(path[depth - 1], path_index[depth - 1]))
+						break;
+					node = path[depth - 1];
+				}
+				if (!root->is_leaf && root->count == 0)
+				{
+					inner_node* previous_root = static_cast<inner_node*>(root);
+					root = children_of(previous_root)[0];
+					free_node(previous_root);
+				}
+				else if (root->is_leaf && root->count == 0)
+				{
+					free_node(root);
+					root = head = nullptr;
+				}
+				return true;
+			}
+
+			template<typename Construct>
+			/// @brief Replaces the content of the tree by 'count' objects constructed in order by 'construct',
+			/// building full leaves then each level of inner nodes from the bottom up.
+			/// @param count The number of objects
+			/// @param construct Called with a pointer to the uninitialized key and value of each object (whose keys should be increasing)
+			void build_sorted(size_t count, Construct&& construct)
+			{
+				clear();
+				if (count == 0)
+					return;
+				const size_t nb_leaves = (count + leaf_capacity - 1) / leaf_capacity;
+				vale::vector<node_base*> level;
+				vale::vector<const Key*> level_first;
+				vale::vector<inner_node*> inners;
+				try
+				{
+					//Each inner node has at least 2 children, so there are less inner nodes than leaves
+					level.reserve(nb_leaves);
+					level_first.reserve(nb_leaves);
+					inners.reserve(nb_leaves);
+					leaf_node* previous = nullptr;
+					for (size_t i = 0; i < nb_leaves; i++)
+					{
+						leaf_node* leaf = allocate_leaf();
+						(previous == nullptr ? head : previous->next) = leaf;
+						previous = leaf;
+						//Spreads the objects evenly, so that all the leaves are at least half full
+						const size_t leaf_count = count / nb_leaves + (i < count % nb_leaves);
+						for (size_t j = 0; j < leaf_count; j++)
+						{
+							construct(keys_of(leaf) + j, values_of(leaf) + (has_values ? j : 0));
+							leaf->count++;
+						}
+						level.push_back(leaf);
+						level_first.push_back(keys_of(leaf));
+					}
+					while (level.size() > 1)
+					{
+						const size_t nb_children = level.size();
+						const size_t nb_nodes = (nb_children + inner_capacity) / (inner_capacity + 1);
+						size_t child = 0;
+						for (size_t i = 0; i < nb_nodes; i++)
+						{
+							inner_node* inner = allocate_inner();
+							inners.push_back(inner);
+							const size_t node_children = nb_children / nb_nodes + (i < nb_children % nb_nodes);
+							children_of(inner)[0] = level.data()[child];
+							for (size_t j = 1; j < node_children; j++)
+							{
+								new(keys_of(inner) + j - 1) Key(*level_first.data()[child + j]);
+								children_of(inner)[j] = level.data()[child + j];
+								inner->count++;
+							}
+							//The nodes of the level above are written over the nodes they replace
+							level.data()[i] = inner;
+							level_first.data()[i] = level_first.data()[child];
+							child += node_children;
+						}
+						while (level.size() > nb_nodes)
+						{
+							level.pop_back();
+							level_first.pop_back();
+						}
+					}
+				}
+				catch (...)
+				{
+					for (size_t i = 0; i < inners.size(); i++)
+						free_node(inners.data()[i]);
+					free_leaves();
+					throw;
+				}
+				root = level.data()[0];
+				nb_elem = count;
+			}
+
+			/// @brief Destroys all the objects, and frees all the nodes
+			void clear() noexcept
+			{
+				if (root != nullptr)
+					free_subtree(root);
+				root = head = nullptr;
+				nb_elem = 0;
+			}
+
+		private:
+			/// @brief Moves 'count' objects of a leaf to another leaf (or the same leaf)
+			static void relocate_objects(leaf_node* from, size_t from_index, size_t count, leaf_node* to, size_t to_index) noexcept
+			{
+				helpers::relocate(keys_of(to) + to_index, keys_of(from) + from_index, count);
+				if constexpr (has_values)
+					helpers::relocate(values_of(to) + to_index, values_of(from) + from_index, count);
+			}
+
+			static leaf_node* allocate_leaf()
+			{
+				return new(Allocator::allocate(leaf_size, cache_line_size)) leaf_node{ { 0, true }, nullptr };
+			}
+
+			static inner_node* allocate_inner()
+			{
+				return new(Allocator::allocate(inner_size, cache_line_size)) inner_node{ { 0, false } };
+			}
+
+			/// @brief Destroys the keys (and values) of a node, and frees it
+			static void free_node(node_base* node) noexcept
+			{
+				if (node->is_leaf)
+				{
+					leaf_node* leaf = static_cast<leaf_node*>(node);
+					for (size_t i = 0; i < leaf->count; i++)
+					{
+						keys_of(leaf)[i].~Key();
+						if constexpr (has_values)
+							values_of(leaf)[i].~mapped_type();
+					}
+					Allocator::deallocate(leaf, leaf_size, cache_line_size);
+				}
+				else
+				{
+					inner_node* inner = static_cast<inner_node*>(node);
+					for (size_t i = 0; i < inner->count; i++)
+						keys_of(inner)[i].~Key();
+					Allocator::deallocate(inner, inner_size, cache_line_size);
+				}
+			}
+
+			/// @brief Frees a node and its descendants
+			static void free_subtree(node_base* node) noexcept
+			{
+				if (!node->is_leaf)
+				{
+					inner_node* inner = static_cast<inner_node*>(node);
+					for (size_t i = 0; i <= inner->count; i++)
+						free_subtree(children_of(inner)[i]);
+				}
+				free_node(node);
+			}
+
+			/// @brief Frees the leaves linked from 'head'
+			void free_leaves() noexcept
+			{
+				while (head != nullptr)
+					free_node(std::exchange(head, head->next));
+			}
+
+			template<typename K>
+			/// @brief Returns the leaf in which 'key' is or would be, descending through the inner nodes
+			leaf_node* leaf_of(const K& key) const
+			{
+				node_base* node = root;
+				while (!node->is_leaf)
+				{
+					const inner_node* inner = static_cast<const inner_node*>(node);
+					node = children_of(inner)[node_rank<true>(keys_of(inner), inner->count, key, comp)];
+				}
+				return static_cast<leaf_node*>(node);
+			}
+
+			/// @brief Returns a position, moving the position following the last object of a leaf to the next leaf
+			static position normalize(leaf_node* leaf, size_t index) noexcept
+			{
+				if (index == leaf->count)
+					return { leaf->next, 0 };
+				return { leaf, index };
+			}
+
+			/// @brief Moves a constructed key and value to 'index' in a leaf which is not full
+			static void insert_in_leaf(leaf_node* leaf, size_t index, Key* key, mapped_type* value) noexcept
+			{
+				relocate_objects(leaf, index, leaf->count - index, leaf, index + 1);
+				helpers::relocate(keys_of(leaf) + index, key, 1);
+				if constexpr (has_values)
+					helpers::relocate(values_of(leaf) + index, value, 1);
+				leaf->count++;
+			}
+
+			/// @brief Moves a constructed key to 'index' in an inner node which is not full, followed by 'child'
+			static void insert_in_inner(inner_node* inner, size_t index, Key* key, node_base* child) noexcept
+			{
+				node_base** children = children_of(inner);
+				helpers::relocate(keys_of(inner) + index + 1, keys_of(inner) + index, inner->count - index);
+				helpers::relocate(keys_of(inner) + index, key, 1);
+				std::memmove(children + index + 2, children + index + 1, (inner->count - index) * sizeof(node_base*));
+				children[index + 1] = child;
+				inner->count++;
+			}
+
+			/// @brief Splits a full leaf in two leaves, inserting a constructed key and value at 'index'
+			/// @return The position of the inserted object
+			position split_leaf(leaf_node* leaf, size_t index, Key* key, mapped_type* value, Key* separator,
+				inner_node* const* path, const size_t* path_index, size_t depth, node_base* const* spares) noexcept
+			{
+				leaf_node* right = static_cast<leaf_node*>(spares[0]);
+				const size_t split = (leaf_capacity + 1) / 2;
+				position result;
+				if (index < split)
+				{
+					relocate_objects(leaf, split - 1, leaf_capacity - split + 1, right, 0);
+					right->count = static_cast<uint32_t>(leaf_capacity - split + 1);
+					leaf->count = static_cast<uint32_t>(split - 1);
+					insert_in_leaf(leaf, index, key, value);
+					result = { leaf, index };
+				}
+				else
+				{
+					relocate_objects(leaf, split, leaf_capacity - split, right, 0);
+					right->count = static_cast<uint32_t>(leaf_capacity - split);
+					leaf->count = static_cast<uint32_t>(split);
+					insert_in_leaf(right, index - split, key, value);
+					result = { right, index - split };
+				}
+				right->next = leaf->next;
+				leaf->next = right;
+				insert_in_parent(separator, right, path, path_index, depth, spares + 1);
+				return result;
+			}
+
+			/// @brief Inserts a constructed key followed by a new child in the parent of a split node,
+			/// splitting the full inner nodes up to the root, with the nodes allocated in 'spares'
+			void insert_in_parent(Key* key, node_base* child, inner_node* const* path, const size_t* path_index, size_t depth, node_base* const* spares) noexcept
+			{
+				constexpr size_t split = inner_capacity / 2;
+				alignas(Key) unsigned char up_storage[sizeof(Key)];
+				Key* up = reinterpret_cast<Key*>(up_storage);
+				for (;; depth--)
+				{
+					if (depth == 0)
+					{
+						inner_node* new_root = static_cast<inner_node*>(*spares);
+						helpers::relocate(keys_of(new_root), key, 1);
+						children_of(new_root)[0] = root;
+						children_of(new_root)[1] = child;
+						new_root->count = 1;
+						root = new_root;
+						return;
+					}
+					inner_node* parent = path[depth - 1];
+					const size_t index = path_index[depth - 1];
+					if (parent->count < inner_capacity)
+					{
+						insert_in_inner(parent, index, key, child);
+						return;
+					}
+					//Splits the parent, moving its middle key (of the keys including 'key') up
+					inner_node* right = static_cast<inner_node*>(*spares++);
+					Key* parent_keys = keys_of(parent);
+					node_base** parent_children = children_of(parent);
+					if (index < split)
+					{
+						helpers::relocate(keys_of(right), parent_keys + split, inner_capacity - split);
+						std::memcpy(children_of(right), parent_children + split, (inner_capacity - split + 1) * sizeof(node_base*));
+						right->count = static_cast<uint32_t>(inner_capacity - split);
+						helpers::relocate(up, parent_keys + split - 1, 1);
+						parent->count = static_cast<uint32_t>(split - 1);
+						insert_in_inner(parent, index, key, child);
+					}
+					else if (index == split)
+					{
+						helpers::relocate(keys_of(right), parent_keys + split, inner_capacity - split);
+						children_of(right)[0] = child;
+						std::memcpy(children_of(right) + 1, parent_children + split + 1, (inner_capacity - split) * sizeof(node_base*));
+						right->count = static_cast<uint32_t>(inner_capacity - split);
+						parent->count = static_cast<uint32_t>(split);
+						helpers::relocate(up, key, 1);
+					}
+					else
+					{
+						helpers::relocate(keys_of(right), parent_keys + split + 1, inner_capacity - split - 1);
+						std::memcpy(children_of(right), parent_children + split + 1, (inner_capacity - split) * sizeof(node_base*));
+						right->count = static_cast<uint32_t>(inner_capacity - split - 1);
+						helpers::relocate(up, parent_keys + split, 1);
+						parent->count = static_cast<uint32_t>(split);
+						insert_in_inner(right, index - split - 1, key, child);
+					}
+					helpers::relocate(key, up, 1);
+					child = right;
+				}
+			}
+
+			/// @brief Rebalances the child 'index' of 'parent', which is less than half full,
+			/// by moving an object from a sibling, or else by merging it with a sibling
+			/// @return True if the children were merged (so that 'parent' lost a key)
+			static bool rebalance(inner_node* parent, size_t index)
+			{
+				node_base** children = children_of(parent);
+				node_base* node = children[index];
+				const size_t min = node->is_leaf ? leaf_min : inner_min;
+				if (index > 0 && children[index - 1]->count > min)
+				{
+					if (node->is_leaf)
+						borrow_from_left(parent, index, static_cast<leaf_node*>(children[index - 1]), static_cast<leaf_node*>(node));
+					else
+						borrow_from_left(parent, index, static_cast<inner_node*>(children[index - 1]), static_cast<inner_node*>(node));
+					return false;
+				}
+				if (index < parent->count && children[index + 1]->count > min)
+				{
+					if (node->is_leaf)
+						borrow_from_right(parent, index, static_cast<leaf_node*>(node), static_cast<leaf_node*>(children[index + 1]));
+					else
+						borrow_from_right(parent, index, static_cast<inner_node*>(node), static_cast<inner_node*>(children[index + 1]));
+					return false;
+				}
+				merge(parent, index > 0 ? index - 1 : index);
+				return true;
+			}
+
+			/// @brief Moves the last object of 'left' to the front of its next sibling 'node'
+			static void borrow_from_left(inner_node* parent, size_t index, leaf_node* left, leaf_node* node)
+			{
+				//Copied first, so that an exception leaves the tree unchanged
+				keys_of(parent)[index - 1] = keys_of(left)[left->count - 1];
+				relocate_objects(node, 0, node->count, node, 1);
+				relocate_objects(left, left->count - 1, 1, node, 0);
+				left->count--;
+				node->count++;
+			}
+
+			/// @brief Moves the first object of 'right' to the back of its previous sibling 'node'
+			static void borrow_from_right(inner_node* parent, size_t index, leaf_node* node, leaf_node* right)
+			{
+				keys_of(parent)[index] = keys_of(right)[1];
+				relocate_objects(right, 0, 1, node, node->count);
+				relocate_objects(right, 1, right->count - 1, right, 0);
+				right->count--;
+				node->count++;
+			}
+
+			/// @brief Rotates the last child of 'left' to the front of its next sibling 'node', through their separator
+			static void borrow_from_left(inner_node* parent, size_t index, inner_node* left, inner_node* node) noexcept
+			{
+				helpers::relocate(keys_of(node) + 1, keys_of(node), node->count);
+				std::memmove(children_of(node) + 1, children_of(node), (node->count + 1) * sizeof(node_base*));
+				helpers::relocate(keys_of(node), keys_of(parent) + index - 1, 1);
+				children_of(node)[0] = children_of(left)[left->count];
+				helpers::relocate(keys_of(parent) + index - 1, keys_of(left) + left->count - 1, 1);
+				left->count--;
+				node->count++;
+			}
+
+			/// @brief Rotates the first child of 'right' to the back of its previous sibling 'node', through their separator
+			static void borrow_from_right(inner_node* parent, size_t index, inner_node* node, inner_node* right) noexcept
+			{
+				helpers::relocate(keys_of(node) + node->count, keys_of(parent) + index, 1);
+				children_of(node)[node->count + 1] = children_of(right)[0];
+				helpers::relocate(keys_of(parent) + index, keys_of(right), 1);
+				helpers::relocate(keys_of(right), keys_of(right) + 1, right->count - 1);
+				std::memmove(children_of(right), children_of(right) + 1, right->count * sizeof(node_base*));
+				right->count--;
+				node->count++;
+			}
+
+			/// @brief Merges the children 'index' and 'index + 1' of 'parent', removing their separator from 'parent'
+			static void merge(inner_node* parent, size_t index) noexcept
+			{
+				node_base** children = children_of(parent);
+				if (children[index]->is_leaf)
+				{
+					leaf_node* left = static_cast<leaf_node*>(children[index]);
+					leaf_node* right = static_cast<leaf_node*>(children[index + 1]);
+					relocate_objects(right, 0, right->count, left, left->count);
+					left->count += right->count;
+					right->count = 0;
+					left->next = right->next;
+					free_node(right);
+					keys_of(parent)[index].~Key();
+				}
+				else
+				{
+					inner_node* left = static_cast<inner_node*>(children[index]);
+					inner_node* right = static_cast<inner_node*>(children[index + 1]);
+					helpers::relocate(keys_of(left) + left->count, keys_of(parent) + index, 1);
+					helpers::relocate(keys_of(left) + left->count + 1, keys_of(right), right->count);
+					std::memcpy(children_of(left) + left->count + 1, children_of(right), (right->count + 1) * sizeof(node_base*));
+					left->count += right->count + 1;
+					right->count = 0;
+					free_node(right);
+				}
+				helpers::relocate(keys_of(parent) + index, keys_of(parent) + index + 1, parent->count - index - 1);
+				std::memmove(children + index + 1, children + index + 2, (parent->count - index - 1) * sizeof(node_base*));
+				parent->count--;
+			}
+		};
+	}
+
+	template<typename Key, typename Value, typename Compare = std::less<>, typename Allocator = heap_allocator, size_t node_cache_lines = 4>
+	/// @brief A non-thread safe ordered map implemented as a B+ tree, whose nodes span 'node_cache_lines' cache lines.
+	/// The keys of a node are contiguous and scanned 16 bytes at a time (for arithmetic keys), and the leaves
+	/// are linked in order, so that range scans read consecutive objects rather than following a pointer per object.
+	/// As the keys and values are not stored as pairs, iterators return a pair of references.
+	/// Inserting or erasing invalidates the iterators.
+	/// @tparam Key The type of the keys
+	/// @tparam Value The type of the values
+	/// @tparam Compare The comparison of the keys (transparent comparisons allow heterogeneous lookups)
+	/// @tparam Allocator The allocator policy used for the nodes
+	/// @tparam node_cache_lines The number of cache lines of a node
+	class btree_map
+	{
+		using tree_type = details::btree<Key, Value, Compare, Allocator, node_cache_lines>;
+		using position = typename tree_type::position;
+
+		/// @brief The tree
+		tree_type tree;
+
+	public:
+		/// @brief The type of the objects of the map
+		using value_type = std::pair<const Key, Value>;
+
+		template<bool is_const>
+		/// @brief Forward iterator over the objects of the map, in the order of their keys
+		class basic_iterator
+		{
+			friend class btree_map;
+
+			/// @brief The current position
+			position current;
+
+			explicit basic_iterator(position current) noexcept : current(current) {}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::pair<const Key, Value>;
+			using difference_type = std::ptrdiff_t;
+			using reference = std::pair<const Key&, std::conditional_t<is_const, const Value&, Value&>>;
+
+			/// @brief Returned by operator->(), as there is no pair to point to
+			struct pointer
+			{
+				reference pair;
+				const reference* operator->() const noexcept { return &pair; }
+			};
+
+			basic_iterator() noexcept = default;
+			/// @brief Converts an iterator to a const iterator
+			template<bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+			basic_iterator(const basic_iterator<other_const>& other) noexcept : current(other.current) {}
+
+			reference operator*() const noexcept
+			{
+				return reference(tree_type::keys_of(current.leaf)[current.index], tree_type::values_of(current.leaf)[current.index]);
+			}
+			pointer operator->() const noexcept { return pointer{ **this }; }
+
+			basic_iterator& operator++() noexcept { tree_type::advance(current); return *this; }
+			basic_iterator operator++(int) noexcept { basic_iterator copy = *this; ++*this; return copy; }
+
+			friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept
+			{
+				return a.current.leaf == b.current.leaf && a.current.index == b.current.index;
+			}
+			friend bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept { return !(a == b); }
+
+			template<bool>
+			friend class basic_iterator;
+		};
+
+		/// @brief Helper alias for iterators
+		using iterator = basic_iterator<false>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = basic_iterator<true>;
+
+		/// @brief Constructs an empty map
+		btree_map() noexcept = default;
+
+		/// @brief Constructs a map from an initializer list of key/value pairs (the first of equal keys is kept)
+		/// @param init The pairs to insert
+		btree_map(std::initializer_list<std::pair<Key, Value>> init)
+		{
+			for (const auto& [key, value] : init)
+				tree.emplace(key, value);
+		}
+
+		/// @brief Copy constructor, which builds the tree from the bottom up
+		/// @param to_copy The map to copy
+		btree_map(const btree_map& to_copy) { copy_from(to_copy); }
+
+		/// @brief Copy assignment operator, which builds the tree from the bottom up
+		/// @param to_copy The map to copy
+		/// @return *this
+		btree_map& operator=(const btree_map& to_copy)
+		{
+			if (this != &to_copy)
+				copy_from(to_copy);
+			return *this;
+		}
+
+		btree_map(btree_map&&) noexcept = default;
+		btree_map& operator=(btree_map&&) noexcept = default;
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the number of objects in the map
+		/// @return The number of objects
+		[[nodiscard]] size_t size() const noexcept { return tree.size(); }
+
+		/// @brief Check if the map is empty (contains 0 objects)
+		/// @return true if the map is empty
+		[[nodiscard]] bool is_empty() const noexcept { return tree.size() == 0; }
+
+		template<typename K>
+		/// @brief Returns an iterator to the object with key 'key'
+		/// @param key The key to search for
+		/// @return iterator to the object, or end() if there are none
+		[[nodiscard]] iterator find(const K& key) { return iterator(tree.find(key)); }
+
+		template<typename K>
+		/// @brief Returns an iterator to the object with key 'key'
+		/// @param key The key to search for
+		/// @return const iterator to the object, or end() if there are none
+		[[nodiscard]] const_iterator find(const K& key) const { return const_iterator(tree.find(key)); }
+
+		template<typename K>
+		/// @brief Check if the map contains an object with key 'key'
+		/// @param key The key to search for
+		/// @return True if an object has key 'key'
+		[[nodiscard]] bool contains(const K& key) const { return tree.find(key).leaf != nullptr; }
+
+		template<typename K>
+		/// @brief Returns an iterator to the first object whose key is not less than 'key'
+		/// @param key The key to search for
+		/// @return iterator to the object, or end() if there are none
+		[[nodiscard]] iterator lower_bound(const K& key) { return iterator(tree.lower_bound(key)); }
+
+		template<typename K>
+		/// @brief Returns an iterator to the first object whose key is not less than 'key'
+		/// @param key The key to search for
+		/// @return const iterator to the object, or end() if there are none
+		[[nodiscard]] const_iterator lower_bound(const K& key) const { return const_iterator(tree.lower_bound(key)); }
+
+		template<typename K>
+		/// @brief Returns an iterator to the first object whose key is greater than 'key'
+		/// @param key The key to search for
+		/// @return iterator to the object, or end() if there are none
+		[[nodiscard]] iterator upper_bound(const K& key) { return iterator(tree.upper_bound(key)); }
+
+		template<typename K>
+		/// @brief Returns an iterator to the first object whose key is greater than 'key'
+		/// @param key The key to search for
+		/// @return const iterator to the object, or end() if there are none
+		[[nodiscard]] const_iterator upper_bound(const K& key) const { return const_iterator(tree.upper_bound(key)); }
+
+		template<typename K>
+		/// @brief Returns the value of the object with key 'key', or throws if there are none
+		/// @param key The key to search for
+		/// @return reference to the value
+		[[nodiscard]] Value& at(const K& key)
+		{
+			if (const position found = tree.find(key); found.leaf != nullptr)
+				return tree_type::values_of(found.leaf)[found.index];
+			throw std::out_of_range("vale::btree_map: key was not found!");
+		}
+
+		template<typename K>
+		/// @brief Returns the value of the object with key 'key', or throws if there are none
+		/// @param key The key to search for
+		/// @return const reference to the value
+		[[nodiscard]] const Value& at(const K& key) const
+		{
+			if (const position found = tree.find(key); found.leaf != nullptr)
+				return tree_type::values_of(found.leaf)[found.index];
+			throw std::out_of_range("vale::btree_map: key was not found!");
+		}
+
+		/// @brief Returns the value of the object with key 'key', inserting a default constructed value if there are none
+		/// @param key The key to search for
+		/// @return reference to the value
+		Value& operator[](const Key& key)
+		{
+			const position found = tree.emplace(key).first;
+			return tree_type::values_of(found.leaf)[found.index];
+		}
+
+		template<typename K, typename Func>
+		/// @brief Calls 'func' on each object whose key is in ['first', 'last'), in the order of the keys.
+		/// The objects of a leaf are contiguous, and the next leaf is prefetched while they are visited.
+		/// @param first The first key of the range
+		/// @param last The key following the range
+		/// @param func The function to call with the key and the value of the objects
+		void scan(const K& first, const K& last, Func&& func)
+		{
+			for (position pos = tree.lower_bound(first); pos.leaf != nullptr; pos = { pos.leaf->next, 0 })
+			{
+				if (pos.leaf->next != nullptr)
+					helpers::prefetch(pos.leaf->next);
+				Key* keys = tree_type::keys_of(pos.leaf);
+				Value* values = tree_type::values_of(pos.leaf);
+				for (; pos.index < pos.leaf->count; pos.index++)
+				{
+					if (!tree.key_comp()(keys[pos.index], last))
+						return;
+					func(keys[pos.index], values[pos.index]);
+				}
+			}
+		}
+
+		/******************************************
+		ITERATORS
+		******************************************/
+
+		[[nodiscard]] iterator begin() noexcept { return iterator(tree.first()); }
+		[[nodiscard]] iterator end() noexcept { return iterator(position{}); }
+		[[nodiscard]] const_iterator begin() const noexcept { return const_iterator(tree.first()); }
+		[[nodiscard]] const_iterator end() const noexcept { return const_iterator(position{}); }
+		[[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+		[[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		template<typename K, typename... Args>
+		/// @brief Constructs an object with key 'key' if there are none
+		/// @param key The key of the object
+		/// @param ...args The arguments to forward to the constructor of the value
+		/// @return iterator to the object with key 'key', and true if it was inserted
+		std::pair<iterator, bool> emplace(K&& key, Args&&... args)
+		{
+			auto [found, inserted] = tree.emplace(std::forward<K>(key), std::forward<Args>(args)...);
+			return { iterator(found), inserted };
+		}
+
+		/// @brief Inserts a copy of 'value' with key 'key' if there are none
+		/// @param key The key of the object
+		/// @param value The value to copy
+		/// @return iterator to the object with key 'key', and true if it was inserted
+		std::pair<iterator, bool> insert(const Key& key, const Value& value) { return emplace(key, value); }
+
+		template<typename V>
+		/// @brief Inserts 'value' with key 'key', or assigns it to the value of the object with key 'key'
+		/// @param key The key of the object
+		/// @param value The value to insert or assign
+		/// @return iterator to the object with key 'key', and true if it was inserted
+		std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value)
+		{
+			auto result = emplace(key, std::forward<V>(value));
+			if (!result.second)
+				result.first->second = std::forward<V>(value);
+			return result;
+		}
+
+		template<typename K>
+		/// @brief Erases the object with key 'key'
+		/// @param key The key of the object to erase
+		/// @return True if an object was erased
+		bool erase(const K& key) { return tree.erase(key); }
+
+		/// @brief Destroys all the objects
+		void clear() noexcept { tree.clear(); }
+
+		template<typename It>
+		/// @brief Replaces the content of the map by the key/value pairs of ['first', 'last'), which should be sorted by
+		/// strictly increasing keys. The tree is built from the bottom up, in linear time, with full leaves.
+		/// If the keys are not sorted, throws std::invalid_argument.
+		/// The range is read twice (to count and check the keys, then to build the tree): 'It' should be a forward iterator.
+		/// @tparam It The forward iterator type
+		/// @param first The iterator to the first pair
+		/// @param last The iterator following the last pair
+		void assign_sorted(It first, It last)
+		{
+			static_assert(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>,
+				"assign_sorted reads the range twice, and expects a forward iterator!");
+			size_t count = 0;
+			for (It it = first, previous = first; it != last; previous = it++, count++)
+			{
+				if (count != 0 && !tree.key_comp()(previous->first, it->first))
+					throw std::invalid_argument("vale::btree_map: keys were not sorted!");
+			}
+			tree.build_sorted(count, [&first](Key* key, Value* value) {
+				new(key) Key(first->first);
+				try
+				{
+					new(value) Value(first->second);
+				}
+				catch (...)
+				{
+					key->~Key();
+					throw;
+				}
+				++first;
+			});
+		}
+
+		/// @brief Prints the content of the map in 'os'
+		/// @param os The ostream in which to << the map's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (auto it = begin(); it != end(); ++it)
+			{
+				if (it != begin())
+					os << ", ";
+				os << it->first << ": " << it->second;
+			}
+			os << '}';
+		}
+
+	private:
+		/// @brief Replaces the content of the map by a copy of 'to_copy'
+		void copy_from(const btree_map& to_copy)
+		{
+			auto it = to_copy.begin();
+			tree.build_sorted(to_copy.size(), [&it](Key* key, Value* value) {
+				new(key) Key(it->first);
+				try
+				{
+					new(value) Value(it->second);
+				}
+				catch (...)
+				{
+					key->~Key();
+					throw;
+				}
+				++it;
+			});
+		}
+	};
+
+	template<typename Key, typename Compare = std::less<>, typename Allocator = heap_allocator, size_t node_cache_lines = 4>
+	/// @brief A non-thread safe ordered set implemented as a B+ tree, whose nodes span 'node_cache_lines' cache lines.
+	/// The keys of a node are contiguous and scanned 16 bytes at a time (for arithmetic keys),
+	/// and the leaves are linked in order for range scans. Inserting or erasing invalidates the iterators.
+	/// @tparam Key The type of the keys
+	/// @tparam Compare The comparison of the keys (transparent comparisons allow heterogeneous lookups)
+	/// @tparam Allocator The allocator policy used for the nodes
+	/// @tparam node_cache_lines The number of cache lines of a node
+	class btree_set
+	{
+		using tree_type = details::btree<Key, void, Compare, Allocator, node_cache_lines>;
+		using position = typename tree_type::position;
+
+		/// @brief The tree
+		tree_type tree;
+
+	public:
+		/// @brief The type of the objects of the set
+		using value_type = Key;
+
+		/// @brief Forward iterator over the keys of the set, in order (the keys cannot be modified)
+		class const_iterator
+		{
+			friend class btree_set;
+
+			/// @brief The current position
+			position current;
+
+			explicit const_iterator(position current) noexcept : current(current) {}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Key;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Key*;
+			using reference = const Key&;
+
+			const_iterator() noexcept = default;
+
+			reference operator*() const noexcept { return tree_type::keys_of(current.leaf)[current.index]; }
+			pointer operator->() const noexcept { return tree_type::keys_of(current.leaf) + current.index; }
+
+			const_iterator& operator++() noexcept { tree_type::advance(current); return *this; }
+			const_iterator operator++(int) noexcept { const_iterator copy = *this; ++*this; return copy; }
+
+			friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept
+			{
+				return a.current.leaf == b.current.leaf && a.current.index == b.current.index;
+			}
+			friend bool operator!=(const const_iterator& a, const const_iterator& b) noexcept { return !(a == b); }
+		};
+
+		/// @brief Helper alias for iterators, which cannot modify the keys
+		using iterator = const_iterator;
+
+		/// @brief Constructs an empty set
+		btree_set() noexcept = default;
+
+		/// @brief Constructs a set from an initializer list of keys
+		/// @param init The keys to insert
+		btree_set(std::initializer_list<Key> init)
+		{
+			for (const auto& key : init)
+				tree.emplace(key);
+		}
+
+		/// @brief Copy constructor, which builds the tree from the bottom up
+		/// @param to_copy The set to copy
+		btree_set(const btree_set& to_copy) { assign_sorted(to_copy.begin(), to_copy.end()); }
+
+		/// @brief Copy assignment operator, which builds the tree from the bottom up
+		/// @param to_copy The set to copy
+		/// @return *this
+		btree_set& operator=(const btree_set& to_copy)
+		{
+			if (this != &to_copy)
+				assign_sorted(to_copy.begin(), to_copy.end());
+			return *this;
+		}
+
+		btree_set(btree_set&&) noexcept = default;
+		btree_set& operator=(btree_set&&) noexcept = default;
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the number of keys in the set
+		/// @return The number of keys
+		[[nodiscard]] size_t size() const noexcept { return tree.size(); }
+
+		/// @brief Check if the set is empty (contains 0 keys)
+		/// @return true if the set is empty
+		[[nodiscard]] bool is_empty() const noexcept { return tree.size() == 0; }
+
+		template<typename K>
+		/// @brief Returns an iterator to the key equal to 'key'
+		/// @param key The key to search for
+		/// @return iterator to the key, or end() if there are none
+		[[nodiscard]] const_iterator find(const K& key) const { return const_iterator(tree.find(key)); }
+
+		template<typename K>
+		/// @brief Check if the set contains 'key'
+		/// @param key The key to search for
+		/// @return True if the set contains 'key'
+		[[nodiscard]] bool contains(const K& key) const { return tree.find(key).leaf != nullptr; }
+
+		template<typename K>
+		/// @brief Returns an iterator to the first key not less than 'key'
+		/// @param key The key to search for
+		/// @return iterator to the key, or end() if there are none
+		[[nodiscard]] const_iterator lower_bound(const K& key) const { return const_iterator(tree.lower_bound(key)); }
+
+		template<typename K>
+		/// @brief Returns an iterator to the first key greater than 'key'
+		/// @param key The key to search for
+		/// @return iterator to the key, or end() if there are none
+		[[nodiscard]] const_iterator upper_bound(const K& key) const { return const_iterator(tree.upper_bound(key)); }
+
+		template<typename K, typename Func>
+		/// @brief Calls 'func' on each key in ['first', 'last'), in order.
+		/// The keys of a leaf are contiguous, and the next leaf is prefetched while they are visited.
+		/// @param first The first key of the range
+		/// @param last The key following the range
+		/// @param func The function to call with the keys
+		void scan(const K& first, const K& last, Func&& func) const
+		{
+			for (position pos = tree.lower_bound(first); pos.leaf != nullptr; pos = { pos.leaf->next, 0 })
+			{
+				if (pos.leaf->next != nullptr)
+					helpers::prefetch(pos.leaf->next);
+				const Key* keys = tree_type::keys_of(pos.leaf);
+				for (; pos.index < pos.leaf->count; pos.index++)
+				{
+					if (!tree.key_comp()(keys[pos.index], last))
+						return;
+					func(keys[pos.index]);
+				}
+			}
+		}
+
+		/******************************************
+		ITERATORS
+		******************************************/
+
+		[[nodiscard]] const_iterator begin() const noexcept { return const_iterator(tree.first()); }
+		[[nodiscard]] const_iterator end() const noexcept { return const_iterator(position{}); }
+		[[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+		[[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		template<typename K>
+		/// @brief Inserts a key constructed from 'key' if the set does not contain it
+		/// @param key The key to insert
+		/// @return iterator to the key, and true if it was inserted
+		std::pair<const_iterator, bool> insert(K&& key)
+		{
+			auto [found, inserted] = tree.emplace(std::forward<K>(key));
+			return { const_iterator(found), inserted };
+		}
+
+		template<typename K>
+		/// @brief Erases the key equal to 'key'
+		/// @param key The key to erase
+		/// @return True if a key was erased
+		bool erase(const K& key) { return tree.erase(key); }
+
+		/// @brief Destroys all the keys
+		void clear() noexcept { tree.clear(); }
+
+		template<typename It>
+		/// @brief Replaces the content of the set by the keys of ['first', 'last'), which should be strictly increasing.
+		/// The tree is built from the bottom up, in linear time, with full leaves.
+		/// If the keys are not sorted, throws std::invalid_argument.
+		/// The range is read twice (to count and check the keys, then to build the tree): 'It' should be a forward iterator.
+		/// @tparam It The forward iterator type
+		/// @param first The iterator to the first key
+		/// @param last The iterator following the last key
+		void assign_sorted(It first, It last)
+		{
+			static_assert(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>,
+				"assign_sorted reads the range twice, and expects a forward iterator!");
+			size_t count = 0;
+			for (It it = first, previous = first; it != last; previous = it++, count++)
+			{
+				if (count != 0 && !tree.key_comp()(*previous, *it))
+					throw std::invalid_argument("vale::btree_set: keys were not sorted!");
+			}
+			tree.build_sorted(count, [&first](Key* key, char*) {
+				new(key) Key(*first);
+				++first;
+			});
+		}
+
+		/// @brief Prints the content of the set in 'os'
+		/// @param os The ostream in which to << the set's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (auto it = begin(); it != end(); ++it)
+			{
+				if (it != begin())
+					os << ", ";
+				os << *it;
+			}
+			os << '}';
+		}
+	};
+
+	template<typename Key, typename Value, typename Compare, typename Allocator, size_t node_cache_lines>
+	/// @brief writes the content of the map between '{}', separating the objects by ','.
+	static std::ostream& operator<<(std::ostream& os, const btree_map<Key, Value, Compare, Allocator, node_cache_lines>& var)
+	{
+		var.print(os);
+		return os;
+	}
+
+	template<typename Key, typename Compare, typename Allocator, size_t node_cache_lines>
+	/// @brief writes the content of the set between '{}', separating the keys by ','.
+	static std::ostream& operator<<(std::ostream& os, const btree_set<Key, Compare, Allocator, node_cache_lines>& var)
+	{
+		var.print(os);
+		return os;
+	}
+}
@@ -0,0 +1,522 @@
+/** @file packed_vector.h
+* @brief Header that contains the packed_vector class.
+* A packed vector stores unsigned integers of 'Bits' bits tightly packed in 64-bit words:
+* a million 10-bit values take 1.25 MB instead of 2 MB in a vector of uint16_t.
+*
+* The width can be a template parameter (packed_vector<10>) or chosen at runtime
+* (runtime_packed_vector, which is packed_vector<0>).
+*
+* Single values are accessed through get()/set(), or through proxy references and iterators.
+* Bulk access should go through unpack()/pack(), which decode and encode many values at a time
+* (using AVX2 when available) to and from full-width integers.
+*/
+
+#pragma once
+#include <vale_structs/vector.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace vale
+{
+	/// @brief The width to pass to packed_vector to choose the number of bits at runtime
+	static constexpr size_t runtime_bits = 0;
+
+	namespace details
+	{
+		template<size_t Bits>
+		/// @brief The width of a packed_vector known at compile time
+		struct packed_width
+		{
+			constexpr packed_width(size_t) noexcept {}
+			static constexpr size_t bits() noexcept { return Bits; }
+		};
+
+		template<>
+		/// @brief The width of a packed_vector chosen at runtime
+		struct packed_width<runtime_bits>
+		{
+			/// @brief The number of bits of each value
+			size_t width;
+
+			constexpr packed_width(size_t width) noexcept : width(width) {}
+			constexpr size_t bits() const noexcept { return width; }
+		};
+
+		template<size_t Bits>
+		/// @brief The smallest unsigned integer that can hold 'Bits' bits
+		using packed_value_t =
+			std::conditional_t<(Bits != runtime_bits && Bits <= 8), uint8_t,
+			std::conditional_t<(Bits != runtime_bits && Bits <= 16), uint16_t, uint32_t>>;
+	}
+
+	template<size_t Bits>
+	/// @brief A vector of unsigned integers of 'Bits' bits, packed in 64-bit words.
+	/// Values greater than the maximum value of 'Bits' bits are truncated.
+	/// @tparam Bits The number of bits of each value (1 to 32), or runtime_bits to choose it at runtime
+	class packed_vector
+		: private details::packed_width<Bits>
+	{
+		static_assert(Bits <= 32, "packed_vector can only store values of at most 32 bits!");
+
+		using width_t = details::packed_width<Bits>;
+
+	public:
+		/// @brief The type of the unpacked values
+		using value_type = details::packed_value_t<Bits>;
+
+	private:
+		/// @brief The words in which values are packed.
+		/// There is always a padding word after the last value, so that reading
+		/// a value never reads past the end of the words.
+		vale::vector<uint64_t> words;
+		/// @brief The number of values
+		size_t nb_elem = 0;
+
+	public:
+		template<bool is_const>
+		class packed_iterator;
+
+		/// @brief Proxy reference to a value of a packed_vector
+		class reference
+		{
+			/// @brief The vector containing the value
+			packed_vector* vec;
+			/// @brief The index of the value
+			size_t index;
+
+		public:
+			constexpr reference(packed_vector* vec, size_t index) noexcept
+				: vec(vec), index(index) {}
+
+			/// @brief Reads the value
+			operator value_type() const noexcept { return vec->get_unchecked(index); }
+
+			/// @brief Writes the value
+			reference& operator=(value_type value) noexcept
+			{
+				vec->set_unchecked(index, value);
+				return *this;
+			}
+
+			/// @brief Writes the value referenced by 'other'
+			reference& operator=(const reference& other) noexcept { return *this = static_cast<value_type>(other); }
+
+			/// @brief Swaps the referenced values (used by std algorithms through iter_swap)
+			friend void swap(reference a, reference b) noexcept
+			{
+				value_type tmp = a;
+				a = static_cast<value_type>(b);
+				b = tmp;
+			}
+		};
+
+		template<bool is_const>
+		/// @brief Random access iterator over the values of a packed_vector, which dereferences to proxies
+		class packed_iterator
+		{
+			using vector_ptr = std::conditional_t<is_const, const packed_vector*, packed_vector*>;
+
+			/// @brief The vector over which to iterate
+			vector_ptr vec;
+			/// @brief The index of the value pointed to
+			size_t index;
+
+		public:
+			//HELPER TAGS
+			using iterator_category = std::random_access_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = packed_vector::value_type;
+			using pointer = void;
+			using reference = std::conditional_t<is_const, value_type, packed_vector::reference>;
+
+			//CONSTRUCTOR
+			constexpr packed_iterator(vector_ptr vec, size_t index) noexcept
+				: vec(vec), index(index) {}
+
+			//OPERATOR
+			reference operator*() const noexcept
+			{
+				if constexpr (is_const)
+					return vec->get_unchecked(index);
+				else
+					return reference(vec, index);
+			}
+			reference operator[](difference_type val) const noexcept { return *(*this + val); }
+			constexpr packed_iterator& operator++() noexcept { index++; return *this; }
+			constexpr packed_iterator operator++(int) noexcept { packed_iterator tmp = *this; ++(*this); return tmp; }
+			constexpr packed_iterator& operator--() noexcept { index--; return *this; }
+			constexpr packed_iterator operator--(int) noexcept { packed_iterator tmp = *this; --(*this); return tmp; }
+			constexpr packed_iterator operator+(difference_type val) const noexcept { return packed_iterator(vec, index + val); }
+			constexpr packed_iterator operator-(difference_type val) const noexcept { return packed_iterator(vec, index - val); }
+			constexpr difference_type operator-(const packed_iterator& val) const noexcept { return index - val.index; }
+			constexpr packed_iterator& operator+=(difference_type val) noexcept { index += val; return *this; }
+			constexpr packed_iterator& operator-=(difference_type val) noexcept { index -= val; return *this; }
+			//COMPARISONS
+			friend constexpr bool operator== (const packed_iterator& a, const packed_iterator& b) { return a.index == b.index; }
+			friend constexpr bool operator!= (const packed_iterator& a, const packed_iterator& b) { return a.index != b.index; }
+			friend constexpr bool operator<	(const packed_iterator& a, const packed_iterator& b) { return a.index < b.index; }
+			friend constexpr bool operator>	(const packed_iterator& a, const packed_iterator& b) { return a.index > b.index; }
+			friend constexpr bool operator<=(const packed_iterator& a, const packed_iterator& b) { return a.index <= b.index; }
+			friend constexpr bool operator>=(const packed_iterator& a, const packed_iterator& b) { return a.index >= b.index; }
+		};
+
+		/// @brief Helper alias for iterators
+		using iterator = packed_iterator<false>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = packed_iterator<true>;
+
+		/******************************************
+		CONSTRUCTORS
+		******************************************/
+
+		/// @brief Constructs an empty packed vector whose width is 'Bits'
+		packed_vector() noexcept
+			: width_t(Bits)
+		{
+			static_assert(Bits != runtime_bits, "A runtime_packed_vector should be constructed with its width!");
+		}
+
+		/// @brief Constructs an empty packed vector whose width is chosen at runtime.
+		/// Throws std::invalid_argument if 'width' is not in [1, 32].
+		/// @param width The number of bits of each value
+		explicit packed_vector(size_t width)
+			: width_t(width)
+		{
+			static_assert(Bits == runtime_bits, "The width of a packed_vector<Bits> is chosen at compile time!");
+			if (width == 0 || width > 32)
+				throw std::invalid_argument("vale::packed_vector: width should be between 1 and 32!");
+		}
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the number of bits of each value
+		/// @return The width of the values
+		[[nodiscard]] constexpr size_t bits() const noexcept { return width_t::bits(); }
+
+		/// @brief Returns the maximum value that can be stored
+		/// @return 2^bits() - 1
+		[[nodiscard]] constexpr value_type max_value() const noexcept { return static_cast<value_type>(mask()); }
+
+		/// @brief Returns the number of values in the vector
+		/// @return The size of the vector
+		[[nodiscard]] constexpr size_t size() const noexcept { return nb_elem; }
+
+		/// @brief Check if the vector is empty (contains 0 values)
+		/// @return true if the vector is empty
+		[[nodiscard]] constexpr bool is_empty() const noexcept { return nb_elem == 0; }
+
+		/// @brief Returns the number of bytes used to store the values (the memory footprint)
+		/// @return The number of bytes allocated
+		[[nodiscard]] size_t byte_size() const noexcept { return words.capacity() * sizeof(uint64_t); }
+
+		/// @brief Returns the value at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the value
+		/// @return The value
+		[[nodiscard]] value_type get(size_t index) const
+		{
+			if (index < nb_elem)
+				return get_unchecked(index);
+			throw std::out_of_range("vale::packed_vector: index was greater than size!");
+		}
+
+		/// @brief Writes the value at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the value
+		/// @param value The value to write, truncated to bits() bits
+		void set(size_t index, value_type value)
+		{
+			if (index < nb_elem)
+				return set_unchecked(index, value);
+			throw std::out_of_range("vale::packed_vector: index was greater than size!");
+		}
+
+		/// @brief Returns the value at 'index', and throws if the index is out of range.
+		/// @param index The index of the value
+		/// @return The value
+		[[nodiscard]] value_type operator[](size_t index) const { return get(index); }
+
+		/// @brief Returns a proxy to the value at 'index', and throws if the index is out of range.
+		/// @param index The index of the value
+		/// @return Proxy reference to the value
+		[[nodiscard]] reference operator[](size_t index)
+		{
+			if (index < nb_elem)
+				return reference(this, index);
+			throw std::out_of_range("vale::packed_vector: index was greater than size!");
+		}
+
+		/// @brief Returns an iterator to the beginning of the vector
+		/// @return iterator to the beginning of the vector
+		[[nodiscard]] iterator begin()				noexcept { return iterator(this, 0); }
+		/// @brief Returns an iterator to the end of the vector
+		/// @return iterator to the end of the vector
+		[[nodiscard]] iterator end()				noexcept { return iterator(this, nb_elem); }
+		/// @brief Returns a const iterator to the beginning of the vector
+		/// @return const iterator to the beginning of the vector
+		[[nodiscard]] const_iterator begin()	const noexcept { return const_iterator(this, 0); }
+		/// @brief Returns a const iterator to the end of the vector
+		/// @return const iterator to the end of the vector
+		[[nodiscard]] const_iterator end()		const noexcept { return const_iterator(this, nb_elem); }
+		/// @brief Returns a const iterator to the beginning of the vector
+		/// @return const iterator to the beginning of the vector
+		[[nodiscard]] const_iterator cbegin()	const noexcept { return const_iterator(this, 0); }
+		/// @brief Returns a const iterator to the end of the vector
+		/// @return const iterator to the end of the vector
+		[[nodiscard]] const_iterator cend()		const noexcept { return const_iterator(this, nb_elem); }
+
+		/******************************************
+		BULK OPERATIONS
+		******************************************/
+
+		/// @brief Unpacks 'count' values starting at 'first' into full-width integers.
+		/// Throws std::out_of_range if first + count > size().
+		/// @param first The index of the first value to unpack
+		/// @param count The number of values to unpack
+		/// @param out Where to write the unpacked values (at least 'count' objects)
+		void unpack(size_t first, size_t count, value_type* out) const
+		{
+			if (first > nb_elem || count > nb_elem - first)
+				throw std::out_of_range("vale::packed_vector: first + count was greater than size!");
+
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(words.data());
+			size_t i = 0;
+			if constexpr (Bits != runtime_bits)
+			{
+				//64 values always start on a word boundary and fill exactly 'Bits' words:
+				//whole blocks are decoded with shifts known at compile time.
+				for (; i < count && (first + i) % 64 != 0; i++)
+					out[i] = read_at_bit(bytes, (first + i) * Bits);
+				const uint64_t* block = words.data() + (first + i) / 64 * Bits;
+				for (; i + 64 <= count; i += 64, block += Bits)
+					unpack_block(block, out + i, std::make_index_sequence<64>{});
+			}
+#ifdef __AVX2__
+			else
+			{
+				//Each value is read by one unaligned 64-bit load at the byte containing its first bit:
+				//as bits() <= 32 and the bit offset in that byte is < 8, the value is fully contained in the load.
+				const __m256i step = _mm256_set1_epi64x(static_cast<long long>(4 * bits()));
+				const __m256i value_mask = _mm256_set1_epi64x(static_cast<long long>(mask()));
+				const __m256i byte_mask = _mm256_set1_epi64x(7);
+				const long long pos0 = static_cast<long long>(first * bits());
+				const long long width = static_cast<long long>(bits());
+				__m256i pos = _mm256_setr_epi64x(pos0, pos0 + width, pos0 + 2 * width, pos0 + 3 * width);
+				for (; i + 4 <= count; i += 4)
+				{
+					const __m256i values = _mm256_i64gather_epi64(
+						reinterpret_cast<const long long*>(bytes), _mm256_srli_epi64(pos, 3), 1);
+					const __m256i shifted = _mm256_and_si256(_mm256_srlv_epi64(values, _mm256_and_si256(pos, byte_mask)), value_mask);
+					alignas(32) uint64_t lanes[4];
+					_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), shifted);
+					out[i] = static_cast<value_type>(lanes[0]);
+					out[i + 1] = static_cast<value_type>(lanes[1]);
+					out[i + 2] = static_cast<value_type>(lanes[2]);
+					out[i + 3] = static_cast<value_type>(lanes[3]);
+					pos = _mm256_add_epi64(pos, step);
+				}
+			}
+#endif
+			for (; i < count; i++)
+				out[i] = read_at_bit(bytes, (first + i) * bits());
+		}
+
+		/// @brief Unpacks all the values into a vector of full-width integers.
+		/// Use .to_view() on the result to obtain a contiguous_struct_view.
+		/// @return vector containing all the values
+		[[nodiscard]] vale::vector<value_type> unpack() const
+		{
+			vale::vector<value_type> result;
+			result.resize_default_init(nb_elem);
+			unpack(0, nb_elem, result.data());
+			return result;
+		}
+
+		/// @brief Packs full-width integers at the end of the vector.
+		/// Values greater than max_value() are truncated.
+		/// @param values The values to append
+		void pack(contiguous_struct_view<value_type> values)
+		{
+			reserve(nb_elem + values.size());
+			const size_t old_size = nb_elem;
+			const size_t count = values.size();
+			const value_type* in = values.data();
+			nb_elem += count;
+			words.resize(words_for(nb_elem));
+
+			size_t i = 0;
+			if constexpr (Bits != runtime_bits)
+			{
+				//Like unpack(), whole blocks of 64 values are encoded with shifts known at compile time
+				for (; i < count && (old_size + i) % 64 != 0; i++)
+					or_at(old_size + i, in[i]);
+				uint64_t* block = words.data() + (old_size + i) / 64 * Bits;
+				for (; i + 64 <= count; i += 64, block += Bits)
+					pack_block(in + i, block, std::make_index_sequence<64>{});
+			}
+			for (; i < count; i++)
+				or_at(old_size + i, in[i]);
+		}
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		/// @brief Reserves memory for at least 'count' values
+		/// @param count The number of values to reserve memory for
+		void reserve(size_t count) { words.reserve(words_for(count)); }
+
+		/// @brief Appends a value at the end of the vector
+		/// @param value The value to append, truncated to bits() bits
+		void push_back(value_type value)
+		{
+			++nb_elem;
+			const size_t needed = words_for(nb_elem);
+			if (words.size() != needed)
+				words.resize(needed);
+			or_at(nb_elem - 1, value);
+		}
+
+		/// @brief Removes the last value, or throws if the vector is empty
+		void pop_back()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::packed_vector: vector was empty!");
+			set_unchecked(nb_elem - 1, 0);
+			--nb_elem;
+			words.resize(words_for(nb_elem));
+		}
+
+		/// @brief Resizes the vector to 'count' values, the new values being 0
+		/// @param count The new size of the vector
+		void resize(size_t count)
+		{
+			if (count < nb_elem)
+			{
+				//Clear the bits of the removed values, as push_back() only sets bits
+				for (size_t i = count; i < nb_elem; i++)
+					set_unchecked(i, 0);
+			}
+			nb_elem = count;
+			words.resize(words_for(count));
+		}
+
+		/// @brief Removes all the values, without freeing memory
+		void clear() noexcept
+		{
+			words.clear();
+			nb_elem = 0;
+		}
+
+		/// @brief Prints the content of the vector in 'os'
+		/// @param os The ostream in which to << the vector's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (size_t i = 0; i < nb_elem; i++)
+				os << (i == 0 ? "" : ", ") << static_cast<uint64_t>(get_unchecked(i));
+			os << '}';
+		}
+
+	private:
+
+		/// @brief Returns the mask of bits() bits
+		constexpr uint64_t mask() const noexcept { return (uint64_t(1) << bits()) - 1; }
+
+		/// @brief Returns the number of words (including the padding word) needed for 'count' values
+		constexpr size_t words_for(size_t count) const noexcept { return (count * bits() + 63) / 64 + 1; }
+
+		/// @brief Reads the value whose first bit is at 'bit' in 'bytes'
+		value_type read_at_bit(const unsigned char* bytes, size_t bit) const noexcept
+		{
+			uint64_t word;
+			std::memcpy(&word, bytes + bit / 8, sizeof(uint64_t));
+			return static_cast<value_type>((word >> (bit % 8)) & mask());
+		}
+
+		template<size_t I>
+		/// @brief Extracts the value 'I' of a block of 64 values starting at 'block'
+		static value_type extract_from_block(const uint64_t* block) noexcept
+		{
+			constexpr size_t bit = I * Bits;
+			constexpr size_t shift = bit % 64;
+			uint64_t value = block[bit / 64] >> shift;
+			if constexpr (shift + Bits > 64)
+				value |= block[bit / 64 + 1] << (64 - shift);
+			return static_cast<value_type>(value & ((uint64_t(1) << Bits) - 1));
+		}
+
+		template<size_t... I>
+		/// @brief Unpacks the 64 values of the block starting at 'block' into 'out'
+		static void unpack_block(const uint64_t* block, value_type* out, std::index_sequence<I...>) noexcept
+		{
+			((out[I] = extract_from_block<I>(block)), ...);
+		}
+
+		template<size_t I>
+		/// @brief ORs the bits of 'value' as the value 'I' of a block of 64 values starting at 'block'
+		static void insert_into_block(uint64_t* block, uint64_t value) noexcept
+		{
+			constexpr size_t bit = I * Bits;
+			constexpr size_t shift = bit % 64;
+			value &= (uint64_t(1) << Bits) - 1;
+			block[bit / 64] |= value << shift;
+			if constexpr (shift + Bits > 64)
+				block[bit / 64 + 1] |= value >> (64 - shift);
+		}
+
+		template<size_t... I>
+		/// @brief Packs 64 values from 'in' into the block starting at 'block', whose words are overwritten.
+		/// The words are built in a local array, so that they do not alias 'in'.
+		static void pack_block(const value_type* in, uint64_t* block, std::index_sequence<I...>) noexcept
+		{
+			uint64_t words_of_block[Bits] = {};
+			(insert_into_block<I>(words_of_block, in[I]), ...);
+			std::memcpy(block, words_of_block, sizeof(words_of_block));
+		}
+
+		/// @brief Reads the value at 'index', which should be < size()
+		value_type get_unchecked(size_t index) const noexcept
+		{
+			return read_at_bit(reinterpret_cast<const unsigned char*>(words.data()), index * bits());
+		}
+
+		/// @brief ORs the bits of 'value' at 'index', whose bits should be 0
+		void or_at(size_t index, uint64_t value) noexcept
+		{
+			const size_t bit = index * bits();
+			const size_t shift = bit % 64;
+			uint64_t* ptr = words.data() + bit / 64;
+			value &= mask();
+			ptr[0] |= value << shift;
+			//(value >> 1) >> (63 - shift) avoids shifting by 64 when shift is 0
+			ptr[1] |= (value >> 1) >> (63 - shift);
+		}
+
+		/// @brief Writes the value at 'index', which should be < size()
+		void set_unchecked(size_t index, uint64_t value) noexcept
+		{
+			const size_t bit = index * bits();
+			const size_t shift = bit % 64;
+			uint64_t* ptr = words.data() + bit / 64;
+			ptr[0] &= ~(mask() << shift);
+			ptr[1] &= ~((mask() >> 1) >> (63 - shift));
+			or_at(index, value);
+		}
+	};
+
+	/// @brief Packed vector whose width is chosen at runtime
+	using runtime_packed_vector = packed_vector<runtime_bits>;
+
+	template<size_t Bits>
+	/// @brief writes the content of the packed vector between '{}', separating the values by ','.
+	static std::ostream& operator<<(std::ostream& os, const packed_vector<Bits>& var)
+	{
+		var.print(os);
+		return os;
+	}
+}
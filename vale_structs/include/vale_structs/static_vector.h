@@ -0,0 +1,569 @@
+/** @file static_vector.h
+* @brief Header that contains the static_vector class.
+* A static vector is a vector whose capacity is fixed at compile time:
+* its objects are stored inline (like an array), but only the first size() objects
+* are constructed. It never allocates, so it can replace a std::vector
+* when the number of objects has a known upper bound (for example at most 32 pending items).
+* This class is overloaded for ThreadSafe, and NonThreadSafe thread safety policy.
+*
+* Like a 'ts_array', a thread safe static vector 'ts_static_vector' does not provide an iterator interface,
+* but rather provides helpful methods to manipulate the vector's content in a thread safe way.
+*/
+
+#pragma once
+#include <vale_structs/array.h>
+#include <memory>
+#include <new>
+#include <mutex>
+
+namespace vale
+{
+	/// @brief Unspecialized static vector which defaults to a NonThreadSafe.
+	/// Reports an error if ThreadSafety is not a thread safety policy: [Non]ThreadSafe.
+	/// @tparam T The type of the objects to store
+	/// @tparam max_elem The capacity of the static vector
+	/// @tparam ThreadSafety The thread safety policy of the static vector
+	template<typename T, size_t max_elem, typename ThreadSafety = NonThreadSafe>
+	class static_vector { static_assert(helpers::is_thread_safety_policy_v<ThreadSafety>, "ThreadSafety can only be [Non]ThreadSafe"); };
+
+	template<typename T, size_t max_elem>
+	/// @brief A non-thread safe vector of at most 'max_elem' objects, stored inline.
+	/// Objects past size() are never constructed.
+	/// @tparam T The type of the objects to store
+	class static_vector<T, max_elem, NonThreadSafe>
+	{
+		// Check that the static vector has a capacity > 0
+		static_assert(max_elem > 0, "Static vector capacity should be greater than 0!");
+		static_assert(std::is_nothrow_destructible_v<T>, "vale::static_vector requires a noexcept destructor!");
+
+		/// @brief Uninitialized storage for 'max_elem' objects
+		alignas(T) unsigned char storage[sizeof(T) * max_elem];
+		/// @brief The number of constructed objects
+		size_t nb_elem = 0;
+
+	public:
+		/// @brief Helper alias for iterators
+		using iterator = array_iterator<T>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = array_iterator<const T>;
+
+		/******************************************
+		CONSTRUCTORS AND DESTRUCTOR
+		******************************************/
+
+		/// @brief Constructs an empty static vector
+		static_vector() noexcept {}
+
+		/// @brief Constructs a static vector by copying the objects of a list.
+		/// Throws std::length_error if the list contains more than 'max_elem' objects.
+		/// @param list The objects to copy
+		static_vector(std::initializer_list<T> list)
+		{
+			copy_from(list.begin(), list.size());
+		}
+
+		/// @brief Constructs a static vector by copying the objects pointed to by a view.
+		/// Throws std::length_error if the view contains more than 'max_elem' objects.
+		/// @param view The objects to copy
+		explicit static_vector(contiguous_struct_view<T> view)
+		{
+			copy_from(view.data(), view.size());
+		}
+
+		/// @brief Copy constructor
+		/// @param to_copy The static vector to copy
+		static_vector(const static_vector& to_copy)
+		{
+			copy_from(to_copy.data(), to_copy.nb_elem);
+		}
+
+		/// @brief Move constructor, which moves the objects of 'to_move'.
+		/// 'to_move' keeps its (moved-from) objects.
+		/// @param to_move The static vector to move
+		static_vector(static_vector&& to_move) noexcept(std::is_nothrow_move_constructible_v<T>)
+		{
+			std::uninitialized_move(to_move.data(), to_move.data() + to_move.nb_elem, data());
+			nb_elem = to_move.nb_elem;
+		}
+
+		/// @brief Copy assignment operator
+		/// @param to_copy The static vector to copy
+		/// @return *this
+		static_vector& operator=(const static_vector& to_copy)
+		{
+			if (this != &to_copy)
+			{
+				clear();
+				copy_from(to_copy.data(), to_copy.nb_elem);
+			}
+			return *this;
+		}
+
+		/// @brief Move assignment operator
+		/// @param to_move The static vector to move
+		/// @return *this
+		static_vector& operator=(static_vector&& to_move) noexcept(std::is_nothrow_move_constructible_v<T>)
+		{
+			if (this != &to_move)
+			{
+				clear();
+				std::uninitialized_move(to_move.data(), to_move.data() + to_move.nb_elem, data());
+				nb_elem = to_move.nb_elem;
+			}
+			return *this;
+		}
+
+		/// @brief Destroys the constructed objects
+		~static_vector() noexcept
+		{
+			clear();
+		}
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the object at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the object
+		/// @return reference to the object
+		[[nodiscard]] T& operator[](size_t index)
+		{
+			if (index < nb_elem)
+				return data()[index];
+			throw std::out_of_range("vale::static_vector: index was greater than size!");
+		}
+
+		/// @brief Returns the object at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the object
+		/// @return const reference to the object
+		[[nodiscard]] const T& operator[](size_t index) const
+		{
+			if (index < nb_elem)
+				return data()[index];
+			throw std::out_of_range("vale::static_vector: index was greater than size!");
+		}
+
+		/// @brief Returns the last object in the static vector, or throws if it is empty
+		/// @return const reference to the last object
+		[[nodiscard]] const T& back() const
+		{
+			if (nb_elem != 0)
+				return data()[nb_elem - 1];
+			throw std::out_of_range("vale::static_vector: static vector was empty!");
+		}
+
+		/// @brief Returns the last object in the static vector, or throws if it is empty
+		/// @return reference to the last object
+		[[nodiscard]] T& back()
+		{
+			if (nb_elem != 0)
+				return data()[nb_elem - 1];
+			throw std::out_of_range("vale::static_vector: static vector was empty!");
+		}
+
+		/// @brief Returns the first object in the static vector, or throws if it is empty
+		/// @return const reference to the first object
+		[[nodiscard]] const T& front() const
+		{
+			if (nb_elem != 0)
+				return data()[0];
+			throw std::out_of_range("vale::static_vector: static vector was empty!");
+		}
+
+		/// @brief Returns the first object in the static vector, or throws if it is empty
+		/// @return reference to the first object
+		[[nodiscard]] T& front()
+		{
+			if (nb_elem != 0)
+				return data()[0];
+			throw std::out_of_range("vale::static_vector: static vector was empty!");
+		}
+
+		/// @brief Returns the number of objects in the static vector
+		/// @return The size of the static vector
+		[[nodiscard]] constexpr size_t size()		const noexcept { return nb_elem; }
+
+		/// @brief Returns the maximum number of objects the static vector can hold.
+		/// The capacity of the static vector is the template parameter 'max_elem'.
+		/// @return The capacity of the static vector
+		[[nodiscard]] static constexpr size_t capacity()	noexcept { return max_elem; }
+
+		/// @brief Check if the static vector is empty (contains 0 objects)
+		/// @return true if the static vector is empty
+		[[nodiscard]] constexpr bool is_empty()		const noexcept { return nb_elem == 0; }
+
+		/// @brief Check if the static vector is full (contains 'max_elem' objects)
+		/// @return true if the static vector is full
+		[[nodiscard]] constexpr bool is_full()		const noexcept { return nb_elem == max_elem; }
+
+		/// @brief Returns a pointer to the beginning of the data
+		/// @return const pointer to the beginning of the data
+		[[nodiscard]] const T* data() const	noexcept { return std::launder(reinterpret_cast<const T*>(storage)); }
+
+		/// @brief Returns a pointer to the beginning of the data
+		/// @return pointer to the beginning of the data
+		[[nodiscard]] T* data()				noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+
+		/// @brief Returns an iterator to the beginning of the static vector
+		/// @return iterator to the beginning of the static vector
+		[[nodiscard]] iterator begin()				noexcept { return iterator(data()); }
+		/// @brief Returns an iterator to the end of the static vector
+		/// @return iterator to the end of the static vector
+		[[nodiscard]] iterator end()				noexcept { return iterator(data() + nb_elem); }
+		/// @brief Returns a const iterator to the beginning of the static vector
+		/// @return const iterator to the beginning of the static vector
+		[[nodiscard]] const_iterator begin()	const noexcept { return const_iterator(data()); }
+		/// @brief Returns a const iterator to the end of the static vector
+		/// @return const iterator to the end of the static vector
+		[[nodiscard]] const_iterator end()		const noexcept { return const_iterator(data() + nb_elem); }
+		/// @brief Returns a const iterator to the beginning of the static vector
+		/// @return const iterator to the beginning of the static vector
+		[[nodiscard]] const_iterator cbegin()	const noexcept { return const_iterator(data()); }
+		/// @brief Returns a const iterator to the end of the static vector
+		/// @return const iterator to the end of the static vector
+		[[nodiscard]] const_iterator cend()		const noexcept { return const_iterator(data() + nb_elem); }
+
+		/// @brief Returns a view of all the items in the struct
+		/// @return view of all the items in the struct
+		[[nodiscard]] array_view<T> to_view() const noexcept { return array_view<T>(data(), nb_elem); }
+
+		/// @brief Returns a view of all the items in the struct starting from offset.
+		/// Throws if offset >= size().
+		/// @return view of all the items in the struct beginning from offset, or throws.
+		[[nodiscard]] array_view<T> to_view(size_t offset) const
+		{
+			if (offset < nb_elem)
+				return array_view<T>(data() + offset, nb_elem - offset);
+			throw std::out_of_range("vale::static_vector: offset was greater than size!");
+		}
+
+		/// @brief Returns a view of 'size' items in the struct starting from offset.
+		/// Throws if offset + size > size().
+		/// @return view of 'size' items in the struct beginning from offset, or throws.
+		[[nodiscard]] array_view<T> to_view(size_t offset, size_t size) const
+		{
+			if (offset <= nb_elem && size <= nb_elem - offset)
+				return array_view<T>(data() + offset, size);
+			throw std::out_of_range("vale::static_vector: offset + size was greater than size!");
+		}
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		/// @brief Copies an object at the end of the static vector.
+		/// Throws std::length_error if the static vector is full.
+		/// @param value The object to copy
+		void push_back(const T& value) { emplace_back(value); }
+
+		/// @brief Moves an object at the end of the static vector.
+		/// Throws std::length_error if the static vector is full.
+		/// @param value The object to move
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		template<typename... Args>
+		/// @brief Constructs an object at the end of the static vector.
+		/// Throws std::length_error if the static vector is full.
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return reference to the constructed object
+		T& emplace_back(Args&&... args)
+		{
+			if (T* ptr = try_emplace_back(std::forward<Args>(args)...))
+				return *ptr;
+			throw std::length_error("vale::static_vector: capacity was exceeded!");
+		}
+
+		template<typename... Args>
+		/// @brief Constructs an object at the end of the static vector if it is not full
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return pointer to the constructed object, or nullptr if the static vector was full
+		T* try_emplace_back(Args&&... args)
+		{
+			if (is_full())
+				return nullptr;
+			T* ptr = new(data() + nb_elem) T(std::forward<Args>(args)...);
+			++nb_elem;
+			return ptr;
+		}
+
+		/// @brief Destroys the last object in the static vector, or throws if it is empty
+		void pop_back()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::static_vector: static vector was empty!");
+			data()[--nb_elem].~T();
+		}
+
+		/// @brief Erases the object pointed to by 'pos'
+		/// @param pos The iterator to the object to erase
+		/// @return iterator following the erased object
+		iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+		/// @brief Erases the objects in the range [first, last)
+		/// @param first The iterator to the first object to erase
+		/// @param last The iterator following the last object to erase
+		/// @return iterator following the erased objects
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			const size_t index = first - cbegin();
+			const size_t count = last - first;
+			T* buffer = data();
+			if (count == 0)
+				return buffer + index;
+			std::move(buffer + index + count, buffer + nb_elem, buffer + index);
+			std::destroy(buffer + nb_elem - count, buffer + nb_elem);
+			nb_elem -= count;
+			return buffer + index;
+		}
+
+		/// @brief Destroys all the objects
+		void clear() noexcept
+		{
+			std::destroy(data(), data() + nb_elem);
+			nb_elem = 0;
+		}
+
+		/// @brief Prints the content of the static vector in 'os'
+		/// @param os The ostream in which to << the static vector's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (size_t i = 0; i + 1 < nb_elem; i++)
+				os << data()[i] << ", ";
+			if (nb_elem != 0)
+				os << data()[nb_elem - 1];
+			os << '}';
+		}
+
+	private:
+
+		/// @brief Copy constructs 'count' objects from 'from', in an empty static vector
+		/// @param from The objects to copy
+		/// @param count The number of objects to copy
+		void copy_from(const T* from, size_t count)
+		{
+			if (count > max_elem)
+				throw std::length_error("vale::static_vector: capacity was exceeded!");
+			std::uninitialized_copy(from, from + count, data());
+			nb_elem = count;
+		}
+	};
+
+	template<typename T, size_t max_elem>
+	/// @brief A thread safe static vector which provides helpful methods when working concurrently.
+	/// Does not possess iterators or .to_view() facilities to avoid false usages.
+	/// All methods lock the mutex protecting the objects.
+	/// @tparam T The type of the objects to store
+	class static_vector<T, max_elem, ThreadSafe>
+	{
+		/// @brief The objects
+		static_vector<T, max_elem, NonThreadSafe> vec;
+		/// @brief The mutex which protects the objects
+		mutable std::mutex mutex{};
+
+	public:
+		/// @brief Constructs an empty static vector
+		static_vector() noexcept {}
+
+		/// @brief Constructs a static vector by copying the objects of a list.
+		/// Throws std::length_error if the list contains more than 'max_elem' objects.
+		/// @param list The objects to copy
+		static_vector(std::initializer_list<T> list)
+			: vec(list) {}
+
+		/// @brief Copy constructor
+		/// @param to_copy The static vector to copy
+		static_vector(const static_vector& to_copy)
+			: vec(to_copy.copy()) {}
+
+		/// @brief Returns a copy of the object at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the object
+		/// @return copy of the object
+		[[nodiscard]] T operator[](size_t index) const
+		{
+			std::scoped_lock lock{ mutex };
+			return vec[index];
+		}
+
+		/// @brief Returns the number of objects in the static vector
+		/// @return The size of the static vector
+		[[nodiscard]] size_t size() const
+		{
+			std::scoped_lock lock{ mutex };
+			return vec.size();
+		}
+
+		/// @brief Returns the maximum number of objects the static vector can hold
+		/// @return The capacity of the static vector
+		[[nodiscard]] static constexpr size_t capacity() noexcept { return max_elem; }
+
+		/// @brief Check if the static vector is empty (contains 0 objects)
+		/// @return true if the static vector is empty
+		[[nodiscard]] bool is_empty() const
+		{
+			std::scoped_lock lock{ mutex };
+			return vec.is_empty();
+		}
+
+		/// @brief Check if the static vector is full (contains 'max_elem' objects)
+		/// @return true if the static vector is full
+		[[nodiscard]] bool is_full() const
+		{
+			std::scoped_lock lock{ mutex };
+			return vec.is_full();
+		}
+
+		/// @brief Returns a non-thread safe copy of the static vector
+		/// @return copy of the objects
+		[[nodiscard]] static_vector<T, max_elem, NonThreadSafe> copy() const
+		{
+			std::scoped_lock lock{ mutex };
+			return vec;
+		}
+
+		/// @brief Copies an object at the end of the static vector.
+		/// Throws std::length_error if the static vector is full.
+		/// @param value The object to copy
+		void push_back(const T& value) { emplace_back(value); }
+
+		/// @brief Moves an object at the end of the static vector.
+		/// Throws std::length_error if the static vector is full.
+		/// @param value The object to move
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		template<typename... Args>
+		/// @brief Constructs an object at the end of the static vector.
+		/// Throws std::length_error if the static vector is full.
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		void emplace_back(Args&&... args)
+		{
+			std::scoped_lock lock{ mutex };
+			vec.emplace_back(std::forward<Args>(args)...);
+		}
+
+		template<typename... Args>
+		/// @brief Constructs an object at the end of the static vector if it is not full
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return false if the static vector was full
+		bool try_emplace_back(Args&&... args)
+		{
+			std::scoped_lock lock{ mutex };
+			return vec.try_emplace_back(std::forward<Args>(args)...) != nullptr;
+		}
+
+		/// @brief Destroys the last object in the static vector, or throws if it is empty
+		void pop_back()
+		{
+			std::scoped_lock lock{ mutex };
+			vec.pop_back();
+		}
+
+		/// @brief Moves the last object in 'out' and destroys it, if the static vector is not empty
+		/// @param out The object to which the last object is move-assigned
+		/// @return false if the static vector was empty
+		bool try_pop_back(T& out)
+		{
+			std::scoped_lock lock{ mutex };
+			if (vec.is_empty())
+				return false;
+			out = std::move(vec.back());
+			vec.pop_back();
+			return true;
+		}
+
+		/// @brief Erases the object at 'index', and throws if the index is out of range.
+		/// @param index The index of the object to erase
+		void erase(size_t index)
+		{
+			std::scoped_lock lock{ mutex };
+			if (index >= vec.size())
+				throw std::out_of_range("vale::static_vector: index was greater than size!");
+			vec.erase(vec.cbegin() + index);
+		}
+
+		/// @brief Destroys all the objects
+		void clear() noexcept
+		{
+			std::scoped_lock lock{ mutex };
+			vec.clear();
+		}
+
+		/// @brief Access the object at 'index' through a functor.
+		/// Returns true if the object is passed to the function, which means the index was in the range of the static vector.
+		/// @param index The index of the object
+		/// @param func function to which the object is passed
+		/// @return false if the index is out of range, true if the object was passed to the function
+		bool access_index(size_t index, void(*func)(T&))
+		{
+			std::scoped_lock lock{ mutex };
+			if (index < vec.size())
+			{
+				func(vec[index]);
+				return true;
+			}
+			return false;
+		}
+
+		template<typename Func>
+		/// @brief Call a functor with each of the object in the static vector
+		/// @param func The functor to which a reference of each object is passed
+		void for_each(Func&& func)
+		{
+			std::scoped_lock lock{ mutex };
+			for (auto& obj : vec)
+				func(obj);
+		}
+
+		template<typename Func>
+		/// @brief Call a functor with each of the object in the static vector
+		/// @param func The functor to which a const reference of each object is passed
+		void for_each(Func&& func) const
+		{
+			std::scoped_lock lock{ mutex };
+			for (const auto& obj : vec)
+				func(obj);
+		}
+
+		template<typename Func, typename... Args>
+		/// @brief Passes begin and end iterators followed by an argument pack to a function, and returns the result of the function.
+		/// This method can be used to thread-safely access iterators of the static vector.
+		/// @tparam Func Type of the function to which to pass the iterators followed by the argument pack
+		/// @tparam ...Args Parameter pack
+		/// @param function The function to which to pass the iterators followed by the argument pack
+		/// @param ...args Argument pack forwarded to 'function' after iterators
+		/// @return What is returned by the 'function'
+		auto pass_iterators(Func function, Args&&... args)
+		{
+			std::scoped_lock lock{ mutex };
+			return function(vec.begin(), vec.end(), std::forward<Args>(args)...);
+		}
+
+		/// @brief Prints the content of the static vector in 'os'
+		/// @param os The ostream in which to << the static vector's content
+		inline void print(std::ostream& os) const
+		{
+			std::scoped_lock lock{ mutex };
+			vec.print(os);
+		}
+	};
+
+	template<typename T, size_t max_elem>
+	/// @brief Thread safe static vector typedef
+	using ts_static_vector = static_vector<T, max_elem, ThreadSafe>;
+
+	template<typename T, size_t max_elem, typename ThreadSafety>
+	/// @brief writes the content of the static vector between '{}', separating the objects by ','.
+	/// Will lock the mutex of the static vector if its thread safety policy is ThreadSafe.
+	static std::ostream& operator<<(std::ostream& os, const static_vector<T, max_elem, ThreadSafety>& var)
+	{
+		var.print(os);
+		return os;
+	}
+}
@@ -0,0 +1,3832 @@
+/** @file string.h
+* @brief Header that contains the string class.
+* A string is a contiguous, null-terminated, sequence of characters whose size can change at runtime.
+*
+* Strings use the small-string optimization: a string whose buffer policy is OptionalBuffer
+* stores up to 'inline_capacity' characters inside the object itself, and only allocates
+* when that capacity is exceeded. The default 'vale::string' is a 24-byte object which
+* stores up to 23 characters inline: the last byte of the object stores the remaining inline
+* capacity (which doubles as the null terminator when the string is full), or a flag
+* signifying that the characters are on the heap.
+*
+* Like vector, the way a string grows is customized through a growth policy (see growth_factor),
+* and the way it obtains memory through an allocator policy (see heap_allocator).
+*
+* Rather than passing a 'const string&' to a function, you should prefer
+* passing a 'string_view' (a contiguous_struct_view<char>) obtained through .to_view().
+*
+* The search functions (find, count, split...) operate on string_view, and are also
+* provided as methods of strings. They compare 16 or 32 characters at a time using SSE2/AVX2
+* when available.
+*
+* Numbers are appended through 'append_int', 'append_float' and 'append_double', and parsed from views through
+* 'parse_int' and 'parse_double' (see charconv.h), without going through a locale or an ostream.
+*
+* A 'shared_string' is an immutable, reference counted string: copies and substrings share a
+* single allocation, which makes handing the same string to many threads O(1) (see ts_shared_string).
+*
+* A 'string_pool' interns strings: each distinct string is stored once, and identified
+* by a 32-bit string_handle, which makes comparing interned strings a comparison of integers.
+*/
+
+#pragma once
+#include <vale_structs/vector.h>
+#include <vale_structs/static_vector.h>
+#include <vale_structs/charconv.h>
+#include <string_view>
+#include <functional>
+#include <mutex>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace vale
+{
+	/// @brief Alias over a contiguous_struct_view of characters for more easy typing
+	using string_view = contiguous_struct_view<char>;
+
+	/// @brief Alias over a contiguous_iterator of characters for more easy typing
+	using string_iterator = contiguous_iterator<char>;
+
+	/// @brief Contains user-defined literals
+	namespace literals
+	{
+		/// @brief Creates a string_view from a string literal
+		/// @param str The string literal
+		/// @param size The size of the literal
+		/// @return view of the literal, without its null terminator
+		constexpr string_view operator""_view(const char* str, size_t size) noexcept
+		{
+			return string_view(str, size);
+		}
+	}
+
+	/// @brief Returns a view of a null-terminated string, without its null terminator
+	/// @param str The null-terminated string
+	/// @return view of 'str'
+	constexpr string_view to_view(const char* str) noexcept
+	{
+		return string_view(str, std::char_traits<char>::length(str));
+	}
+
+	namespace details
+	{
+		/// @brief The representation of a string whose characters are on the heap
+		struct string_heap
+		{
+			/// @brief Pointer to the characters
+			char* ptr;
+			/// @brief The number of characters
+			size_t size;
+			/// @brief The number of characters that can be stored without reallocating (without the null terminator)
+			size_t capacity;
+		};
+	}
+
+	/******************************************
+	SEARCH
+	******************************************/
+
+	/// @brief Returned by the search functions when nothing was found
+	static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+	namespace details
+	{
+#if defined(__AVX2__)
+		/// @brief Compares 32 characters at a time
+		struct char_block
+		{
+			using type = __m256i;
+			/// @brief The number of characters in a block
+			static constexpr size_t width = 32;
+
+			static type splat(char c) noexcept { return _mm256_set1_epi8(c); }
+			static type load(const char* ptr) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); }
+			/// @brief Returns a mask whose bit i is set if the characters i of 'a' and 'b' are equal
+			static uint32_t equal(type a, type b) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b))); }
+			/// @brief Returns a mask whose bit i is set if the (signed) character i of 'a' is greater than the one of 'b'
+			static uint32_t greater(type a, type b) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(a, b))); }
+			/// @brief Converts the ASCII upper case letters to lower case
+			static type to_lower(type a) noexcept
+			{
+				//Shifts 'A' to -128: upper case letters are the only characters lower than -128 + 26
+				const __m256i shifted = _mm256_add_epi8(a, _mm256_set1_epi8(static_cast<char>(0x80 - 'A')));
+				const __m256i is_upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + 26)), shifted);
+				return _mm256_or_si256(a, _mm256_and_si256(is_upper, _mm256_set1_epi8(0x20)));
+			}
+		};
+#elif defined(__SSE2__) || defined(_M_X64)
+		/// @brief Compares 16 characters at a time
+		struct char_block
+		{
+			using type = __m128i;
+			/// @brief The number of characters in a block
+			static constexpr size_t width = 16;
+
+			static type splat(char c) noexcept { return _mm_set1_epi8(c); }
+			static type load(const char* ptr) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)); }
+			/// @brief Returns a mask whose bit i is set if the characters i of 'a' and 'b' are equal
+			static uint32_t equal(type a, type b) noexcept { return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))); }
+			/// @brief Returns a mask whose bit i is set if the (signed) character i of 'a' is greater than the one of 'b'
+			static uint32_t greater(type a, type b) noexcept { return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(a, b))); }
+			/// @brief Converts the ASCII upper case letters to lower case
+			static type to_lower(type a) noexcept
+			{
+				//Shifts 'A' to -128: upper case letters are the only characters lower than -128 + 26
+				const __m128i shifted = _mm_add_epi8(a, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+				const __m128i is_upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+				return _mm_or_si128(a, _mm_and_si128(is_upper, _mm_set1_epi8(0x20)));
+			}
+		};
+#else
+		/// @brief No SIMD instructions are available: the search functions only use their scalar loops.
+		/// The methods are never called, but must exist as the SIMD loops are discarded by 'if constexpr'.
+		struct char_block
+		{
+			using type = char;
+			/// @brief The number of characters in a block
+			static constexpr size_t width = 0;
+
+			static type splat(char c) noexcept { return c; }
+			static type load(const char* ptr) noexcept { return *ptr; }
+			static uint32_t equal(type a, type b) noexcept { return a == b; }
+			static uint32_t greater(type a, type b) noexcept { return a > b; }
+			static type to_lower(type a) noexcept { return a; }
+		};
+#endif
+
+		/// @brief The mask of a full char_block::equal()
+		static constexpr uint32_t full_block_mask = char_block::width == 32
+			? 0xFFFFFFFFu : static_cast<uint32_t>((uint64_t(1) << char_block::width) - 1);
+
+		/// @brief Needles longer than this are searched using the two-way algorithm
+		static constexpr size_t max_filtered_needle = 64;
+
+		/// @brief Converts an ASCII upper case letter to lower case
+		constexpr char ascii_to_lower(char c) noexcept
+		{
+			return static_cast<unsigned char>(c - 'A') < 26 ? static_cast<char>(c | 0x20) : c;
+		}
+
+		/// @brief Returns the index of the first occurrence of 'c' in 'str', or npos
+		inline size_t find_char(const char* str, size_t size, char c) noexcept
+		{
+			size_t i = 0;
+			if constexpr (char_block::width != 0)
+			{
+				const auto target = char_block::splat(c);
+				for (; i + char_block::width <= size; i += char_block::width)
+				{
+					const uint32_t mask = char_block::equal(char_block::load(str + i), target);
+					if (mask != 0)
+						return i + helpers::count_trailing_zeros(mask);
+				}
+			}
+			const void* found = std::memchr(str + i, c, size - i);
+			return found == nullptr ? npos : static_cast<const char*>(found) - str;
+		}
+
+		/// @brief Returns the number of occurrences of 'c' in 'str'
+		inline size_t count_char(const char* str, size_t size, char c) noexcept
+		{
+			size_t i = 0;
+			size_t count = 0;
+			if constexpr (char_block::width != 0)
+			{
+				//The masks of 64 characters are merged to count them with a single popcount
+				const auto target = char_block::splat(c);
+				for (; i + 64 <= size; i += 64)
+				{
+					uint64_t mask = 0;
+					for (size_t block = 0; block < 64; block += char_block::width)
+						mask |= uint64_t(char_block::equal(char_block::load(str + i + block), target)) << block;
+					count += helpers::popcount(mask);
+				}
+			}
+			for (; i < size; i++)
+				count += str[i] == c;
+			return count;
+		}
+
+		/// @brief Returns the index of the first occurrence of a needle of 2 to max_filtered_needle characters, or npos.
+		/// Blocks of positions are filtered by comparing their first and last characters with the ones
+		/// of the needle, and only the positions which pass the filter are compared with memcmp.
+		inline size_t find_filtered(const char* str, size_t size, const char* needle, size_t needle_size) noexcept
+		{
+			const size_t last = needle_size - 1;
+			size_t i = 0;
+			if constexpr (char_block::width != 0)
+			{
+				const auto first_char = char_block::splat(needle[0]);
+				const auto last_char = char_block::splat(needle[last]);
+				for (; i + last + char_block::width <= size; i += char_block::width)
+				{
+					uint32_t mask = char_block::equal(char_block::load(str + i), first_char)
+						& char_block::equal(char_block::load(str + i + last), last_char);
+					while (mask != 0)
+					{
+						const size_t candidate = i + helpers::count_trailing_zeros(mask);
+						if (std::memcmp(str + candidate + 1, needle + 1, last - 1) == 0)
+							return candidate;
+						mask &= mask - 1;
+					}
+				}
+			}
+			for (; i + last < size; i++)
+			{
+				if (str[i] == needle[0] && str[i + last] == needle[last]
+					&& std::memcmp(str + i + 1, needle + 1, last - 1) == 0)
+					return i;
+			}
+			return npos;
+		}
+
+		/// @brief Computes the maximal suffix of 'needle' for the two-way algorithm
+		/// @param needle The needle
+		/// @param size The size of the needle
+		/// @param reversed True to use the reversed alphabet order
+		/// @param period Set to the period of the maximal suffix
+		/// @return The index preceding the maximal suffix (which may be -1)
+		inline std::ptrdiff_t maximal_suffix(const unsigned char* needle, std::ptrdiff_t size, bool reversed, std::ptrdiff_t& period) noexcept
+		{
+			std::ptrdiff_t suffix = -1;
+			std::ptrdiff_t j = 0;
+			std::ptrdiff_t k = 1;
+			period = 1;
+			while (j + k < size)
+			{
+				const unsigned char a = needle[j + k];
+				const unsigned char b = needle[suffix + k];
+				if (a == b)
+				{
+					if (k != period)
+						++k;
+					else
+					{
+						j += period;
+						k = 1;
+					}
+				}
+				else if ((a < b) != reversed)
+				{
+					j += k;
+					k = 1;
+					period = j - suffix;
+				}
+				else
+				{
+					suffix = j;
+					j = suffix + 1;
+					k = period = 1;
+				}
+			}
+			return suffix;
+		}
+
+		/// @brief Returns the index of the first occurrence of 'needle' using the two-way algorithm
+		/// of Crochemore and Perrin, which is linear in the worst case and uses constant memory.
+		inline size_t find_two_way(const char* str, size_t size, const char* needle, size_t needle_size) noexcept
+		{
+			const auto* text = reinterpret_cast<const unsigned char*>(str);
+			const auto* pattern = reinterpret_cast<const unsigned char*>(needle);
+			const auto n = static_cast<std::ptrdiff_t>(size);
+			const auto m = static_cast<std::ptrdiff_t>(needle_size);
+
+			std::ptrdiff_t period, reversed_period;
+			const std::ptrdiff_t suffix = maximal_suffix(pattern, m, false, period);
+			const std::ptrdiff_t reversed_suffix = maximal_suffix(pattern, m, true, reversed_period);
+			std::ptrdiff_t critical = suffix;
+			if (reversed_suffix > suffix)
+			{
+				critical = reversed_suffix;
+				period = reversed_period;
+			}
+
+			if (std::memcmp(pattern, pattern + period, critical + 1) == 0)
+			{
+				//The needle is periodic: remember how much of its prefix already matched
+				std::ptrdiff_t memory = -1;
+				for (std::ptrdiff_t j = 0; j <= n - m;)
+				{
+					std::ptrdiff_t i = std::max(critical, memory) + 1;
+					while (i < m && pattern[i] == text[i + j])
+						++i;
+					if (i < m)
+					{
+						j += i - critical;
+						memory = -1;
+						continue;
+					}
+					i = critical;
+					while (i > memory && pattern[i] == text[i + j])
+						--i;
+					if (i <= memory)
+						return static_cast<size_t>(j);
+					j += period;
+					memory = m - period - 1;
+				}
+				return npos;
+			}
+
+			period = std::max(critical + 1, m - critical - 1) + 1;
+			for (std::ptrdiff_t j = 0; j <= n - m;)
+			{
+				std::ptrdiff_t i = critical + 1;
+				while (i < m && pattern[i] == text[i + j])
+					++i;
+				if (i < m)
+				{
+					j += i - critical;
+					continue;
+				}
+				i = critical;
+				while (i >= 0 && pattern[i] == text[i + j])
+					--i;
+				if (i < 0)
+					return static_cast<size_t>(j);
+				j += period;
+			}
+			return npos;
+		}
+
+		/// @brief Returns the index of the first character which differs (ignoring ASCII case) in 'a' and 'b'
+		/// @return The index of the first difference, or 'size' if the characters are equal
+		inline size_t first_difference_ignore_case(const char* a, const char* b, size_t size) noexcept
+		{
+			size_t i = 0;
+			if constexpr (char_block::width != 0)
+			{
+				for (; i + char_block::width <= size; i += char_block::width)
+				{
+					const uint32_t mask = char_block::equal(
+						char_block::to_lower(char_block::load(a + i)), char_block::to_lower(char_block::load(b + i)));
+					if (mask != full_block_mask)
+						return i + helpers::count_trailing_zeros(~mask);
+				}
+			}
+			for (; i < size; i++)
+			{
+				if (ascii_to_lower(a[i]) != ascii_to_lower(b[i]))
+					return i;
+			}
+			return size;
+		}
+	}
+
+	/// @brief Returns the index of the first occurrence of 'c' in 'str'
+	/// @param str The string in which to search
+	/// @param c The character to search for
+	/// @return The index of 'c', or npos if it was not found
+	inline size_t find(string_view str, char c) noexcept
+	{
+		return details::find_char(str.data(), str.size(), c);
+	}
+
+	/// @brief Returns the index of the first occurrence of 'needle' in 'str'.
+	/// Needles of at most 64 characters are searched using SIMD instructions,
+	/// longer needles using the two-way algorithm.
+	/// @param str The string in which to search
+	/// @param needle The characters to search for
+	/// @return The index of 'needle', 0 if it is empty, or npos if it was not found
+	inline size_t find(string_view str, string_view needle) noexcept
+	{
+		if (needle.size() <= 1)
+			return needle.is_empty() ? 0 : find(str, needle.data()[0]);
+		if (needle.size() > str.size())
+			return npos;
+		if (needle.size() <= details::max_filtered_needle)
+			return details::find_filtered(str.data(), str.size(), needle.data(), needle.size());
+		return details::find_two_way(str.data(), str.size(), needle.data(), needle.size());
+	}
+
+	/// @brief Check if 'str' contains 'c'
+	/// @param str The string in which to search
+	/// @param c The character to search for
+	/// @return True if 'c' was found
+	inline bool contains(string_view str, char c) noexcept { return find(str, c) != npos; }
+
+	/// @brief Check if 'str' contains 'needle'
+	/// @param str The string in which to search
+	/// @param needle The characters to search for
+	/// @return True if 'needle' was found
+	inline bool contains(string_view str, string_view needle) noexcept { return find(str, needle) != npos; }
+
+	/// @brief Returns the number of occurrences of 'c' in 'str'
+	/// @param str The string in which to count
+	/// @param c The character to count
+	/// @return The number of occurrences of 'c'
+	inline size_t count(string_view str, char c) noexcept
+	{
+		return details::count_char(str.data(), str.size(), c);
+	}
+
+	/// @brief Returns the number of non-overlapping occurrences of 'needle' in 'str'
+	/// @param str The string in which to count
+	/// @param needle The characters to count
+	/// @return The number of occurrences of 'needle', or 0 if it is empty
+	inline size_t count(string_view str, string_view needle) noexcept
+	{
+		if (needle.size() <= 1)
+			return needle.is_empty() ? 0 : count(str, needle.data()[0]);
+		size_t result = 0;
+		for (size_t pos = find(str, needle); pos != npos;)
+		{
+			++result;
+			str = string_view(str.data() + pos + needle.size(), str.size() - pos - needle.size());
+			pos = find(str, needle);
+		}
+		return result;
+	}
+
+	/// @brief Check if two strings are equal, ignoring the case of ASCII letters
+	/// @param a The first string
+	/// @param b The second string
+	/// @return True if both strings are equal, ignoring case
+	inline bool iequals(string_view a, string_view b) noexcept
+	{
+		return a.size() == b.size()
+			&& details::first_difference_ignore_case(a.data(), b.data(), a.size()) == a.size();
+	}
+
+	/// @brief Compares two strings lexicographically, ignoring the case of ASCII letters
+	/// @param a The first string
+	/// @param b The second string
+	/// @return < 0 if 'a' is lower than 'b', 0 if they are equal, > 0 otherwise
+	inline int icompare(string_view a, string_view b) noexcept
+	{
+		const size_t size = std::min(a.size(), b.size());
+		const size_t index = details::first_difference_ignore_case(a.data(), b.data(), size);
+		if (index != size)
+		{
+			return static_cast<unsigned char>(details::ascii_to_lower(a.data()[index]))
+				< static_cast<unsigned char>(details::ascii_to_lower(b.data()[index])) ? -1 : 1;
+		}
+		return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+	}
+
+	namespace details
+	{
+		template<typename String>
+		/// @brief Appends 'str' to 'result', replacing all the occurrences of 'from' by 'to'
+		/// @param result The string to which to append, which should not be pointed to by the views
+		/// @param str The string in which to replace
+		/// @param from The characters to replace, which should not be empty
+		/// @param to The replacement
+		void append_replaced(String& result, string_view str, string_view from, string_view to)
+		{
+			const size_t occurrences = count(str, from);
+			result.reserve(result.size() + str.size() + occurrences * to.size() - occurrences * from.size());
+			for (size_t pos = find(str, from); pos != npos; pos = find(str, from))
+			{
+				result.append(string_view(str.data(), pos));
+				result.append(to);
+				str = string_view(str.data() + pos + from.size(), str.size() - pos - from.size());
+			}
+			result.append(str);
+		}
+	}
+
+	template<typename Delimiter>
+	/// @brief Forward iterator over the pieces of a string separated by a delimiter.
+	/// The pieces are views of the string: splitting never allocates.
+	/// @tparam Delimiter char or string_view
+	class split_iterator
+	{
+		/// @brief The current piece
+		string_view current{};
+		/// @brief The characters following the delimiter that ended the current piece
+		string_view rest{};
+		/// @brief The delimiter
+		Delimiter delimiter{};
+		/// @brief True if the current piece is the last one
+		bool is_last = true;
+		/// @brief True if the iterator is past the last piece
+		bool is_end = true;
+
+	public:
+		//HELPER TAGS
+		using iterator_category = std::forward_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using value_type = string_view;
+		using pointer = const string_view*;
+		using reference = string_view;
+
+		/// @brief Constructs an end iterator
+		split_iterator() noexcept = default;
+
+		/// @brief Constructs an iterator to the first piece of 'str'
+		/// @param str The string to split
+		/// @param delimiter The delimiter separating the pieces
+		split_iterator(string_view str, Delimiter delimiter) noexcept
+			: rest(str), delimiter(delimiter), is_last(false), is_end(false)
+		{
+			advance();
+		}
+
+		//OPERATOR
+		string_view operator*() const noexcept { return current; }
+		pointer operator->() const noexcept { return &current; }
+		split_iterator& operator++() noexcept { advance(); return *this; }
+		split_iterator operator++(int) noexcept { split_iterator tmp = *this; advance(); return tmp; }
+		//COMPARISONS
+		friend bool operator==(const split_iterator& a, const split_iterator& b) noexcept
+		{
+			return a.is_end == b.is_end && (a.is_end || a.current.data() == b.current.data());
+		}
+		friend bool operator!=(const split_iterator& a, const split_iterator& b) noexcept { return !(a == b); }
+
+	private:
+		/// @brief Returns the size of the delimiter
+		size_t delimiter_size() const noexcept
+		{
+			if constexpr (std::is_same_v<Delimiter, char>)
+				return 1;
+			else
+				return delimiter.size();
+		}
+
+		/// @brief Moves to the next piece
+		void advance() noexcept
+		{
+			if (is_last)
+			{
+				is_end = true;
+				return;
+			}
+			const size_t pos = delimiter_size() == 0 ? npos : find(rest, delimiter);
+			if (pos == npos)
+			{
+				current = rest;
+				is_last = true;
+				return;
+			}
+			current = string_view(rest.data(), pos);
+			rest = string_view(rest.data() + pos + delimiter_size(), rest.size() - pos - delimiter_size());
+		}
+	};
+
+	template<typename Delimiter>
+	/// @brief Lazy range over the pieces of a string separated by a delimiter.
+	/// A string containing N delimiters is split in N + 1 (possibly empty) pieces.
+	/// @tparam Delimiter char or string_view
+	class split_range
+	{
+		/// @brief The string to split
+		string_view str;
+		/// @brief The delimiter
+		Delimiter delimiter;
+
+	public:
+		/// @brief Constructs a range over the pieces of 'str'
+		/// @param str The string to split
+		/// @param delimiter The delimiter separating the pieces
+		split_range(string_view str, Delimiter delimiter) noexcept
+			: str(str), delimiter(delimiter) {}
+
+		/// @brief Returns an iterator to the first piece
+		split_iterator<Delimiter> begin() const noexcept { return split_iterator<Delimiter>(str, delimiter); }
+		/// @brief Returns the end iterator
+		split_iterator<Delimiter> end() const noexcept { return split_iterator<Delimiter>(); }
+	};
+
+	/// @brief Splits a string on each occurrence of a character, without allocating
+	/// \code{.cpp}
+	/// for (vale::string_view field : vale::split(line, ','))
+	///		process(field);
+	/// \endcode
+	/// @param str The string to split
+	/// @param delimiter The character separating the pieces
+	/// @return Lazy range over the pieces
+	inline split_range<char> split(string_view str, char delimiter) noexcept { return split_range<char>(str, delimiter); }
+
+	/// @brief Splits a string on each occurrence of a delimiter, without allocating.
+	/// An empty delimiter does not split the string.
+	/// @param str The string to split
+	/// @param delimiter The characters separating the pieces
+	/// @return Lazy range over the pieces
+	inline split_range<string_view> split(string_view str, string_view delimiter) noexcept { return split_range<string_view>(str, delimiter); }
+
+	template<typename Growth = default_growth, typename Allocator = heap_allocator,
+		typename BufferPolicy = OptionalBuffer, size_t inline_capacity = 23>
+	/// @brief A null-terminated string of characters, which stores up to 'inline_capacity' characters
+	/// without allocating when its buffer policy is OptionalBuffer.
+	/// @tparam Growth The growth policy of the string
+	/// @tparam Allocator The allocator policy of the string
+	/// @tparam BufferPolicy OptionalBuffer to store up to 'inline_capacity' characters without allocating
+	/// @tparam inline_capacity The number of characters of the inline buffer (0 for NonOptionalBuffer)
+	class basic_string
+	{
+		static_assert(helpers::is_growth_policy_v<Growth>, "Growth can only be a growth_factor");
+		static_assert(helpers::is_buffer_policy_v<BufferPolicy>, "BufferPolicy can only be [Non]OptionalBuffer");
+		static_assert(std::is_same_v<BufferPolicy, OptionalBuffer> == (inline_capacity > 0),
+			"inline_capacity should be greater than 0 for OptionalBuffer, and 0 for NonOptionalBuffer!");
+		static_assert(inline_capacity < 0x80, "inline_capacity should be lower than 128!");
+
+		/// @brief The size of the storage of the string (the size of the string, before padding)
+		static constexpr size_t storage_size = std::max(sizeof(details::string_heap), inline_capacity + 1);
+		/// @brief True if the last byte of the storage is also the last byte of the heap capacity
+		static constexpr bool flag_in_capacity = storage_size == sizeof(details::string_heap);
+		/// @brief The value of the last byte of the storage for strings stored on the heap
+		static constexpr unsigned char heap_flag = 0x80;
+		/// @brief The bits of details::string_heap::capacity which store the capacity
+		static constexpr size_t capacity_mask = flag_in_capacity
+			? (size_t(1) << (8 * (sizeof(size_t) - 1))) - 1 : std::numeric_limits<size_t>::max();
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+		static_assert(!flag_in_capacity || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+			"vale::basic_string stores its heap flag in the most significant byte of its capacity, which requires a little-endian target!");
+#endif
+
+		union
+		{
+			/// @brief The heap representation
+			details::string_heap heap;
+			/// @brief The inline characters, the last byte storing the remaining inline capacity or 'heap_flag'
+			char chars[storage_size];
+		};
+
+	public:
+		/// @brief Helper alias for iterators
+		using iterator = string_iterator;
+		/// @brief Helper alias for const iterators
+		using const_iterator = contiguous_iterator<const char>;
+
+		/******************************************
+		STATIC HELPERS
+		******************************************/
+
+		/// @brief Returns the maximum number of characters a string can hold
+		/// @return The maximum size of the string
+		static constexpr size_t max_size() noexcept { return capacity_mask - 1; }
+
+		/// @brief Check if the string has an inline buffer
+		/// @return True if the buffer policy is OptionalBuffer
+		static constexpr bool has_inline_buffer() noexcept { return std::is_same_v<BufferPolicy, OptionalBuffer>; }
+
+		/// @brief Returns the number of characters that can be stored without allocating
+		/// @return The capacity of the inline buffer
+		static constexpr size_t inline_buffer_capacity() noexcept { return inline_capacity; }
+
+		/******************************************
+		CONSTRUCTORS AND DESTRUCTOR
+		******************************************/
+
+		/// @brief Constructs an empty string, which does not allocate
+		basic_string() noexcept
+		{
+			set_inline_size(0);
+		}
+
+		/// @brief Constructs a string by copying a null-terminated string
+		/// @param str The null-terminated string to copy
+		basic_string(const char* str)
+			: basic_string(vale::to_view(str)) {}
+
+		/// @brief Constructs a string by copying 'size' characters
+		/// @param str The characters to copy
+		/// @param size The number of characters to copy
+		basic_string(const char* str, size_t size)
+			: basic_string(string_view(str, size)) {}
+
+		/// @brief Constructs a string of 'count' copies of 'c'
+		/// @param count The number of characters
+		/// @param c The character to copy
+		basic_string(size_t count, char c)
+		{
+			set_inline_size(0);
+			resize(count, c);
+		}
+
+		/// @brief Constructs a string by copying the characters pointed to by a view
+		/// @param view The characters to copy
+		explicit basic_string(string_view view)
+		{
+			init_from(view.data(), view.size());
+		}
+
+		/// @brief Copy constructor.
+		/// The copy of a heap string which fits in the inline buffer is stored inline.
+		/// @param to_copy The string to copy
+		basic_string(const basic_string& to_copy)
+		{
+			init_from(to_copy.data(), to_copy.size());
+		}
+
+		/// @brief Move constructor, which steals the buffer of 'to_move'
+		/// @param to_move The string to move, which is left empty
+		basic_string(basic_string&& to_move) noexcept
+		{
+			steal_from(to_move);
+		}
+
+		/// @brief Copy assignment operator
+		/// @param to_copy The string to copy
+		/// @return *this
+		basic_string& operator=(const basic_string& to_copy)
+		{
+			if (this != &to_copy)
+				assign(to_copy.to_view());
+			return *this;
+		}
+
+		/// @brief Move assignment operator, which steals the buffer of 'to_move'
+		/// @param to_move The string to move, which is left empty
+		/// @return *this
+		basic_string& operator=(basic_string&& to_move) noexcept
+		{
+			if (this != &to_move)
+			{
+				free_buffer();
+				steal_from(to_move);
+			}
+			return *this;
+		}
+
+		/// @brief Assigns a null-terminated string
+		/// @param str The null-terminated string to copy
+		/// @return *this
+		basic_string& operator=(const char* str)
+		{
+			assign(vale::to_view(str));
+			return *this;
+		}
+
+		/// @brief Frees the buffer
+		~basic_string() noexcept
+		{
+			free_buffer();
+		}
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the character at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the character
+		/// @return reference to the character
+		[[nodiscard]] char& operator[](size_t index)
+		{
+			if (index < size())
+				return data()[index];
+			throw std::out_of_range("vale::string: index was greater than size!");
+		}
+
+		/// @brief Returns the character at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the character
+		/// @return const reference to the character
+		[[nodiscard]] const char& operator[](size_t index) const
+		{
+			if (index < size())
+				return data()[index];
+			throw std::out_of_range("vale::string: index was greater than size!");
+		}
+
+		/// @brief Returns the first character of the string, or throws if the string is empty
+		/// @return reference to the first character
+		[[nodiscard]] char& front()
+		{
+			if (!is_empty())
+				return data()[0];
+			throw std::out_of_range("vale::string: string was empty!");
+		}
+
+		/// @brief Returns the first character of the string, or throws if the string is empty
+		/// @return const reference to the first character
+		[[nodiscard]] const char& front() const
+		{
+			if (!is_empty())
+				return data()[0];
+			throw std::out_of_range("vale::string: string was empty!");
+		}
+
+		/// @brief Returns the last character of the string, or throws if the string is empty
+		/// @return reference to the last character
+		[[nodiscard]] char& back()
+		{
+			if (!is_empty())
+				return data()[size() - 1];
+			throw std::out_of_range("vale::string: string was empty!");
+		}
+
+		/// @brief Returns the last character of the string, or throws if the string is empty
+		/// @return const reference to the last character
+		[[nodiscard]] const char& back() const
+		{
+			if (!is_empty())
+				return data()[size() - 1];
+			throw std::out_of_range("vale::string: string was empty!");
+		}
+
+		/// @brief Returns the number of characters in the string, without the null terminator
+		/// @return The size of the string
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return is_inline() ? inline_capacity - flag() : heap.size;
+		}
+
+		/// @brief Returns the number of characters that can be stored without reallocating
+		/// @return The capacity of the string
+		[[nodiscard]] size_t capacity() const noexcept
+		{
+			return is_inline() ? inline_capacity : heap_capacity();
+		}
+
+		/// @brief Check if the characters are stored in the inline buffer
+		/// @return True if the string did not allocate
+		[[nodiscard]] bool is_inline() const noexcept { return flag() != heap_flag; }
+
+		/// @brief Check if the string is empty (contains 0 characters)
+		/// @return true if the string is empty
+		[[nodiscard]] bool is_empty() const noexcept { return size() == 0; }
+
+		/// @brief Returns a pointer to the beginning of the characters
+		/// @return pointer to the beginning of the characters
+		[[nodiscard]] char* data()				noexcept { return is_inline() ? chars : heap.ptr; }
+
+		/// @brief Returns a pointer to the beginning of the characters
+		/// @return const pointer to the beginning of the characters
+		[[nodiscard]] const char* data() const	noexcept { return is_inline() ? chars : heap.ptr; }
+
+		/// @brief Returns a pointer to the null-terminated characters
+		/// @return const pointer to the null-terminated characters
+		[[nodiscard]] const char* c_str() const	noexcept { return data(); }
+
+		/// @brief Returns an iterator to the beginning of the string
+		/// @return iterator to the beginning of the string
+		[[nodiscard]] iterator begin()				noexcept { return iterator(data()); }
+		/// @brief Returns an iterator to the end of the string
+		/// @return iterator to the end of the string
+		[[nodiscard]] iterator end()				noexcept { return iterator(data() + size()); }
+		/// @brief Returns a const iterator to the beginning of the string
+		/// @return const iterator to the beginning of the string
+		[[nodiscard]] const_iterator begin()	const noexcept { return const_iterator(data()); }
+		/// @brief Returns a const iterator to the end of the string
+		/// @return const iterator to the end of the string
+		[[nodiscard]] const_iterator end()		const noexcept { return const_iterator(data() + size()); }
+		/// @brief Returns a const iterator to the beginning of the string
+		/// @return const iterator to the beginning of the string
+		[[nodiscard]] const_iterator cbegin()	const noexcept { return const_iterator(data()); }
+		/// @brief Returns a const iterator to the end of the string
+		/// @return const iterator to the end of the string
+		[[nodiscard]] const_iterator cend()		const noexcept { return const_iterator(data() + size()); }
+
+		/// @brief Returns a view of all the characters of the string
+		/// @return view of all the characters of the string
+		[[nodiscard]] string_view to_view() const noexcept { return string_view(data(), size()); }
+
+		/// @brief Returns a view of all the characters of the string starting from offset.
+		/// Throws if offset >= size().
+		/// @return view of all the characters of the string beginning from offset, or throws.
+		[[nodiscard]] string_view to_view(size_t offset) const
+		{
+			const size_t nb_elem = size();
+			if (offset < nb_elem)
+				return string_view(data() + offset, nb_elem - offset);
+			throw std::out_of_range("vale::string: offset was greater than size!");
+		}
+
+		/// @brief Returns a view of 'size' characters of the string starting from offset.
+		/// Throws if offset + size > size().
+		/// @return view of 'size' characters of the string beginning from offset, or throws.
+		[[nodiscard]] string_view to_view(size_t offset, size_t size) const
+		{
+			const size_t nb_elem = this->size();
+			if (offset <= nb_elem && size <= nb_elem - offset)
+				return string_view(data() + offset, size);
+			throw std::out_of_range("vale::string: offset + size was greater than size!");
+		}
+
+		/// @brief Returns a copy of 'size' characters of the string starting from offset.
+		/// Throws if offset + size > size().
+		/// @return string containing 'size' characters of the string beginning from offset, or throws.
+		[[nodiscard]] basic_string substr(size_t offset, size_t size) const
+		{
+			return basic_string(to_view(offset, size));
+		}
+
+		/// @brief Compares the string with the characters pointed to by a view, lexicographically
+		/// @param view The characters to compare with
+		/// @return < 0 if the string is lower than 'view', 0 if they are equal, > 0 otherwise
+		[[nodiscard]] int compare(string_view view) const noexcept
+		{
+			return compare(to_view(), view);
+		}
+
+		/// @brief Compares two views lexicographically
+		/// @param a The first view
+		/// @param b The second view
+		/// @return < 0 if 'a' is lower than 'b', 0 if they are equal, > 0 otherwise
+		[[nodiscard]] static int compare(string_view a, string_view b) noexcept
+		{
+			const int result = std::char_traits<char>::compare(a.data(), b.data(), std::min(a.size(), b.size()));
+			if (result != 0)
+				return result;
+			return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+		}
+
+		/******************************************
+		SEARCH
+		******************************************/
+
+		/// @brief Returns the index of the first occurrence of 'c', starting the search at 'from'
+		/// @param c The character to search for
+		/// @param from The index from which to search
+		/// @return The index of 'c', or npos if it was not found
+		[[nodiscard]] size_t find(char c, size_t from = 0) const noexcept
+		{
+			const size_t nb_elem = size();
+			if (from >= nb_elem)
+				return npos;
+			const size_t pos = vale::find(string_view(data() + from, nb_elem - from), c);
+			return pos == npos ? npos : pos + from;
+		}
+
+		/// @brief Returns the index of the first occurrence of 'needle', starting the search at 'from'
+		/// @param needle The characters to search for
+		/// @param from The index from which to search
+		/// @return The index of 'needle', or npos if it was not found
+		[[nodiscard]] size_t find(string_view needle, size_t from = 0) const noexcept
+		{
+			const size_t nb_elem = size();
+			if (from > nb_elem)
+				return npos;
+			const size_t pos = vale::find(string_view(data() + from, nb_elem - from), needle);
+			return pos == npos ? npos : pos + from;
+		}
+
+		/// @brief Check if the string contains 'c'
+		/// @param c The character to search for
+		/// @return True if 'c' was found
+		[[nodiscard]] bool contains(char c) const noexcept { return vale::contains(to_view(), c); }
+
+		/// @brief Check if the string contains 'needle'
+		/// @param needle The characters to search for
+		/// @return True if 'needle' was found
+		[[nodiscard]] bool contains(string_view needle) const noexcept { return vale::contains(to_view(), needle); }
+
+		/// @brief Returns the number of occurrences of 'c'
+		/// @param c The character to count
+		/// @return The number of occurrences of 'c'
+		[[nodiscard]] size_t count(char c) const noexcept { return vale::count(to_view(), c); }
+
+		/// @brief Returns the number of non-overlapping occurrences of 'needle'
+		/// @param needle The characters to count
+		/// @return The number of occurrences of 'needle'
+		[[nodiscard]] size_t count(string_view needle) const noexcept { return vale::count(to_view(), needle); }
+
+		/// @brief Splits the string on each occurrence of 'delimiter', without allocating.
+		/// The pieces are invalidated by any modification of the string.
+		/// @param delimiter The character separating the pieces
+		/// @return Lazy range over the pieces
+		[[nodiscard]] split_range<char> split(char delimiter) const noexcept { return vale::split(to_view(), delimiter); }
+
+		/// @brief Splits the string on each occurrence of 'delimiter', without allocating.
+		/// The pieces are invalidated by any modification of the string.
+		/// @param delimiter The characters separating the pieces
+		/// @return Lazy range over the pieces
+		[[nodiscard]] split_range<string_view> split(string_view delimiter) const noexcept { return vale::split(to_view(), delimiter); }
+
+		/// @brief Check if the string is equal to 'view', ignoring the case of ASCII letters
+		/// @param view The characters to compare with
+		/// @return True if both are equal, ignoring case
+		[[nodiscard]] bool iequals(string_view view) const noexcept { return vale::iequals(to_view(), view); }
+
+		/// @brief Compares the string with 'view' lexicographically, ignoring the case of ASCII letters
+		/// @param view The characters to compare with
+		/// @return < 0 if the string is lower than 'view', 0 if they are equal, > 0 otherwise
+		[[nodiscard]] int icompare(string_view view) const noexcept { return vale::icompare(to_view(), view); }
+
+		/// @brief Replaces all the non-overlapping occurrences of 'from' by 'to'
+		/// @param from The characters to replace (nothing is replaced if it is empty)
+		/// @param to The replacement
+		/// @return *this
+		basic_string& replace_all(string_view from, string_view to)
+		{
+			if (from.is_empty() || !contains(from))
+				return *this;
+			basic_string result;
+			details::append_replaced(result, to_view(), from, to);
+			*this = std::move(result);
+			return *this;
+		}
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		/// @brief Reserves memory for at least 'count' characters
+		/// @param count The number of characters to reserve memory for
+		void reserve(size_t count)
+		{
+			if (count > capacity())
+				reallocate_buffer(count);
+		}
+
+		/// @brief Frees the memory which is not used by the characters.
+		/// If the characters fit in the inline buffer, they are moved to it.
+		void shrink_to_fit()
+		{
+			if (is_inline() || heap.size == heap_capacity())
+				return;
+			if (heap.size <= inline_capacity)
+			{
+				details::string_heap old = heap;
+				std::memcpy(chars, old.ptr, old.size);
+				set_inline_size(old.size);
+				Allocator::deallocate(old.ptr, (old.capacity & capacity_mask) + 1, alignof(char));
+				return;
+			}
+			reallocate_buffer(heap.size);
+		}
+
+		/// @brief Removes all the characters, without freeing memory
+		void clear() noexcept { set_size(0); }
+
+		/// @brief Resizes the string to 'count' characters, new characters being copies of 'c'
+		/// @param count The new size of the string
+		/// @param c The character to append if the string grows
+		void resize(size_t count, char c = '\0')
+		{
+			const size_t old_size = size();
+			if (count > old_size)
+			{
+				if (count > capacity())
+					reallocate_buffer(Growth::grow(capacity(), count));
+				std::memset(data() + old_size, c, count - old_size);
+			}
+			set_size(count);
+		}
+
+		/// @brief Replaces the characters of the string by a copy of the characters of 'view'
+		/// @param view The characters to copy
+		void assign(string_view view)
+		{
+			if (view.size() > capacity())
+			{
+				basic_string copy(view);
+				*this = std::move(copy);
+				return;
+			}
+			std::memmove(data(), view.data(), view.size());
+			set_size(view.size());
+		}
+
+		/// @brief Appends a character at the end of the string
+		/// @param c The character to append
+		void push_back(char c)
+		{
+			const size_t old_size = size();
+			if (old_size == capacity())
+				reallocate_buffer(Growth::grow(old_size, old_size + 1));
+			data()[old_size] = c;
+			set_size(old_size + 1);
+		}
+
+		/// @brief Removes the last character, or throws if the string is empty
+		void pop_back()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::string: string was empty!");
+			set_size(size() - 1);
+		}
+
+		/// @brief Appends the characters pointed to by a view (which may point to this string)
+		/// @param view The characters to append
+		/// @return *this
+		basic_string& append(string_view view)
+		{
+			const char* str = view.data();
+			const size_t count = view.size();
+			const size_t old_size = size();
+			if (count > capacity() - old_size)
+			{
+				if (count > max_size() - old_size)
+					throw std::length_error("vale::string: size was greater than max_size()!");
+				//The view could point to the characters of this string
+				const char* old_data = data();
+				const bool is_aliasing = !std::less<const char*>()(str, old_data)
+					&& std::less<const char*>()(str, old_data + old_size + 1);
+				const size_t offset = str - old_data;
+				reallocate_buffer(Growth::grow(capacity(), old_size + count));
+				if (is_aliasing)
+					str = data() + offset;
+			}
+			std::memmove(data() + old_size, str, count);
+			set_size(old_size + count);
+			return *this;
+		}
+
+		/// @brief Appends a null-terminated string
+		/// @param str The null-terminated string to append
+		/// @return *this
+		basic_string& append(const char* str) { return append(vale::to_view(str)); }
+
+		/// @brief Appends 'count' copies of 'c'
+		/// @param count The number of characters to append
+		/// @param c The character to append
+		/// @return *this
+		basic_string& append(size_t count, char c)
+		{
+			resize(size() + count, c);
+			return *this;
+		}
+
+		template<typename Int>
+		/// @brief Appends the decimal representation of an integer, without going through a locale
+		/// @tparam Int The integer type
+		/// @param value The integer to append
+		/// @return *this
+		basic_string& append_int(Int value)
+		{
+			char* end = vale::write_int(reserve_back(max_int_chars), value);
+			set_size(end - data());
+			return *this;
+		}
+
+		/// @brief Appends the shortest representation of a double which parses back to the same
+		/// double (see write_double), without going through a locale
+		/// @param value The double to append
+		/// @return *this
+		basic_string& append_double(double value)
+		{
+			char* end = vale::write_double(reserve_back(max_double_chars), value);
+			set_size(end - data());
+			return *this;
+		}
+
+		/// @brief Appends the shortest representation of a float which parses back to the same
+		/// float (see write_float), without going through a locale
+		/// @param value The float to append
+		/// @return *this
+		basic_string& append_float(float value)
+		{
+			char* end = vale::write_float(reserve_back(max_float_chars), value);
+			set_size(end - data());
+			return *this;
+		}
+
+		/// @brief Appends the characters pointed to by a view
+		/// @param view The characters to append
+		/// @return *this
+		basic_string& operator+=(string_view view) { return append(view); }
+		/// @brief Appends a string
+		/// @param str The string to append
+		/// @return *this
+		basic_string& operator+=(const basic_string& str) { return append(str.to_view()); }
+		/// @brief Appends a null-terminated string
+		/// @param str The null-terminated string to append
+		/// @return *this
+		basic_string& operator+=(const char* str) { return append(str); }
+		/// @brief Appends a character
+		/// @param c The character to append
+		/// @return *this
+		basic_string& operator+=(char c) { push_back(c); return *this; }
+
+		/// @brief Inserts the characters pointed to by a view before 'offset'.
+		/// Throws if offset > size().
+		/// @param offset The index before which to insert
+		/// @param view The characters to insert (which may point to this string)
+		/// @return *this
+		basic_string& insert(size_t offset, string_view view)
+		{
+			const size_t old_size = size();
+			const size_t count = view.size();
+			if (offset > old_size)
+				throw std::out_of_range("vale::string: offset was greater than size!");
+			//The view could point to the characters of this string
+			const char* old_data = data();
+			const bool is_aliasing = !std::less<const char*>()(view.data(), old_data)
+				&& std::less<const char*>()(view.data(), old_data + old_size + 1);
+			const size_t source = view.data() - old_data;
+			if (count > capacity() - old_size)
+			{
+				if (count > max_size() - old_size)
+					throw std::length_error("vale::string: size was greater than max_size()!");
+				reallocate_buffer(Growth::grow(capacity(), old_size + count));
+			}
+			char* ptr = data();
+			std::memmove(ptr + offset + count, ptr + offset, old_size - offset);
+			if (!is_aliasing)
+				std::memcpy(ptr + offset, view.data(), count);
+			else
+			{
+				//The characters following 'offset' moved by 'count': the view is split in the characters before and after 'offset'
+				const size_t before = source < offset ? (offset - source < count ? offset - source : count) : 0;
+				std::memcpy(ptr + offset, ptr + source, before);
+				std::memcpy(ptr + offset + before, ptr + source + before + count, count - before);
+			}
+			set_size(old_size + count);
+			return *this;
+		}
+
+		/// @brief Erases 'count' characters starting at 'offset'.
+		/// Throws if offset + count > size().
+		/// @param offset The index of the first character to erase
+		/// @param count The number of characters to erase
+		/// @return *this
+		basic_string& erase(size_t offset, size_t count)
+		{
+			const size_t old_size = size();
+			if (offset > old_size || count > old_size - offset)
+				throw std::out_of_range("vale::string: offset + count was greater than size!");
+			char* ptr = data();
+			std::memmove(ptr + offset, ptr + offset + count, old_size - offset - count);
+			set_size(old_size - count);
+			return *this;
+		}
+
+		/// @brief Swaps the content of two strings
+		/// @param other The string to swap with
+		void swap(basic_string& other) noexcept
+		{
+			alignas(basic_string) unsigned char temp[sizeof(basic_string)];
+			std::memcpy(temp, static_cast<void*>(this), sizeof(basic_string));
+			std::memcpy(static_cast<void*>(this), static_cast<void*>(&other), sizeof(basic_string));
+			std::memcpy(static_cast<void*>(&other), temp, sizeof(basic_string));
+		}
+
+		/// @brief Prints the content of the string in 'os'
+		/// @param os The ostream in which to << the string's content
+		inline void print(std::ostream& os) const
+		{
+			os.write(data(), size());
+		}
+
+		/******************************************
+		COMPARISONS
+		******************************************/
+
+		friend bool operator==(const basic_string& a, const basic_string& b) noexcept
+		{
+			const size_t size = a.size();
+			return size == b.size() && std::memcmp(a.data(), b.data(), size) == 0;
+		}
+		friend bool operator==(const basic_string& a, string_view b) noexcept
+		{
+			return a.size() == b.size() && std::memcmp(a.data(), b.data(), b.size()) == 0;
+		}
+		friend bool operator==(const basic_string& a, const char* b) noexcept { return a == vale::to_view(b); }
+		friend bool operator!=(const basic_string& a, const basic_string& b) noexcept { return !(a == b); }
+		friend bool operator!=(const basic_string& a, string_view b) noexcept { return !(a == b); }
+		friend bool operator!=(const basic_string& a, const char* b) noexcept { return !(a == b); }
+		friend bool operator< (const basic_string& a, const basic_string& b) noexcept { return compare(a.to_view(), b.to_view()) < 0; }
+		friend bool operator> (const basic_string& a, const basic_string& b) noexcept { return compare(a.to_view(), b.to_view()) > 0; }
+		friend bool operator<=(const basic_string& a, const basic_string& b) noexcept { return compare(a.to_view(), b.to_view()) <= 0; }
+		friend bool operator>=(const basic_string& a, const basic_string& b) noexcept { return compare(a.to_view(), b.to_view()) >= 0; }
+
+		/// @brief Concatenates two strings
+		friend basic_string operator+(const basic_string& a, string_view b)
+		{
+			basic_string result;
+			result.reserve(a.size() + b.size());
+			result.append(a.to_view());
+			result.append(b);
+			return result;
+		}
+		/// @brief Concatenates two strings
+		friend basic_string operator+(const basic_string& a, const basic_string& b) { return a + b.to_view(); }
+		/// @brief Concatenates two strings
+		friend basic_string operator+(const basic_string& a, const char* b) { return a + vale::to_view(b); }
+		/// @brief Concatenates two strings, reusing the buffer of 'a'
+		friend basic_string operator+(basic_string&& a, string_view b) { a.append(b); return std::move(a); }
+
+	private:
+
+		/// @brief Returns the last byte of the storage
+		unsigned char flag() const noexcept { return static_cast<unsigned char>(chars[storage_size - 1]); }
+
+		/// @brief Returns the capacity of a heap string
+		size_t heap_capacity() const noexcept { return heap.capacity & capacity_mask; }
+
+		/// @brief Sets the size of an inline string, writing the null terminator
+		/// @param size The new size, which should be <= inline_capacity
+		void set_inline_size(size_t size) noexcept
+		{
+			chars[size] = '\0';
+			chars[storage_size - 1] = static_cast<char>(inline_capacity - size);
+		}
+
+		/// @brief Makes the string point to a heap buffer
+		/// @param ptr The buffer of 'capacity' + 1 characters
+		/// @param size The number of characters
+		/// @param capacity The capacity of the buffer, without the null terminator
+		void set_heap(char* ptr, size_t size, size_t capacity) noexcept
+		{
+			heap.ptr = ptr;
+			heap.size = size;
+			heap.capacity = capacity;
+			chars[storage_size - 1] = static_cast<char>(heap_flag);
+			ptr[size] = '\0';
+		}
+
+		/// @brief Sets the size of the string, writing the null terminator
+		/// @param size The new size, which should be <= capacity()
+		void set_size(size_t size) noexcept
+		{
+			if (is_inline())
+				return set_inline_size(size);
+			heap.size = size;
+			heap.ptr[size] = '\0';
+		}
+
+		/// @brief Copies 'size' characters in an uninitialized string
+		/// @param str The characters to copy
+		/// @param size The number of characters
+		void init_from(const char* str, size_t size)
+		{
+			if (size <= inline_capacity)
+			{
+				std::memcpy(chars, str, size);
+				set_inline_size(size);
+				return;
+			}
+			if (size > max_size())
+				throw std::length_error("vale::string: size was greater than max_size()!");
+			char* ptr = static_cast<char*>(Allocator::allocate(size + 1, alignof(char)));
+			std::memcpy(ptr, str, size);
+			set_heap(ptr, size, size);
+		}
+
+		/// @brief Steals the buffer of 'to_move', in an uninitialized string
+		/// @param to_move The string to steal from, which is left empty
+		void steal_from(basic_string& to_move) noexcept
+		{
+			std::memcpy(static_cast<void*>(this), static_cast<void*>(&to_move), sizeof(basic_string));
+			to_move.set_inline_size(0);
+		}
+
+		/// @brief Frees the heap buffer if there is one
+		void free_buffer() noexcept
+		{
+			if (!is_inline())
+				Allocator::deallocate(heap.ptr, heap_capacity() + 1, alignof(char));
+		}
+
+		/// @brief Makes space for 'count' characters after the last one, without changing the size
+		/// @param count The number of characters to make space for
+		/// @return Pointer past the last character
+		char* reserve_back(size_t count)
+		{
+			const size_t old_size = size();
+			if (count > capacity() - old_size)
+			{
+				if (count > max_size() - old_size)
+					throw std::length_error("vale::string: size was greater than max_size()!");
+				reallocate_buffer(Growth::grow(capacity(), old_size + count));
+			}
+			return data() + old_size;
+		}
+
+		/// @brief Moves the characters to a heap buffer of 'new_capacity' characters
+		/// @param new_capacity The new capacity, which should be greater than the size
+		void reallocate_buffer(size_t new_capacity)
+		{
+			if (new_capacity > max_size())
+				throw std::length_error("vale::string: size was greater than max_size()!");
+			if (is_inline())
+			{
+				const size_t size = inline_capacity - flag();
+				char* ptr = static_cast<char*>(Allocator::allocate(new_capacity + 1, alignof(char)));
+				std::memcpy(ptr, chars, size);
+				set_heap(ptr, size, new_capacity);
+				return;
+			}
+			char* ptr = static_cast<char*>(Allocator::reallocate(heap.ptr,
+				heap_capacity() + 1, new_capacity + 1, alignof(char)));
+			set_heap(ptr, heap.size, new_capacity);
+		}
+	};
+
+	/// @brief String which stores up to 23 characters without allocating, in a 24-byte object
+	using string = basic_string<>;
+
+	/// @brief Returns a copy of 'str' in which all the non-overlapping occurrences of 'from' are replaced by 'to'
+	/// @param str The string in which to replace
+	/// @param from The characters to replace (nothing is replaced if it is empty)
+	/// @param to The replacement
+	/// @return The string after replacement
+	inline string replace_all(string_view str, string_view from, string_view to)
+	{
+		if (from.is_empty())
+			return string(str);
+		string result;
+		details::append_replaced(result, str, from, to);
+		return result;
+	}
+
+	template<size_t N, typename Growth = default_growth, typename Allocator = heap_allocator>
+	/// @brief String which stores up to 'N' characters without allocating
+	using small_string = basic_string<Growth, Allocator, OptionalBuffer, N>;
+
+	template<typename Growth, typename Allocator, typename BufferPolicy, size_t inline_capacity>
+	/// @brief Strings do not point into themselves: they can be relocated using memcpy
+	struct is_trivially_relocatable<basic_string<Growth, Allocator, BufferPolicy, inline_capacity>> : std::true_type {};
+
+	template<typename Growth, typename Allocator, typename BufferPolicy, size_t inline_capacity>
+	/// @brief writes the characters of the string.
+	static std::ostream& operator<<(std::ostream& os, const basic_string<Growth, Allocator, BufferPolicy, inline_capacity>& var)
+	{
+		var.print(os);
+		return os;
+	}
+
+	/******************************************
+	UTF-8
+	******************************************/
+
+	/// @brief Alias over a contiguous_struct_view of UTF-16 code units
+	using u16string_view = contiguous_struct_view<char16_t>;
+
+	/// @brief Alias over a contiguous_struct_view of UTF-32 code points
+	using u32string_view = contiguous_struct_view<char32_t>;
+
+	namespace details
+	{
+		/// @brief Check if 8 characters are all ASCII
+		inline bool is_ascii_word(const char* str) noexcept
+		{
+			uint64_t word;
+			std::memcpy(&word, str, sizeof(uint64_t));
+			return (word & 0x8080808080808080ull) == 0;
+		}
+
+		/// @brief Decodes the code point beginning at 'str', accepting only the well-formed
+		/// byte sequences of the Unicode standard (no overlong forms, surrogates, or code points above U+10FFFF)
+		/// @return The number of bytes of the code point (1 to 4), or 0 if the sequence is invalid or truncated
+		inline size_t decode_utf8(const unsigned char* str, size_t size, char32_t& code_point) noexcept
+		{
+			const unsigned char lead = str[0];
+			if (lead < 0x80)
+			{
+				code_point = lead;
+				return 1;
+			}
+			if (lead < 0xC2)
+				return 0;
+			if (lead < 0xE0)
+			{
+				if (size < 2 || (str[1] & 0xC0) != 0x80)
+					return 0;
+				code_point = (char32_t(lead & 0x1F) << 6) | (str[1] & 0x3F);
+				return 2;
+			}
+			if (lead < 0xF0)
+			{
+				const unsigned char low = lead == 0xE0 ? 0xA0 : 0x80;
+				const unsigned char high = lead == 0xED ? 0x9F : 0xBF;
+				if (size < 3 || str[1] < low || str[1] > high || (str[2] & 0xC0) != 0x80)
+					return 0;
+				code_point = (char32_t(lead & 0x0F) << 12) | (char32_t(str[1] & 0x3F) << 6) | (str[2] & 0x3F);
+				return 3;
+			}
+			if (lead < 0xF5)
+			{
+				const unsigned char low = lead == 0xF0 ? 0x90 : 0x80;
+				const unsigned char high = lead == 0xF4 ? 0x8F : 0xBF;
+				if (size < 4 || str[1] < low || str[1] > high || (str[2] & 0xC0) != 0x80 || (str[3] & 0xC0) != 0x80)
+					return 0;
+				code_point = (char32_t(lead & 0x07) << 18) | (char32_t(str[1] & 0x3F) << 12)
+					| (char32_t(str[2] & 0x3F) << 6) | (str[3] & 0x3F);
+				return 4;
+			}
+			return 0;
+		}
+
+		/// @brief Encodes a valid code point in UTF-8
+		/// @return The number of bytes written (1 to 4)
+		inline size_t encode_utf8(char32_t code_point, char* out) noexcept
+		{
+			if (code_point < 0x80)
+			{
+				out[0] = static_cast<char>(code_point);
+				return 1;
+			}
+			if (code_point < 0x800)
+			{
+				out[0] = static_cast<char>(0xC0 | (code_point >> 6));
+				out[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+				return 2;
+			}
+			if (code_point < 0x10000)
+			{
+				out[0] = static_cast<char>(0xE0 | (code_point >> 12));
+				out[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+				out[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+				return 3;
+			}
+			out[0] = static_cast<char>(0xF0 | (code_point >> 18));
+			out[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+			out[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+			out[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+			return 4;
+		}
+
+		/// @brief Scalar reference validation, which skips 8 ASCII characters at a time
+		/// @return The index of the first byte of the first invalid sequence, or npos if 'str' is valid UTF-8
+		inline size_t validate_utf8_scalar(const char* str, size_t size) noexcept
+		{
+			const auto* bytes = reinterpret_cast<const unsigned char*>(str);
+			size_t i = 0;
+			while (i < size)
+			{
+				if (i + 8 <= size && is_ascii_word(str + i))
+				{
+					i += 8;
+					continue;
+				}
+				char32_t code_point;
+				const size_t length = decode_utf8(bytes + i, size - i, code_point);
+				if (length == 0)
+					return i;
+				i += length;
+			}
+			return npos;
+		}
+
+		/// @brief Scalar reference: returns the number of code points of valid UTF-8
+		inline size_t count_code_points_scalar(const char* str, size_t size) noexcept
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < size; i++)
+				count += (static_cast<unsigned char>(str[i]) & 0xC0) != 0x80;
+			return count;
+		}
+
+		/// @brief Scalar reference: converts UTF-8 to UTF-16
+		/// @return The number of code units written, or npos if 'str' is not valid UTF-8
+		inline size_t utf8_to_utf16_scalar(const char* str, size_t size, char16_t* out) noexcept
+		{
+			const auto* bytes = reinterpret_cast<const unsigned char*>(str);
+			const char16_t* begin = out;
+			for (size_t i = 0; i < size;)
+			{
+				char32_t code_point;
+				const size_t length = decode_utf8(bytes + i, size - i, code_point);
+				if (length == 0)
+					return npos;
+				i += length;
+				if (code_point < 0x10000)
+					*out++ = static_cast<char16_t>(code_point);
+				else
+				{
+					*out++ = static_cast<char16_t>(0xD800 + ((code_point - 0x10000) >> 10));
+					*out++ = static_cast<char16_t>(0xDC00 + ((code_point - 0x10000) & 0x3FF));
+				}
+			}
+			return out - begin;
+		}
+
+		/// @brief Scalar reference: converts UTF-8 to UTF-32
+		/// @return The number of code points written, or npos if 'str' is not valid UTF-8
+		inline size_t utf8_to_utf32_scalar(const char* str, size_t size, char32_t* out) noexcept
+		{
+			const auto* bytes = reinterpret_cast<const unsigned char*>(str);
+			const char32_t* begin = out;
+			for (size_t i = 0; i < size;)
+			{
+				const size_t length = decode_utf8(bytes + i, size - i, *out++);
+				if (length == 0)
+					return npos;
+				i += length;
+			}
+			return out - begin;
+		}
+
+		/// @brief Scalar reference: converts UTF-16 to UTF-8
+		/// @return The number of bytes written, or npos if 'str' contains an unpaired surrogate
+		inline size_t utf16_to_utf8_scalar(const char16_t* str, size_t size, char* out) noexcept
+		{
+			const char* begin = out;
+			for (size_t i = 0; i < size; i++)
+			{
+				char32_t code_point = str[i];
+				if (code_point >= 0xD800 && code_point <= 0xDFFF)
+				{
+					if (code_point > 0xDBFF || i + 1 == size || str[i + 1] < 0xDC00 || str[i + 1] > 0xDFFF)
+						return npos;
+					code_point = 0x10000 + ((code_point - 0xD800) << 10) + (str[++i] - 0xDC00);
+				}
+				out += encode_utf8(code_point, out);
+			}
+			return out - begin;
+		}
+
+		/// @brief Scalar reference: converts UTF-32 to UTF-8
+		/// @return The number of bytes written, or npos if 'str' contains a surrogate or a value above U+10FFFF
+		inline size_t utf32_to_utf8_scalar(const char32_t* str, size_t size, char* out) noexcept
+		{
+			const char* begin = out;
+			for (size_t i = 0; i < size; i++)
+			{
+				if (str[i] > 0x10FFFF || (str[i] >= 0xD800 && str[i] <= 0xDFFF))
+					return npos;
+				out += encode_utf8(str[i], out);
+			}
+			return out - begin;
+		}
+
+#if defined(__AVX2__)
+		/// @brief Validates 32 bytes at a time using the lookup tables of validate_utf8_lookup().
+		/// Also used by the fingerprint filter of multi_matcher.
+		struct utf8_block
+		{
+			using type = __m256i;
+			/// @brief The number of bytes in a block
+			static constexpr size_t width = 32;
+
+			static type load(const char* ptr) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); }
+			static type splat(uint8_t value) noexcept { return _mm256_set1_epi8(static_cast<char>(value)); }
+			static void store(uint8_t* ptr, type a) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), a); }
+			/// @brief Creates a lookup table of 16 entries
+			static type table(const uint8_t (&entries)[16]) noexcept
+			{
+				return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(entries)));
+			}
+			/// @brief Returns the entries of 'table' indexed by each byte of 'index' (which should be lower than 16)
+			static type lookup(type table, type index) noexcept { return _mm256_shuffle_epi8(table, index); }
+			static type high_nibbles(type a) noexcept { return _mm256_and_si256(_mm256_srli_epi16(a, 4), splat(0x0F)); }
+			static type low_nibbles(type a) noexcept { return _mm256_and_si256(a, splat(0x0F)); }
+			template<int N>
+			/// @brief Returns the bytes of 'input' shifted by N bytes, the first ones coming from 'previous'
+			static type previous(type input, type previous) noexcept
+			{
+				return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+			}
+			static type bit_and(type a, type b) noexcept { return _mm256_and_si256(a, b); }
+			static type bit_or(type a, type b) noexcept { return _mm256_or_si256(a, b); }
+			static type bit_xor(type a, type b) noexcept { return _mm256_xor_si256(a, b); }
+			/// @brief Unsigned saturating subtraction
+			static type saturating_sub(type a, type b) noexcept { return _mm256_subs_epu8(a, b); }
+			/// @brief Returns 0xFF for the (signed) bytes of 'a' greater than 0
+			static type is_positive(type a) noexcept { return _mm256_cmpgt_epi8(a, _mm256_setzero_si256()); }
+			static bool is_ascii(type a) noexcept { return _mm256_movemask_epi8(a) == 0; }
+			static bool is_zero(type a) noexcept { return _mm256_testz_si256(a, a) != 0; }
+		};
+#elif defined(__SSSE3__)
+		/// @brief Validates 16 bytes at a time using the lookup tables of validate_utf8_lookup().
+		/// Also used by the fingerprint filter of multi_matcher.
+		struct utf8_block
+		{
+			using type = __m128i;
+			/// @brief The number of bytes in a block
+			static constexpr size_t width = 16;
+
+			static type load(const char* ptr) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)); }
+			static type splat(uint8_t value) noexcept { return _mm_set1_epi8(static_cast<char>(value)); }
+			static void store(uint8_t* ptr, type a) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), a); }
+			/// @brief Creates a lookup table of 16 entries
+			static type table(const uint8_t (&entries)[16]) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(entries)); }
+			/// @brief Returns the entries of 'table' indexed by each byte of 'index' (which should be lower than 16)
+			static type lookup(type table, type index) noexcept { return _mm_shuffle_epi8(table, index); }
+			static type high_nibbles(type a) noexcept { return _mm_and_si128(_mm_srli_epi16(a, 4), splat(0x0F)); }
+			static type low_nibbles(type a) noexcept { return _mm_and_si128(a, splat(0x0F)); }
+			template<int N>
+			/// @brief Returns the bytes of 'input' shifted by N bytes, the first ones coming from 'previous'
+			static type previous(type input, type previous) noexcept { return _mm_alignr_epi8(input, previous, 16 - N); }
+			static type bit_and(type a, type b) noexcept { return _mm_and_si128(a, b); }
+			static type bit_or(type a, type b) noexcept { return _mm_or_si128(a, b); }
+			static type bit_xor(type a, type b) noexcept { return _mm_xor_si128(a, b); }
+			/// @brief Unsigned saturating subtraction
+			static type saturating_sub(type a, type b) noexcept { return _mm_subs_epu8(a, b); }
+			/// @brief Returns 0xFF for the (signed) bytes of 'a' greater than 0
+			static type is_positive(type a) noexcept { return _mm_cmpgt_epi8(a, _mm_setzero_si128()); }
+			static bool is_ascii(type a) noexcept { return _mm_movemask_epi8(a) == 0; }
+			static bool is_zero(type a) noexcept { return _mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_setzero_si128())) == 0xFFFF; }
+		};
+#else
+		/// @brief No byte shuffle instruction is available: validation uses validate_utf8_blocks(),
+		/// and multi_matcher always uses its automaton.
+		/// The methods are never called, but must exist as the SIMD loop is discarded by 'if constexpr'.
+		struct utf8_block
+		{
+			using type = uint8_t;
+			/// @brief The number of bytes in a block
+			static constexpr size_t width = 0;
+
+			static type load(const char* ptr) noexcept { return static_cast<type>(*ptr); }
+			static type splat(uint8_t value) noexcept { return value; }
+			static void store(uint8_t* ptr, type a) noexcept { *ptr = a; }
+			static type table(const uint8_t (&entries)[16]) noexcept { return entries[0]; }
+			static type lookup(type table, type) noexcept { return table; }
+			static type high_nibbles(type a) noexcept { return a; }
+			static type low_nibbles(type a) noexcept { return a; }
+			template<int N>
+			static type previous(type input, type) noexcept { return input; }
+			static type bit_and(type a, type b) noexcept { return a & b; }
+			static type bit_or(type a, type b) noexcept { return a | b; }
+			static type bit_xor(type a, type b) noexcept { return a ^ b; }
+			static type saturating_sub(type a, type) noexcept { return a; }
+			static type is_positive(type a) noexcept { return a; }
+			static bool is_ascii(type a) noexcept { return a < 0x80; }
+			static bool is_zero(type a) noexcept { return a == 0; }
+		};
+#endif
+
+		/// @brief Validates UTF-8 one utf8_block at a time, using the lookup algorithm of Keiser and Lemire
+		/// ("Validating UTF-8 In Less Than One Instruction Per Byte").
+		/// Each byte is classified with its predecessor using 3 lookup tables indexed by nibbles, whose entries
+		/// are sets of the errors the pair of bytes could be part of: an error is present if all 3 entries contain it.
+		/// Continuation bytes expected after 3 and 4 byte leads are checked separately, as are sequences truncated
+		/// by the end of the input.
+		/// @return True if 'str' is valid UTF-8
+		inline bool validate_utf8_lookup(const char* str, size_t size) noexcept
+		{
+			using block = utf8_block;
+			//Errors of a pair of bytes (first byte, second byte)
+			constexpr uint8_t too_short = 1 << 0;		// 11______ 0_______ or 11______ 11______
+			constexpr uint8_t too_long = 1 << 1;		// 0_______ 10______
+			constexpr uint8_t overlong_3 = 1 << 2;		// 11100000 100_____
+			constexpr uint8_t too_large = 1 << 3;		// 11110100 1001____, 11110100 101_____ or 11110101+ 10______
+			constexpr uint8_t surrogate = 1 << 4;		// 11101101 101_____
+			constexpr uint8_t overlong_2 = 1 << 5;		// 1100000_ 10______
+			constexpr uint8_t too_large_1000 = 1 << 6;	// 11110100 1000____ or 11110101+ 1000____
+			constexpr uint8_t overlong_4 = 1 << 6;		// 11110000 1000____
+			constexpr uint8_t two_conts = 1 << 7;		// 10______ 10______
+			constexpr uint8_t carry = too_short | too_long | two_conts;
+
+			static constexpr uint8_t first_high[16] = {
+				too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+				two_conts, two_conts, two_conts, two_conts,
+				too_short | overlong_2,
+				too_short,
+				too_short | overlong_3 | surrogate,
+				too_short | too_large | too_large_1000 | overlong_4
+			};
+			static constexpr uint8_t first_low[16] = {
+				carry | overlong_3 | overlong_2 | overlong_4,
+				carry | overlong_2,
+				carry, carry,
+				carry | too_large,
+				carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000 | surrogate,
+				carry | too_large | too_large_1000, carry | too_large | too_large_1000
+			};
+			static constexpr uint8_t second_high[16] = {
+				too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+				too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+				too_long | overlong_2 | two_conts | overlong_3 | too_large,
+				too_long | overlong_2 | two_conts | surrogate | too_large,
+				too_long | overlong_2 | two_conts | surrogate | too_large,
+				too_short, too_short, too_short, too_short
+			};
+			//The maximum value of the last 3 bytes of a block that do not begin a truncated sequence
+			alignas(32) uint8_t incomplete[block::width == 0 ? 1 : block::width];
+			std::memset(incomplete, 0xFF, sizeof(incomplete));
+			if constexpr (block::width != 0)
+			{
+				incomplete[block::width - 3] = 0xEF;
+				incomplete[block::width - 2] = 0xDF;
+				incomplete[block::width - 1] = 0xBF;
+			}
+
+			const auto first_high_table = block::table(first_high);
+			const auto first_low_table = block::table(first_low);
+			const auto second_high_table = block::table(second_high);
+			const auto max_complete = block::load(reinterpret_cast<const char*>(incomplete));
+			const auto zero = block::splat(0);
+			auto error = zero;
+			auto previous_input = zero;
+			auto previous_incomplete = zero;
+
+			const auto check = [&](typename block::type input)
+			{
+				if (block::is_ascii(input))
+				{
+					error = block::bit_or(error, previous_incomplete);
+					previous_input = input;
+					previous_incomplete = zero;
+					return;
+				}
+				const auto previous_1 = block::template previous<1>(input, previous_input);
+				const auto special = block::bit_and(block::bit_and(
+					block::lookup(first_high_table, block::high_nibbles(previous_1)),
+					block::lookup(first_low_table, block::low_nibbles(previous_1))),
+					block::lookup(second_high_table, block::high_nibbles(input)));
+				//The bytes following 3 and 4 byte leads by 2 and 3 bytes must be continuations
+				const auto is_third = block::saturating_sub(block::template previous<2>(input, previous_input), block::splat(0xE0 - 1));
+				const auto is_fourth = block::saturating_sub(block::template previous<3>(input, previous_input), block::splat(0xF0 - 1));
+				const auto must_be_continuation = block::bit_and(block::is_positive(block::bit_or(is_third, is_fourth)), block::splat(0x80));
+				error = block::bit_or(error, block::bit_xor(must_be_continuation, special));
+				previous_incomplete = block::saturating_sub(input, max_complete);
+				previous_input = input;
+			};
+
+			size_t i = 0;
+			for (; i + block::width <= size; i += block::width)
+				check(block::load(str + i));
+			if (i != size)
+			{
+				//The last partial block is padded with ASCII zeroes
+				char tail[block::width == 0 ? 1 : block::width] = {};
+				std::memcpy(tail, str + i, size - i);
+				check(block::load(tail));
+			}
+			return block::is_zero(block::bit_or(error, previous_incomplete));
+		}
+
+		template<typename Char>
+		/// @brief Widens 16 characters to UTF-16 or UTF-32 if they are all ASCII
+		/// @return False (without writing) if one of the characters is not ASCII
+		inline bool widen_ascii(const char* str, Char* out) noexcept
+		{
+#if defined(__SSE2__) || defined(_M_X64)
+			const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+			if (_mm_movemask_epi8(input) != 0)
+				return false;
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i low = _mm_unpacklo_epi8(input, zero);
+			const __m128i high = _mm_unpackhi_epi8(input, zero);
+			auto* ptr = reinterpret_cast<__m128i*>(out);
+			if constexpr (sizeof(Char) == 2)
+			{
+				_mm_storeu_si128(ptr, low);
+				_mm_storeu_si128(ptr + 1, high);
+			}
+			else
+			{
+				_mm_storeu_si128(ptr, _mm_unpacklo_epi16(low, zero));
+				_mm_storeu_si128(ptr + 1, _mm_unpackhi_epi16(low, zero));
+				_mm_storeu_si128(ptr + 2, _mm_unpacklo_epi16(high, zero));
+				_mm_storeu_si128(ptr + 3, _mm_unpackhi_epi16(high, zero));
+			}
+			return true;
+#else
+			if (!is_ascii_word(str) || !is_ascii_word(str + 8))
+				return false;
+			for (size_t i = 0; i < 16; i++)
+				out[i] = static_cast<Char>(str[i]);
+			return true;
+#endif
+		}
+
+		template<typename Char>
+		/// @brief Narrows 16 UTF-16 or UTF-32 code units to UTF-8 if they are all ASCII
+		/// @return False (without writing) if one of the code units is not ASCII
+		inline bool narrow_ascii(const Char* str, char* out) noexcept
+		{
+#if defined(__SSE2__) || defined(_M_X64)
+			const auto* ptr = reinterpret_cast<const __m128i*>(str);
+			__m128i low, high;
+			if constexpr (sizeof(Char) == 2)
+			{
+				low = _mm_loadu_si128(ptr);
+				high = _mm_loadu_si128(ptr + 1);
+			}
+			else
+			{
+				const __m128i a = _mm_loadu_si128(ptr), b = _mm_loadu_si128(ptr + 1);
+				const __m128i c = _mm_loadu_si128(ptr + 2), d = _mm_loadu_si128(ptr + 3);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)),
+					_mm_set1_epi32(static_cast<int>(0xFFFFFF80))), _mm_setzero_si128())) != 0xFFFF)
+					return false;
+				low = _mm_packs_epi32(a, b);
+				high = _mm_packs_epi32(c, d);
+			}
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(low, high), _mm_set1_epi16(static_cast<short>(0xFF80))),
+				_mm_setzero_si128())) != 0xFFFF)
+				return false;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(low, high));
+			return true;
+#else
+			for (size_t i = 0; i < 16; i++)
+			{
+				if (str[i] >= 0x80)
+					return false;
+			}
+			for (size_t i = 0; i < 16; i++)
+				out[i] = static_cast<char>(str[i]);
+			return true;
+#endif
+		}
+
+		/// @brief Check if 16 characters are all ASCII
+		inline bool is_ascii_block(const char* str) noexcept
+		{
+#if defined(__SSE2__) || defined(_M_X64)
+			return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(str))) == 0;
+#else
+			return is_ascii_word(str) && is_ascii_word(str + 8);
+#endif
+		}
+
+		/// @brief Validates UTF-8 when no byte shuffle instruction is available:
+		/// blocks of 16 ASCII characters are skipped at once, and the code points of the other blocks
+		/// are decoded one at a time
+		/// @return True if 'str' is valid UTF-8
+		inline bool validate_utf8_blocks(const char* str, size_t size) noexcept
+		{
+			const auto* bytes = reinterpret_cast<const unsigned char*>(str);
+			size_t i = 0;
+			while (i < size)
+			{
+				if (i + 16 <= size && is_ascii_block(str + i))
+				{
+					i += 16;
+					continue;
+				}
+				//Decode up to the end of the block (the last code point can overlap the next one)
+				for (const size_t end = std::min(size, i + 16); i < end;)
+				{
+					if (bytes[i] < 0x80)
+					{
+						i++;
+						continue;
+					}
+					char32_t code_point;
+					const size_t length = decode_utf8(bytes + i, size - i, code_point);
+					if (length == 0)
+						return false;
+					i += length;
+				}
+			}
+			return true;
+		}
+
+		template<typename Char>
+		/// @brief Converts UTF-8 to UTF-16 or UTF-32: blocks of 16 ASCII characters are widened at once,
+		/// and the code points of the other blocks are decoded one at a time
+		/// @return The number of code units written, or npos if 'str' is not valid UTF-8
+		inline size_t utf8_to_wide(const char* str, size_t size, Char* out) noexcept
+		{
+			const auto* bytes = reinterpret_cast<const unsigned char*>(str);
+			const Char* begin = out;
+			size_t i = 0;
+			while (i < size)
+			{
+				if (i + 16 <= size && widen_ascii(str + i, out))
+				{
+					i += 16;
+					out += 16;
+					continue;
+				}
+				//Decode up to the end of the block (the last code point can overlap the next one)
+				for (const size_t end = std::min(size, i + 16); i < end;)
+				{
+					if (bytes[i] < 0x80)
+					{
+						*out++ = bytes[i++];
+						continue;
+					}
+					char32_t code_point;
+					const size_t length = decode_utf8(bytes + i, size - i, code_point);
+					if (length == 0)
+						return npos;
+					i += length;
+					if constexpr (sizeof(Char) == 4)
+						*out++ = code_point;
+					else if (code_point < 0x10000)
+						*out++ = static_cast<char16_t>(code_point);
+					else
+					{
+						*out++ = static_cast<char16_t>(0xD800 + ((code_point - 0x10000) >> 10));
+						*out++ = static_cast<char16_t>(0xDC00 + ((code_point - 0x10000) & 0x3FF));
+					}
+				}
+			}
+			return out - begin;
+		}
+
+		template<typename Char>
+		/// @brief Converts UTF-16 or UTF-32 to UTF-8: blocks of 16 ASCII code units are narrowed at once,
+		/// and the code points of the other blocks are encoded one at a time
+		/// @return The number of bytes written, or npos if 'str' is not valid
+		inline size_t wide_to_utf8(const Char* str, size_t size, char* out) noexcept
+		{
+			const char* begin = out;
+			size_t i = 0;
+			while (i < size)
+			{
+				if (i + 16 <= size && narrow_ascii(str + i, out))
+				{
+					i += 16;
+					out += 16;
+					continue;
+				}
+				//Encode up to the end of the block (the last surrogate pair can overlap the next one)
+				for (const size_t end = std::min(size, i + 16); i < end; i++)
+				{
+					char32_t code_point = str[i];
+					if (code_point < 0x80)
+					{
+						*out++ = static_cast<char>(code_point);
+						continue;
+					}
+					if (code_point - 0xD800 < 0x800 || code_point > 0x10FFFF)
+					{
+						if (sizeof(Char) == 4 || code_point > 0xDBFF || i + 1 == size || str[i + 1] - 0xDC00u >= 0x400)
+							return npos;
+						code_point = 0x10000 + ((code_point - 0xD800) << 10) + (str[++i] - 0xDC00);
+					}
+					out += encode_utf8(code_point, out);
+				}
+			}
+			return out - begin;
+		}
+
+		/// @brief Returns the number of characters of 'str' which are greater than 'lower' and (if 'upper' is not 0) not greater than 'upper'.
+		/// The characters are compared as signed bytes, whether 'char' is signed or not.
+		inline size_t count_in_range(const char* str, size_t size, int8_t lower, int8_t upper) noexcept
+		{
+			size_t i = 0;
+			size_t count = 0;
+			if constexpr (char_block::width != 0)
+			{
+				//The masks of 64 characters are merged to count them with a single popcount
+				const auto lower_block = char_block::splat(static_cast<char>(lower));
+				const auto upper_block = char_block::splat(static_cast<char>(upper));
+				for (; i + 64 <= size; i += 64)
+				{
+					uint64_t mask = 0;
+					for (size_t block = 0; block < 64; block += char_block::width)
+					{
+						const auto input = char_block::load(str + i + block);
+						uint32_t in_range = char_block::greater(input, lower_block);
+						if (upper != 0)
+							in_range &= ~char_block::greater(input, upper_block);
+						mask |= uint64_t(in_range) << block;
+					}
+					count += helpers::popcount(mask);
+				}
+			}
+			for (; i < size; i++)
+			{
+				const int8_t c = static_cast<int8_t>(str[i]);
+				count += c > lower && (upper == 0 || c <= upper);
+			}
+			return count;
+		}
+	}
+
+	/// @brief Check if a string is valid UTF-8.
+	/// Uses the lookup algorithm of Keiser and Lemire on 16 or 32 bytes at a time when SSSE3/AVX2 are available,
+	/// and skips blocks of 16 ASCII characters otherwise.
+	/// @param str The string to validate
+	/// @return True if 'str' is valid UTF-8
+	inline bool is_valid_utf8(string_view str) noexcept
+	{
+		if constexpr (details::utf8_block::width != 0)
+			return details::validate_utf8_lookup(str.data(), str.size());
+		else
+			return details::validate_utf8_blocks(str.data(), str.size());
+	}
+
+	/// @brief Returns the index of the first invalid UTF-8 sequence of a string
+	/// @param str The string to validate
+	/// @return The index of the first byte of the first invalid sequence, or npos if 'str' is valid UTF-8
+	inline size_t find_invalid_utf8(string_view str) noexcept
+	{
+		//Locating the error is only needed on the (rare) invalid strings
+		return is_valid_utf8(str) ? npos : details::validate_utf8_scalar(str.data(), str.size());
+	}
+
+	/// @brief Returns the number of code points of a valid UTF-8 string
+	/// @param str The valid UTF-8 string
+	/// @return The number of code points (which is the number of bytes which are not continuation bytes)
+	inline size_t count_code_points(string_view str) noexcept
+	{
+		return details::count_in_range(str.data(), str.size(), static_cast<int8_t>(0xBF), 0);
+	}
+
+	/// @brief Returns the number of UTF-16 code units needed to represent a valid UTF-8 string
+	/// @param str The valid UTF-8 string
+	/// @return The number of code units (code points above U+FFFF take 2 code units)
+	inline size_t utf16_length(string_view str) noexcept
+	{
+		return count_code_points(str) + details::count_in_range(str.data(), str.size(), static_cast<int8_t>(0xEF), static_cast<int8_t>(0xFF));
+	}
+
+	/// @brief Returns the number of bytes needed to represent a UTF-16 string in UTF-8
+	/// @param str The UTF-16 string
+	/// @return The number of bytes (exact if 'str' is valid, never lower than the bytes written by utf16_to_utf8())
+	inline size_t utf8_length(u16string_view str) noexcept
+	{
+		size_t length = 0;
+		for (size_t i = 0; i < str.size(); i++)
+		{
+			const char16_t unit = str.data()[i];
+			length += 1 + (unit >= 0x80) + (unit >= 0x800 && (unit < 0xD800 || unit > 0xDFFF));
+		}
+		return length;
+	}
+
+	/// @brief Returns the number of bytes needed to represent a UTF-32 string in UTF-8
+	/// @param str The UTF-32 string
+	/// @return The number of bytes (exact if 'str' is valid, never lower than the bytes written by utf32_to_utf8())
+	inline size_t utf8_length(u32string_view str) noexcept
+	{
+		size_t length = 0;
+		for (size_t i = 0; i < str.size(); i++)
+		{
+			const char32_t code_point = str.data()[i];
+			length += 1 + (code_point >= 0x80) + (code_point >= 0x800) + (code_point >= 0x10000);
+		}
+		return length;
+	}
+
+	/// @brief Converts UTF-8 to UTF-16, validating the input
+	/// @param str The UTF-8 string
+	/// @param out The buffer to write to, which should be able to hold str.size() code units (or utf16_length(str))
+	/// @return The number of code units written, or npos if 'str' is not valid UTF-8
+	inline size_t utf8_to_utf16(string_view str, char16_t* out) noexcept
+	{
+		return details::utf8_to_wide(str.data(), str.size(), out);
+	}
+
+	/// @brief Converts UTF-8 to UTF-32, validating the input
+	/// @param str The UTF-8 string
+	/// @param out The buffer to write to, which should be able to hold str.size() code points (or count_code_points(str))
+	/// @return The number of code points written, or npos if 'str' is not valid UTF-8
+	inline size_t utf8_to_utf32(string_view str, char32_t* out) noexcept
+	{
+		return details::utf8_to_wide(str.data(), str.size(), out);
+	}
+
+	/// @brief Converts UTF-16 to UTF-8, validating the input
+	/// @param str The UTF-16 string
+	/// @param out The buffer to write to, which should be able to hold utf8_length(str) bytes
+	/// @return The number of bytes written, or npos if 'str' contains an unpaired surrogate
+	inline size_t utf16_to_utf8(u16string_view str, char* out) noexcept
+	{
+		return details::wide_to_utf8(str.data(), str.size(), out);
+	}
+
+	/// @brief Converts UTF-32 to UTF-8, validating the input
+	/// @param str The UTF-32 string
+	/// @param out The buffer to write to, which should be able to hold utf8_length(str) bytes
+	/// @return The number of bytes written, or npos if 'str' contains a surrogate or a value above U+10FFFF
+	inline size_t utf32_to_utf8(u32string_view str, char* out) noexcept
+	{
+		return details::wide_to_utf8(str.data(), str.size(), out);
+	}
+
+	/// @brief Converts UTF-8 to UTF-16.
+	/// Throws std::invalid_argument if 'str' is not valid UTF-8.
+	/// @param str The UTF-8 string
+	/// @return vector of UTF-16 code units
+	inline vector<char16_t> to_utf16(string_view str)
+	{
+		vector<char16_t> result;
+		result.resize_default_init(str.size());
+		const size_t written = utf8_to_utf16(str, result.data());
+		if (written == npos)
+			throw std::invalid_argument("vale::to_utf16: string was not valid UTF-8!");
+		result.resize(written);
+		return result;
+	}
+
+	/// @brief Converts UTF-8 to UTF-32.
+	/// Throws std::invalid_argument if 'str' is not valid UTF-8.
+	/// @param str The UTF-8 string
+	/// @return vector of code points
+	inline vector<char32_t> to_utf32(string_view str)
+	{
+		vector<char32_t> result;
+		result.resize_default_init(str.size());
+		const size_t written = utf8_to_utf32(str, result.data());
+		if (written == npos)
+			throw std::invalid_argument("vale::to_utf32: string was not valid UTF-8!");
+		result.resize(written);
+		return result;
+	}
+
+	/// @brief Converts UTF-16 to UTF-8.
+	/// Throws std::invalid_argument if 'str' contains an unpaired surrogate.
+	/// @param str The UTF-16 string
+	/// @return UTF-8 string
+	inline string to_utf8(u16string_view str)
+	{
+		string result;
+		result.resize(utf8_length(str));
+		const size_t written = utf16_to_utf8(str, result.data());
+		if (written == npos)
+			throw std::invalid_argument("vale::to_utf8: string was not valid UTF-16!");
+		result.resize(written);
+		return result;
+	}
+
+	/// @brief Converts UTF-32 to UTF-8.
+	/// Throws std::invalid_argument if 'str' contains a surrogate or a value above U+10FFFF.
+	/// @param str The UTF-32 string
+	/// @return UTF-8 string
+	inline string to_utf8(u32string_view str)
+	{
+		string result;
+		result.resize(utf8_length(str));
+		const size_t written = utf32_to_utf8(str, result.data());
+		if (written == npos)
+			throw std::invalid_argument("vale::to_utf8: string was not valid UTF-32!");
+		result.resize(written);
+		return result;
+	}
+
+	/******************************************
+	ROPE
+	******************************************/
+
+	namespace details
+	{
+		/// @brief A node of a rope: either a leaf owning characters (stored right after the node),
+		/// or the concatenation of two nodes. Nodes are shared between ropes through their reference count,
+		/// and are never modified once shared.
+		struct rope_node
+		{
+			/// @brief The number of ropes and nodes referencing this node
+			std::atomic<size_t> refcount;
+			/// @brief The number of characters of the node
+			size_t size;
+			/// @brief The depth of the node (0 for leaves)
+			size_t depth;
+			/// @brief The left child of a concatenation (nullptr for leaves)
+			rope_node* left;
+			/// @brief The right child of a concatenation (nullptr for leaves)
+			rope_node* right;
+			/// @brief The number of characters that can be stored after a leaf (0 for concatenations)
+			size_t capacity;
+
+			/// @brief Check if the node is a leaf
+			/// @return True if the node owns characters
+			bool is_leaf() const noexcept { return depth == 0; }
+
+			/// @brief Returns the characters of a leaf
+			/// @return Pointer to the characters stored after the node
+			char* chars() noexcept { return reinterpret_cast<char*>(this + 1); }
+
+			/// @brief Returns the characters of a leaf
+			/// @return Pointer to the characters stored after the node
+			const char* chars() const noexcept { return reinterpret_cast<const char*>(this + 1); }
+		};
+	}
+
+	template<typename Allocator = heap_allocator>
+	/// @brief An immutable-chunk string for large incremental concatenations.
+	/// A rope is a balanced tree whose leaves are reference counted chunks of characters:
+	/// copying a rope is O(1), and concatenating, inserting, erasing or taking a substring
+	/// are O(log n) operations which share the untouched chunks instead of copying them.
+	///
+	/// Appending to a rope fills its last chunk in place while no other rope shares it,
+	/// so that building a document through many small appends does not allocate per append.
+	/// Ropes sharing chunks can be used from different threads, but a single rope is not thread safe.
+	/// @tparam Allocator The allocator policy used for the nodes
+	class basic_rope
+	{
+		using node = details::rope_node;
+
+		/// @brief The number of characters of a full chunk (chunks are allocated 4 KB at a time)
+		static constexpr size_t chunk_capacity = 4096 - sizeof(node);
+		/// @brief Adjacent chunks whose total size is lower than this threshold are merged
+		static constexpr size_t merge_threshold = 256;
+		/// @brief The maximum depth of a rope (the depths of siblings differ by at most 2)
+		static constexpr size_t max_depth = 128;
+
+		/// @brief Owning pointer to a node
+		class node_ptr
+		{
+			/// @brief The node or nullptr
+			node* ptr = nullptr;
+
+		public:
+			node_ptr() noexcept = default;
+			/// @brief Takes ownership of a reference to 'ptr'
+			explicit node_ptr(node* ptr) noexcept : ptr(ptr) {}
+			node_ptr(const node_ptr& to_copy) noexcept : ptr(to_copy.ptr) { acquire(ptr); }
+			node_ptr(node_ptr&& to_move) noexcept : ptr(std::exchange(to_move.ptr, nullptr)) {}
+			node_ptr& operator=(node_ptr other) noexcept { std::swap(ptr, other.ptr); return *this; }
+			~node_ptr() { basic_rope::release(ptr); }
+
+			/// @brief Returns a new reference to a node
+			static node_ptr share(node* ptr) noexcept { acquire(ptr); return node_ptr(ptr); }
+
+			/// @brief Releases ownership of the reference without removing it
+			node* detach() noexcept { return std::exchange(ptr, nullptr); }
+
+			node* get() const noexcept { return ptr; }
+			node* operator->() const noexcept { return ptr; }
+			explicit operator bool() const noexcept { return ptr != nullptr; }
+		};
+
+		/// @brief The root of the tree, or nullptr for empty ropes
+		node_ptr root;
+
+		explicit basic_rope(node_ptr root) noexcept
+			: root(std::move(root)) {}
+
+	public:
+		/// @brief Forward iterator over the chunks of a rope, each exposed as a string_view
+		class chunk_iterator
+		{
+			/// @brief The right siblings of the ancestors of the current chunk, which remain to be visited
+			static_vector<const node*, max_depth> pending;
+			/// @brief The current chunk, or nullptr for the end iterator
+			const node* current = nullptr;
+
+			/// @brief Sets the current chunk to the leftmost leaf of 'from'
+			void descend(const node* from) noexcept
+			{
+				while (!from->is_leaf())
+				{
+					pending.push_back(from->right);
+					from = from->left;
+				}
+				current = from;
+			}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = string_view;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const string_view*;
+			using reference = string_view;
+
+			/// @brief Constructs the end iterator
+			chunk_iterator() noexcept = default;
+
+			/// @brief Constructs an iterator to the first chunk of a tree
+			/// @param root The root of the tree (can be nullptr)
+			explicit chunk_iterator(const node* root) noexcept
+			{
+				if (root != nullptr)
+					descend(root);
+			}
+
+			string_view operator*() const noexcept { return string_view(current->chars(), current->size); }
+
+			chunk_iterator& operator++() noexcept
+			{
+				if (pending.is_empty())
+				{
+					current = nullptr;
+					return *this;
+				}
+				const node* next = pending.back();
+				pending.pop_back();
+				descend(next);
+				return *this;
+			}
+
+			chunk_iterator operator++(int) noexcept { chunk_iterator copy = *this; ++*this; return copy; }
+
+			friend bool operator==(const chunk_iterator& a, const chunk_iterator& b) noexcept { return a.current == b.current; }
+			friend bool operator!=(const chunk_iterator& a, const chunk_iterator& b) noexcept { return a.current != b.current; }
+		};
+
+		/// @brief Range over the chunks of a rope, which should not outlive the rope
+		class chunk_range
+		{
+			/// @brief The root of the rope
+			const node* root;
+
+		public:
+			explicit chunk_range(const node* root) noexcept : root(root) {}
+
+			chunk_iterator begin() const noexcept { return chunk_iterator(root); }
+			chunk_iterator end() const noexcept { return chunk_iterator(); }
+		};
+
+		/// @brief Constructs an empty rope
+		basic_rope() noexcept = default;
+
+		/// @brief Constructs a rope containing a copy of the characters pointed to by a view
+		/// @param view The characters to copy
+		explicit basic_rope(string_view view)
+			: root(build(view.data(), view.size())) {}
+
+		/// @brief Constructs a rope containing a copy of a null-terminated string
+		/// @param str The null-terminated string
+		basic_rope(const char* str)
+			: basic_rope(vale::to_view(str)) {}
+
+		/// @brief Shares the chunks of another rope, in O(1)
+		basic_rope(const basic_rope&) noexcept = default;
+		basic_rope(basic_rope&&) noexcept = default;
+		basic_rope& operator=(const basic_rope&) noexcept = default;
+		basic_rope& operator=(basic_rope&&) noexcept = default;
+
+		/// @brief Returns the number of characters of the rope
+		/// @return The number of characters
+		[[nodiscard]] size_t size() const noexcept { return root ? root->size : 0; }
+
+		/// @brief Check if the rope is empty
+		/// @return True if the rope does not contain any character
+		[[nodiscard]] bool is_empty() const noexcept { return !root; }
+
+		/// @brief Returns the depth of the tree of the rope, which is O(log(number of chunks))
+		/// @return The depth of the tree (0 for a single chunk)
+		[[nodiscard]] size_t depth() const noexcept { return root ? root->depth : 0; }
+
+		/// @brief Returns the character at 'index', in O(log n).
+		/// Throws if index >= size().
+		/// @param index The index of the character
+		/// @return The character at 'index'
+		[[nodiscard]] char at(size_t index) const
+		{
+			if (index >= size())
+				throw std::out_of_range("vale::rope: index was greater than size!");
+			const node* current = root.get();
+			while (!current->is_leaf())
+			{
+				if (index < current->left->size)
+					current = current->left;
+				else
+				{
+					index -= current->left->size;
+					current = current->right;
+				}
+			}
+			return current->chars()[index];
+		}
+
+		/// @brief Returns a range over the chunks of the rope, from left to right.
+		/// Each chunk is a string_view, which can be passed as is to scatter/gather writes (writev).
+		/// @return Range over the chunks (which is invalidated by modifications of the rope)
+		[[nodiscard]] chunk_range chunks() const noexcept { return chunk_range(root.get()); }
+
+		/// @brief Returns the number of chunks of the rope
+		/// @return The number of chunks
+		[[nodiscard]] size_t chunk_count() const noexcept
+		{
+			size_t count = 0;
+			for (chunk_iterator it = chunk_iterator(root.get()); it != chunk_iterator(); ++it)
+				count++;
+			return count;
+		}
+
+		/// @brief Returns a rope sharing 'size' characters of the rope starting from 'offset', in O(log n).
+		/// Throws if offset + size > size().
+		/// @param offset The index of the first character
+		/// @param size The number of characters
+		/// @return The substring
+		[[nodiscard]] basic_rope substr(size_t offset, size_t size) const
+		{
+			const size_t nb_elem = this->size();
+			if (offset > nb_elem || size > nb_elem - offset)
+				throw std::out_of_range("vale::rope: offset + size was greater than size!");
+			auto [before, rest] = split(root, offset);
+			return basic_rope(split(std::move(rest), size).first);
+		}
+
+		/// @brief Appends a copy of the characters pointed to by a view
+		/// @param view The characters to append
+		/// @return *this
+		basic_rope& append(string_view view)
+		{
+			const size_t filled = append_in_place(view);
+			if (filled != view.size())
+				root = concat(std::move(root), build(view.data() + filled, view.size() - filled));
+			return *this;
+		}
+
+		/// @brief Appends another rope, sharing its chunks, in O(log n)
+		/// @param other The rope to append (which can be *this)
+		/// @return *this
+		basic_rope& append(const basic_rope& other)
+		{
+			node_ptr appended = other.root;
+			root = concat(std::move(root), std::move(appended));
+			return *this;
+		}
+
+		basic_rope& operator+=(string_view view) { return append(view); }
+		basic_rope& operator+=(const basic_rope& other) { return append(other); }
+		basic_rope& operator+=(const char* str) { return append(vale::to_view(str)); }
+
+		/// @brief Inserts a copy of the characters pointed to by a view before 'offset', in O(log n).
+		/// Throws if offset > size().
+		/// @param offset The index before which to insert
+		/// @param view The characters to insert
+		/// @return *this
+		basic_rope& insert(size_t offset, string_view view)
+		{
+			return insert(offset, basic_rope(view));
+		}
+
+		/// @brief Inserts another rope before 'offset', sharing its chunks, in O(log n).
+		/// Throws if offset > size().
+		/// @param offset The index before which to insert
+		/// @param other The rope to insert (which can be *this)
+		/// @return *this
+		basic_rope& insert(size_t offset, const basic_rope& other)
+		{
+			if (offset > size())
+				throw std::out_of_range("vale::rope: offset was greater than size!");
+			node_ptr inserted = other.root;
+			auto [before, after] = split(std::move(root), offset);
+			root = concat(concat(std::move(before), std::move(inserted)), std::move(after));
+			return *this;
+		}
+
+		/// @brief Erases 'count' characters starting at 'offset', in O(log n).
+		/// Throws if offset + count > size().
+		/// @param offset The index of the first character to erase
+		/// @param count The number of characters to erase
+		/// @return *this
+		basic_rope& erase(size_t offset, size_t count)
+		{
+			const size_t nb_elem = size();
+			if (offset > nb_elem || count > nb_elem - offset)
+				throw std::out_of_range("vale::rope: offset + count was greater than size!");
+			auto [before, rest] = split(std::move(root), offset);
+			root = concat(std::move(before), split(std::move(rest), count).second);
+			return *this;
+		}
+
+		/// @brief Removes all the characters of the rope
+		void clear() noexcept { root = node_ptr(); }
+
+		/// @brief Copies the characters of the rope to a buffer
+		/// @param out The buffer, which should be able to hold size() characters
+		void copy_to(char* out) const noexcept
+		{
+			for (string_view chunk : chunks())
+			{
+				std::memcpy(out, chunk.data(), chunk.size());
+				out += chunk.size();
+			}
+		}
+
+		template<typename String = vale::string>
+		/// @brief Flattens the rope into a contiguous string
+		/// @tparam String The string type to return (vale::basic_string or std::string)
+		/// @return String containing all the characters of the rope
+		[[nodiscard]] String flatten() const
+		{
+			String result;
+			result.resize(size());
+			copy_to(result.data());
+			return result;
+		}
+
+		/// @brief Prints the content of the rope in 'os'
+		/// @param os The ostream in which to << the rope's content
+		inline void print(std::ostream& os) const
+		{
+			for (string_view chunk : chunks())
+				os.write(chunk.data(), chunk.size());
+		}
+
+		friend bool operator==(const basic_rope& a, const basic_rope& b) noexcept
+		{
+			if (a.size() != b.size())
+				return false;
+			if (a.root.get() == b.root.get())
+				return true;
+			chunk_iterator it_a = chunk_iterator(a.root.get());
+			chunk_iterator it_b = chunk_iterator(b.root.get());
+			string_view chunk_a = *it_a, chunk_b = *it_b;
+			size_t offset_a = 0, offset_b = 0;
+			for (size_t left = a.size(); left != 0;)
+			{
+				const size_t count = std::min(chunk_a.size() - offset_a, chunk_b.size() - offset_b);
+				if (std::memcmp(chunk_a.data() + offset_a, chunk_b.data() + offset_b, count) != 0)
+					return false;
+				left -= count;
+				if ((offset_a += count) == chunk_a.size() && left != 0)
+					chunk_a = *++it_a, offset_a = 0;
+				if ((offset_b += count) == chunk_b.size() && left != 0)
+					chunk_b = *++it_b, offset_b = 0;
+			}
+			return true;
+		}
+		friend bool operator!=(const basic_rope& a, const basic_rope& b) noexcept { return !(a == b); }
+
+		friend basic_rope operator+(basic_rope a, const basic_rope& b) { a.append(b); return a; }
+
+	private:
+		/// @brief Adds a reference to a node
+		static void acquire(node* ptr) noexcept
+		{
+			if (ptr != nullptr)
+				ptr->refcount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/// @brief Removes a reference to a node, freeing it (and releasing its children) if it was the last one
+		static void release(node* ptr) noexcept
+		{
+			if (ptr == nullptr || ptr->refcount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+				return;
+			const size_t bytes = sizeof(node) + ptr->capacity;
+			if (!ptr->is_leaf())
+			{
+				release(ptr->left);
+				release(ptr->right);
+			}
+			ptr->~node();
+			Allocator::deallocate(ptr, bytes, alignof(node));
+		}
+
+		/// @brief Returns the depth of a node which is not null
+		static size_t depth_of(const node_ptr& ptr) noexcept { return ptr->depth; }
+
+		/// @brief Creates a leaf containing a copy of 'size' characters, which can hold up to 'capacity' characters
+		static node_ptr make_leaf(const char* data, size_t size, size_t capacity)
+		{
+			void* memory = Allocator::allocate(sizeof(node) + capacity, alignof(node));
+			node* leaf = new(memory) node{ { 1 }, size, 0, nullptr, nullptr, capacity };
+			std::memcpy(leaf->chars(), data, size);
+			return node_ptr(leaf);
+		}
+
+		/// @brief Creates the concatenation of two nodes which are not null, without balancing
+		static node_ptr make_concat(node_ptr left, node_ptr right)
+		{
+			void* memory = Allocator::allocate(sizeof(node), alignof(node));
+			const size_t depth = std::max(left->depth, right->depth) + 1;
+			const size_t size = left->size + right->size;
+			//The new node owns the references of its children
+			return node_ptr(new(memory) node{ { 1 }, size, depth, left.detach(), right.detach(), 0 });
+		}
+
+		/// @brief Builds a balanced tree of full chunks containing a copy of 'size' characters
+		static node_ptr build(const char* data, size_t size)
+		{
+			if (size <= chunk_capacity)
+				return size == 0 ? node_ptr() : make_leaf(data, size, chunk_capacity);
+			const size_t nb_chunks = (size + chunk_capacity - 1) / chunk_capacity;
+			const size_t left_size = (nb_chunks / 2) * chunk_capacity;
+			return make_concat(build(data, left_size), build(data + left_size, size - left_size));
+		}
+
+		/// @brief Creates the concatenation of two nodes whose depths differ by at most 3,
+		/// rotating them so that the depths of the children of the result differ by at most 2
+		static node_ptr balance(node_ptr left, node_ptr right)
+		{
+			if (depth_of(left) > depth_of(right) + 2)
+			{
+				node_ptr left_left = node_ptr::share(left->left);
+				node_ptr left_right = node_ptr::share(left->right);
+				if (depth_of(left_left) >= depth_of(left_right))
+					return make_concat(std::move(left_left), make_concat(std::move(left_right), std::move(right)));
+				return make_concat(make_concat(std::move(left_left), node_ptr::share(left_right->left)),
+					make_concat(node_ptr::share(left_right->right), std::move(right)));
+			}
+			if (depth_of(right) > depth_of(left) + 2)
+			{
+				node_ptr right_left = node_ptr::share(right->left);
+				node_ptr right_right = node_ptr::share(right->right);
+				if (depth_of(right_right) >= depth_of(right_left))
+					return make_concat(make_concat(std::move(left), std::move(right_left)), std::move(right_right));
+				return make_concat(make_concat(std::move(left), node_ptr::share(right_left->left)),
+					make_concat(node_ptr::share(right_left->right), std::move(right_right)));
+			}
+			return make_concat(std::move(left), std::move(right));
+		}
+
+		/// @brief Joins two nodes which are not null into a balanced tree, in O(difference of their depths)
+		static node_ptr join(node_ptr left, node_ptr right)
+		{
+			if (left->is_leaf() && right->is_leaf() && left->size + right->size <= merge_threshold)
+			{
+				node_ptr merged = make_leaf(left->chars(), left->size, left->size + right->size);
+				std::memcpy(merged->chars() + left->size, right->chars(), right->size);
+				merged->size += right->size;
+				return merged;
+			}
+			if (depth_of(left) > depth_of(right) + 2)
+				return balance(node_ptr::share(left->left), join(node_ptr::share(left->right), std::move(right)));
+			if (depth_of(right) > depth_of(left) + 2)
+				return balance(join(std::move(left), node_ptr::share(right->left)), node_ptr::share(right->right));
+			return make_concat(std::move(left), std::move(right));
+		}
+
+		/// @brief Concatenates two nodes, any of which can be null
+		static node_ptr concat(node_ptr left, node_ptr right)
+		{
+			if (!left)
+				return right;
+			if (!right)
+				return left;
+			return join(std::move(left), std::move(right));
+		}
+
+		/// @brief Splits a node in the nodes containing its first 'offset' characters and the others
+		static std::pair<node_ptr, node_ptr> split(node_ptr from, size_t offset)
+		{
+			if (offset == 0)
+				return { node_ptr(), std::move(from) };
+			if (offset == from->size)
+				return { std::move(from), node_ptr() };
+			if (from->is_leaf())
+			{
+				return { make_leaf(from->chars(), offset, offset),
+					make_leaf(from->chars() + offset, from->size - offset, from->size - offset) };
+			}
+			node_ptr left = node_ptr::share(from->left);
+			node_ptr right = node_ptr::share(from->right);
+			from = node_ptr();
+			if (offset <= left->size)
+			{
+				auto [first, second] = split(std::move(left), offset);
+				return { std::move(first), concat(std::move(second), std::move(right)) };
+			}
+			const size_t left_size = left->size;
+			auto [first, second] = split(std::move(right), offset - left_size);
+			return { concat(std::move(left), std::move(first)), std::move(second) };
+		}
+
+		/// @brief Copies as many characters as possible in the free capacity of the last chunk,
+		/// if the chunk and its ancestors are not shared
+		/// @return The number of characters copied
+		size_t append_in_place(string_view view) noexcept
+		{
+			node* path[max_depth + 1];
+			size_t length = 0;
+			for (node* current = root.get(); current != nullptr; current = current->right)
+			{
+				if (current->refcount.load(std::memory_order_acquire) != 1)
+					return 0;
+				path[length++] = current;
+			}
+			if (length == 0)
+				return 0;
+			node* leaf = path[length - 1];
+			const size_t count = std::min(leaf->capacity - leaf->size, view.size());
+			std::memcpy(leaf->chars() + leaf->size, view.data(), count);
+			for (size_t i = 0; i < length; i++)
+				path[i]->size += count;
+			return count;
+		}
+	};
+
+	/// @brief Rope using the default allocator
+	using rope = basic_rope<>;
+
+	template<typename Allocator>
+	/// @brief writes the characters of the rope.
+	static std::ostream& operator<<(std::ostream& os, const basic_rope<Allocator>& var)
+	{
+		var.print(os);
+		return os;
+	}
+
+	/******************************************
+	SHARED STRING
+	******************************************/
+
+	namespace details
+	{
+		template<typename ThreadSafety>
+		/// @brief The header of the storage of a shared string, followed by its null-terminated characters.
+		/// The reference count is atomic for ThreadSafe shared strings.
+		struct shared_string_header
+		{
+			/// @brief The number of shared strings referencing the storage
+			std::conditional_t<std::is_same_v<ThreadSafety, ThreadSafe>, std::atomic<size_t>, size_t> refcount;
+			/// @brief The number of characters of the storage, without the null terminator
+			size_t size;
+
+			/// @brief Returns the characters stored after the header
+			/// @return Pointer to the characters
+			char* chars() noexcept { return reinterpret_cast<char*>(this + 1); }
+		};
+	}
+
+	template<typename Allocator = heap_allocator, typename ThreadSafety = NonThreadSafe>
+	/// @brief An immutable, reference counted string, whose header and characters are stored in a single allocation.
+	/// Copying a shared string is O(1): copies share the storage, which is freed with the last of them.
+	/// A substring is a view of the same storage, which keeps it alive without copying characters.
+	///
+	/// The reference count of a ThreadSafe shared string (ts_shared_string) is atomic: copies of the same
+	/// string can be handed to and destroyed by different threads. A single shared_string object is not
+	/// synchronized (like a std::shared_ptr), and a NonThreadSafe one should only be copied by one thread.
+	/// @tparam Allocator The allocator policy used for the storage
+	/// @tparam ThreadSafety The thread safety policy of the reference count
+	class basic_shared_string
+	{
+		static_assert(helpers::is_thread_safety_policy_v<ThreadSafety>, "ThreadSafety can only be [Non]ThreadSafe");
+
+		using header = details::shared_string_header<ThreadSafety>;
+
+		/// @brief The storage, or nullptr for empty strings
+		header* storage = nullptr;
+		/// @brief The first character of the string
+		const char* ptr = "";
+		/// @brief The number of characters of the string
+		size_t length = 0;
+
+		/// @brief Constructs a view of a storage, taking ownership of a reference to it
+		basic_shared_string(header* storage, const char* ptr, size_t length) noexcept
+			: storage(storage), ptr(ptr), length(length) {}
+
+	public:
+		/// @brief Constructs an empty string, which does not allocate
+		basic_shared_string() noexcept = default;
+
+		/// @brief Constructs a string containing a copy of the characters pointed to by a view
+		/// @param view The characters to copy
+		explicit basic_shared_string(string_view view)
+		{
+			if (view.is_empty())
+				return;
+			if (view.size() > std::numeric_limits<size_t>::max() - sizeof(header) - 1)
+				throw std::length_error("vale::shared_string: size was greater than max_size()!");
+			void* memory = Allocator::allocate(sizeof(header) + view.size() + 1, alignof(header));
+			storage = new(memory) header{ { 1 }, view.size() };
+			std::memcpy(storage->chars(), view.data(), view.size());
+			storage->chars()[view.size()] = '\0';
+			ptr = storage->chars();
+			length = view.size();
+		}
+
+		/// @brief Constructs a string containing a copy of a null-terminated string
+		/// @param str The null-terminated string
+		basic_shared_string(const char* str)
+			: basic_shared_string(vale::to_view(str)) {}
+
+		/// @brief Shares the storage of another string, in O(1)
+		basic_shared_string(const basic_shared_string& to_copy) noexcept
+			: storage(to_copy.storage), ptr(to_copy.ptr), length(to_copy.length)
+		{
+			acquire(storage);
+		}
+
+		basic_shared_string(basic_shared_string&& to_move) noexcept
+			: storage(std::exchange(to_move.storage, nullptr)), ptr(std::exchange(to_move.ptr, "")),
+			length(std::exchange(to_move.length, 0)) {}
+
+		basic_shared_string& operator=(basic_shared_string other) noexcept
+		{
+			std::swap(storage, other.storage);
+			std::swap(ptr, other.ptr);
+			std::swap(length, other.length);
+			return *this;
+		}
+
+		~basic_shared_string() { release(storage); }
+
+		/// @brief Returns the number of characters of the string
+		/// @return The number of characters
+		[[nodiscard]] size_t size() const noexcept { return length; }
+
+		/// @brief Check if the string is empty
+		/// @return True if the string does not contain any character
+		[[nodiscard]] bool is_empty() const noexcept { return length == 0; }
+
+		/// @brief Returns a pointer to the characters of the string.
+		/// They are only null-terminated if the string is not a substring (see is_null_terminated()).
+		/// @return Pointer to the characters
+		[[nodiscard]] const char* data() const noexcept { return ptr; }
+
+		/// @brief Check if the characters of the string are followed by a null terminator,
+		/// which is the case of strings which are not substrings, or which end their storage
+		/// @return True if data()[size()] is '\0'
+		[[nodiscard]] bool is_null_terminated() const noexcept
+		{
+			return storage == nullptr || ptr + length == storage->chars() + storage->size;
+		}
+
+		/// @brief Returns the number of strings sharing the storage of the string
+		/// @return The number of strings, or 0 for empty strings which do not have any storage
+		[[nodiscard]] size_t use_count() const noexcept
+		{
+			if (storage == nullptr)
+				return 0;
+			if constexpr (std::is_same_v<ThreadSafety, ThreadSafe>)
+				return storage->refcount.load(std::memory_order_relaxed);
+			else
+				return storage->refcount;
+		}
+
+		/// @brief Returns the character at 'index'.
+		/// Throws if index >= size().
+		/// @param index The index of the character
+		/// @return The character at 'index'
+		[[nodiscard]] char operator[](size_t index) const
+		{
+			if (index >= length)
+				throw std::out_of_range("vale::shared_string: index was greater than size!");
+			return ptr[index];
+		}
+
+		/// @brief Returns a view of the characters of the string, which is valid as long as the string
+		/// (or any string sharing its storage) exists
+		/// @return View of the characters
+		[[nodiscard]] string_view to_view() const noexcept { return string_view(ptr, length); }
+
+		/// @brief Returns a substring of 'size' characters starting from offset, which shares the storage
+		/// of the string (no characters are copied, and the storage is kept alive by the substring).
+		/// Throws if offset + size > size().
+		/// @param offset The offset of the first character
+		/// @param size The number of characters
+		/// @return The substring
+		[[nodiscard]] basic_shared_string substr(size_t offset, size_t size) const
+		{
+			if (offset > length || size > length - offset)
+				throw std::out_of_range("vale::shared_string: offset + size was greater than size!");
+			if (size == 0)
+				return basic_shared_string();
+			acquire(storage);
+			return basic_shared_string(storage, ptr + offset, size);
+		}
+
+		/// @brief Returns a substring of all the characters starting from offset, which shares the storage
+		/// of the string. Throws if offset > size().
+		/// @param offset The offset of the first character
+		/// @return The substring
+		[[nodiscard]] basic_shared_string substr(size_t offset) const
+		{
+			if (offset > length)
+				throw std::out_of_range("vale::shared_string: offset was greater than size!");
+			return substr(offset, length - offset);
+		}
+
+		/// @brief Compares the string with the characters pointed to by a view, lexicographically
+		/// @param view The characters to compare with
+		/// @return < 0 if the string is lower than 'view', 0 if they are equal, > 0 otherwise
+		[[nodiscard]] int compare(string_view view) const noexcept { return string::compare(to_view(), view); }
+
+		/// @brief Returns a copy of the characters of the string
+		/// @return A string
+		[[nodiscard]] string to_string() const { return string(to_view()); }
+
+		/// @brief Writes the characters of the string
+		/// @param os The stream to write to
+		void print(std::ostream& os) const
+		{
+			os.write(ptr, length);
+		}
+
+		/******************************************
+		COMPARISONS
+		******************************************/
+
+		friend bool operator==(const basic_shared_string& a, const basic_shared_string& b) noexcept
+		{
+			return a.length == b.length && (a.ptr == b.ptr || std::memcmp(a.ptr, b.ptr, a.length) == 0);
+		}
+		friend bool operator==(const basic_shared_string& a, string_view b) noexcept
+		{
+			return a.length == b.size() && std::memcmp(a.ptr, b.data(), b.size()) == 0;
+		}
+		friend bool operator==(const basic_shared_string& a, const char* b) noexcept { return a == vale::to_view(b); }
+		friend bool operator!=(const basic_shared_string& a, const basic_shared_string& b) noexcept { return !(a == b); }
+		friend bool operator!=(const basic_shared_string& a, string_view b) noexcept { return !(a == b); }
+		friend bool operator!=(const basic_shared_string& a, const char* b) noexcept { return !(a == b); }
+		friend bool operator< (const basic_shared_string& a, const basic_shared_string& b) noexcept { return string::compare(a.to_view(), b.to_view()) < 0; }
+		friend bool operator> (const basic_shared_string& a, const basic_shared_string& b) noexcept { return string::compare(a.to_view(), b.to_view()) > 0; }
+		friend bool operator<=(const basic_shared_string& a, const basic_shared_string& b) noexcept { return string::compare(a.to_view(), b.to_view()) <= 0; }
+		friend bool operator>=(const basic_shared_string& a, const basic_shared_string& b) noexcept { return string::compare(a.to_view(), b.to_view()) >= 0; }
+
+	private:
+		/// @brief Adds a reference to a storage
+		static void acquire(header* storage) noexcept
+		{
+			if (storage == nullptr)
+				return;
+			if constexpr (std::is_same_v<ThreadSafety, ThreadSafe>)
+				storage->refcount.fetch_add(1, std::memory_order_relaxed);
+			else
+				++storage->refcount;
+		}
+
+		/// @brief Removes a reference to a storage, freeing it if it was the last one
+		static void release(header* storage) noexcept
+		{
+			if (storage == nullptr)
+				return;
+			if constexpr (std::is_same_v<ThreadSafety, ThreadSafe>)
+			{
+				if (storage->refcount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+					return;
+			}
+			else if (--storage->refcount != 0)
+				return;
+			const size_t bytes = sizeof(header) + storage->size + 1;
+			storage->~header();
+			Allocator::deallocate(storage, bytes, alignof(header));
+		}
+	};
+
+	/// @brief Shared string whose reference count is not atomic, to be used by a single thread
+	using shared_string = basic_shared_string<>;
+	/// @brief Shared string whose reference count is atomic, whose copies can be handed to other threads
+	using ts_shared_string = basic_shared_string<heap_allocator, ThreadSafe>;
+
+	template<typename Allocator, typename ThreadSafety>
+	/// @brief writes the characters of the shared string.
+	static std::ostream& operator<<(std::ostream& os, const basic_shared_string<Allocator, ThreadSafety>& var)
+	{
+		var.print(os);
+		return os;
+	}
+
+	/******************************************
+	MULTI-PATTERN MATCHING
+	******************************************/
+
+	/// @brief An occurrence of a pattern of a multi_matcher
+	struct pattern_match
+	{
+		/// @brief The offset of the first character of the occurrence, or npos if there is none
+		size_t position = npos;
+		/// @brief The index of the pattern, in the order in which the patterns were given
+		size_t pattern = npos;
+
+		/// @brief Checks if the match refers to an occurrence
+		/// @return False if no pattern was found
+		[[nodiscard]] constexpr bool is_valid() const noexcept { return position != npos; }
+	};
+
+	/// @brief Finds the occurrences of many literal patterns in a single pass over a text.
+	///
+	/// Small sets of patterns (at most teddy_max_patterns) use a SIMD fingerprint filter ("Teddy", from Hyperscan)
+	/// when SSSE3 or AVX2 is available: patterns are spread over 8 buckets, and the nibbles of their first 3 bytes
+	/// are looked up in 16-entry tables of buckets, which flags the positions at which a pattern of a bucket may start
+	/// 16 or 32 bytes at a time. Flagged positions are then verified using memcmp.
+	///
+	/// Other sets use an Aho-Corasick automaton, stored as a dense table of transitions. Its columns are the classes
+	/// of the bytes which appear in the patterns rather than the 256 bytes (all other bytes share a class), which
+	/// compresses the table, and its states are numbered so that matching states come first: each byte costs a lookup
+	/// in the table and a comparison.
+	///
+	/// A matcher is immutable once constructed: it can be used by any number of threads without locking.
+	class multi_matcher
+	{
+	public:
+		/// @brief The maximum number of patterns for which the fingerprint filter is used
+		static constexpr size_t teddy_max_patterns = 16;
+
+		/// @brief Compiles a matcher for null-terminated patterns, which should not be empty
+		/// @param patterns The patterns
+		multi_matcher(std::initializer_list<const char*> patterns)
+		{
+			for (const char* pattern : patterns)
+				add_pattern(vale::to_view(pattern));
+			compile();
+		}
+
+		template<typename Range>
+		/// @brief Compiles a matcher for the patterns of a range, which should not be empty.
+		/// The elements of the range can be views, vale::string, std::string or null-terminated strings.
+		/// @tparam Range The type of the range
+		/// @param patterns The patterns
+		explicit multi_matcher(const Range& patterns)
+		{
+			for (const auto& pattern : patterns)
+			{
+				using element = std::decay_t<decltype(pattern)>;
+				if constexpr (std::is_convertible_v<const element&, const char*>)
+					add_pattern(vale::to_view(pattern));
+				else if constexpr (details::has_char_view<element>::value)
+					add_pattern(string_view(pattern.to_view()));
+				else
+					add_pattern(string_view(pattern.data(), pattern.size()));
+			}
+			compile();
+		}
+
+		/// @brief Returns the number of patterns
+		/// @return The number of patterns
+		[[nodiscard]] size_t size() const noexcept { return offsets.size() - 1; }
+
+		/// @brief Returns a pattern
+		/// @param index The index of the pattern, in the order in which the patterns were given
+		/// @return View of the pattern
+		[[nodiscard]] string_view pattern(size_t index) const
+		{
+			if (index >= size())
+				throw std::out_of_range("vale::multi_matcher: index was greater than size!");
+			return pattern_view(index);
+		}
+
+		/// @brief Checks if the fingerprint filter is used rather than the automaton
+		/// @return True if the filter is used
+		[[nodiscard]] bool uses_fingerprint_filter() const noexcept { return teddy_bytes != 0; }
+
+		/// @brief Checks if any pattern occurs in a text
+		/// @param text The text to search in
+		/// @return True if a pattern occurs in 'text'
+		[[nodiscard]] bool contains_any(string_view text) const noexcept
+		{
+			if (uses_fingerprint_filter())
+				return !scan_fingerprints(text, [](size_t, size_t) noexcept { return false; });
+			const uint32_t* table = transitions.data();
+			uint32_t state = start_state;
+			for (size_t i = 0; i < text.size(); i++)
+			{
+				state = table[state + classes[static_cast<uint8_t>(text.data()[i])]];
+				if (state < match_limit)
+					return true;
+			}
+			return false;
+		}
+
+		/// @brief Finds the leftmost occurrence of a pattern in a text
+		/// (the longest one if several patterns start at the same position)
+		/// @param text The text to search in
+		/// @return The occurrence, which is not valid if no pattern occurs in 'text'
+		[[nodiscard]] pattern_match find(string_view text) const noexcept
+		{
+			pattern_match best;
+			size_t best_size = 0;
+			const auto update = [&](size_t position, size_t pattern) noexcept {
+				const size_t pattern_size = offsets[pattern + 1] - offsets[pattern];
+				if (!best.is_valid() || position < best.position || (position == best.position && pattern_size > best_size))
+				{
+					best = pattern_match{ position, pattern };
+					best_size = pattern_size;
+				}
+			};
+			if (uses_fingerprint_filter())
+			{
+				//Occurrences are found in the order of their positions
+				scan_fingerprints(text, [&](size_t position, size_t pattern) noexcept {
+					if (best.is_valid() && position > best.position)
+						return false;
+					update(position, pattern);
+					return true;
+				});
+				return best;
+			}
+			//Occurrences are found in the order of their ends: once no occurrence
+			//ending after 'i' can start before the best one, the search stops
+			const uint32_t* table = transitions.data();
+			uint32_t state = start_state;
+			for (size_t i = 0; i < text.size(); i++)
+			{
+				if (best.is_valid() && i >= best.position + max_pattern_size)
+					break;
+				state = table[state + classes[static_cast<uint8_t>(text.data()[i])]];
+				if (state < match_limit)
+					visit_outputs(state, i, update);
+			}
+			return best;
+		}
+
+		/// @brief Counts the occurrences of the patterns in a text, including overlapping ones
+		/// @param text The text to search in
+		/// @return The number of occurrences
+		[[nodiscard]] size_t count(string_view text) const noexcept
+		{
+			size_t result = 0;
+			for_each_match(text, [&result](pattern_match) noexcept { ++result; });
+			return result;
+		}
+
+		template<typename Function>
+		/// @brief Calls a function with each occurrence of the patterns in a text, including overlapping ones.
+		/// Occurrences are not necessarily visited in the order of their positions.
+		/// @tparam Function Callable taking a pattern_match
+		/// @param text The text to search in
+		/// @param function The function to call
+		void for_each_match(string_view text, Function&& function) const
+		{
+			const auto visit = [&function](size_t position, size_t pattern) {
+				function(pattern_match{ position, pattern });
+				return true;
+			};
+			if (uses_fingerprint_filter())
+			{
+				scan_fingerprints(text, visit);
+				return;
+			}
+			const uint32_t* table = transitions.data();
+			uint32_t state = start_state;
+			for (size_t i = 0; i < text.size(); i++)
+			{
+				state = table[state + classes[static_cast<uint8_t>(text.data()[i])]];
+				if (state < match_limit)
+					visit_outputs(state, i, visit);
+			}
+		}
+
+	private:
+		using block = details::utf8_block;
+
+		/// @brief The number of buckets of the fingerprint filter (the bits of a byte)
+		static constexpr size_t teddy_buckets = 8;
+
+		/// @brief The characters of the patterns, one after the other
+		vale::vector<char> characters;
+		/// @brief The offset of each pattern in 'characters', followed by the total size
+		vale::vector<size_t> offsets{ 0 };
+		/// @brief The size of the longest pattern
+		size_t max_pattern_size = 0;
+
+		/// @brief The number of bytes of the fingerprints (1 to 3), or 0 if the automaton is used
+		size_t teddy_bytes = 0;
+		/// @brief For each fingerprint byte, the buckets of the patterns per low nibble of the byte
+		uint8_t teddy_low[3][16] = {};
+		/// @brief For each fingerprint byte, the buckets of the patterns per high nibble of the byte
+		uint8_t teddy_high[3][16] = {};
+		/// @brief The patterns of each bucket
+		vale::vector<uint32_t> bucket_patterns[teddy_buckets];
+
+		/// @brief The class of each byte, which is the column of the byte in 'transitions'
+		uint8_t classes[256] = {};
+		/// @brief The number of classes, which is the number of columns of 'transitions'
+		uint32_t stride = 0;
+		/// @brief The transitions of the automaton: the row of a state starts at the state.
+		/// States are multiplied by the stride, and matching states are lower than 'match_limit'.
+		vale::vector<uint32_t> transitions;
+		/// @brief The initial state of the automaton
+		uint32_t start_state = 0;
+		/// @brief The first state which is not matching
+		uint32_t match_limit = 0;
+		/// @brief For each matching state, the offset of its patterns in 'outputs', followed by the total size
+		vale::vector<uint32_t> output_offsets;
+		/// @brief The patterns which end at each matching state
+		vale::vector<uint32_t> outputs;
+
+		/// @brief Returns a pattern, without checking the index
+		string_view pattern_view(size_t index) const noexcept
+		{
+			return string_view(characters.data() + offsets.data()[index], offsets.data()[index + 1] - offsets.data()[index]);
+		}
+
+		/// @brief Adds a pattern, or throws if it is empty
+		/// @param pattern The pattern to add
+		void add_pattern(string_view pattern)
+		{
+			if (pattern.is_empty())
+				throw std::invalid_argument("vale::multi_matcher: patterns should not be empty!");
+			if (size() == std::numeric_limits<uint32_t>::max())
+				throw std::length_error("vale::multi_matcher: too many patterns!");
+			for (size_t i = 0; i < pattern.size(); i++)
+				characters.push_back(pattern.data()[i]);
+			offsets.push_back(characters.size());
+			max_pattern_size = std::max(max_pattern_size, pattern.size());
+		}
+
+		/// @brief Compiles the fingerprint filter if possible, or else the automaton
+		void compile()
+		{
+			if constexpr (block::width != 0)
+			{
+				if (size() != 0 && size() <= teddy_max_patterns)
+				{
+					compile_fingerprints();
+					return;
+				}
+			}
+			compile_automaton();
+		}
+
+		/// @brief Spreads the patterns over the buckets, and fills the tables of the filter
+		void compile_fingerprints()
+		{
+			size_t min_size = max_pattern_size;
+			for (size_t i = 0; i < size(); i++)
+				min_size = std::min(min_size, offsets[i + 1] - offsets[i]);
+			teddy_bytes = std::min<size_t>(min_size, 3);
+			for (size_t i = 0; i < size(); i++)
+			{
+				const size_t bucket = i % teddy_buckets;
+				bucket_patterns[bucket].push_back(static_cast<uint32_t>(i));
+				const string_view pattern = pattern_view(i);
+				for (size_t k = 0; k < teddy_bytes; k++)
+				{
+					const uint8_t c = static_cast<uint8_t>(pattern.data()[k]);
+					teddy_low[k][c & 0x0F] |= static_cast<uint8_t>(1u << bucket);
+					teddy_high[k][c >> 4] |= static_cast<uint8_t>(1u << bucket);
+				}
+			}
+		}
+
+		/// @brief Builds the trie of the patterns, then the automaton in breadth-first order
+		void compile_automaton()
+		{
+			//Bytes which do not appear in the patterns share class 0 (unless all bytes appear)
+			bool is_used[256] = {};
+			for (size_t i = 0; i < characters.size(); i++)
+				is_used[static_cast<uint8_t>(characters.data()[i])] = true;
+			uint32_t used = 0;
+			for (size_t c = 0; c < 256; c++)
+				used += is_used[c];
+			stride = used == 256 ? 256 : used + 1;
+			uint32_t next_class = used == 256 ? 0 : 1;
+			for (size_t c = 0; c < 256; c++)
+				classes[c] = is_used[c] ? static_cast<uint8_t>(next_class++) : 0;
+
+			//Trie, whose state 0 is the root (which is never a child, so 0 means 'no child')
+			vale::vector<uint32_t> delta(stride, 0);
+			vale::vector<uint32_t> own_outputs; //Linked lists of the patterns ending at each state
+			vale::vector<uint32_t> first_output(1, std::numeric_limits<uint32_t>::max());
+			own_outputs.resize(size());
+			uint32_t nb_states = 1;
+			for (size_t p = 0; p < size(); p++)
+			{
+				const string_view pattern = pattern_view(p);
+				uint32_t state = 0;
+				for (size_t i = 0; i < pattern.size(); i++)
+				{
+					uint32_t& next = delta.data()[state * stride + classes[static_cast<uint8_t>(pattern.data()[i])]];
+					if (next == 0)
+					{
+						if (static_cast<uint64_t>(nb_states + 1) * stride > std::numeric_limits<uint32_t>::max())
+							throw std::length_error("vale::multi_matcher: the automaton has too many states!");
+						next = nb_states++;
+						delta.resize(static_cast<size_t>(nb_states) * stride, 0);
+						first_output.push_back(std::numeric_limits<uint32_t>::max());
+					}
+					state = delta.data()[state * stride + classes[static_cast<uint8_t>(pattern.data()[i])]];
+				}
+				own_outputs[p] = first_output[state];
+				first_output[state] = static_cast<uint32_t>(p);
+			}
+
+			//Breadth-first: the failure state of a state is always visited before it,
+			//so its row is complete and the transitions of missing children can be copied from it
+			vale::vector<uint32_t> order;
+			vale::vector<uint32_t> failure(nb_states, 0);
+			order.reserve(nb_states);
+			order.push_back(0);
+			for (size_t visited = 0; visited < order.size(); visited++)
+			{
+				const uint32_t state = order[visited];
+				uint32_t* row = delta.data() + static_cast<size_t>(state) * stride;
+				const uint32_t* failure_row = delta.data() + static_cast<size_t>(failure[state]) * stride;
+				for (uint32_t c = 0; c < stride; c++)
+				{
+					if (state == 0)
+					{
+						if (row[c] != 0)
+							order.push_back(row[c]);
+						continue;
+					}
+					if (row[c] == 0)
+						row[c] = failure_row[c];
+					else
+					{
+						failure[row[c]] = failure_row[c];
+						order.push_back(row[c]);
+					}
+				}
+			}
+
+			//The patterns of a state are its own, followed by those of its failure state
+			vale::vector<uint32_t> state_outputs_begin(nb_states + 1, 0);
+			vale::vector<uint32_t> state_outputs;
+			vale::vector<uint32_t> state_outputs_end(nb_states, 0);
+			for (size_t visited = 0; visited < order.size(); visited++)
+			{
+				const uint32_t state = order[visited];
+				state_outputs_begin[state] = static_cast<uint32_t>(state_outputs.size());
+				for (uint32_t p = first_output[state]; p != std::numeric_limits<uint32_t>::max(); p = own_outputs[p])
+					state_outputs.push_back(p);
+				if (state != 0)
+				{
+					const uint32_t fail = failure[state];
+					for (uint32_t i = state_outputs_begin[fail]; i < state_outputs_end[fail]; i++)
+						state_outputs.push_back(state_outputs[i]);
+				}
+				state_outputs_end[state] = static_cast<uint32_t>(state_outputs.size());
+			}
+
+			//Number the matching states first, and multiply the states by the stride
+			vale::vector<uint32_t> renumbered(nb_states, 0);
+			uint32_t next_state = 0;
+			for (uint32_t state = 0; state < nb_states; state++)
+				if (state_outputs_end[state] != state_outputs_begin[state])
+					renumbered[state] = next_state++;
+			match_limit = next_state * stride;
+			for (uint32_t state = 0; state < nb_states; state++)
+				if (state_outputs_end[state] == state_outputs_begin[state])
+					renumbered[state] = next_state++;
+
+			transitions.resize(static_cast<size_t>(nb_states) * stride);
+			output_offsets.resize(match_limit / stride + 1);
+			for (uint32_t state = 0; state < nb_states; state++)
+			{
+				const uint32_t* row = delta.data() + static_cast<size_t>(state) * stride;
+				uint32_t* new_row = transitions.data() + static_cast<size_t>(renumbered[state]) * stride;
+				for (uint32_t c = 0; c < stride; c++)
+					new_row[c] = renumbered[row[c]] * stride;
+			}
+			for (uint32_t state = 0; state < nb_states; state++)
+			{
+				if (state_outputs_end[state] == state_outputs_begin[state])
+					continue;
+				output_offsets[renumbered[state]] = static_cast<uint32_t>(outputs.size());
+				for (uint32_t i = state_outputs_begin[state]; i < state_outputs_end[state]; i++)
+					outputs.push_back(state_outputs[i]);
+			}
+			output_offsets[match_limit / stride] = static_cast<uint32_t>(outputs.size());
+			//Matching states were numbered in increasing order: their outputs are contiguous
+			start_state = renumbered[0] * stride;
+		}
+
+		template<typename OnMatch>
+		/// @brief Calls 'on_match' with each pattern ending at a matching state
+		/// @param state The matching state
+		/// @param end The position of the last character of the patterns
+		/// @param on_match Callable taking the position and the index of the pattern
+		void visit_outputs(uint32_t state, size_t end, OnMatch& on_match) const
+		{
+			const uint32_t index = state / stride;
+			for (uint32_t i = output_offsets.data()[index]; i < output_offsets.data()[index + 1]; i++)
+			{
+				const uint32_t pattern = outputs.data()[i];
+				on_match(end + 1 - (offsets.data()[pattern + 1] - offsets.data()[pattern]), pattern);
+			}
+		}
+
+		template<typename OnMatch>
+		/// @brief Finds the occurrences of the patterns using the fingerprint filter,
+		/// in the order of their positions
+		/// @param text The text to search in
+		/// @param on_match Callable taking the position and the index of the pattern,
+		/// returning false to stop the search
+		/// @return False if the search was stopped
+		bool scan_fingerprints(string_view text, OnMatch&& on_match) const
+		{
+			switch (teddy_bytes)
+			{
+			case 1: return scan_fingerprints<1>(text, on_match);
+			case 2: return scan_fingerprints<2>(text, on_match);
+			default: return scan_fingerprints<3>(text, on_match);
+			}
+		}
+
+		template<size_t nb_bytes, typename OnMatch, typename Block = block>
+		/// @brief Finds the occurrences of the patterns using fingerprints of 'nb_bytes' bytes.
+		/// 'Block' is a template parameter so that the SIMD code is only checked when it is used.
+		bool scan_fingerprints(string_view text, OnMatch& on_match) const
+		{
+			if constexpr (Block::width == 0)
+				return true;
+			else
+			{
+				typename Block::type low[nb_bytes], high[nb_bytes], previous[nb_bytes];
+				for (size_t k = 0; k < nb_bytes; k++)
+				{
+					low[k] = Block::table(teddy_low[k]);
+					high[k] = Block::table(teddy_high[k]);
+					previous[k] = Block::splat(0);
+				}
+				const char* const data = text.data();
+				const size_t size = text.size();
+
+				//Returns false if the search was stopped
+				const auto process = [&](typename Block::type input, size_t base) {
+					const typename Block::type low_nibbles = Block::low_nibbles(input);
+					const typename Block::type high_nibbles = Block::high_nibbles(input);
+					typename Block::type current[nb_bytes];
+					for (size_t k = 0; k < nb_bytes; k++)
+						current[k] = Block::bit_and(Block::lookup(low[k], low_nibbles), Block::lookup(high[k], high_nibbles));
+					//Each byte is the set of buckets having a pattern whose fingerprint ends at the byte
+					typename Block::type result = current[nb_bytes - 1];
+					if constexpr (nb_bytes >= 2)
+						result = Block::bit_and(result, Block::template previous<1>(current[nb_bytes - 2], previous[nb_bytes - 2]));
+					if constexpr (nb_bytes >= 3)
+						result = Block::bit_and(result, Block::template previous<2>(current[nb_bytes - 3], previous[nb_bytes - 3]));
+					for (size_t k = 0; k < nb_bytes; k++)
+						previous[k] = current[k];
+
+					uint64_t candidates = ~static_cast<uint64_t>(details::char_block::equal(result, Block::splat(0)))
+						& ((uint64_t(1) << Block::width) - 1);
+					if (candidates == 0)
+						return true;
+					uint8_t buckets[Block::width];
+					Block::store(buckets, result);
+					for (; candidates != 0; candidates &= candidates - 1)
+					{
+						const size_t index = static_cast<size_t>(helpers::count_trailing_zeros(candidates));
+						const size_t position = base + index - (nb_bytes - 1);
+						for (uint32_t bits = buckets[index]; bits != 0; bits &= bits - 1)
+						{
+							const vale::vector<uint32_t>& patterns = bucket_patterns[helpers::count_trailing_zeros(bits)];
+							for (size_t i = 0; i < patterns.size(); i++)
+							{
+								const string_view pattern = pattern_view(patterns.data()[i]);
+								if (position + pattern.size() <= size
+									&& std::memcmp(data + position, pattern.data(), pattern.size()) == 0
+									&& !on_match(position, static_cast<size_t>(patterns.data()[i])))
+									return false;
+							}
+						}
+					}
+					return true;
+				};
+
+				size_t i = 0;
+				for (; i + Block::width <= size; i += Block::width)
+					if (!process(Block::load(data + i), i))
+						return false;
+				if (i != size)
+				{
+					//The padding is verified like the text, but cannot match as occurrences must fit in the text
+					char padded[Block::width] = {};
+					std::memcpy(padded, data + i, size - i);
+					if (!process(Block::load(padded), i))
+						return false;
+				}
+				return true;
+			}
+		}
+	};
+
+	/******************************************
+	STRING POOL
+	******************************************/
+
+	/// @brief Compact 32-bit handle to a string interned in a string_pool.
+	/// Two handles of the same pool are equal if and only if their strings are equal.
+	class string_handle
+	{
+		/// @brief The shard of the string in its high bits, followed by its index in the shard
+		uint32_t value = std::numeric_limits<uint32_t>::max();
+
+	public:
+		/// @brief Constructs an invalid handle
+		constexpr string_handle() noexcept = default;
+
+		/// @brief Constructs a handle from its integer representation
+		/// @param value The integer representation returned by to_int()
+		constexpr explicit string_handle(uint32_t value) noexcept
+			: value(value) {}
+
+		/// @brief Check if the handle refers to a string
+		/// @return False if the handle was default constructed, or returned by a failed lookup
+		[[nodiscard]] constexpr bool is_valid() const noexcept { return value != std::numeric_limits<uint32_t>::max(); }
+
+		/// @brief Returns the integer representation of the handle
+		/// @return The integer representation of the handle
+		[[nodiscard]] constexpr uint32_t to_int() const noexcept { return value; }
+
+		friend constexpr bool operator==(string_handle a, string_handle b) noexcept { return a.value == b.value; }
+		friend constexpr bool operator!=(string_handle a, string_handle b) noexcept { return a.value != b.value; }
+		friend constexpr bool operator< (string_handle a, string_handle b) noexcept { return a.value < b.value; }
+	};
+
+	/// @brief A thread safe pool of interned strings.
+	/// Each distinct string is copied once in an append-only arena, and identified by a string_handle.
+	/// Interned strings never move: the views returned by view() remain valid until the pool is destroyed.
+	///
+	/// The pool is split in shards chosen by the hash of the strings. Looking up a string
+	/// which is already interned does not lock, and inserting a new string only locks its shard.
+	/// Hash tables replaced while growing are kept until the pool is destroyed, as lock-free
+	/// readers could still be probing them (they use at most as much memory as the current tables).
+	class string_pool
+	{
+		/// @brief log2 of the number of shards
+		static constexpr size_t shard_bits = 4;
+		/// @brief The number of shards
+		static constexpr size_t nb_shards = size_t(1) << shard_bits;
+		/// @brief The number of bits of a handle storing the index of the string in its shard
+		static constexpr size_t index_bits = 32 - shard_bits;
+		/// @brief The maximum number of strings in a shard (the last index of the last shard is the invalid handle)
+		static constexpr size_t max_strings_per_shard = (size_t(1) << index_bits) - 1;
+		/// @brief The size of the chunks of the arena
+		static constexpr size_t chunk_size = size_t(64) << 10;
+		/// @brief The initial number of slots of the hash table of a shard
+		static constexpr size_t initial_table_capacity = 64;
+
+		/// @brief Open addressing hash table, whose slots store the 32 high bits of the hash of a string
+		/// followed by its index + 1 (0 marking an empty slot)
+		struct hash_table
+		{
+			/// @brief The number of slots, which is a power of 2
+			size_t capacity;
+			/// @brief The slots
+			std::unique_ptr<std::atomic<uint64_t>[]> slots;
+
+			explicit hash_table(size_t capacity)
+				: capacity(capacity), slots(new std::atomic<uint64_t>[capacity])
+			{
+				for (size_t i = 0; i < capacity; i++)
+					slots[i].store(0, std::memory_order_relaxed);
+			}
+		};
+
+		/// @brief A shard of the pool, on its own cache lines
+		struct alignas(cache_line_size) pool_shard
+		{
+			/// @brief The current hash table, read without locking
+			std::atomic<hash_table*> current{ nullptr };
+			/// @brief Pointers to the interned strings in the arena, indexed by their index in the shard
+			ts_vector<const char*> entries;
+			/// @brief Mutex locked while inserting
+			mutable std::mutex mutex;
+			/// @brief All the hash tables of the shard, the last being the current one
+			vale::vector<std::unique_ptr<hash_table>> tables;
+			/// @brief The chunks of the arena
+			vale::vector<std::unique_ptr<char[]>> chunks;
+			/// @brief The next free byte of the last chunk
+			char* chunk_ptr = nullptr;
+			/// @brief The number of free bytes of the last chunk
+			size_t chunk_left = 0;
+			/// @brief The number of bytes of the chunks
+			size_t arena_bytes = 0;
+		};
+
+		/// @brief The shards
+		pool_shard shards[nb_shards];
+
+	public:
+		/// @brief Constructs an empty pool
+		string_pool()
+		{
+			for (auto& shard : shards)
+			{
+				shard.tables.push_back(std::make_unique<hash_table>(initial_table_capacity));
+				shard.current.store(shard.tables.back().get(), std::memory_order_release);
+			}
+		}
+
+		string_pool(const string_pool&) = delete;
+		string_pool& operator=(const string_pool&) = delete;
+
+		/// @brief Interns a string, copying it in the pool if it was not already interned.
+		/// Throws std::length_error if the string is longer than 4 GB, or if a shard is full.
+		/// @param str The string to intern
+		/// @return The handle of the string
+		string_handle intern(string_view str)
+		{
+			const uint64_t hash = hash_of(str);
+			pool_shard& shard = shards[hash >> (64 - shard_bits)];
+			if (const string_handle found = lookup(shard, hash, str); found.is_valid())
+				return found;
+			return insert(shard, hash, str);
+		}
+
+		/// @brief Returns the handle of a string if it was interned, without locking
+		/// @param str The string to search for
+		/// @return The handle of the string, or an invalid handle if it was not interned
+		[[nodiscard]] string_handle find(string_view str) const noexcept
+		{
+			const uint64_t hash = hash_of(str);
+			return lookup(shards[hash >> (64 - shard_bits)], hash, str);
+		}
+
+		/// @brief Returns a view of an interned string, without locking.
+		/// Throws std::out_of_range if the index of the handle is out of range (as for an invalid handle):
+		/// a handle of another pool whose index is in range is not detected, and returns another string.
+		/// @param handle The handle of the string
+		/// @return view of the string, which is valid until the pool is destroyed (and null-terminated)
+		[[nodiscard]] string_view view(string_handle handle) const
+		{
+			const uint32_t value = handle.to_int();
+			return entry_view(shards[value >> index_bits].entries[value & max_strings_per_shard]);
+		}
+
+		/// @brief Returns the number of interned strings
+		/// @return The number of distinct strings in the pool
+		[[nodiscard]] size_t size() const noexcept
+		{
+			size_t result = 0;
+			for (const auto& shard : shards)
+				result += shard.entries.size();
+			return result;
+		}
+
+		/// @brief Returns the number of bytes used by the pool: the arena, the hash tables and the entries.
+		/// Locks the shards.
+		/// @return The memory used by the pool
+		[[nodiscard]] size_t byte_size() const
+		{
+			size_t result = sizeof(string_pool);
+			for (const auto& shard : shards)
+			{
+				std::scoped_lock lock{ shard.mutex };
+				result += shard.arena_bytes + shard.entries.size() * sizeof(const char*);
+				for (const auto& table : shard.tables)
+					result += table->capacity * sizeof(uint64_t);
+			}
+			return result;
+		}
+
+	private:
+
+		/// @brief Returns the hash of a string
+		static uint64_t hash_of(string_view str) noexcept
+		{
+			//Multiplying spreads the bits of 32-bit hashes to the high bits used for the shard
+			return uint64_t(std::hash<std::string_view>()(std::string_view(str.data(), str.size()))) * 0x9E3779B97F4A7C15ull;
+		}
+
+		/// @brief Returns the view of an entry of the arena, which begins with the 32-bit size of the string
+		static string_view entry_view(const char* entry) noexcept
+		{
+			uint32_t size;
+			std::memcpy(&size, entry, sizeof(uint32_t));
+			return string_view(entry + sizeof(uint32_t), size);
+		}
+
+		/// @brief Returns the handle of the string at 'index' of 'shard'
+		string_handle handle_of(const pool_shard& shard, size_t index) const noexcept
+		{
+			return string_handle(static_cast<uint32_t>(((&shard - shards) << index_bits) | index));
+		}
+
+		/// @brief Searches the current table of a shard for a string, without locking
+		string_handle lookup(const pool_shard& shard, uint64_t hash, string_view str) const noexcept
+		{
+			const hash_table* table = shard.current.load(std::memory_order_acquire);
+			const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+			for (size_t i = hash & (table->capacity - 1);; i = (i + 1) & (table->capacity - 1))
+			{
+				const uint64_t slot = table->slots[i].load(std::memory_order_acquire);
+				if (slot == 0)
+					return string_handle();
+				if (static_cast<uint32_t>(slot >> 32) != tag)
+					continue;
+				const size_t index = static_cast<uint32_t>(slot) - 1;
+				const string_view entry = entry_view(*shard.entries.try_get(index));
+				if (entry.size() == str.size() && std::memcmp(entry.data(), str.data(), str.size()) == 0)
+					return handle_of(shard, index);
+			}
+		}
+
+		/// @brief Stores the index of a string in the first empty slot of its probe sequence
+		static void store_slot(hash_table& table, uint64_t hash, size_t index) noexcept
+		{
+			size_t i = hash & (table.capacity - 1);
+			while (table.slots[i].load(std::memory_order_relaxed) != 0)
+				i = (i + 1) & (table.capacity - 1);
+			table.slots[i].store(((hash >> 32) << 32) | (index + 1), std::memory_order_release);
+		}
+
+		/// @brief Copies a string in the arena of a shard, and returns its entry
+		static const char* copy_to_arena(pool_shard& shard, string_view str)
+		{
+			const size_t bytes = sizeof(uint32_t) + str.size() + 1;
+			if (bytes > shard.chunk_left)
+			{
+				const size_t size = std::max(chunk_size, bytes);
+				shard.chunks.push_back(std::unique_ptr<char[]>(new char[size]));
+				shard.chunk_ptr = shard.chunks.back().get();
+				shard.chunk_left = size;
+				shard.arena_bytes += size;
+			}
+			char* entry = shard.chunk_ptr;
+			const uint32_t size = static_cast<uint32_t>(str.size());
+			std::memcpy(entry, &size, sizeof(uint32_t));
+			std::memcpy(entry + sizeof(uint32_t), str.data(), str.size());
+			entry[sizeof(uint32_t) + str.size()] = '\0';
+			shard.chunk_ptr += bytes;
+			shard.chunk_left -= bytes;
+			return entry;
+		}
+
+		/// @brief Inserts a string in a shard, unless another thread inserted it first
+		string_handle insert(pool_shard& shard, uint64_t hash, string_view str)
+		{
+			if (str.size() > std::numeric_limits<uint32_t>::max())
+				throw std::length_error("vale::string_pool: string was longer than 4 GB!");
+
+			std::scoped_lock lock{ shard.mutex };
+			if (const string_handle found = lookup(shard, hash, str); found.is_valid())
+				return found;
+			if (shard.entries.size() == max_strings_per_shard)
+				throw std::length_error("vale::string_pool: shard was full!");
+
+			const size_t index = shard.entries.push_back(copy_to_arena(shard, str));
+			hash_table* current = shard.current.load(std::memory_order_relaxed);
+			if ((index + 1) * 2 <= current->capacity)
+			{
+				store_slot(*current, hash, index);
+				return handle_of(shard, index);
+			}
+
+			//Keep the load factor under 0.5: the new table is filled before being published
+			auto grown = std::make_unique<hash_table>(current->capacity * 2);
+			for (size_t i = 0; i <= index; i++)
+				store_slot(*grown, hash_of(entry_view(shard.entries[i])), i);
+			shard.tables.push_back(std::move(grown));
+			shard.current.store(shard.tables.back().get(), std::memory_order_release);
+			return handle_of(shard, index);
+		}
+	};
+}
+
+namespace std
+{
+	template<>
+	/// @brief Hashes a vale::string_handle
+	struct hash<vale::string_handle>
+	{
+		size_t operator()(vale::string_handle handle) const noexcept
+		{
+			return std::hash<uint32_t>()(handle.to_int());
+		}
+	};
+
+	template<typename Allocator, typename ThreadSafety>
+	/// @brief Hashes the characters of a vale::basic_shared_string
+	struct hash<vale::basic_shared_string<Allocator, ThreadSafety>>
+	{
+		size_t operator()(const vale::basic_shared_string<Allocator, ThreadSafety>& str) const noexcept
+		{
+			return std::hash<std::string_view>()(std::string_view(str.data(), str.size()));
+		}
+	};
+
+	template<typename Growth, typename Allocator, typename BufferPolicy, size_t inline_capacity>
+	/// @brief Hashes the characters of a vale::basic_string
+	struct hash<vale::basic_string<Growth, Allocator, BufferPolicy, inline_capacity>>
+	{
+		size_t operator()(const vale::basic_string<Growth, Allocator, BufferPolicy, inline_capacity>& str) const noexcept
+		{
+			return std::hash<std::string_view>()(std::string_view(str.data(), str.size()));
+		}
+	};
+}
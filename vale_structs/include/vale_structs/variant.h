@@ -61,6 +61,17 @@ namespace vale
 		{
 			os << *reinterpret_cast<const T*>(buffer);
 		}
+
+		template<typename String, typename T>
+		/// @brief Helper static method that converts the buffer to the appropriate type and appends it to 'out'.
+		/// @tparam String The string type
+		/// @tparam T The type to which to cast 'buffer'
+		/// @param out The string to which to append the casted result
+		/// @param buffer The buffer to cast
+		static void append_variant_ptr(String& out, const void* buffer)
+		{
+			vale::append_value(out, *reinterpret_cast<const T*>(buffer));
+		}
 	}
 
 	template<typename DestructionPolicy, typename ThreadSafety, typename First, typename... Rest>
@@ -354,6 +365,27 @@ namespace vale
 				return dt[type](os, buffer);
 		}
 
+		template<typename String, typename = std::enable_if_t<!std::is_base_of_v<std::ostream, String>>>
+		/// @brief Helper method to append a variant's active content to a string,
+		/// formatting numbers without going through an ostream (see append_value)
+		/// @tparam String The string type (vale::basic_string)
+		/// @param out The string to append to
+		inline void print(String& out) const
+		{
+			static const vale::array dt
+				= { &helpers::append_variant_ptr<String, First>,
+				&helpers::append_variant_ptr<String, Rest>... };
+
+			if constexpr (can_be_invalid())
+			{
+				if (is_valid())
+					return dt[type](out, buffer);
+				throw vale::invalid_variant_access{};
+			}
+			else
+				return dt[type](out, buffer);
+		}
+
 		template<typename T, typename... Args>
 		/// @brief Constructs an object directly, after destroying the active one
 		/// @tparam T The type to construct
@@ -778,6 +810,15 @@ namespace vale
 			std::scoped_lock lock(mutex);
 			variant.print(os);
 		}
+
+		template<typename String, typename = std::enable_if_t<!std::is_base_of_v<std::ostream, String>>>
+		/// @brief Thread-safe string print implementation
+		/// @param out The string to which to append the variant's content
+		inline void print(String& out) const
+		{
+			std::scoped_lock lock(mutex);
+			variant.print(out);
+		}
 	};
 
 	template<typename DestructionPolicy, typename ThreadSafety, typename First, typename... Rest>
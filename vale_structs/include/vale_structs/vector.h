@@ -0,0 +1,1817 @@
+/** @file vector.h
+* @brief Header that contains the vector class.
+* A vector is a contiguous region representing a collection of heap-allocated elements.
+* Its size can change at runtime.
+*
+* The way a vector grows is customized through a growth policy (see growth_factor),
+* and the way it obtains memory through an allocator policy (see heap_allocator).
+* Very large vectors can map their memory directly, using huge pages, through mmap_allocator.
+*
+* Objects of a type that is trivially relocatable (see is_trivially_relocatable in common.h) are
+* moved in memory using realloc/memcpy/memmove rather than by calling their move constructor
+* followed by their destructor. This trait can be specialized for user types.
+*
+* A vector whose buffer policy is OptionalBuffer stores up to 'inline_capacity' objects
+* in an aligned buffer inside the vector itself, and only allocates when that capacity is exceeded
+* (see small_vector). Such a vector is not trivially relocatable.
+*
+* A thread safe vector 'ts_vector' is an append-only segmented array: many threads can
+* push to it concurrently, each claiming a slot with one atomic operation.
+* Objects never move, and reading an object that was published does not lock.
+*
+* A 'mapped_vector' is a vector stored in a file mapped in memory, which can be opened in O(1)
+* and whose objects can be viewed directly over the mapping.
+*
+* Rather than passing a 'const vector&' to a function, you should prefer
+* passing a 'contiguous_struct_view' obtained through .to_view().
+*/
+
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <string>
+#include <limits>
+#include <vale_structs/common.h>
+
+#include <system_error>
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h> // For mmap_allocator and mapped_vector
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace vale
+{
+	/******************************************
+	GROWTH POLICY
+	******************************************/
+
+	template<size_t numerator, size_t denominator>
+	/// @brief Growth policy which multiplies the capacity of a full vector by 'numerator / denominator'
+	/// @tparam numerator The numerator of the growth factor
+	/// @tparam denominator The denominator of the growth factor
+	struct growth_factor
+	{
+		static_assert(denominator > 0, "Denominator of the growth factor cannot be 0!");
+		static_assert(numerator > denominator, "Growth factor should be greater than 1!");
+
+		/// @brief The capacity of a vector which allocates for the first time
+		static constexpr size_t initial_capacity = 4;
+
+		/// @brief Returns the capacity to allocate when a vector of capacity 'capacity' is full
+		/// @param capacity The current capacity
+		/// @param required The minimum capacity needed
+		/// @return The new capacity, which is at least 'required'
+		static constexpr size_t grow(size_t capacity, size_t required) noexcept
+		{
+			size_t next = capacity == 0
+				? initial_capacity
+				: capacity + (capacity / denominator) * (numerator - denominator);
+			//If the capacity overflowed or is not enough, use the required capacity
+			return next < required || next < capacity ? required : next;
+		}
+	};
+
+	/// @brief The default growth policy of a vector, which grows by a factor of 1.5
+	using default_growth = growth_factor<3, 2>;
+
+	/******************************************
+	ALLOCATOR POLICY
+	******************************************/
+
+	/// @brief Allocator policy which allocates memory through malloc/realloc/free.
+	/// Over-aligned types are allocated through aligned operator new.
+	struct heap_allocator
+	{
+		/// @brief Allocates 'bytes' bytes aligned on 'alignment', or throws std::bad_alloc
+		/// @param bytes The number of bytes to allocate (> 0)
+		/// @param alignment The alignment of the memory to return
+		/// @return Pointer to the allocated memory
+		static void* allocate(size_t bytes, size_t alignment)
+		{
+			if (alignment > alignof(std::max_align_t))
+				return ::operator new(bytes, std::align_val_t{ alignment });
+			if (void* ptr = std::malloc(bytes))
+				return ptr;
+			throw std::bad_alloc{};
+		}
+
+		/// @brief Resizes a block allocated by allocate() to 'new_bytes' bytes, copying its bytes if needed.
+		/// On failure, throws std::bad_alloc and the old block stays valid.
+		/// @param ptr The block to resize (can be nullptr if 'old_bytes' is 0)
+		/// @param old_bytes The size of the old block
+		/// @param new_bytes The new size of the block (> 0)
+		/// @param alignment The alignment of the block
+		/// @return Pointer to the resized block
+		static void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t alignment)
+		{
+			if (alignment > alignof(std::max_align_t))
+			{
+				void* new_ptr = allocate(new_bytes, alignment);
+				if (ptr != nullptr)
+				{
+					std::memcpy(new_ptr, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+					deallocate(ptr, old_bytes, alignment);
+				}
+				return new_ptr;
+			}
+			if (void* new_ptr = std::realloc(ptr, new_bytes))
+				return new_ptr;
+			throw std::bad_alloc{};
+		}
+
+		/// @brief Frees a block allocated by allocate() or reallocate()
+		/// @param ptr The block to free (can be nullptr)
+		/// @param bytes The size of the block
+		/// @param alignment The alignment of the block
+		static void deallocate(void* ptr, [[maybe_unused]] size_t bytes, size_t alignment) noexcept
+		{
+			if (alignment > alignof(std::max_align_t))
+				::operator delete(ptr, std::align_val_t{ alignment });
+			else
+				std::free(ptr);
+		}
+	};
+
+	template<size_t threshold = (size_t(64) << 20), bool explicit_huge_pages = false>
+	/// @brief Allocator policy for very large vectors, which maps memory directly (through mmap)
+	/// for blocks of at least 'threshold' bytes, and uses heap_allocator for smaller blocks.
+	/// Mapped blocks are hinted to use transparent huge pages (MADV_HUGEPAGE), or explicit huge pages
+	/// (MAP_HUGETLB) if 'explicit_huge_pages' is true and the system has huge pages available.
+	/// Mapped blocks grow through mremap, which does not copy memory, and return the pages
+	/// freed when shrinking to the OS (MADV_DONTNEED) while keeping the address range reserved.
+	/// On systems other than Linux, all blocks are allocated by heap_allocator.
+	/// @tparam threshold The minimum size in bytes of a block to map
+	/// @tparam explicit_huge_pages True to try MAP_HUGETLB before falling back to transparent huge pages
+	struct mmap_allocator
+	{
+		static_assert(threshold > 0, "Threshold of mmap_allocator cannot be 0!");
+
+		/// @brief The granularity of mapped blocks (the size of a huge page)
+		static constexpr size_t huge_page_size = size_t(2) << 20;
+
+		/// @brief Allocates 'bytes' bytes aligned on 'alignment', or throws std::bad_alloc
+		/// @param bytes The number of bytes to allocate (> 0)
+		/// @param alignment The alignment of the memory to return
+		/// @return Pointer to the allocated memory
+		static void* allocate(size_t bytes, size_t alignment)
+		{
+#ifdef __linux__
+			if (bytes >= threshold)
+				return map_block(bytes, alignment);
+#endif
+			return heap_allocator::allocate(bytes, alignment);
+		}
+
+		/// @brief Resizes a block allocated by allocate() to 'new_bytes' bytes.
+		/// Mapped blocks are grown in place or moved by mremap, and shrunk by returning their pages to the OS.
+		/// On failure, throws std::bad_alloc and the old block stays valid.
+		/// @param ptr The block to resize (can be nullptr if 'old_bytes' is 0)
+		/// @param old_bytes The size of the old block
+		/// @param new_bytes The new size of the block (> 0)
+		/// @param alignment The alignment of the block
+		/// @return Pointer to the resized block
+		static void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes, size_t alignment)
+		{
+#ifdef __linux__
+			const bool old_mapped = ptr != nullptr && old_bytes >= threshold;
+			const bool new_mapped = new_bytes >= threshold;
+			if (old_mapped && new_mapped)
+				return remap_block(ptr, new_bytes, alignment);
+			if (old_mapped || new_mapped)
+			{
+				//Moving from/to the heap: copy the bytes
+				void* new_ptr = allocate(new_bytes, alignment);
+				if (ptr != nullptr)
+				{
+					std::memcpy(new_ptr, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+					deallocate(ptr, old_bytes, alignment);
+				}
+				return new_ptr;
+			}
+#endif
+			return heap_allocator::reallocate(ptr, old_bytes, new_bytes, alignment);
+		}
+
+		/// @brief Frees a block allocated by allocate() or reallocate()
+		/// @param ptr The block to free (can be nullptr)
+		/// @param bytes The size of the block
+		/// @param alignment The alignment of the block
+		static void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept
+		{
+#ifdef __linux__
+			if (ptr != nullptr && bytes >= threshold)
+			{
+				unsigned char* mapping = static_cast<unsigned char*>(ptr) - header_size(alignment);
+				::munmap(mapping, reinterpret_cast<block_header*>(mapping)->mapping_size);
+				return;
+			}
+#endif
+			heap_allocator::deallocate(ptr, bytes, alignment);
+		}
+
+#ifdef __linux__
+	private:
+
+		/// @brief Header at the beginning of each mapping, as the mapping can be larger than the block
+		struct block_header
+		{
+			/// @brief The size in bytes of the mapping, including the header
+			size_t mapping_size;
+		};
+
+		/// @brief Returns the size of the header, which keeps the block aligned
+		static constexpr size_t header_size(size_t alignment) noexcept
+		{
+			return alignment > cache_line_size ? alignment : cache_line_size;
+		}
+
+		/// @brief Rounds 'bytes' to a multiple of the huge page size
+		static constexpr size_t round_to_huge_page(size_t bytes) noexcept
+		{
+			return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+		}
+
+		/// @brief Maps a new block of at least 'bytes' bytes
+		static void* map_block(size_t bytes, size_t alignment)
+		{
+			const size_t mapping_size = round_to_huge_page(bytes + header_size(alignment));
+			void* mapping = MAP_FAILED;
+			if constexpr (explicit_huge_pages)
+				mapping = ::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (mapping == MAP_FAILED)
+			{
+				mapping = ::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (mapping == MAP_FAILED)
+					throw std::bad_alloc{};
+				::madvise(mapping, mapping_size, MADV_HUGEPAGE);
+			}
+			static_cast<block_header*>(mapping)->mapping_size = mapping_size;
+			return static_cast<unsigned char*>(mapping) + header_size(alignment);
+		}
+
+		/// @brief Resizes a mapped block to 'bytes' bytes.
+		/// Growing within the mapping does nothing, growing past it calls mremap.
+		/// Shrinking returns the pages past the new end of the block to the OS.
+		static void* remap_block(void* ptr, size_t bytes, size_t alignment)
+		{
+			unsigned char* mapping = static_cast<unsigned char*>(ptr) - header_size(alignment);
+			const size_t mapping_size = reinterpret_cast<block_header*>(mapping)->mapping_size;
+			const size_t needed_size = round_to_huge_page(bytes + header_size(alignment));
+			if (needed_size < mapping_size)
+			{
+				//The address range stays reserved: growing back only faults pages in
+				::madvise(mapping + needed_size, mapping_size - needed_size, MADV_DONTNEED);
+				return ptr;
+			}
+			if (needed_size == mapping_size)
+				return ptr;
+
+			void* new_mapping = ::mremap(mapping, mapping_size, needed_size, MREMAP_MAYMOVE);
+			if (new_mapping == MAP_FAILED)
+			{
+				//mremap can fail for explicit huge pages: map a new block and copy
+				void* new_ptr = map_block(bytes, alignment);
+				std::memcpy(new_ptr, ptr, mapping_size - header_size(alignment));
+				::munmap(mapping, mapping_size);
+				return new_ptr;
+			}
+			::madvise(new_mapping, needed_size, MADV_HUGEPAGE);
+			static_cast<block_header*>(new_mapping)->mapping_size = needed_size;
+			return static_cast<unsigned char*>(new_mapping) + header_size(alignment);
+		}
+#endif
+	};
+
+	namespace helpers
+	{
+		template<typename T>
+		/// @brief Helper struct to check if a type is a growth_factor
+		/// @tparam T The type to check for
+		struct is_growth_policy { static constexpr bool value = false; };
+
+		template<size_t numerator, size_t denominator>
+		/// @brief Overload for growth_factor growth policy
+		struct is_growth_policy<growth_factor<numerator, denominator>> { static constexpr bool value = true; };
+
+		template<typename T>
+		/// @brief Helper to check if a type is a growth_factor
+		/// @tparam T The type to check for
+		static constexpr bool is_growth_policy_v = is_growth_policy<T>::value;
+	}
+
+	namespace details
+	{
+		template<typename T, typename BufferPolicy, size_t inline_capacity>
+		/// @brief The inline storage of a vector, which is empty for NonOptionalBuffer
+		struct vector_inline_buffer
+		{
+			/// @brief Returns the inline buffer
+			/// @return nullptr as there are no inline buffer
+			constexpr T* inline_data() noexcept { return nullptr; }
+
+			/// @brief Returns the inline buffer
+			/// @return nullptr as there are no inline buffer
+			constexpr const T* inline_data() const noexcept { return nullptr; }
+		};
+
+		template<typename T, size_t inline_capacity>
+		/// @brief The inline storage of a vector whose buffer policy is OptionalBuffer
+		struct vector_inline_buffer<T, OptionalBuffer, inline_capacity>
+		{
+			/// @brief Aligned uninitialized storage for 'inline_capacity' objects
+			alignas(T) unsigned char storage[sizeof(T) * inline_capacity];
+
+			/// @brief Returns the inline buffer
+			/// @return pointer to the beginning of the inline buffer
+			T* inline_data() noexcept { return reinterpret_cast<T*>(storage); }
+
+			/// @brief Returns the inline buffer
+			/// @return const pointer to the beginning of the inline buffer
+			const T* inline_data() const noexcept { return reinterpret_cast<const T*>(storage); }
+		};
+	}
+
+	template<typename T>
+	/// @brief Alias over a contiguous_struct_view for more easy typing
+	/// @tparam T The type of the view
+	using vector_view = contiguous_struct_view<T>;
+
+	template<typename T>
+	/// @brief Alias over a contiguous_iterator for more easy typing
+	/// @tparam T The type of the iterator
+	using vector_iterator = contiguous_iterator<T>;
+
+	template<typename T, typename Growth = default_growth, typename Allocator = heap_allocator,
+		typename BufferPolicy = NonOptionalBuffer, size_t inline_capacity = 0, typename ThreadSafety = NonThreadSafe>
+	/// @brief Unspecialized vector which defaults to a NonThreadSafe.
+	/// Reports an error if ThreadSafety is not a thread safety policy: [Non]ThreadSafe.
+	/// @tparam T The type of the objects to store
+	/// @tparam Growth The growth policy of the vector
+	/// @tparam Allocator The allocator policy of the vector
+	/// @tparam BufferPolicy OptionalBuffer to store up to 'inline_capacity' objects without allocating
+	/// @tparam inline_capacity The number of objects of the inline buffer (0 for NonOptionalBuffer)
+	/// @tparam ThreadSafety The thread safety policy of the vector
+	class vector { static_assert(helpers::is_thread_safety_policy_v<ThreadSafety>, "ThreadSafety can only be [Non]ThreadSafe"); };
+
+	template<typename T, typename Growth, typename Allocator, typename BufferPolicy, size_t inline_capacity>
+	/// @brief A non-thread safe heap-allocated array of objects, whose size can change.
+	/// @tparam T The type of the objects to store
+	/// @tparam Growth The growth policy of the vector
+	/// @tparam Allocator The allocator policy of the vector
+	/// @tparam BufferPolicy OptionalBuffer to store up to 'inline_capacity' objects without allocating
+	/// @tparam inline_capacity The number of objects of the inline buffer (0 for NonOptionalBuffer)
+	class vector<T, Growth, Allocator, BufferPolicy, inline_capacity, NonThreadSafe>
+		: private details::vector_inline_buffer<T, BufferPolicy, inline_capacity>
+	{
+		static_assert(helpers::is_growth_policy_v<Growth>, "Growth can only be a growth_factor");
+		static_assert(helpers::is_buffer_policy_v<BufferPolicy>, "BufferPolicy can only be [Non]OptionalBuffer");
+		static_assert(std::is_same_v<BufferPolicy, OptionalBuffer> == (inline_capacity > 0),
+			"inline_capacity should be greater than 0 for OptionalBuffer, and 0 for NonOptionalBuffer!");
+		static_assert(std::is_nothrow_destructible_v<T>, "vale::vector requires a noexcept destructor!");
+
+		using inline_buffer_t = details::vector_inline_buffer<T, BufferPolicy, inline_capacity>;
+		using inline_buffer_t::inline_data;
+
+		/// @brief Pointer to the beginning of the data (the inline buffer if there are one)
+		T* buffer = inline_data();
+		/// @brief The number of objects in the vector
+		size_t nb_elem = 0;
+		/// @brief The number of objects that can be stored without reallocating
+		size_t buffer_capacity = inline_capacity;
+
+	public:
+		/// @brief Helper alias for iterators
+		using iterator = vector_iterator<T>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = vector_iterator<const T>;
+
+		/******************************************
+		STATIC HELPERS
+		******************************************/
+
+		/// @brief Check if the objects of the vector are moved using memcpy/realloc
+		/// @return True if 'T' is trivially relocatable
+		static constexpr bool is_relocatable() noexcept { return is_trivially_relocatable_v<T>; }
+
+		/// @brief Returns the maximum number of objects a vector can hold
+		/// @return The maximum size of the vector
+		static constexpr size_t max_size() noexcept { return std::numeric_limits<size_t>::max() / sizeof(T); }
+
+		/// @brief Check if the vector has an inline buffer
+		/// @return True if the buffer policy is OptionalBuffer
+		static constexpr bool has_inline_buffer() noexcept { return std::is_same_v<BufferPolicy, OptionalBuffer>; }
+
+		/// @brief Returns the number of objects that can be stored without allocating
+		/// @return The capacity of the inline buffer
+		static constexpr size_t inline_buffer_capacity() noexcept { return inline_capacity; }
+
+		/// @brief Check if moving or swapping the vector cannot throw.
+		/// Moving a vector only moves objects if they are stored in the inline buffer.
+		/// @return True if moving the vector is noexcept
+		static constexpr bool is_noexcept_movable() noexcept
+		{
+			return !has_inline_buffer() || is_relocatable() || std::is_nothrow_move_constructible_v<T>;
+		}
+
+		/******************************************
+		CONSTRUCTORS AND DESTRUCTOR
+		******************************************/
+
+		/// @brief Constructs an empty vector, which does not allocate
+		vector() noexcept = default;
+
+		/// @brief Constructs a vector of 'count' value-initialized objects
+		/// @param count The number of objects to construct
+		explicit vector(size_t count)
+		{
+			resize(count);
+		}
+
+		/// @brief Constructs a vector of 'count' copies of 'value'
+		/// @param count The number of objects to construct
+		/// @param value The object to copy
+		vector(size_t count, const T& value)
+		{
+			resize(count, value);
+		}
+
+		/// @brief Constructs a vector by copying the objects of a list
+		/// @param list The objects to copy
+		vector(std::initializer_list<T> list)
+		{
+			copy_from(list.begin(), list.size());
+		}
+
+		/// @brief Constructs a vector by copying the objects pointed to by a view
+		/// @param view The objects to copy
+		explicit vector(contiguous_struct_view<T> view)
+		{
+			copy_from(view.data(), view.size());
+		}
+
+		/// @brief Copy constructor
+		/// @param to_copy The vector to copy
+		vector(const vector& to_copy)
+		{
+			copy_from(to_copy.buffer, to_copy.nb_elem);
+		}
+
+		/// @brief Move constructor, which steals the buffer of 'to_move'.
+		/// If 'to_move' stores its objects inline, they are relocated to the inline buffer of this vector.
+		/// @param to_move The vector to move, which is left empty
+		vector(vector&& to_move) noexcept(is_noexcept_movable())
+		{
+			steal_from(to_move);
+		}
+
+		/// @brief Copy assignment operator
+		/// @param to_copy The vector to copy
+		/// @return *this
+		vector& operator=(const vector& to_copy)
+		{
+			if (this != &to_copy)
+			{
+				clear();
+				copy_from(to_copy.buffer, to_copy.nb_elem);
+			}
+			return *this;
+		}
+
+		/// @brief Move assignment operator, which steals the buffer of 'to_move'
+		/// If 'to_move' stores its objects inline, they are relocated to the inline buffer of this vector.
+		/// @param to_move The vector to move, which is left empty
+		/// @return *this
+		vector& operator=(vector&& to_move) noexcept(is_noexcept_movable())
+		{
+			if (this != &to_move)
+			{
+				free_buffer();
+				steal_from(to_move);
+			}
+			return *this;
+		}
+
+		/// @brief Destroys the objects and frees the buffer
+		~vector() noexcept
+		{
+			free_buffer();
+		}
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the object at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the object
+		/// @return reference to the object
+		[[nodiscard]] constexpr T& operator[](size_t index)
+		{
+			if (index < nb_elem)
+				return buffer[index];
+			throw std::out_of_range("vale::vector: index was greater than size!");
+		}
+
+		/// @brief Returns the object at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the object
+		/// @return const reference to the object
+		[[nodiscard]] constexpr const T& operator[](size_t index) const
+		{
+			if (index < nb_elem)
+				return buffer[index];
+			throw std::out_of_range("vale::vector: index was greater than size!");
+		}
+
+		/// @brief Returns the first object in the vector, or throws if the vector is empty
+		/// @return reference to the first object
+		[[nodiscard]] constexpr T& front()
+		{
+			if (!is_empty())
+				return buffer[0];
+			throw std::out_of_range("vale::vector: vector was empty!");
+		}
+
+		/// @brief Returns the first object in the vector, or throws if the vector is empty
+		/// @return const reference to the first object
+		[[nodiscard]] constexpr const T& front() const
+		{
+			if (!is_empty())
+				return buffer[0];
+			throw std::out_of_range("vale::vector: vector was empty!");
+		}
+
+		/// @brief Returns the last object in the vector, or throws if the vector is empty
+		/// @return reference to the last object
+		[[nodiscard]] constexpr T& back()
+		{
+			if (!is_empty())
+				return buffer[nb_elem - 1];
+			throw std::out_of_range("vale::vector: vector was empty!");
+		}
+
+		/// @brief Returns the last object in the vector, or throws if the vector is empty
+		/// @return const reference to the last object
+		[[nodiscard]] constexpr const T& back() const
+		{
+			if (!is_empty())
+				return buffer[nb_elem - 1];
+			throw std::out_of_range("vale::vector: vector was empty!");
+		}
+
+		/// @brief Returns the number of objects in the vector
+		/// @return The size of the vector
+		[[nodiscard]] constexpr size_t size()		const noexcept { return nb_elem; }
+
+		/// @brief Returns the number of objects the vector can hold without reallocating
+		/// @return The capacity of the vector
+		[[nodiscard]] constexpr size_t capacity()	const noexcept { return buffer_capacity; }
+
+		/// @brief Check if the objects of the vector are stored in its inline buffer
+		/// @return true if the vector did not allocate
+		[[nodiscard]] bool is_inline()		const noexcept { return has_inline_buffer() && buffer == inline_data(); }
+
+		/// @brief Check if the vector is empty (contains 0 objects)
+		/// @return true if the vector is empty
+		[[nodiscard]] constexpr bool is_empty()		const noexcept { return nb_elem == 0; }
+
+		/// @brief Returns a pointer to the beginning of the data
+		/// @return const pointer to the beginning of the data
+		[[nodiscard]] constexpr const T* data()		const noexcept { return buffer; }
+
+		/// @brief Returns a pointer to the beginning of the data
+		/// @return pointer to the beginning of the data
+		[[nodiscard]] constexpr T* data()			noexcept { return buffer; }
+
+		/// @brief Returns an iterator to the beginning of the vector
+		/// @return iterator to the beginning of the vector
+		[[nodiscard]] constexpr iterator begin()				noexcept { return buffer; }
+		/// @brief Returns an iterator to the end of the vector
+		/// @return iterator to the end of the vector
+		[[nodiscard]] constexpr iterator end()					noexcept { return buffer + nb_elem; }
+
+		/// @brief Returns a const iterator to the beginning of the vector
+		/// @return const iterator to the beginning of the vector
+		[[nodiscard]] constexpr const_iterator begin()	const	noexcept { return buffer; }
+		/// @brief Returns a const iterator to the end of the vector
+		/// @return const iterator to the end of the vector
+		[[nodiscard]] constexpr const_iterator end()	const	noexcept { return buffer + nb_elem; }
+
+		/// @brief Returns a const iterator to the beginning of the vector
+		/// @return const iterator to the beginning of the vector
+		[[nodiscard]] constexpr const_iterator cbegin()	const	noexcept { return buffer; }
+		/// @brief Returns a const iterator to the end of the vector
+		/// @return const iterator to the end of the vector
+		[[nodiscard]] constexpr const_iterator cend()	const	noexcept { return buffer + nb_elem; }
+
+		/// @brief Returns a view of all the items in the struct
+		/// @return view of all the items in the struct
+		[[nodiscard]] constexpr vector_view<T> to_view() const noexcept { return vector_view<T>(buffer, nb_elem); }
+
+		/// @brief Returns a view of all the items in the struct starting from offset.
+		/// Throws if offset >= size().
+		/// @return view of all the items in the struct beginning from offset, or throws.
+		[[nodiscard]] vector_view<T> to_view(size_t offset) const
+		{
+			if (offset < nb_elem)
+				return vector_view<T>(buffer + offset, nb_elem - offset);
+			throw std::out_of_range("vale::vector: offset was greater than size!");
+		}
+
+		/// @brief Returns a view of 'size' items in the struct starting from offset.
+		/// Throws if offset + size > size().
+		/// @return view of 'size' items in the struct beginning from offset, or throws.
+		[[nodiscard]] vector_view<T> to_view(size_t offset, size_t size) const
+		{
+			if (offset <= nb_elem && size <= nb_elem - offset)
+				return vector_view<T>(buffer + offset, size);
+			throw std::out_of_range("vale::vector: offset + size was greater than size!");
+		}
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		/// @brief Reserves memory for at least 'count' objects.
+		/// Does nothing if the capacity is already greater than 'count'.
+		/// @param count The number of objects to reserve memory for
+		void reserve(size_t count)
+		{
+			if (count > buffer_capacity)
+				reallocate_buffer(count);
+		}
+
+		/// @brief Frees the memory that is not used by objects of the vector.
+		/// If the objects fit in the inline buffer, they are moved back to it.
+		void shrink_to_fit()
+		{
+			if (nb_elem == buffer_capacity || is_inline())
+				return;
+			if (nb_elem == 0)
+				free_buffer();
+			else
+				reallocate_buffer(nb_elem);
+		}
+
+		/// @brief Destroys all the objects in the vector, without freeing memory
+		void clear() noexcept
+		{
+			std::destroy(buffer, buffer + nb_elem);
+			nb_elem = 0;
+		}
+
+		/// @brief Resizes the vector to 'count' objects, value-initializing the new objects
+		/// @param count The new size of the vector
+		void resize(size_t count)
+		{
+			if (count <= nb_elem)
+				return destroy_tail(count);
+			reserve(count);
+			std::uninitialized_value_construct(buffer + nb_elem, buffer + count);
+			nb_elem = count;
+		}
+
+		/// @brief Resizes the vector to 'count' objects, copying 'value' in the new objects
+		/// @param count The new size of the vector
+		/// @param value The object to copy
+		void resize(size_t count, const T& value)
+		{
+			if (count <= nb_elem)
+				return destroy_tail(count);
+			if (count > buffer_capacity)
+			{
+				//'value' could be an object of the vector
+				T copy = value;
+				reserve(count);
+				std::uninitialized_fill(buffer + nb_elem, buffer + count, copy);
+			}
+			else
+				std::uninitialized_fill(buffer + nb_elem, buffer + count, value);
+			nb_elem = count;
+		}
+
+		/// @brief Resizes the vector to 'count' objects, default-initializing the new objects.
+		/// For trivially default constructible types, the new objects are left uninitialized:
+		/// this avoids zero-filling memory that will be overwritten (by a read() for example).
+		/// @param count The new size of the vector
+		void resize_default_init(size_t count)
+		{
+			if (count <= nb_elem)
+				return destroy_tail(count);
+			reserve(count);
+			std::uninitialized_default_construct(buffer + nb_elem, buffer + count);
+			nb_elem = count;
+		}
+
+		/// @brief Appends 'count' uninitialized objects at the end of the vector.
+		/// The capacity grows following the growth policy, so that appending repeatedly is amortized.
+		/// Only available for trivially default constructible types.
+		/// @param count The number of objects to append
+		/// @return Pointer to the first appended object, which should be written to by the caller
+		[[nodiscard]] T* append_uninitialized(size_t count)
+		{
+			static_assert(std::is_trivially_default_constructible_v<T>,
+				"append_uninitialized() requires a trivially default constructible type!");
+			reserve_for_append(count);
+			T* first = buffer + nb_elem;
+			nb_elem += count;
+			return first;
+		}
+
+		template<typename Callable>
+		/// @brief Reserves memory for 'count' objects after the last object, and lets 'fill'
+		/// write directly into that memory.
+		/// 'fill' is called with a pointer to the uninitialized memory and 'count', and returns the
+		/// number of objects it wrote (at most 'count'), which are appended to the vector.
+		/// Only available for trivially default constructible types.
+		/// \code{.cpp}
+		/// vale::vector<char> buffer;
+		/// buffer.reserve_and_fill(4096, [&](char* ptr, size_t count) { return std::fread(ptr, 1, count, file); });
+		/// \endcode
+		/// @tparam Callable Functor of signature 'size_t(T*, size_t)'
+		/// @param count The maximum number of objects to append
+		/// @param fill The functor which writes the objects
+		/// @return The number of objects appended
+		size_t reserve_and_fill(size_t count, Callable&& fill)
+		{
+			static_assert(std::is_trivially_default_constructible_v<T>,
+				"reserve_and_fill() requires a trivially default constructible type!");
+			reserve_for_append(count);
+			const size_t written = fill(buffer + nb_elem, count);
+			if (written > count)
+				throw std::length_error("vale::vector: reserve_and_fill() wrote more objects than reserved!");
+			nb_elem += written;
+			return written;
+		}
+
+		/// @brief Copies an object at the end of the vector
+		/// @param value The object to copy
+		void push_back(const T& value) { emplace_back(value); }
+
+		/// @brief Moves an object at the end of the vector
+		/// @param value The object to move
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		template<typename... Args>
+		/// @brief Constructs an object at the end of the vector
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return reference to the constructed object
+		T& emplace_back(Args&&... args)
+		{
+			if (nb_elem == buffer_capacity)
+				return emplace_back_grow(std::forward<Args>(args)...);
+			T* ptr = new(buffer + nb_elem) T(std::forward<Args>(args)...);
+			++nb_elem;
+			return *ptr;
+		}
+
+		/// @brief Destroys the last object in the vector, or throws if the vector is empty
+		void pop_back()
+		{
+			if (is_empty())
+				throw std::out_of_range("vale::vector: vector was empty!");
+			buffer[--nb_elem].~T();
+		}
+
+		/// @brief Copies an object before 'pos'
+		/// @param pos The iterator before which to insert
+		/// @param value The object to copy
+		/// @return iterator to the inserted object
+		iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+
+		/// @brief Moves an object before 'pos'
+		/// @param pos The iterator before which to insert
+		/// @param value The object to move
+		/// @return iterator to the inserted object
+		iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+		template<typename... Args>
+		/// @brief Constructs an object before 'pos'
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param pos The iterator before which to construct the object
+		/// @param ...args The arguments to forward to the constructor
+		/// @return iterator to the constructed object
+		iterator emplace(const_iterator pos, Args&&... args)
+		{
+			const size_t index = pos - cbegin();
+			if (index == nb_elem)
+				return &emplace_back(std::forward<Args>(args)...);
+
+			if constexpr (is_relocatable())
+			{
+				//The arguments could refer to objects of the vector:
+				//we construct the object before moving memory
+				alignas(T) unsigned char storage[sizeof(T)];
+				new(storage) T(std::forward<Args>(args)...);
+				if (nb_elem == buffer_capacity)
+				{
+					try { reallocate_buffer(Growth::grow(buffer_capacity, nb_elem + 1)); }
+					catch (...) { reinterpret_cast<T*>(storage)->~T(); throw; }
+				}
+				std::memmove(static_cast<void*>(buffer + index + 1), buffer + index, (nb_elem - index) * sizeof(T));
+				std::memcpy(static_cast<void*>(buffer + index), storage, sizeof(T));
+			}
+			else
+			{
+				T value(std::forward<Args>(args)...);
+				if (nb_elem == buffer_capacity)
+					reallocate_buffer(Growth::grow(buffer_capacity, nb_elem + 1));
+				new(buffer + nb_elem) T(std::move(buffer[nb_elem - 1]));
+				std::move_backward(buffer + index, buffer + nb_elem - 1, buffer + nb_elem);
+				buffer[index] = std::move(value);
+			}
+			++nb_elem;
+			return buffer + index;
+		}
+
+		/// @brief Erases the object pointed to by 'pos'
+		/// @param pos The iterator to the object to erase
+		/// @return iterator following the erased object
+		iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+		/// @brief Erases the objects in the range [first, last)
+		/// @param first The iterator to the first object to erase
+		/// @param last The iterator following the last object to erase
+		/// @return iterator following the erased objects
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			const size_t index = first - cbegin();
+			const size_t count = last - first;
+			if (count == 0)
+				return buffer + index;
+
+			if constexpr (is_relocatable())
+			{
+				std::destroy(buffer + index, buffer + index + count);
+				std::memmove(static_cast<void*>(buffer + index), buffer + index + count,
+					(nb_elem - index - count) * sizeof(T));
+				nb_elem -= count;
+			}
+			else
+			{
+				std::move(buffer + index + count, buffer + nb_elem, buffer + index);
+				destroy_tail(nb_elem - count);
+			}
+			return buffer + index;
+		}
+
+		/// @brief Swaps the content of two vectors.
+		/// Objects are only moved if one of the vectors stores its objects inline.
+		/// @param other The vector to swap with
+		void swap(vector& other) noexcept(is_noexcept_movable())
+		{
+			if (is_inline() || other.is_inline())
+			{
+				vector temp = std::move(other);
+				other = std::move(*this);
+				*this = std::move(temp);
+				return;
+			}
+			std::swap(buffer, other.buffer);
+			std::swap(nb_elem, other.nb_elem);
+			std::swap(buffer_capacity, other.buffer_capacity);
+		}
+
+		/// @brief Prints the content of the vector in 'os'
+		/// @param os The ostream in which to << the vector's content
+		inline void print(std::ostream& os) const
+		{
+			os << "{";
+			for (size_t i = 0; i + 1 < nb_elem; i++)
+				os << buffer[i] << ", ";
+			if (nb_elem != 0)
+				os << buffer[nb_elem - 1];
+			os << '}';
+		}
+
+	private:
+
+		/// @brief Allocates an uninitialized buffer of 'count' objects
+		/// @param count The number of objects
+		/// @return Pointer to the allocated buffer
+		static T* allocate(size_t count)
+		{
+			if (count > max_size())
+				throw std::length_error("vale::vector: size was greater than max_size()!");
+			return static_cast<T*>(Allocator::allocate(count * sizeof(T), alignof(T)));
+		}
+
+		/// @brief Frees a buffer returned by allocate()
+		/// @param ptr The buffer to free
+		/// @param count The capacity of the buffer
+		static void deallocate(T* ptr, size_t count) noexcept
+		{
+			Allocator::deallocate(ptr, count * sizeof(T), alignof(T));
+		}
+
+		/// @brief Frees the buffer if it was allocated (is not nullptr or the inline buffer)
+		void release_buffer() noexcept
+		{
+			if (buffer != nullptr && !is_inline())
+				deallocate(buffer, buffer_capacity);
+		}
+
+		/// @brief Destroys all the objects and frees the buffer
+		void free_buffer() noexcept
+		{
+			clear();
+			release_buffer();
+			buffer = inline_data();
+			buffer_capacity = inline_capacity;
+		}
+
+		/// @brief Steals the buffer of 'from', or relocates its objects if it stores them inline.
+		/// This vector should not contain any object nor have allocated.
+		/// @param from The vector from which to steal, which is left empty
+		void steal_from(vector& from) noexcept(is_noexcept_movable())
+		{
+			if (from.is_inline())
+			{
+				from.relocate_to(buffer);
+				nb_elem = std::exchange(from.nb_elem, 0);
+				return;
+			}
+			buffer = std::exchange(from.buffer, from.inline_data());
+			nb_elem = std::exchange(from.nb_elem, 0);
+			buffer_capacity = std::exchange(from.buffer_capacity, inline_capacity);
+		}
+
+		/// @brief Grows the buffer, following the growth policy, so that 'count' objects can be appended
+		/// @param count The number of objects to append
+		void reserve_for_append(size_t count)
+		{
+			if (count > max_size() - nb_elem)
+				throw std::length_error("vale::vector: size was greater than max_size()!");
+			if (nb_elem + count > buffer_capacity)
+				reallocate_buffer(Growth::grow(buffer_capacity, nb_elem + count));
+		}
+
+		/// @brief Destroys the objects at the end of the vector so that its size is 'count'
+		/// @param count The new size (<= size())
+		void destroy_tail(size_t count) noexcept
+		{
+			std::destroy(buffer + count, buffer + nb_elem);
+			nb_elem = count;
+		}
+
+		/// @brief Copies 'count' objects into an empty vector
+		/// @param from Pointer to the objects to copy
+		/// @param count The number of objects to copy
+		void copy_from(const T* from, size_t count)
+		{
+			if (count == 0)
+				return;
+			reserve(count);
+			if constexpr (std::is_trivially_copyable_v<T>)
+				std::memcpy(static_cast<void*>(buffer), from, count * sizeof(T));
+			else
+				std::uninitialized_copy(from, from + count, buffer);
+			nb_elem = count;
+		}
+
+		/// @brief Moves the objects of the vector to a buffer of capacity 'new_capacity'.
+		/// Uses the allocator's reallocate() if the objects are trivially relocatable
+		/// and the buffer was allocated. If 'new_capacity' fits in the inline buffer,
+		/// the objects are moved to the inline buffer.
+		/// @param new_capacity The new capacity (>= size())
+		void reallocate_buffer(size_t new_capacity)
+		{
+			const bool to_inline = has_inline_buffer() && new_capacity <= inline_capacity;
+			if constexpr (is_relocatable())
+			{
+				if (!to_inline && !is_inline())
+				{
+					if (new_capacity > max_size())
+						throw std::length_error("vale::vector: size was greater than max_size()!");
+					buffer = static_cast<T*>(Allocator::reallocate(buffer, buffer_capacity * sizeof(T),
+						new_capacity * sizeof(T), alignof(T)));
+					buffer_capacity = new_capacity;
+					return;
+				}
+			}
+			T* new_buffer = to_inline ? inline_data() : allocate(new_capacity);
+			try { relocate_to(new_buffer); }
+			catch (...)
+			{
+				if (!to_inline)
+					deallocate(new_buffer, new_capacity);
+				throw;
+			}
+			release_buffer();
+			buffer = new_buffer;
+			buffer_capacity = to_inline ? inline_capacity : new_capacity;
+		}
+
+		/// @brief Moves (or copies if the move constructor can throw) the objects
+		/// of the vector to 'to', then destroys the old objects.
+		/// If copying throws, the vector is left unchanged.
+		/// Trivially relocatable objects are copied using memcpy.
+		/// @param to The uninitialized buffer to which to move the objects
+		void relocate_to(T* to) noexcept(is_relocatable() || std::is_nothrow_move_constructible_v<T>)
+		{
+			if constexpr (is_relocatable())
+			{
+				if (nb_elem != 0)
+					std::memcpy(static_cast<void*>(to), buffer, nb_elem * sizeof(T));
+				return;
+			}
+			else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+				std::uninitialized_move(buffer, buffer + nb_elem, to);
+			else
+				std::uninitialized_copy(buffer, buffer + nb_elem, to);
+			std::destroy(buffer, buffer + nb_elem);
+		}
+
+		template<typename... Args>
+		/// @brief Slow path of emplace_back(), which grows the buffer.
+		/// The new object is constructed before moving the old ones, as the arguments
+		/// could refer to objects of the vector.
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return reference to the constructed object
+		T& emplace_back_grow(Args&&... args)
+		{
+			const size_t new_capacity = Growth::grow(buffer_capacity, nb_elem + 1);
+			if constexpr (is_relocatable())
+			{
+				alignas(T) unsigned char storage[sizeof(T)];
+				new(storage) T(std::forward<Args>(args)...);
+				try { reallocate_buffer(new_capacity); }
+				catch (...) { reinterpret_cast<T*>(storage)->~T(); throw; }
+				std::memcpy(static_cast<void*>(buffer + nb_elem), storage, sizeof(T));
+			}
+			else
+			{
+				T* new_buffer = allocate(new_capacity);
+				try { new(new_buffer + nb_elem) T(std::forward<Args>(args)...); }
+				catch (...) { deallocate(new_buffer, new_capacity); throw; }
+				try { relocate_to(new_buffer); }
+				catch (...)
+				{
+					new_buffer[nb_elem].~T();
+					deallocate(new_buffer, new_capacity);
+					throw;
+				}
+				release_buffer();
+				buffer = new_buffer;
+				buffer_capacity = new_capacity;
+			}
+			return buffer[nb_elem++];
+		}
+	};
+
+	template<typename T, typename Growth, typename Allocator, typename BufferPolicy, size_t inline_capacity>
+	/// @brief A thread safe append-only vector, which many threads can push to concurrently.
+	/// Objects are stored in segments whose sizes grow geometrically: segments are never reallocated,
+	/// so the address of an object never changes.
+	/// A slot is claimed by a single atomic fetch_add, and becomes published once its object is constructed.
+	/// Reading a published object does not lock.
+	/// The growth policy is not used, as each segment is twice as big as the previous one.
+	/// @tparam T The type of the objects to store
+	/// @tparam Allocator The allocator policy used to allocate segments
+	class vector<T, Growth, Allocator, BufferPolicy, inline_capacity, ThreadSafe>
+	{
+		static_assert(std::is_same_v<BufferPolicy, NonOptionalBuffer>, "A ThreadSafe vector cannot have an inline buffer!");
+		static_assert(std::is_nothrow_destructible_v<T>, "vale::vector requires a noexcept destructor!");
+
+		/// @brief log2 of the number of objects of the first segment
+		static constexpr size_t first_segment_bits = 5;
+		/// @brief The number of objects of the first segment
+		static constexpr size_t first_segment_size = size_t(1) << first_segment_bits;
+		/// @brief The maximum number of segments, which can hold all indexes representable by a size_t
+		static constexpr size_t max_segments = std::numeric_limits<size_t>::digits - first_segment_bits;
+
+		/// @brief The segments, which begin with a bitmap of published slots followed by the objects
+		std::atomic<unsigned char*> segments[max_segments] = {};
+		/// @brief The number of claimed slots, on its own cache line as all pushing threads write to it
+		alignas(cache_line_size) std::atomic<size_t> nb_claimed{ 0 };
+
+	public:
+
+		/******************************************
+		CONSTRUCTORS AND DESTRUCTOR
+		******************************************/
+
+		/// @brief Constructs an empty vector, which does not allocate
+		vector() noexcept = default;
+
+		vector(const vector&) = delete;
+		vector& operator=(const vector&) = delete;
+
+		/// @brief Destroys the published objects and frees the segments.
+		/// No other thread should access the vector.
+		~vector() noexcept
+		{
+			const size_t claimed = nb_claimed.load(std::memory_order_acquire);
+			for (size_t segment = 0; segment < max_segments; segment++)
+			{
+				unsigned char* ptr = segments[segment].load(std::memory_order_acquire);
+				if (ptr == nullptr)
+					continue;
+				const size_t first_index = segment_first_index(segment);
+				if constexpr (!std::is_trivially_destructible_v<T>)
+				{
+					for (size_t offset = 0; offset < segment_size(segment) && first_index + offset < claimed; offset++)
+					{
+						if (is_published_in(ptr, offset))
+							objects_of(ptr, segment)[offset].~T();
+					}
+				}
+				Allocator::deallocate(ptr, segment_byte_size(segment), segment_alignment());
+			}
+		}
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		/// @brief Copies an object at the end of the vector
+		/// @param value The object to copy
+		/// @return The index of the object
+		size_t push_back(const T& value) { return emplace_back_index(value); }
+
+		/// @brief Moves an object at the end of the vector
+		/// @param value The object to move
+		/// @return The index of the object
+		size_t push_back(T&& value) { return emplace_back_index(std::move(value)); }
+
+		template<typename... Args>
+		/// @brief Constructs an object at the end of the vector.
+		/// If the constructor throws, the claimed slot is never published.
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return reference to the constructed object, whose address never changes
+		T& emplace_back(Args&&... args)
+		{
+			const size_t index = emplace_back_index(std::forward<Args>(args)...);
+			const location loc = locate(index);
+			return objects_of(segments[loc.segment].load(std::memory_order_relaxed), loc.segment)[loc.offset];
+		}
+
+		/// @brief Allocates the segments needed to store 'count' objects.
+		/// This avoids allocating while pushing.
+		/// @param count The number of objects to reserve memory for
+		void reserve(size_t count)
+		{
+			if (count == 0)
+				return;
+			const size_t last_segment = locate(count - 1).segment;
+			for (size_t segment = 0; segment <= last_segment; segment++)
+				get_or_allocate_segment(segment);
+		}
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the number of claimed slots, which includes objects that are not yet published
+		/// @return The size of the vector
+		[[nodiscard]] size_t size() const noexcept { return nb_claimed.load(std::memory_order_acquire); }
+
+		/// @brief Check if the vector is empty (no slot was claimed)
+		/// @return true if the vector is empty
+		[[nodiscard]] bool is_empty() const noexcept { return size() == 0; }
+
+		/// @brief Check if the object at 'index' is constructed and can be read
+		/// @param index The index of the object
+		/// @return true if the object is published
+		[[nodiscard]] bool is_published(size_t index) const noexcept { return try_get(index) != nullptr; }
+
+		/// @brief Returns a pointer to the object at 'index' if it is published
+		/// @param index The index of the object
+		/// @return pointer to the object, or nullptr if it is not published
+		[[nodiscard]] T* try_get(size_t index) noexcept
+		{
+			return const_cast<T*>(std::as_const(*this).try_get(index));
+		}
+
+		/// @brief Returns a pointer to the object at 'index' if it is published
+		/// @param index The index of the object
+		/// @return const pointer to the object, or nullptr if it is not published
+		[[nodiscard]] const T* try_get(size_t index) const noexcept
+		{
+			if (index >= size())
+				return nullptr;
+			const location loc = locate(index);
+			unsigned char* ptr = segments[loc.segment].load(std::memory_order_acquire);
+			if (ptr == nullptr || !is_published_in(ptr, loc.offset))
+				return nullptr;
+			return objects_of(ptr, loc.segment) + loc.offset;
+		}
+
+		/// @brief Returns the object at 'index', and throws if it is not published.
+		/// If the index is greater than size() - 1 or the object is not yet constructed, throws std::out_of_range
+		/// @param index The index of the object
+		/// @return reference to the object
+		[[nodiscard]] T& operator[](size_t index)
+		{
+			if (T* ptr = try_get(index))
+				return *ptr;
+			throw std::out_of_range("vale::ts_vector: index was not published!");
+		}
+
+		/// @brief Returns the object at 'index', and throws if it is not published.
+		/// If the index is greater than size() - 1 or the object is not yet constructed, throws std::out_of_range
+		/// @param index The index of the object
+		/// @return const reference to the object
+		[[nodiscard]] const T& operator[](size_t index) const
+		{
+			if (const T* ptr = try_get(index))
+				return *ptr;
+			throw std::out_of_range("vale::ts_vector: index was not published!");
+		}
+
+		template<typename Func>
+		/// @brief Call a functor with each published object, in index order
+		/// @param func The functor to which a const reference of each object is passed
+		void for_each(Func&& func) const
+		{
+			const size_t claimed = size();
+			for (size_t index = 0; index < claimed; index++)
+			{
+				if (const T* ptr = try_get(index))
+					func(*ptr);
+			}
+		}
+
+		/// @brief Prints the published objects of the vector in 'os'
+		/// @param os The ostream in which to << the vector's content
+		inline void print(std::ostream& os) const
+		{
+			bool first = true;
+			os << "{";
+			for_each([&](const T& obj) {
+				os << (first ? "" : ", ") << obj;
+				first = false;
+			});
+			os << '}';
+		}
+
+	private:
+
+		/// @brief The segment and offset in that segment of an object
+		struct location
+		{
+			size_t segment;
+			size_t offset;
+		};
+
+		/// @brief Computes the location of the object at 'index'.
+		/// Segment 'k' contains the indexes [first_segment_size * (2^k - 1), first_segment_size * (2^(k+1) - 1)).
+		/// @param index The index of the object
+		/// @return The location of the object
+		static location locate(size_t index) noexcept
+		{
+			const size_t biased = index + first_segment_size;
+			const size_t msb = static_cast<size_t>(helpers::floor_log2(biased));
+			return { msb - first_segment_bits, biased - (size_t(1) << msb) };
+		}
+
+		/// @brief Returns the number of objects of a segment
+		static constexpr size_t segment_size(size_t segment) noexcept { return first_segment_size << segment; }
+
+		/// @brief Returns the index of the first object of a segment
+		static constexpr size_t segment_first_index(size_t segment) noexcept { return segment_size(segment) - first_segment_size; }
+
+		/// @brief Returns the number of words of the bitmap of published slots of a segment
+		static constexpr size_t bitmap_words(size_t segment) noexcept { return (segment_size(segment) + 63) / 64; }
+
+		/// @brief Returns the byte offset of the objects of a segment, which follow the bitmap of published slots
+		static constexpr size_t objects_byte_offset(size_t segment) noexcept
+		{
+			const size_t bitmap_bytes = bitmap_words(segment) * sizeof(std::atomic<uint64_t>);
+			return (bitmap_bytes + alignof(T) - 1) / alignof(T) * alignof(T);
+		}
+
+		/// @brief Returns the number of bytes to allocate for a segment
+		static constexpr size_t segment_byte_size(size_t segment) noexcept
+		{
+			return objects_byte_offset(segment) + segment_size(segment) * sizeof(T);
+		}
+
+		/// @brief Returns the alignment of the segments
+		static constexpr size_t segment_alignment() noexcept
+		{
+			return alignof(T) > alignof(std::atomic<uint64_t>) ? alignof(T) : alignof(std::atomic<uint64_t>);
+		}
+
+		/// @brief Returns the objects of a segment
+		static T* objects_of(unsigned char* ptr, size_t segment) noexcept
+		{
+			return reinterpret_cast<T*>(ptr + objects_byte_offset(segment));
+		}
+
+		/// @brief Returns the word of the bitmap of published slots containing 'offset'
+		static std::atomic<uint64_t>& bitmap_word(unsigned char* ptr, size_t offset) noexcept
+		{
+			return reinterpret_cast<std::atomic<uint64_t>*>(ptr)[offset / 64];
+		}
+
+		/// @brief Check if the object at 'offset' in a segment is published
+		static bool is_published_in(unsigned char* ptr, size_t offset) noexcept
+		{
+			return (bitmap_word(ptr, offset).load(std::memory_order_acquire) >> (offset % 64)) & 1;
+		}
+
+		/// @brief Returns a segment, allocating it if no thread did.
+		/// If two threads allocate the same segment, the one that loses the race frees its segment.
+		/// @param segment The index of the segment
+		/// @return Pointer to the segment
+		unsigned char* get_or_allocate_segment(size_t segment)
+		{
+			unsigned char* ptr = segments[segment].load(std::memory_order_acquire);
+			if (ptr != nullptr)
+				return ptr;
+
+			unsigned char* new_ptr = static_cast<unsigned char*>(
+				Allocator::allocate(segment_byte_size(segment), segment_alignment()));
+			for (size_t word = 0; word < bitmap_words(segment); word++)
+				new(new_ptr + word * sizeof(std::atomic<uint64_t>)) std::atomic<uint64_t>(0);
+
+			if (segments[segment].compare_exchange_strong(ptr, new_ptr, std::memory_order_acq_rel))
+				return new_ptr;
+			//Another thread installed the segment first: 'ptr' now holds its segment
+			Allocator::deallocate(new_ptr, segment_byte_size(segment), segment_alignment());
+			return ptr;
+		}
+
+		template<typename... Args>
+		/// @brief Claims a slot, constructs an object in it and publishes it
+		/// @tparam ...Args The parameter pack to forward to the constructor
+		/// @param ...args The arguments to forward to the constructor
+		/// @return The index of the object
+		size_t emplace_back_index(Args&&... args)
+		{
+			const size_t index = nb_claimed.fetch_add(1, std::memory_order_relaxed);
+			const location loc = locate(index);
+			unsigned char* ptr = get_or_allocate_segment(loc.segment);
+			new(objects_of(ptr, loc.segment) + loc.offset) T(std::forward<Args>(args)...);
+			bitmap_word(ptr, loc.offset).fetch_or(uint64_t(1) << (loc.offset % 64), std::memory_order_release);
+			return index;
+		}
+	};
+
+#if defined(__unix__) || defined(__APPLE__)
+	/******************************************
+	PERSISTENT MAPPED VECTOR
+	******************************************/
+
+	/// @brief Thrown if a file opened by a mapped_vector is not a valid mapped_vector file,
+	/// or was written with a different element type
+	class invalid_mapped_file
+		: public std::exception
+	{
+	public:
+		const char* what() const noexcept override { return "The file was not a valid mapped_vector file for this type!"; }
+	};
+
+	/// @brief The mode in which a mapped_vector opens its file
+	enum class mapped_file_mode
+	{
+		read_only, read_write
+	};
+
+	/// @brief The header at the beginning of a mapped_vector file.
+	/// The objects follow the header, at 'data_offset' bytes from the beginning of the file.
+	struct mapped_vector_header
+	{
+		/// @brief The magic number of the file
+		char magic[8];
+		/// @brief The version of the file format
+		uint32_t version;
+		/// @brief sizeof() the type of the objects
+		uint32_t element_size;
+		/// @brief alignof() the type of the objects
+		uint32_t element_alignment;
+		/// @brief The byte offset of the objects from the beginning of the file
+		uint32_t data_offset;
+		/// @brief The number of objects
+		uint64_t count;
+		/// @brief The number of objects the file can hold
+		uint64_t capacity;
+		/// @brief Checksum of the objects, written by sync()
+		uint64_t checksum;
+		/// @brief Unused bytes, which pad the header to a cache line
+		uint64_t reserved[2];
+
+		/// @brief The magic number of mapped_vector files
+		static constexpr char file_magic[8] = { 'V', 'A', 'L', 'E', 'V', 'E', 'C', '\0' };
+		/// @brief The current version of the file format
+		static constexpr uint32_t file_version = 1;
+	};
+	static_assert(sizeof(mapped_vector_header) == cache_line_size, "mapped_vector_header should fill a cache line!");
+
+	namespace details
+	{
+		/// @brief Computes a 64-bit checksum of 'size' bytes, reading 8 bytes at a time
+		/// @param ptr The bytes
+		/// @param size The number of bytes
+		/// @return The checksum
+		inline uint64_t checksum64(const void* ptr, size_t size) noexcept
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(ptr);
+			uint64_t hash = 0x243F6A8885A308D3ull ^ size;
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+			{
+				uint64_t word;
+				std::memcpy(&word, bytes + i, sizeof(uint64_t));
+				hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+				hash ^= hash >> 32;
+			}
+			for (; i < size; i++)
+				hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+			return hash;
+		}
+	}
+
+	template<typename T, typename Growth = default_growth>
+	/// @brief A vector stored in a file, which is mapped in memory.
+	/// Opening an existing file is O(1) whatever its size: pages are only read when accessed.
+	/// The file begins with a versioned header (see mapped_vector_header) recording the size and alignment
+	/// of 'T', the number of objects and a checksum of the objects.
+	/// The checksum is only verified through verify_checksum(), as verifying it is O(n).
+	/// Objects are written directly in the mapping; sync() updates the checksum and flushes the mapping
+	/// to the file, and is called by the destructor of a read_write vector.
+	/// @tparam T The type of the objects, which should be trivially copyable and not contain pointers
+	/// @tparam Growth The growth policy of the file
+	class mapped_vector
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "mapped_vector requires a trivially copyable type!");
+		static_assert(helpers::is_growth_policy_v<Growth>, "Growth can only be a growth_factor");
+
+		/// @brief The file descriptor of the file
+		int file = -1;
+		/// @brief The mode in which the file was opened
+		mapped_file_mode mode = mapped_file_mode::read_only;
+		/// @brief The mapping of the whole file
+		unsigned char* mapping = nullptr;
+		/// @brief The size of the mapping
+		size_t mapping_size = 0;
+
+	public:
+		/// @brief Helper alias for iterators
+		using iterator = vector_iterator<T>;
+		/// @brief Helper alias for const iterators
+		using const_iterator = vector_iterator<const T>;
+
+		/// @brief The capacity of a newly created file
+		static constexpr size_t initial_capacity = 1024;
+
+		/// @brief Returns the byte offset of the objects in the file
+		/// @return The size of the header, rounded to the alignment of 'T'
+		static constexpr size_t data_offset() noexcept
+		{
+			return alignof(T) > sizeof(mapped_vector_header) ? alignof(T) : sizeof(mapped_vector_header);
+		}
+
+		/******************************************
+		CONSTRUCTORS AND DESTRUCTOR
+		******************************************/
+
+		/// @brief Opens (or creates if 'mode' is read_write) a mapped_vector file.
+		/// Throws std::system_error if the file cannot be opened or mapped,
+		/// and invalid_mapped_file if its header does not match 'T'.
+		/// @param path The path to the file
+		/// @param mode The mode in which to open the file
+		explicit mapped_vector(const std::string& path, mapped_file_mode mode = mapped_file_mode::read_write)
+			: mode(mode)
+		{
+			const bool writable = mode == mapped_file_mode::read_write;
+			file = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+			if (file == -1)
+				throw_system_error("vale::mapped_vector: could not open file!");
+
+			try
+			{
+				struct stat info;
+				if (::fstat(file, &info) == -1)
+					throw_system_error("vale::mapped_vector: could not stat file!");
+
+				if (info.st_size == 0 && writable)
+				{
+					create_file();
+				}
+				else
+				{
+					if (static_cast<size_t>(info.st_size) < data_offset())
+						throw invalid_mapped_file{};
+					map_file(static_cast<size_t>(info.st_size));
+					if (!is_header_valid(static_cast<size_t>(info.st_size)))
+						throw invalid_mapped_file{};
+				}
+			}
+			catch (...)
+			{
+				close_file();
+				throw;
+			}
+		}
+
+		mapped_vector(const mapped_vector&) = delete;
+		mapped_vector& operator=(const mapped_vector&) = delete;
+
+		/// @brief Move constructor, which steals the file of 'to_move'
+		/// @param to_move The vector to move, which is left closed
+		mapped_vector(mapped_vector&& to_move) noexcept
+			: file(std::exchange(to_move.file, -1))
+			, mode(to_move.mode)
+			, mapping(std::exchange(to_move.mapping, nullptr))
+			, mapping_size(std::exchange(to_move.mapping_size, 0))
+		{}
+
+		/// @brief Syncs the file if it was opened in read_write mode, and closes it
+		~mapped_vector() noexcept
+		{
+			if (mapping != nullptr && mode == mapped_file_mode::read_write)
+			{
+				try { sync(); }
+				catch (...) {}
+			}
+			close_file();
+		}
+
+		/******************************************
+		ACCESS
+		******************************************/
+
+		/// @brief Returns the header of the file
+		/// @return const reference to the header
+		[[nodiscard]] const mapped_vector_header& header() const noexcept { return *reinterpret_cast<const mapped_vector_header*>(mapping); }
+
+		/// @brief Returns the number of objects in the file
+		/// @return The size of the vector
+		[[nodiscard]] size_t size()		const noexcept { return static_cast<size_t>(header().count); }
+
+		/// @brief Returns the number of objects the file can hold without growing
+		/// @return The capacity of the vector
+		[[nodiscard]] size_t capacity()	const noexcept { return static_cast<size_t>(header().capacity); }
+
+		/// @brief Check if the vector is empty (contains 0 objects)
+		/// @return true if the vector is empty
+		[[nodiscard]] bool is_empty()	const noexcept { return size() == 0; }
+
+		/// @brief Returns a pointer to the beginning of the data, in the mapping
+		/// @return const pointer to the beginning of the data
+		[[nodiscard]] const T* data()	const noexcept { return reinterpret_cast<const T*>(mapping + data_offset()); }
+
+		/// @brief Returns a pointer to the beginning of the data, in the mapping.
+		/// Writing through this pointer is UB if the file was opened in read_only mode.
+		/// @return pointer to the beginning of the data
+		[[nodiscard]] T* data()			noexcept { return reinterpret_cast<T*>(mapping + data_offset()); }
+
+		/// @brief Returns the object at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range
+		/// @param index The index of the object
+		/// @return const reference to the object
+		[[nodiscard]] const T& operator[](size_t index) const
+		{
+			if (index < size())
+				return data()[index];
+			throw std::out_of_range("vale::mapped_vector: index was greater than size!");
+		}
+
+		/// @brief Returns the object at 'index', and throws if the index is out of range.
+		/// If the index is greater than size() - 1, throws std::out_of_range.
+		/// Writing through this reference is UB if the file was opened in read_only mode.
+		/// @param index The index of the object
+		/// @return reference to the object
+		[[nodiscard]] T& operator[](size_t index)
+		{
+			if (index < size())
+				return data()[index];
+			throw std::out_of_range("vale::mapped_vector: index was greater than size!");
+		}
+
+		/// @brief Returns a const iterator to the beginning of the vector
+		/// @return const iterator to the beginning of the vector
+		[[nodiscard]] const_iterator begin()	const noexcept { return data(); }
+		/// @brief Returns a const iterator to the end of the vector
+		/// @return const iterator to the end of the vector
+		[[nodiscard]] const_iterator end()		const noexcept { return data() + size(); }
+
+		/// @brief Returns a view of all the items in the file, directly over the mapping
+		/// @return view of all the items in the file
+		[[nodiscard]] vector_view<T> to_view() const noexcept { return vector_view<T>(data(), size()); }
+
+		/// @brief Returns a view of all the items in the file starting from offset.
+		/// Throws if offset >= size().
+		/// @return view of all the items in the file beginning from offset, or throws.
+		[[nodiscard]] vector_view<T> to_view(size_t offset) const
+		{
+			if (offset < size())
+				return vector_view<T>(data() + offset, size() - offset);
+			throw std::out_of_range("vale::mapped_vector: offset was greater than size!");
+		}
+
+		/// @brief Returns a view of 'count' items in the file starting from offset.
+		/// Throws if offset + count > size().
+		/// @return view of 'count' items in the file beginning from offset, or throws.
+		[[nodiscard]] vector_view<T> to_view(size_t offset, size_t count) const
+		{
+			if (offset <= size() && count <= size() - offset)
+				return vector_view<T>(data() + offset, count);
+			throw std::out_of_range("vale::mapped_vector: offset + size was greater than size!");
+		}
+
+		/// @brief Computes the checksum of the objects and compares it to the checksum of the header.
+		/// This is O(n), and only succeeds if sync() was called after the last modification.
+		/// @return true if the checksum matches
+		[[nodiscard]] bool verify_checksum() const noexcept
+		{
+			return header().checksum == details::checksum64(data(), size() * sizeof(T));
+		}
+
+		/******************************************
+		MODIFIERS
+		******************************************/
+
+		/// @brief Grows the file so that it can hold at least 'count' objects
+		/// @param count The number of objects to reserve space for
+		void reserve(size_t count)
+		{
+			check_writable();
+			if (count > capacity())
+				grow_file(count);
+		}
+
+		/// @brief Appends an object at the end of the file
+		/// @param value The object to append
+		void push_back(const T& value)
+		{
+			check_writable();
+			if (size() == capacity())
+				grow_file(Growth::grow(capacity(), size() + 1));
+			std::memcpy(static_cast<void*>(data() + size()), &value, sizeof(T));
+			++mutable_header().count;
+		}
+
+		/// @brief Appends the objects of a view at the end of the file
+		/// @param view The objects to append
+		void append(contiguous_struct_view<T> view)
+		{
+			check_writable();
+			if (view.size() > capacity() - size())
+				grow_file(Growth::grow(capacity(), size() + view.size()));
+			if (!view.is_empty())
+				std::memcpy(static_cast<void*>(data() + size()), view.data(), view.size() * sizeof(T));
+			mutable_header().count += view.size();
+		}
+
+		/// @brief Removes all the objects, without shrinking the file
+		void clear()
+		{
+			check_writable();
+			mutable_header().count = 0;
+		}
+
+		/// @brief Updates the checksum of the header and flushes the mapping to the file (msync)
+		void sync()
+		{
+			check_writable();
+			mutable_header().checksum = details::checksum64(data(), size() * sizeof(T));
+			if (::msync(mapping, mapping_size, MS_SYNC) == -1)
+				throw_system_error("vale::mapped_vector: could not sync file!");
+		}
+
+		/// @brief Prints the content of the vector in 'os'
+		/// @param os The ostream in which to << the vector's content
+		inline void print(std::ostream& os) const
+		{
+			os << to_view();
+		}
+
+	private:
+
+		/// @brief Throws a std::system_error built from errno
+		[[noreturn]] static void throw_system_error(const char* message)
+		{
+			throw std::system_error(errno, std::generic_category(), message);
+		}
+
+		/// @brief Throws if the file was opened in read_only mode
+		void check_writable() const
+		{
+			if (mode != mapped_file_mode::read_write)
+				throw std::logic_error("vale::mapped_vector: file was opened in read_only mode!");
+		}
+
+		/// @brief Returns the header of the file
+		mapped_vector_header& mutable_header() noexcept { return *reinterpret_cast<mapped_vector_header*>(mapping); }
+
+		/// @brief Check that the header matches 'T' and the size of the file
+		bool is_header_valid(size_t file_size) const noexcept
+		{
+			const mapped_vector_header& head = header();
+			return std::memcmp(head.magic, mapped_vector_header::file_magic, sizeof(head.magic)) == 0
+				&& head.version == mapped_vector_header::file_version
+				&& head.element_size == sizeof(T)
+				&& head.element_alignment == alignof(T)
+				&& head.data_offset == data_offset()
+				&& head.count <= head.capacity
+				&& head.capacity <= (file_size - data_offset()) / sizeof(T);
+		}
+
+		/// @brief Maps 'size' bytes of the file
+		void map_file(size_t size)
+		{
+			const int protection = mode == mapped_file_mode::read_write ? PROT_READ | PROT_WRITE : PROT_READ;
+			void* ptr = ::mmap(nullptr, size, protection, MAP_SHARED, file, 0);
+			if (ptr == MAP_FAILED)
+				throw_system_error("vale::mapped_vector: could not map file!");
+			mapping = static_cast<unsigned char*>(ptr);
+			mapping_size = size;
+		}
+
+		/// @brief Sizes an empty file for 'initial_capacity' objects and writes its header
+		void create_file()
+		{
+			const size_t size = data_offset() + initial_capacity * sizeof(T);
+			if (::ftruncate(file, static_cast<off_t>(size)) == -1)
+				throw_system_error("vale::mapped_vector: could not resize file!");
+			map_file(size);
+
+			mapped_vector_header& head = mutable_header();
+			std::memcpy(head.magic, mapped_vector_header::file_magic, sizeof(head.magic));
+			head.version = mapped_vector_header::file_version;
+			head.element_size = static_cast<uint32_t>(sizeof(T));
+			head.element_alignment = static_cast<uint32_t>(alignof(T));
+			head.data_offset = static_cast<uint32_t>(data_offset());
+			head.count = 0;
+			head.capacity = initial_capacity;
+			head.checksum = details::checksum64(nullptr, 0);
+		}
+
+		/// @brief Grows the file and its mapping to hold 'new_capacity' objects
+		void grow_file(size_t new_capacity)
+		{
+			if (new_capacity > (std::numeric_limits<size_t>::max() - data_offset()) / sizeof(T))
+				throw std::length_error("vale::mapped_vector: size was greater than max_size()!");
+			const size_t size = data_offset() + new_capacity * sizeof(T);
+			if (::ftruncate(file, static_cast<off_t>(size)) == -1)
+				throw_system_error("vale::mapped_vector: could not resize file!");
+#ifdef __linux__
+			void* ptr = ::mremap(mapping, mapping_size, size, MREMAP_MAYMOVE);
+			if (ptr == MAP_FAILED)
+				throw_system_error("vale::mapped_vector: could not map file!");
+			mapping = static_cast<unsigned char*>(ptr);
+			mapping_size = size;
+#else
+			::munmap(mapping, mapping_size);
+			mapping = nullptr;
+			map_file(size);
+#endif
+			mutable_header().capacity = new_capacity;
+		}
+
+		/// @brief Unmaps and closes the file
+		void close_file() noexcept
+		{
+			if (mapping != nullptr)
+				::munmap(mapping, mapping_size);
+			if (file != -1)
+				::close(file);
+			mapping = nullptr;
+			file = -1;
+		}
+	};
+
+	template<typename T, typename Growth>
+	/// @brief writes the content of the mapped vector between '{}', separating the objects by ','.
+	static std::ostream& operator<<(std::ostream& os, const mapped_vector<T, Growth>& var)
+	{
+		var.print(os);
+		return os;
+	}
+#endif
+
+	template<typename T, size_t inline_capacity, typename Growth = default_growth, typename Allocator = heap_allocator>
+	/// @brief Vector which stores up to 'inline_capacity' objects without allocating
+	using small_vector = vector<T, Growth, Allocator, OptionalBuffer, inline_capacity>;
+
+	template<typename T, typename Allocator = heap_allocator>
+	/// @brief Thread safe append-only vector typedef
+	using ts_vector = vector<T, default_growth, Allocator, NonOptionalBuffer, 0, ThreadSafe>;
+
+	template<typename T, typename Growth, typename Allocator>
+	/// @brief Overload for vale::vector without inline buffer, which only stores a pointer to its buffer
+	struct is_trivially_relocatable<vector<T, Growth, Allocator, NonOptionalBuffer, 0, NonThreadSafe>> : std::true_type {};
+
+	template<typename T, typename Growth, typename Allocator, typename BufferPolicy, size_t inline_capacity, typename ThreadSafety>
+	/// @brief writes the content of the vector between '{}', separating the objects by ','.
+	/// Only writes the published objects of a ThreadSafe vector.
+	static std::ostream& operator<<(std::ostream& os, const vector<T, Growth, Allocator, BufferPolicy, inline_capacity, ThreadSafety>& var)
+	{
+		var.print(os);
+		return os;
+	}
+}
@@ -4,11 +4,15 @@
 #define ANKERL_NANOBENCH_IMPLEMENT
 #include <nanobench.h>
 #include <chrono>
+#include <cstdlib>
 
 #include <vale_structs/array.h>
 #include <vale_structs/variant.h>
 
 #include <string>
+#include <string_view>
+
+#include "benchmarks/benchmarks.h"
 
 using namespace vale;
 using namespace std::string_literals;
@@ -17,6 +21,28 @@ using namespace std::string_literals;
 
 int main(int argc, char** argv)
 {
+	//'--bench' runs all the benchmark suites, '--bench <name>' only runs the suite named <name>
+	if (argc > 1 && std::string_view(argv[1]) == "--bench")
+	{
+		for (size_t i = 0; i < benchmarks::suites.size(); i++)
+		{
+			if (argc == 2 || std::string_view(argv[2]) == benchmarks::suites[i].name)
+				benchmarks::suites[i].run();
+		}
+		return 0;
+	}
+
+	//Without arguments, the checks are run, the executable failing if any of them fails
+	size_t failures = 0;
+	for (size_t i = 0; i < benchmarks::checks.size(); i++)
+	{
+		const size_t check_failures = benchmarks::checks[i].run();
+		std::cout << benchmarks::checks[i].name << ": " << (check_failures == 0 ? "passed" : "FAILED")
+			<< " (" << check_failures << " failures)\n";
+		failures += check_failures;
+	}
+
 	vale::array array_variants = { vale::variant<int, float, std::string>(10.0f), vale::variant<int, float, std::string>("Hello Vale"s) };
 	PRINT(array_variants);
-}
\ No newline at end of file
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}